@@ -53,6 +53,7 @@
 #include "Scripting/ScriptManager.h"
 #include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
+#include "UI/Browser/ThumbnailCache.h"
 #include "UI/SBrush.h"
 #include "Utility/Tokenizer.h"
 #include "SLADEWxApp.h"
@@ -464,6 +465,77 @@ bool App::init(vector<string>& args, double ui_scale)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Headless application initialisation (for batch mode). Only the non-UI
+// subsystems needed to open and process archives are initialised, so no
+// display is required
+// -----------------------------------------------------------------------------
+bool App::initHeadless()
+{
+	// Get the id of the current thread (should be the main one)
+	main_thread_id = std::this_thread::get_id();
+
+	// Set locale to C so that the tokenizer will work properly
+	// even in locales where the decimal separator is a comma.
+	setlocale(LC_ALL, "C");
+
+	// No splash window without a display
+	UI::enableSplash(false);
+
+	// Init application directories
+	if (!initDirectories())
+		return false;
+
+	// Init log
+	Log::init();
+
+	// Load configuration file
+	Log::info("Loading configuration");
+	KeyBind::initBinds();
+	readConfigFile();
+
+	// Check that SLADE.pk3 can be found
+	Log::info("Loading resources");
+	archive_manager.init();
+	if (!archive_manager.resArchiveOK())
+	{
+		Log::error("Unable to find slade.pk3, make sure it exists in the same directory as the SLADE executable");
+		return false;
+	}
+
+	// Init lua
+	Lua::init();
+
+	// Init palettes
+	if (!palette_manager.init())
+	{
+		Log::error("Failed to initialise palettes");
+		return false;
+	}
+
+	// Init SImage formats
+	SIFormat::initFormats();
+
+	// Load entry types
+	Log::info("Loading entry types");
+	EntryDataFormat::initBuiltinFormats();
+	EntryType::loadEntryTypes();
+
+	// Init base resource
+	Log::info("Loading base resource");
+	archive_manager.initBaseResource();
+
+	// Init game configuration (zdoom.pk3 is parsed up-front here, since batch
+	// jobs may open game configurations straight away)
+	Log::info("Loading game configurations");
+	Game::init(false);
+
+	init_ok = true;
+	Log::info("SLADE Headless Initialisation OK");
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Saves the SLADE configuration file
 // -----------------------------------------------------------------------------
@@ -562,6 +634,9 @@ void App::exit(bool save_config)
 		ScriptManager::saveUserScripts();
 	}
 
+	// Stop thumbnail worker threads
+	ThumbnailCache::shutdown();
+
 	// Close all open archives
 	archive_manager.closeAll();
 
@@ -16,6 +16,7 @@ bool            isExiting();
 ArchiveManager& archiveManager();
 
 bool init(vector<string>& args, double ui_scale = 1.);
+bool initHeadless();
 void saveConfigFile();
 void exit(bool save_config);
 
@@ -0,0 +1,558 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Batch.cpp
+// Description: Headless batch processing of archives (gfx conversion, map
+//              checks, unused texture/patch removal, scripts) from the
+//              command line
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Batch.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Game/Configuration.h"
+#include "General/Misc.h"
+#include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "MainEditor/ArchiveOperations.h"
+#include "MainEditor/EntryOperations.h"
+#include "MapEditor/MapChecks.h"
+#include "MapEditor/SLADEMap/SLADEMap.h"
+#include "Scripting/Lua.h"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+enum class Stage
+{
+	Open,
+	ConvertGfx,
+	RemoveUnusedPatches,
+	RemoveUnusedTextures,
+	MapCheck,
+	Script,
+	Save,
+
+	Count
+};
+const char* stage_names[] = {
+	"Open", "Convert Gfx", "Remove Unused Patches", "Remove Unused Textures", "Map Check", "Script", "Save"
+};
+
+struct Options
+{
+	vector<string>                  files;
+	unsigned                        jobs = 0;
+	string                          convert_gfx;
+	vector<MapCheck::StandardCheck> map_checks;
+	string                          game;
+	string                          port;
+	bool                            remove_unused_patches  = false;
+	bool                            remove_unused_textures = false;
+	string                          script;
+	bool                            rebuild = false;
+	string                          output_dir;
+};
+
+struct Result
+{
+	string         filename;
+	bool           ok                            = true;
+	bool           stage_run[(int)Stage::Count]  = {};
+	long           stage_time[(int)Stage::Count] = {};
+	long           wait_time                     = 0;
+	unsigned       gfx_converted                 = 0;
+	unsigned       map_problems                  = 0;
+	vector<string> messages;
+};
+
+// Stages that use global state (the resource manager, game configuration,
+// lua state etc.) can't run concurrently, so they are serialized with this.
+// Opening, gfx conversion and saving only touch the archive being processed
+// (zip temp files and png data are per-archive) so they run unlocked
+std::mutex global_mutex;
+uint8_t    config_format = MAP_UNKNOWN;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Prints command line usage info
+// -----------------------------------------------------------------------------
+void printHelp()
+{
+	printf("Usage: slade --batch [options] <archive> [<archive> ...]\n\n");
+	printf("Options:\n");
+	printf("  --jobs <n>                 Number of archives to process in parallel (default: all cores)\n");
+	printf("  --convert-gfx <format>     Convert all graphics to <format> (eg. png, doom)\n");
+	printf("  --remove-unused-patches    Remove patches not used in any TEXTUREx\n");
+	printf("  --remove-unused-textures   Remove textures not used in any map\n");
+	printf("  --map-check <checks>       Run map checks, 'all' or a comma-separated list of:\n");
+	printf("                            ");
+	for (int a = 0; a < MapCheck::NumStandardChecks; a++)
+		if (a != MapCheck::UnknownTexture && a != MapCheck::UnknownFlat)
+			printf(" %s", CHR(MapCheck::standardCheckId((MapCheck::StandardCheck)a)));
+	printf("\n");
+	printf("  --game <id> [--port <id>]  Game configuration to use for map checks\n");
+	printf("  --script <file>            Run the lua archive script in <file> on each archive\n");
+	printf("  --rebuild                  Save each archive even if unmodified\n");
+	printf("  --output <dir>             Save processed archives to <dir> instead of in-place\n");
+}
+
+// -----------------------------------------------------------------------------
+// Parses command line [args] into [opt].
+// Returns false if the args were invalid
+// -----------------------------------------------------------------------------
+bool parseArgs(const vector<string>& args, Options& opt)
+{
+	std::set<string> paths;
+	for (unsigned a = 0; a < args.size(); a++)
+	{
+		auto& arg       = args[a];
+		bool  has_value = a + 1 < args.size();
+
+		if (Batch::isBatchArg(arg))
+			continue;
+		else if (arg == "--help" || arg == "-h")
+			return false;
+		else if (arg == "--jobs" && has_value)
+		{
+			long jobs = 0;
+			args[++a].ToLong(&jobs);
+			opt.jobs = MAX(jobs, 0);
+		}
+		else if (arg == "--convert-gfx" && has_value)
+		{
+			opt.convert_gfx = args[++a];
+			if (SIFormat::getFormat(opt.convert_gfx) == SIFormat::unknownFormat())
+			{
+				printf("Unknown image format \"%s\"\n", CHR(opt.convert_gfx));
+				return false;
+			}
+		}
+		else if (arg == "--map-check" && has_value)
+		{
+			wxArrayString ids = wxSplit(args[++a], ',');
+			for (auto& id : ids)
+			{
+				bool found = false;
+				for (int c = 0; c < MapCheck::NumStandardChecks; c++)
+				{
+					// Texture checks need a texture manager, which isn't available
+					if (c == MapCheck::UnknownTexture || c == MapCheck::UnknownFlat)
+						continue;
+
+					if (id == "all" || MapCheck::standardCheckId((MapCheck::StandardCheck)c) == id)
+					{
+						opt.map_checks.push_back((MapCheck::StandardCheck)c);
+						found = true;
+					}
+				}
+
+				if (!found)
+				{
+					printf("Unknown or unsupported map check \"%s\"\n", CHR(id));
+					return false;
+				}
+			}
+		}
+		else if (arg == "--game" && has_value)
+			opt.game = args[++a];
+		else if (arg == "--port" && has_value)
+			opt.port = args[++a];
+		else if (arg == "--remove-unused-patches")
+			opt.remove_unused_patches = true;
+		else if (arg == "--remove-unused-textures")
+			opt.remove_unused_textures = true;
+		else if (arg == "--script" && has_value)
+		{
+			wxFile file(args[++a]);
+			if (!file.IsOpened() || !file.ReadAll(&opt.script))
+			{
+				printf("Unable to read script file \"%s\"\n", CHR(args[a]));
+				return false;
+			}
+		}
+		else if (arg == "--rebuild")
+			opt.rebuild = true;
+		else if (arg == "--output" && has_value)
+		{
+			opt.output_dir = args[++a];
+			if (!wxDirExists(opt.output_dir) && !wxMkdir(opt.output_dir))
+			{
+				printf("Unable to create output directory \"%s\"\n", CHR(opt.output_dir));
+				return false;
+			}
+		}
+		else if (arg.StartsWith("-"))
+		{
+			printf("Unknown or incomplete option \"%s\"\n", CHR(arg));
+			return false;
+		}
+		else
+		{
+			// Each archive can only be processed once, since jobs on the same
+			// file would overwrite each other's output
+			wxFileName fn(arg);
+			fn.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE | wxPATH_NORM_TILDE | wxPATH_NORM_CASE);
+			if (!paths.insert(fn.GetFullPath()).second)
+			{
+				printf("Archive \"%s\" given more than once\n", CHR(arg));
+				return false;
+			}
+
+			opt.files.push_back(arg);
+		}
+	}
+
+	return !opt.files.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Converts all image entries in [archive] to the format in [opt]
+// -----------------------------------------------------------------------------
+void convertGfx(Archive* archive, const Options& opt, Result& result)
+{
+	// Use the archive's palette if it has one, otherwise the global palette
+	Palette palette;
+	if (!Misc::loadPaletteFromArchive(&palette, archive))
+		palette.copyPalette(App::paletteManager()->globalPalette());
+
+	SIFormat::convert_options_t convert_opt;
+	convert_opt.pal_current = &palette;
+	convert_opt.pal_target  = &palette;
+
+	vector<ArchiveEntry*> entries;
+	archive->getEntryTreeAsList(entries);
+	for (auto entry : entries)
+	{
+		if (entry->getType() == EntryType::folderType() || !entry->getType()->extraProps().propertyExists("image"))
+			continue;
+
+		// Skip if already in the target format
+		if (SIFormat::determineFormat(entry->getMCData())->getId() == opt.convert_gfx)
+			continue;
+
+		if (EntryOperations::gfxConvert(entry, opt.convert_gfx, convert_opt))
+			result.gfx_converted++;
+		else
+			result.messages.push_back(S_FMT("Unable to convert %s", entry->getPath(true)));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Runs the map checks in [opt] on all maps in [archive]
+// -----------------------------------------------------------------------------
+void checkMaps(Archive* archive, const Options& opt, Result& result)
+{
+	for (auto& map_desc : archive->detectMaps())
+	{
+		// Open game configuration for the map format (if needed)
+		if (!opt.game.empty() && map_desc.format != config_format)
+		{
+			if (!Game::configuration().openConfig(opt.game, opt.port, map_desc.format))
+			{
+				result.messages.push_back(S_FMT("Unable to open game configuration \"%s\"", opt.game));
+				result.ok = false;
+				return;
+			}
+			config_format = map_desc.format;
+		}
+
+		// Read map
+		SLADEMap map;
+		if (!map.readMap(map_desc))
+		{
+			result.messages.push_back(S_FMT("%s: Unable to read map: %s", map_desc.name, Global::error));
+			result.ok = false;
+			continue;
+		}
+
+		// Run checks
+		for (auto type : opt.map_checks)
+		{
+			std::unique_ptr<MapCheck> check(MapCheck::standardCheck(type, &map));
+			if (!check)
+				continue;
+
+			check->doCheck();
+			for (unsigned a = 0; a < check->nProblems(); a++)
+				result.messages.push_back(S_FMT("%s: %s", map_desc.name, check->problemDesc(a)));
+			result.map_problems += check->nProblems();
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Saves [archive], either to the output directory in [opt] or in-place.
+// Returns false if saving failed
+// -----------------------------------------------------------------------------
+bool saveArchive(Archive* archive, const Options& opt, Result& result)
+{
+	bool ok;
+	if (!opt.output_dir.empty())
+	{
+		wxFileName fn(archive->filename());
+		fn.SetPath(opt.output_dir);
+		ok = archive->save(fn.GetFullPath());
+	}
+	else
+		ok = archive->save();
+
+	if (!ok)
+		result.messages.push_back(S_FMT("Unable to save: %s", Global::error));
+
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Opens and processes the archive [filename] with the stages enabled in [opt]
+// -----------------------------------------------------------------------------
+void processArchive(const string& filename, const Options& opt, Result& result)
+{
+	result.filename = filename;
+
+	wxStopWatch sw;
+	auto        begin = [&](Stage stage) {
+		result.stage_run[(int)stage] = true;
+		sw.Start();
+	};
+	auto end = [&](Stage stage) { result.stage_time[(int)stage] = sw.Time(); };
+
+	// Lock the global mutex for a serialized stage, recording the time spent
+	// waiting for it
+	auto lock = [&]() {
+		wxStopWatch wait;
+		std::unique_lock<std::mutex> l(global_mutex);
+		result.wait_time += wait.Time();
+		return l;
+	};
+
+	// Open (if the archive is already open in the archive manager, eg. from a
+	// script, use it but leave it to the archive manager to close)
+	begin(Stage::Open);
+	Archive* managed;
+	{
+		auto l  = lock();
+		managed = App::archiveManager().getArchive(filename);
+	}
+	auto                     archive = managed ? managed : App::archiveManager().openArchive(filename, false, true);
+	std::unique_ptr<Archive> owned(managed ? nullptr : archive);
+	end(Stage::Open);
+	if (!archive)
+	{
+		result.messages.push_back(S_FMT("Unable to open: %s", Global::error));
+		result.ok = false;
+		return;
+	}
+
+	// Gfx conversion
+	if (!opt.convert_gfx.empty())
+	{
+		begin(Stage::ConvertGfx);
+		convertGfx(archive, opt, result);
+		end(Stage::ConvertGfx);
+	}
+
+	// Remove unused patches
+	if (opt.remove_unused_patches)
+	{
+		auto l = lock();
+		begin(Stage::RemoveUnusedPatches);
+		ArchiveOperations::removeUnusedPatches(archive, false);
+		end(Stage::RemoveUnusedPatches);
+	}
+
+	// Remove unused textures
+	if (opt.remove_unused_textures)
+	{
+		auto l = lock();
+		begin(Stage::RemoveUnusedTextures);
+		int removed = ArchiveOperations::removeUnusedTextures(archive, false);
+		if (removed > 0)
+			result.messages.push_back(S_FMT("Removed %d unused textures", removed));
+		end(Stage::RemoveUnusedTextures);
+	}
+
+	// Map checks
+	if (!opt.map_checks.empty())
+	{
+		auto l = lock();
+		begin(Stage::MapCheck);
+		checkMaps(archive, opt, result);
+		end(Stage::MapCheck);
+	}
+
+	// Script
+	if (!opt.script.empty())
+	{
+		auto l = lock();
+		begin(Stage::Script);
+		if (!Lua::runArchiveScript(opt.script, archive))
+		{
+			result.messages.push_back(S_FMT("Script error: %s", Lua::error().message));
+			result.ok = false;
+		}
+		end(Stage::Script);
+	}
+
+	// Save
+	if (archive->isModified() || opt.rebuild || !opt.output_dir.empty())
+	{
+		begin(Stage::Save);
+		if (!saveArchive(archive, opt, result))
+			result.ok = false;
+		end(Stage::Save);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Prints the per-archive and total timing report for [results]
+// -----------------------------------------------------------------------------
+void printReport(const vector<Result>& results, unsigned n_threads, long wall_time)
+{
+	long total[(int)Stage::Count] = {};
+	long total_wait               = 0;
+	int  failed                   = 0;
+
+	printf("\n");
+	for (auto& result : results)
+	{
+		printf("%s: %s\n", CHR(result.filename), result.ok ? "OK" : "FAILED");
+		for (int s = 0; s < (int)Stage::Count; s++)
+		{
+			if (!result.stage_run[s])
+				continue;
+
+			printf("  %-24s %6ldms", stage_names[s], result.stage_time[s]);
+			if (s == (int)Stage::ConvertGfx)
+				printf("  (%u converted)", result.gfx_converted);
+			else if (s == (int)Stage::MapCheck)
+				printf("  (%u problems)", result.map_problems);
+			printf("\n");
+
+			total[s] += result.stage_time[s];
+		}
+		if (result.wait_time > 0)
+			printf("  %-24s %6ldms\n", "(Waiting)", result.wait_time);
+		for (auto& message : result.messages)
+			printf("    %s\n", CHR(message));
+
+		total_wait += result.wait_time;
+		if (!result.ok)
+			failed++;
+	}
+
+	printf("\nTotals (%lu archives, %d failed):\n", (unsigned long)results.size(), failed);
+	for (int s = 0; s < (int)Stage::Count; s++)
+		if (total[s] > 0)
+			printf("  %-24s %6ldms\n", stage_names[s], total[s]);
+	printf("  %-24s %6ldms\n", "(Waiting)", total_wait);
+	printf("  %-24s %6ldms (%u threads)\n", "Wall Time", wall_time, n_threads);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Batch Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if [arg] is the command line argument to run in batch mode
+// -----------------------------------------------------------------------------
+bool Batch::isBatchArg(const string& arg)
+{
+	return arg == "--batch";
+}
+
+// -----------------------------------------------------------------------------
+// Runs batch processing with the given command line [args].
+// Returns the process exit code (0 if all archives were processed successfully)
+// -----------------------------------------------------------------------------
+int Batch::run(const vector<string>& args)
+{
+	Options opt;
+	if (!parseArgs(args, opt))
+	{
+		printHelp();
+		return 2;
+	}
+
+	// Determine number of threads
+	unsigned n_threads = opt.jobs > 0 ? opt.jobs : std::thread::hardware_concurrency();
+	n_threads          = MAX(MIN(n_threads, (unsigned)opt.files.size()), 1u);
+
+	// Process archives
+	vector<Result>      results(opt.files.size());
+	std::atomic<size_t> next(0);
+	std::mutex          print_mutex;
+	auto                worker = [&]() {
+		size_t index;
+		while ((index = next++) < opt.files.size())
+		{
+			processArchive(opt.files[index], opt, results[index]);
+
+			std::lock_guard<std::mutex> l(print_mutex);
+			printf("Processed %s (%s)\n", CHR(opt.files[index]), results[index].ok ? "OK" : "FAILED");
+		}
+	};
+
+	wxStopWatch         sw;
+	vector<std::thread> threads;
+	for (unsigned a = 1; a < n_threads; a++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+
+	printReport(results, n_threads, sw.Time());
+
+	for (auto& result : results)
+		if (!result.ok)
+			return 1;
+
+	return 0;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Headless batch processing of archives from the command line, eg.
+//   slade --batch --convert-gfx png --map-check all --output out/ *.wad
+// Each archive is opened and processed independently, so multiple archives
+// are processed in parallel
+namespace Batch
+{
+bool isBatchArg(const string& arg);
+int  run(const vector<string>& args);
+} // namespace Batch
@@ -33,6 +33,7 @@
 #include "SLADEWxApp.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Batch.h"
 #include "External/email/wxMailer.h"
 #include "General/Console/Console.h"
 #include "General/Web.h"
@@ -57,7 +58,7 @@
 // -----------------------------------------------------------------------------
 namespace Global
 {
-string error = "";
+thread_local string error = "";
 
 int    beta_num    = 5;
 int    version_num = 3120;
@@ -244,8 +245,8 @@ public:
 
 		// Last 10 log lines
 		trace_ += "\nLast Log Messages:\n";
-		auto& log = Log::history();
-		for (auto a = log.size() - 10; a < log.size(); a++)
+		auto log = Log::history();
+		for (auto a = log.size() > 10 ? log.size() - 10 : 0; a < log.size(); a++)
 			trace_ += log[a].message + "\n";
 
 		// Add stack trace text area
@@ -500,11 +501,51 @@ bool SLADEWxApp::singleInstanceCheck()
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Initialises wxWidgets. In batch mode only the console (non-GUI) parts are
+// initialised, so that no display is required
+// -----------------------------------------------------------------------------
+bool SLADEWxApp::Initialize(int& argc, wxChar** argv)
+{
+	for (int a = 1; a < argc; a++)
+		if (Batch::isBatchArg(argv[a]))
+			batch_mode_ = true;
+
+	if (batch_mode_)
+		return wxAppConsole::Initialize(argc, argv);
+
+	return wxApp::Initialize(argc, argv);
+}
+
+// -----------------------------------------------------------------------------
+// Cleans up wxWidgets (see Initialize)
+// -----------------------------------------------------------------------------
+void SLADEWxApp::CleanUp()
+{
+	if (batch_mode_)
+		wxAppConsole::CleanUp();
+	else
+		wxApp::CleanUp();
+}
+
 // -----------------------------------------------------------------------------
 // Application initialization, run when program is started
 // -----------------------------------------------------------------------------
 bool SLADEWxApp::OnInit()
 {
+	// Batch mode
+	if (batch_mode_)
+	{
+#ifdef __WINDOWS__
+		wxApp::SetAppName("SLADE3");
+#else
+		wxApp::SetAppName("slade3");
+#endif
+		wxInitAllImageHandlers();
+		wxLog::SetActiveTarget(new SLADELog());
+		return App::initHeadless();
+	}
+
 	// Check if an instance of SLADE is already running
 	if (!singleInstanceCheck())
 	{
@@ -582,11 +623,31 @@ bool SLADEWxApp::OnInit()
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Runs the application main loop, or the batch processing if in batch mode
+// -----------------------------------------------------------------------------
+int SLADEWxApp::OnRun()
+{
+	if (batch_mode_)
+	{
+		vector<string> args;
+		for (int a = 1; a < argc; a++)
+			args.push_back(argv[a]);
+
+		return Batch::run(args);
+	}
+
+	return wxApp::OnRun();
+}
+
 // -----------------------------------------------------------------------------
 // Application shutdown, run when program is closed
 // -----------------------------------------------------------------------------
 int SLADEWxApp::OnExit()
 {
+	if (batch_mode_)
+		return 0;
+
 	wxSocketBase::Shutdown();
 	delete single_instance_checker_;
 	delete file_listener_;
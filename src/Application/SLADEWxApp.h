@@ -9,7 +9,10 @@ public:
 	SLADEWxApp();
 	~SLADEWxApp();
 
+	bool Initialize(int& argc, wxChar** argv) override;
+	void CleanUp() override;
 	bool OnInit() override;
+	int  OnRun() override;
 	int  OnExit() override;
 	void OnFatalException() override;
 
@@ -27,6 +30,7 @@ public:
 private:
 	wxSingleInstanceChecker* single_instance_checker_;
 	MainAppFileListener*     file_listener_;
+	bool                     batch_mode_ = false;
 };
 
 DECLARE_APP(SLADEWxApp)
@@ -66,6 +66,7 @@ ArchiveEntry::ArchiveEntry(string name, uint32_t size)
 	prev_         = nullptr;
 	encrypted_    = ENC_NONE;
 	index_guess_  = 0;
+	modified_count_ = 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -88,6 +89,7 @@ ArchiveEntry::ArchiveEntry(ArchiveEntry& copy)
 	prev_         = nullptr;
 	encrypted_    = copy.encrypted_;
 	index_guess_  = 0;
+	modified_count_ = 0;
 
 	// Copy data
 	data_.importMem(copy.getData(true), copy.getSize());
@@ -234,6 +236,11 @@ ArchiveEntry::SPtr ArchiveEntry::getShared()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::setState(uint8_t state, bool silent)
 {
+	// Any (non-'unmodified') state change means the entry data or info may
+	// have changed, even if the state itself stays the same
+	if (state > 0)
+		modified_count_++;
+
 	if (state_locked_ || (state == 0 && this->state_ == 0))
 		return;
 
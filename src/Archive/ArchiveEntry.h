@@ -51,6 +51,7 @@ public:
 	PropertyList&    exProps() { return ex_props_; }
 	Property&        exProp(string key) { return ex_props_[key]; }
 	uint8_t          getState() { return state_; }
+	unsigned         modifiedCount() const { return modified_count_; }
 	bool             isLocked() { return locked_; }
 	bool             isLoaded() { return data_loaded_; }
 	int              isEncrypted() { return encrypted_; }
@@ -132,6 +133,7 @@ private:
 	bool    locked_;       // If true the entry data+info cannot be changed
 	bool    data_loaded_;  // True if the entry's data is currently loaded into the data MemChunk
 	int     encrypted_;    // Is there some encrypting on the archive?
+	unsigned modified_count_; // Incremented each time the entry is modified
 
 	// Misc stuff
 	int           reliability_; // The reliability of the entry's identification
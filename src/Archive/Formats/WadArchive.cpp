@@ -31,8 +31,10 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WadArchive.h"
+#include "General/Console/Console.h"
 #include "General/Misc.h"
 #include "General/UI.h"
+#include "MainEditor/MainEditor.h"
 #include "Utility/Tokenizer.h"
 #include "WadJArchive.h"
 
@@ -44,6 +46,8 @@
 // -----------------------------------------------------------------------------
 CVAR(Bool, wad_force_uppercase, true, CVAR_SAVE)
 CVAR(Bool, iwad_lock, true, CVAR_SAVE)
+CVAR(Bool, wad_save_incremental, true, CVAR_SAVE)
+CVAR(Int, wad_compact_threshold, 25, CVAR_SAVE) // Max % of unused space in the file before a full save is done
 
 namespace
 {
@@ -600,6 +604,12 @@ bool WadArchive::write(string filename, bool update)
 		return false;
 	}
 
+	// If overwriting the wad file itself, make sure all entry data is loaded
+	// before the file is truncated
+	if (filename == filename_)
+		for (uint32_t l = 0; l < numEntries(); l++)
+			getEntry(l)->getData(true);
+
 	// Open file for writing
 	wxFile file;
 	file.Open(filename, wxFile::write);
@@ -667,6 +677,180 @@ bool WadArchive::write(string filename, bool update)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Override of Archive::save to save the wad incrementally if possible, when
+// overwriting the existing file on disk (see writeIncremental)
+// -----------------------------------------------------------------------------
+bool WadArchive::save(string filename)
+{
+	if (wad_save_incremental && filename.IsEmpty() && !parent_ && on_disk_ && !read_only_ && formatId() == "wad")
+	{
+		if (writeIncremental())
+		{
+			setModified(false);
+			announce("saved");
+			return true;
+		}
+	}
+
+	return Archive::save(filename);
+}
+
+// -----------------------------------------------------------------------------
+// Rewrites the whole wad file on disk, removing any unused space left behind
+// by incremental saves
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool WadArchive::compact()
+{
+	if (parent_ || !on_disk_)
+	{
+		Global::error = "Archive is not a file on disk";
+		return false;
+	}
+
+	return Archive::save();
+}
+
+// -----------------------------------------------------------------------------
+// Saves the wad to its existing file on disk without rewriting it entirely.
+// Data for any unmodified lumps is left where it is in the file, and only new
+// or modified lumps are appended to the end of the file, followed by a new
+// directory. The header is written last, so if saving fails part way through
+// the existing file is still valid (no backup is made).
+//
+// Returns false if the wad couldn't (or shouldn't) be saved incrementally, in
+// which case the file is either untouched or still valid, and a full save
+// should be done instead. A full save is needed if the wad contains encrypted
+// lumps, or if the amount of unused space in the file would exceed
+// wad_compact_threshold percent
+// -----------------------------------------------------------------------------
+bool WadArchive::writeIncremental()
+{
+	if (iwad_ && iwad_lock)
+		return false;
+
+	if (!wxFileExists(filename_))
+		return false;
+
+	// Open the existing file
+	wxFile file(filename_, wxFile::read_write);
+	if (!file.IsOpened())
+		return false;
+	uint64_t file_size = file.Length();
+
+	// Determine which lumps can keep their existing data in the file
+	uint32_t     num_lumps = numEntries();
+	vector<bool> keep(num_lumps, false);
+	uint64_t     size_kept     = 0;
+	uint64_t     size_appended = 0;
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		auto entry = getEntry(l);
+		auto size  = entry->getSize();
+
+		// Lumps that would be saved differently in a full write
+		if (entry->isEncrypted())
+			return false;
+
+		// Lump data is unchanged if the entry is unmodified or its data was
+		// never loaded from the file
+		if (entry->exProps().propertyExists("Offset") && (entry->getState() == 0 || !entry->isLoaded())
+			&& (size == 0 || getEntryOffset(entry) + (uint64_t)size <= file_size))
+		{
+			keep[l] = true;
+			size_kept += size;
+		}
+		else
+			size_appended += size;
+	}
+
+	// Check the resulting file is valid and not too wasteful
+	uint64_t dir_offset = file_size + size_appended;
+	uint64_t new_size   = dir_offset + num_lumps * 16;
+	if (new_size > 0xFFFFFFFF)
+		return false;
+	uint64_t unused = new_size - 12 - size_kept - size_appended - num_lumps * 16;
+	if (unused * 100 > new_size * wad_compact_threshold)
+	{
+		LOG_MESSAGE(2, "Wad file %s has %llu unused bytes, compacting", filename_, (unsigned long long)unused);
+		return false;
+	}
+
+	// Write new/modified lump data at the end of the file
+	vector<uint32_t> offsets(num_lumps);
+	if (file.Seek(file_size, wxFromStart) == wxInvalidOffset)
+		return false;
+	uint32_t offset = file_size;
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		auto entry = getEntry(l);
+		if (keep[l])
+		{
+			offsets[l] = getEntryOffset(entry);
+			continue;
+		}
+
+		offsets[l] = offset;
+		if (entry->getSize() > 0)
+		{
+			if (file.Write(entry->getData(), entry->getSize()) != entry->getSize())
+				return false;
+			offset += entry->getSize();
+		}
+	}
+
+	// Write the directory
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		auto     entry    = getEntry(l);
+		char     name[8]  = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		uint32_t l_offset = wxINT32_SWAP_ON_BE(offsets[l]);
+		uint32_t l_size   = wxINT32_SWAP_ON_BE(entry->getSize());
+
+		for (size_t c = 0; c < entry->getName().length() && c < 8; c++)
+			name[c] = entry->getName()[c];
+
+		if (file.Write(&l_offset, 4) != 4 || file.Write(&l_size, 4) != 4 || file.Write(name, 8) != 8)
+			return false;
+	}
+	if (!file.Flush())
+		return false;
+
+	// Finally, write the header to point to the new directory
+	char wad_type[4] = { 'P', 'W', 'A', 'D' };
+	if (iwad_)
+		wad_type[0] = 'I';
+	uint32_t h_num_lumps  = wxINT32_SWAP_ON_BE(num_lumps);
+	uint32_t h_dir_offset = wxINT32_SWAP_ON_BE((uint32_t)dir_offset);
+	file.Seek(0, wxFromStart);
+	if (file.Write(wad_type, 4) != 4 || file.Write(&h_num_lumps, 4) != 4 || file.Write(&h_dir_offset, 4) != 4)
+	{
+		// Header may be partially written at this point
+		LOG_MESSAGE(1, "WadArchive::writeIncremental: Failed writing header to %s", filename_);
+		Global::error = "Failed writing wad header";
+		return false;
+	}
+	file.Close();
+
+	// Update entries
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		auto entry              = getEntry(l);
+		entry->exProp("Offset") = (int)offsets[l];
+		entry->setState(0);
+	}
+
+	LOG_MESSAGE(
+		2,
+		"Saved wad %s incrementally (%llu bytes appended, %llu unused)",
+		filename_,
+		(unsigned long long)size_appended,
+		(unsigned long long)unused);
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Loads an entry's data from the wadfile
 // Returns true if successful, false otherwise
@@ -1602,3 +1786,24 @@ bool WadArchive::isWadArchive(string filename)
 	// If it's passed to here it's probably a wad file
 	return true;
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+CONSOLE_COMMAND(wad_compact, 0, true)
+{
+	Archive* archive = MainEditor::currentArchive();
+	if (archive && archive->formatId() == "wad")
+	{
+		if (((WadArchive*)archive)->compact())
+			Log::console(S_FMT("Compacted %s", archive->filename()));
+		else
+			Log::console(S_FMT("Compacting failed: %s", Global::error));
+	}
+	else
+		Log::console("Current tab is not a wad archive");
+}
@@ -21,6 +21,8 @@ public:
 	// Writing/Saving
 	bool write(MemChunk& mc, bool update = true) override;    // Write to MemChunk
 	bool write(string filename, bool update = true) override; // Write to File
+	bool save(string filename = "") override;                 // Save archive
+	bool compact();                                            // Full rewrite of the wad file on disk
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
@@ -94,4 +96,6 @@ private:
 
 	bool           iwad_;
 	vector<NSPair> namespaces_;
+
+	bool writeIncremental();
 };
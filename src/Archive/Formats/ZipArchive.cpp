@@ -34,7 +34,19 @@
 #include "App.h"
 #include "General/UI.h"
 #include "WadArchive.h"
+#include <atomic>
 #include <fstream>
+#include <thread>
+#include <wx/mstream.h>
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, zip_compression_level, 9, CVAR_SAVE)
+CVAR(Int, zip_save_threads, 0, CVAR_SAVE) // 0 = use all available cores
 
 
 // -----------------------------------------------------------------------------
@@ -67,6 +79,79 @@ struct ZipFileHeader
 	uint16_t len_fn;
 	uint16_t len_extra;
 };
+
+// Struct holding a modified entry to be compressed when writing a zip
+struct ZipCompressJob
+{
+	string                                name;
+	const uint8_t*                        data;
+	unsigned                              size;
+	bool                                  store;
+	std::unique_ptr<wxMemoryOutputStream> out;
+};
+
+// Formats that are already compressed, and are just stored in the zip rather
+// than deflated again
+const char* stored_formats[] = { "img_png",   "img_jpeg",  "img_gif",      "snd_ogg",     "snd_flac",
+								 "snd_mp3",   "snd_mp2",   "archive_zip",  "archive_gzip", "archive_bz2" };
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is of an already-compressed format
+// -----------------------------------------------------------------------------
+bool isCompressedFormat(ArchiveEntry* entry)
+{
+	auto& format = entry->getType()->formatId();
+	for (auto id : stored_formats)
+		if (format == id)
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Compresses [job]'s data as a single entry zip in [job]'s output stream
+// -----------------------------------------------------------------------------
+void compressZipJob(ZipCompressJob& job, int level)
+{
+	job.out = std::make_unique<wxMemoryOutputStream>();
+	wxZipOutputStream zip(*job.out, level);
+	auto              zipentry = new wxZipEntry(job.name);
+	if (job.store || level == 0)
+		zipentry->SetMethod(wxZIP_METHOD_STORE);
+	zip.PutNextEntry(zipentry);
+	zip.Write(job.data, job.size);
+	zip.Close();
+}
+
+// -----------------------------------------------------------------------------
+// Compresses all [jobs], split between multiple threads
+// -----------------------------------------------------------------------------
+void compressZipJobs(vector<std::unique_ptr<ZipCompressJob>>& jobs, int level)
+{
+	// Determine number of threads to use
+	unsigned n_threads = zip_save_threads > 0 ? (unsigned)zip_save_threads : std::thread::hardware_concurrency();
+	n_threads          = MIN(n_threads, jobs.size());
+	if (n_threads <= 1)
+	{
+		for (auto& job : jobs)
+			compressZipJob(*job, level);
+		return;
+	}
+
+	// Each thread takes the next job in the list until none remain
+	std::atomic<size_t> next(0);
+	auto worker = [&]() {
+		for (size_t a = next++; a < jobs.size(); a = next++)
+			compressZipJob(*jobs[a], level);
+	};
+
+	vector<std::thread> threads;
+	for (unsigned t = 1; t < n_threads; t++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+}
 } // namespace
 
 // -----------------------------------------------------------------------------
@@ -268,7 +353,8 @@ bool ZipArchive::write(string filename, bool update)
 	}
 
 	// Open as zip for writing
-	wxZipOutputStream zip(out, 9);
+	int               level = MAX(0, MIN(9, (int)zip_compression_level));
+	wxZipOutputStream zip(out, level);
 	if (!zip.IsOk())
 	{
 		Global::error = "Unable to create zip for saving";
@@ -291,6 +377,33 @@ bool ZipArchive::write(string filename, bool update)
 	vector<ArchiveEntry*> entries;
 	getEntryTreeAsList(entries);
 
+	// Compress all modified entries (or entries not in the old zip) up-front
+	// on multiple threads, each into its own single-entry zip in memory. These
+	// are then copied over to the new zip as-is below
+	vector<std::unique_ptr<ZipCompressJob>> jobs;
+	vector<ZipCompressJob*>                 entry_jobs(entries.size(), nullptr);
+	for (size_t a = 0; a < entries.size(); a++)
+	{
+		if (entries[a]->getType() == EntryType::folderType())
+			continue;
+
+		int index = -1;
+		if (entries[a]->exProps().propertyExists("ZipIndex"))
+			index = entries[a]->exProp("ZipIndex");
+
+		if (!inzip.IsOk() || entries[a]->getState() > 0 || index < 0 || index >= inzip.GetTotalEntries())
+		{
+			auto job   = std::make_unique<ZipCompressJob>();
+			job->name     = entries[a]->getPath() + entries[a]->getName();
+			job->data     = entries[a]->getData();
+			job->size     = entries[a]->getSize();
+			job->store    = isCompressedFormat(entries[a]);
+			entry_jobs[a] = job.get();
+			jobs.push_back(std::move(job));
+		}
+	}
+	compressZipJobs(jobs, level);
+
 	// Go through all entries
 	for (size_t a = 0; a < entries.size(); a++)
 	{
@@ -311,10 +424,18 @@ bool ZipArchive::write(string filename, bool update)
 		if (!inzip.IsOk() || entries[a]->getState() > 0 || index < 0 || index >= inzip.GetTotalEntries())
 		{
 			// If the current entry has been changed, or doesn't exist in the old zip,
-			// (re)compress its data and write it to the zip
-			wxZipEntry* zipentry = new wxZipEntry(entries[a]->getPath() + entries[a]->getName());
-			zip.PutNextEntry(zipentry);
-			zip.Write(entries[a]->getData(), entries[a]->getSize());
+			// copy its (re)compressed data to the zip
+			auto                job = entry_jobs[a];
+			wxMemoryInputStream job_in(*job->out);
+			wxZipInputStream    job_zip(job_in);
+			if (!zip.CopyEntry(job_zip.GetNextEntry(), job_zip))
+			{
+				LOG_MESSAGE(1, "ZipArchive::write: Failed writing entry %s", job->name);
+				Global::error = "Failed writing entry " + job->name;
+				delete[] c_entries;
+				return false;
+			}
+			job->out.reset();
 		}
 		else
 		{
@@ -626,26 +747,20 @@ vector<ArchiveEntry*> ZipArchive::findAll(SearchOptions& options)
 
 // -----------------------------------------------------------------------------
 // Generates the temp file path to use, from [filename].
-// The temp file will be in the configured temp folder
+// The temp file will be in the configured temp folder, and is created straight
+// away (only if it doesn't already exist) so that zips with the same name
+// opened at the same time (eg. in batch mode) can't get the same temp file
 // -----------------------------------------------------------------------------
 void ZipArchive::generateTempFileName(string filename)
 {
 	wxFileName tfn(filename);
-	temp_file_ = App::path(tfn.GetFullName(), App::Dir::Temp);
-	if (wxFileExists(temp_file_))
-	{
-		// Make sure we don't overwrite an existing temp file
-		// (in case there are multiple zips open with the same name)
-		int n = 1;
-		while (1)
-		{
-			temp_file_ = App::path(S_FMT("%s.%d", CHR(tfn.GetFullName()), n), App::Dir::Temp);
-			if (!wxFileExists(temp_file_))
-				break;
+	wxLogNull  no_log;
+	wxFile     file;
 
-			n++;
-		}
-	}
+	// Add a number if a temp file with the name already exists
+	temp_file_ = App::path(tfn.GetFullName(), App::Dir::Temp);
+	for (int n = 1; n < 1000 && !file.Create(temp_file_, false); n++)
+		temp_file_ = App::path(S_FMT("%s.%d", CHR(tfn.GetFullName()), n), App::Dir::Temp);
 }
 
 
@@ -153,6 +153,8 @@ gc_mapinfo_t Configuration::mapInfo(string name)
 // -----------------------------------------------------------------------------
 void Configuration::readActionSpecials(ParseTreeNode* node, Arg::SpecialMap& shared_args, ActionSpecial* group_defaults)
 {
+	action_special_lookup_.invalidate();
+
 	// Check if we're clearing all existing specials
 	if (node->getChild("clearexisting"))
 		action_specials_.clear();
@@ -220,6 +222,8 @@ void Configuration::readActionSpecials(ParseTreeNode* node, Arg::SpecialMap& sha
 // -----------------------------------------------------------------------------
 void Configuration::readThingTypes(ParseTreeNode* node, const ThingType& group_defaults)
 {
+	thing_type_lookup_.invalidate();
+
 	// Check if we're clearing all existing specials
 	if (node->getChild("clearexisting"))
 		thing_types_.clear();
@@ -531,6 +535,8 @@ bool Configuration::readConfiguration(string& cfg, string source, uint8_t format
 		setDefaults();
 		action_specials_.clear();
 		thing_types_.clear();
+		action_special_lookup_.invalidate();
+		thing_type_lookup_.invalidate();
 		flags_thing_.clear();
 		flags_line_.clear();
 		sector_types_.clear();
@@ -982,11 +988,12 @@ bool Configuration::openConfig(string game, string port, uint8_t format)
 // -----------------------------------------------------------------------------
 const ActionSpecial& Configuration::actionSpecial(unsigned id)
 {
-	auto& as = action_specials_[id];
+	if (!action_special_lookup_.valid())
+		action_special_lookup_.build(action_specials_, nullptr);
 
 	// Defined Action Special
-	if (as.defined())
-		return as;
+	if (auto as = action_special_lookup_.get(id))
+		return *as;
 
 	// Boom Generalised Special
 	if (supported_features_[Feature::Boom] && id >= 0x2f80)
@@ -1012,8 +1019,11 @@ string Configuration::actionSpecialName(int special)
 	else if (special == 0)
 		return "None";
 
-	if (action_specials_[special].defined())
-		return action_specials_[special].name();
+	if (!action_special_lookup_.valid())
+		action_special_lookup_.build(action_specials_, nullptr);
+
+	if (auto as = action_special_lookup_.get(special))
+		return as->name();
 	else if (special >= 0x2F80 && supported_features_[Feature::Boom])
 		return BoomGenLineSpecial::parseLineType(special);
 	else
@@ -1025,11 +1035,10 @@ string Configuration::actionSpecialName(int special)
 // -----------------------------------------------------------------------------
 const ThingType& Configuration::thingType(unsigned type)
 {
-	auto& ttype = thing_types_[type];
-	if (ttype.defined())
-		return ttype;
-	else
-		return ThingType::unknown();
+	if (!thing_type_lookup_.valid())
+		thing_type_lookup_.build(thing_types_, &ThingType::unknown());
+
+	return *thing_type_lookup_.get(type);
 }
 
 // -----------------------------------------------------------------------------
@@ -1074,99 +1083,120 @@ bool Configuration::thingFlagSet(unsigned index, MapThing* thing)
 // -----------------------------------------------------------------------------
 bool Configuration::thingFlagSet(string flag, MapThing* thing, int map_format)
 {
-	// If UDMF, just get the bool value
-	if (map_format == MAP_UDMF)
-		return thing->boolProperty(flag);
+	return thingFlagHandle(flag, map_format, false).isSet(thing);
+}
 
-	// Get current flags
-	unsigned long flags = thing->intProperty("flags");
+// -----------------------------------------------------------------------------
+// Returns true if the basic flag matching [flag] is set for [thing]
+// -----------------------------------------------------------------------------
+bool Configuration::thingBasicFlagSet(string flag, MapThing* thing, int map_format)
+{
+	return thingFlagHandle(flag, map_format, true).isSet(thing);
+}
 
-	// Iterate through flags
-	for (size_t i = 0; i < flags_thing_.size(); ++i)
+// -----------------------------------------------------------------------------
+// Returns true if the flag is set on [object] (which should be the type of
+// object the handle was resolved for)
+// -----------------------------------------------------------------------------
+bool Configuration::FlagHandle::isSet(MapObject* object) const
+{
+	static const string flags_key = "flags";
+
+	switch (test)
 	{
-		if (flags_thing_[i].udmf == flag)
-			return !!(flags & flags_thing_[i].flag);
+	case Test::Always: return true;
+	case Test::Set: return !!((unsigned long)object->intProperty(flags_key) & mask);
+	case Test::Unset: return !((unsigned long)object->intProperty(flags_key) & mask);
+	case Test::UDMF: return object->boolProperty(udmf);
+	default: return false;
 	}
-	LOG_MESSAGE(2, "Flag %s does not exist in this configuration", flag);
-	return false;
 }
 
 // -----------------------------------------------------------------------------
-// Returns true if the basic flag matching [flag] is set for [thing]
+// Resolves the thing flag matching [flag] (UDMF name) for [map_format] into a
+// FlagHandle that can be used to quickly test the flag on any number of things.
+// If [basic] is true, 'basic' flags (skills, game modes, classes) are checked
+// for first
 // -----------------------------------------------------------------------------
-bool Configuration::thingBasicFlagSet(string flag, MapThing* thing, int map_format)
+Configuration::FlagHandle Configuration::thingFlagHandle(const string& flag, int map_format, bool basic)
 {
 	// If UDMF, just get the bool value
 	if (map_format == MAP_UDMF)
-		return thing->boolProperty(flag);
+		return FlagHandle(FlagHandle::Test::UDMF, 0, flag);
 
-	// Get current flags
-	unsigned long flags = thing->intProperty("flags");
+	if (basic)
+	{
+		// Hexen-style flags in Hexen-format maps
+		bool hexen = map_format == MAP_HEXEN;
 
-	// Hexen-style flags in Hexen-format maps
-	bool hexen = map_format == MAP_HEXEN;
+		// Easy Skill
+		if (flag == "skill2" || flag == "skill1")
+			return FlagHandle(FlagHandle::Test::Set, 1);
 
-	// Easy Skill
-	if (flag == "skill2" || flag == "skill1")
-		return !!(flags & 1);
+		// Medium Skill
+		else if (flag == "skill3")
+			return FlagHandle(FlagHandle::Test::Set, 2);
 
-	// Medium Skill
-	else if (flag == "skill3")
-		return !!(flags & 2);
+		// Hard Skill
+		else if (flag == "skill4" || flag == "skill5")
+			return FlagHandle(FlagHandle::Test::Set, 4);
 
-	// Hard Skill
-	else if (flag == "skill4" || flag == "skill5")
-		return !!(flags & 4);
+		// Game mode flags
+		else if (flag == "single")
+		{
+			// Single Player
+			if (hexen)
+				return FlagHandle(FlagHandle::Test::Set, 256);
+			// *Not* Multiplayer
+			else
+				return FlagHandle(FlagHandle::Test::Unset, 16);
+		}
+		else if (flag == "coop")
+		{
+			// Coop
+			if (hexen)
+				return FlagHandle(FlagHandle::Test::Set, 512);
+			// *Not* Not In Coop
+			else if (supported_features_[Feature::Boom])
+				return FlagHandle(FlagHandle::Test::Unset, 64);
+			else
+				return FlagHandle(FlagHandle::Test::Always);
+		}
+		else if (flag == "dm")
+		{
+			// Deathmatch
+			if (hexen)
+				return FlagHandle(FlagHandle::Test::Set, 1024);
+			// *Not* Not In DM
+			else if (supported_features_[Feature::Boom])
+				return FlagHandle(FlagHandle::Test::Unset, 32);
+			else
+				return FlagHandle(FlagHandle::Test::Always);
+		}
 
-	// Game mode flags
-	else if (flag == "single")
-	{
-		// Single Player
-		if (hexen)
-			return !!(flags & 256);
-		// *Not* Multiplayer
-		else
-			return !(flags & 16);
-	}
-	else if (flag == "coop")
-	{
-		// Coop
-		if (hexen)
-			return !!(flags & 512);
-		// *Not* Not In Coop
-		else if (supported_features_[Feature::Boom])
-			return !(flags & 64);
-		else
-			return true;
-	}
-	else if (flag == "dm")
-	{
-		// Deathmatch
-		if (hexen)
-			return !!(flags & 1024);
-		// *Not* Not In DM
-		else if (supported_features_[Feature::Boom])
-			return !(flags & 32);
-		else
-			return true;
+		// Hexen class flags
+		else if (hexen && flag.StartsWith("class"))
+		{
+			// Fighter
+			if (flag == "class1")
+				return FlagHandle(FlagHandle::Test::Set, 32);
+			// Cleric
+			else if (flag == "class2")
+				return FlagHandle(FlagHandle::Test::Set, 64);
+			// Mage
+			else if (flag == "class3")
+				return FlagHandle(FlagHandle::Test::Set, 128);
+		}
 	}
 
-	// Hexen class flags
-	else if (hexen && flag.StartsWith("class"))
+	// Iterate through flags
+	for (size_t i = 0; i < flags_thing_.size(); ++i)
 	{
-		// Fighter
-		if (flag == "class1")
-			return !!(flags & 32);
-		// Cleric
-		else if (flag == "class2")
-			return !!(flags & 64);
-		// Mage
-		else if (flag == "class3")
-			return !!(flags & 128);
+		if (flags_thing_[i].udmf == flag)
+			return FlagHandle(FlagHandle::Test::Set, flags_thing_[i].flag);
 	}
-
-	// Not basic
-	return thingFlagSet(flag, thing, map_format);
+	LOG_MESSAGE(2, "Flag %s does not exist in this configuration", flag);
+	return FlagHandle();
 }
 
 // -----------------------------------------------------------------------------
@@ -1373,6 +1403,7 @@ void Configuration::setThingBasicFlag(string flag, MapThing* thing, int map_form
 // -----------------------------------------------------------------------------
 bool Configuration::parseDecorateDefs(Archive* archive)
 {
+	thing_type_lookup_.invalidate();
 	return Game::readDecorateDefs(archive, thing_types_, parsed_types_);
 }
 
@@ -1381,6 +1412,7 @@ bool Configuration::parseDecorateDefs(Archive* archive)
 // -----------------------------------------------------------------------------
 void Configuration::clearDecorateDefs()
 {
+	thing_type_lookup_.invalidate();
 	for (auto def : thing_types_)
 		if (def.second.decorate() && def.second.defined())
 			def.second.define(-1, "", "");
@@ -1393,6 +1425,7 @@ void Configuration::clearDecorateDefs()
 // -----------------------------------------------------------------------------
 void Configuration::importZScriptDefs(ZScript::Definitions& defs)
 {
+	thing_type_lookup_.invalidate();
 	defs.exportThingTypes(thing_types_, parsed_types_);
 }
 
@@ -1410,6 +1443,8 @@ bool Configuration::parseMapInfo(Archive* archive)
 // -----------------------------------------------------------------------------
 void Configuration::linkDoomEdNums()
 {
+	thing_type_lookup_.invalidate();
+
 	for (auto& parsed : parsed_types_)
 	{
 		// Find MAPINFO editor number for parsed actor class
@@ -1460,21 +1495,7 @@ bool Configuration::lineFlagSet(unsigned index, MapLine* line)
 // -----------------------------------------------------------------------------
 bool Configuration::lineFlagSet(string flag, MapLine* line, int map_format)
 {
-	// If UDMF, just get the bool value
-	if (map_format == MAP_UDMF)
-		return line->boolProperty(flag);
-
-	// Get current flags
-	unsigned long flags = line->intProperty("flags");
-
-	// Iterate through flags
-	for (size_t i = 0; i < flags_line_.size(); ++i)
-	{
-		if (flags_line_[i].udmf == flag)
-			return !!(flags & flags_line_[i].flag);
-	}
-	LOG_MESSAGE(2, "Flag %s does not exist in this configuration", flag);
-	return false;
+	return lineFlagHandle(flag, map_format, false).isSet(line);
 }
 
 // -----------------------------------------------------------------------------
@@ -1483,32 +1504,49 @@ bool Configuration::lineFlagSet(string flag, MapLine* line, int map_format)
 // game configurations
 // -----------------------------------------------------------------------------
 bool Configuration::lineBasicFlagSet(string flag, MapLine* line, int map_format)
+{
+	return lineFlagHandle(flag, map_format, true).isSet(line);
+}
+
+// -----------------------------------------------------------------------------
+// Resolves the line flag matching [flag] (UDMF name) for [map_format] into a
+// FlagHandle that can be used to quickly test the flag on any number of lines.
+// If [basic] is true, 'basic' flags (see lineBasicFlagSet) are checked for
+// first
+// -----------------------------------------------------------------------------
+Configuration::FlagHandle Configuration::lineFlagHandle(const string& flag, int map_format, bool basic)
 {
 	// If UDMF, just get the bool value
 	if (map_format == MAP_UDMF)
-		return line->boolProperty(flag);
+		return FlagHandle(FlagHandle::Test::UDMF, 0, flag);
 
-	// Get current flags
-	unsigned long flags = line->intProperty("flags");
-
-	// Impassable
-	if (flag == "blocking")
-		return !!(flags & 1);
+	if (basic)
+	{
+		// Impassable
+		if (flag == "blocking")
+			return FlagHandle(FlagHandle::Test::Set, 1);
 
-	// Two Sided
-	else if (flag == "twosided")
-		return !!(flags & 4);
+		// Two Sided
+		else if (flag == "twosided")
+			return FlagHandle(FlagHandle::Test::Set, 4);
 
-	// Upper unpegged
-	else if (flag == "dontpegtop")
-		return !!(flags & 8);
+		// Upper unpegged
+		else if (flag == "dontpegtop")
+			return FlagHandle(FlagHandle::Test::Set, 8);
 
-	// Lower unpegged
-	else if (flag == "dontpegbottom")
-		return !!(flags & 16);
+		// Lower unpegged
+		else if (flag == "dontpegbottom")
+			return FlagHandle(FlagHandle::Test::Set, 16);
+	}
 
-	// Not basic
-	return lineFlagSet(flag, line, map_format);
+	// Iterate through flags
+	for (size_t i = 0; i < flags_line_.size(); ++i)
+	{
+		if (flags_line_[i].udmf == flag)
+			return FlagHandle(FlagHandle::Test::Set, flags_line_[i].flag);
+	}
+	LOG_MESSAGE(2, "Flag %s does not exist in this configuration", flag);
+	return FlagHandle();
 }
 
 // -----------------------------------------------------------------------------
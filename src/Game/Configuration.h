@@ -2,6 +2,7 @@
 
 #include "ActionSpecial.h"
 #include "Game.h"
+#include "IdLookup.h"
 #include "MapInfo.h"
 #include "SpecialPreset.h"
 #include "ThingType.h"
@@ -69,6 +70,33 @@ public:
 		bool   activation;
 	};
 
+	// A line or thing flag resolved for a specific map format, so it can be
+	// tested on many objects without looking up the flag by name each time
+	struct FlagHandle
+	{
+		enum class Test
+		{
+			Never,  // Flag doesn't exist
+			Always, // Flag is always considered set (eg. coop in vanilla Doom)
+			Set,    // Flag is set if any of [mask] is set in 'flags'
+			Unset,  // Flag is set if none of [mask] is set in 'flags'
+			UDMF,   // Flag is the UDMF bool property [udmf]
+		};
+
+		Test          test;
+		unsigned long mask;
+		string        udmf;
+
+		FlagHandle(Test test = Test::Never, unsigned long mask = 0, const string& udmf = "") :
+			test{ test },
+			mask{ mask },
+			udmf{ udmf }
+		{
+		}
+
+		bool isSet(MapObject* object) const;
+	};
+
 	Configuration();
 	~Configuration();
 
@@ -125,6 +153,7 @@ public:
 	void   setThingFlag(unsigned flag_index, MapThing* thing, bool set = true);
 	void   setThingFlag(string udmf_name, MapThing* thing, int map_format, bool set = true);
 	void   setThingBasicFlag(string flag, MapThing* line, int map_format, bool set = true);
+	FlagHandle thingFlagHandle(const string& udmf_name, int map_format, bool basic = true);
 
 	// DECORATE
 	bool parseDecorateDefs(Archive* archive);
@@ -148,6 +177,7 @@ public:
 	void        setLineFlag(unsigned flag_index, MapLine* line, bool set = true);
 	void        setLineFlag(string udmf_name, MapLine* line, int map_format, bool set = true);
 	void        setLineBasicFlag(string flag, MapLine* line, int map_format, bool set = true);
+	FlagHandle  lineFlagHandle(const string& udmf_name, int map_format, bool basic = true);
 
 	// Line action (SPAC) triggers
 	string        spacTriggerString(MapLine* line, int map_format);
@@ -204,9 +234,11 @@ private:
 
 	// Action specials
 	std::map<int, ActionSpecial> action_specials_;
+	IdLookup<ActionSpecial>      action_special_lookup_;
 
 	// Thing types
 	std::map<int, ThingType>    thing_types_;
+	IdLookup<ThingType>         thing_type_lookup_;
 	std::map<string, ThingType> tt_group_defaults_;
 	vector<ThingType>           parsed_types_;
 	// std::map<string, ThingType> parsed_types_;		// ThingTypes parsed from definitions
@@ -33,6 +33,7 @@
 #include "Decorate.h"
 #include "Archive/Archive.h"
 #include "Configuration.h"
+#include "DefinitionCache.h"
 #include "Game.h"
 #include "ThingType.h"
 #include "Utility/StringUtils.h"
@@ -49,7 +50,21 @@ using namespace Game;
 namespace
 {
 EntryType* etype_decorate = nullptr;
-}
+
+// A parsed DECORATE thing definition, applied to the thing types list after
+// parsing (see applyDecorateDef)
+struct DecorateDef
+{
+	bool           actor = true; // False for old-style (non-actor) definitions
+	string         name;
+	string         actor_name;
+	string         parent;
+	string         group;
+	int            ednum = -1;
+	vector<string> game_filters;
+	PropertyList   props;
+};
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -237,7 +252,7 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 // -----------------------------------------------------------------------------
 // Parses a DECORATE 'actor' definition
 // -----------------------------------------------------------------------------
-void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateActor(Tokenizer& tz, vector<DecorateDef>& defs)
 {
 	// Get actor name
 	string name       = tz.next().text;
@@ -264,12 +279,11 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 	else
 		tz.next().toInt(ednum);
 
-	PropertyList found_props;
-	bool         available       = false;
-	bool         filters_present = false;
-	bool         sprite_given    = false;
-	bool         title_given     = false;
-	string       group;
+	PropertyList   found_props;
+	vector<string> game_filters;
+	bool           sprite_given = false;
+	bool           title_given  = false;
+	string         group;
 
 	// Skip "native" keyword if present
 	tz.advIfNextNC("native");
@@ -296,11 +310,7 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 
 			// Game filter
 			else if (tz.checkNC("game"))
-			{
-				filters_present = true;
-				if (gameDef(configuration().currentGame()).supportsFilter(tz.next().text))
-					available = true;
-			}
+				game_filters.push_back(tz.next().text);
 
 			// Tag
 			else if (!title_given && tz.checkNC("tag"))
@@ -421,9 +431,45 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 	else
 		LOG_MESSAGE(1, "Warning: Invalid actor definition for %s", name);
 
-	// Ignore actors filtered for other games,
-	// and actors with a negative or null type
-	if (available || !filters_present)
+	defs.emplace_back();
+	auto& def        = defs.back();
+	def.name         = name;
+	def.actor_name   = actor_name;
+	def.parent       = parent;
+	def.group        = group;
+	def.ednum        = ednum;
+	def.game_filters = game_filters;
+	found_props.copyTo(def.props);
+}
+
+// -----------------------------------------------------------------------------
+// Adds/updates thing type definition [ddef] in [types] (or [parsed] if it has
+// no editor number)
+// -----------------------------------------------------------------------------
+void applyDecorateDef(DecorateDef& ddef, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	auto& name       = ddef.name;
+	auto& actor_name = ddef.actor_name;
+	auto& parent     = ddef.parent;
+	auto& group      = ddef.group;
+	auto  ednum      = ddef.ednum;
+
+	// Old-style definition
+	if (!ddef.actor)
+	{
+		types[ednum].define(ednum, name, group.empty() ? "Decorate" : "Decorate/" + group);
+		types[ednum].loadProps(ddef.props);
+		return;
+	}
+
+	// Check game filters
+	bool available = ddef.game_filters.empty();
+	for (auto& filter : ddef.game_filters)
+		if (gameDef(configuration().currentGame()).supportsFilter(filter))
+			available = true;
+
+	// Ignore actors filtered for other games
+	if (available)
 	{
 		string group_path = group.empty() ? "Decorate" : "Decorate/" + group;
 
@@ -468,14 +514,14 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 				}
 
 		// Set parsed properties
-		def->loadProps(found_props);
+		def->loadProps(ddef.props);
 	}
 }
 
 // -----------------------------------------------------------------------------
 // Parses an old-style (non-actor) DECORATE definition
 // -----------------------------------------------------------------------------
-void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
+void parseDecorateOld(Tokenizer& tz, vector<DecorateDef>& defs)
 {
 	string       name, sprite, group;
 	bool         spritefound = false;
@@ -552,10 +598,12 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 			found_props["sprite"] = sprite + frame + '?';
 
 		// Add type
-		types[type].define(type, name, group.empty() ? "Decorate" : "Decorate/" + group);
-
-		// Set parsed properties
-		types[type].loadProps(found_props);
+		defs.emplace_back();
+		defs.back().actor = false;
+		defs.back().name  = name;
+		defs.back().group = group;
+		defs.back().ednum = type;
+		found_props.copyTo(defs.back().props);
 
 		LOG_MESSAGE(3, "Parsed %s %s: %d", group.length() ? group : "decoration", name, type);
 	}
@@ -564,9 +612,10 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 }
 
 // -----------------------------------------------------------------------------
-// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// Parses all DECORATE thing definitions in [entry] and adds them to [defs].
+// Any #included entries are added to [sources] if given
 // -----------------------------------------------------------------------------
-void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateEntry(ArchiveEntry* entry, vector<DecorateDef>& defs, DefinitionCache::Sources* sources = nullptr)
 {
 	// Init tokenizer
 	Tokenizer tz;
@@ -593,16 +642,20 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 					tz.current().line_no));
 			}
 			else
-				parseDecorateEntry(inc_entry, types, parsed);
+			{
+				if (sources)
+					sources->add(inc_entry);
+				parseDecorateEntry(inc_entry, defs, sources);
+			}
 
 			tz.adv();
 		}
 
 		// Check for actor definition
 		else if (tz.checkNC("actor"))
-			parseDecorateActor(tz, types, parsed);
+			parseDecorateActor(tz, defs);
 		else
-			parseDecorateOld(tz, types); // Old DECORATE definitions might be found
+			parseDecorateOld(tz, defs); // Old DECORATE definitions might be found
 
 		tz.advIf("}");
 	}
@@ -612,6 +665,53 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 		entry->setType(etype_decorate);
 }
 
+// -----------------------------------------------------------------------------
+// Writes [defs] to [writer] for the definition cache
+// -----------------------------------------------------------------------------
+void writeDecorateDefs(DefinitionCache::Writer& writer, vector<DecorateDef>& defs)
+{
+	writer.write((unsigned)defs.size());
+	for (auto& def : defs)
+	{
+		writer.write(def.actor);
+		writer.write(def.name);
+		writer.write(def.actor_name);
+		writer.write(def.parent);
+		writer.write(def.group);
+		writer.write(def.ednum);
+		writer.write((unsigned)def.game_filters.size());
+		for (auto& filter : def.game_filters)
+			writer.write(filter);
+		writer.write(def.props);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads [defs] from [reader]. Returns false if the data was invalid
+// -----------------------------------------------------------------------------
+bool readDecorateDefs(DefinitionCache::Reader& reader, vector<DecorateDef>& defs)
+{
+	defs.resize(reader.readUInt());
+	for (auto& def : defs)
+	{
+		def.actor      = reader.readBool();
+		def.name       = reader.readString();
+		def.actor_name = reader.readString();
+		def.parent     = reader.readString();
+		def.group      = reader.readString();
+		def.ednum      = reader.readInt();
+		auto filters   = reader.readUInt();
+		for (unsigned a = 0; a < filters && reader.ok(); a++)
+			def.game_filters.push_back(reader.readString());
+		reader.readProps(def.props);
+
+		if (!reader.ok())
+			return false;
+	}
+
+	return reader.ok();
+}
+
 } // namespace
 
 
@@ -645,9 +745,41 @@ bool Game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, v
 	if (etype_decorate == EntryType::unknownType())
 		etype_decorate = nullptr;
 
-	// Parse DECORATE entries
-	for (auto entry : decorate_entries)
-		parseDecorateEntry(entry, types, parsed);
+	// Read parsed definitions from the cache if possible
+	DefinitionCache::Sources sources;
+	vector<DecorateDef>      defs;
+	vector<uint8_t>          cached;
+	bool                     from_cache = false;
+	if (DefinitionCache::load(archive, "decorate", decorate_entries, 0, sources, cached))
+	{
+		DefinitionCache::Reader reader(cached);
+		from_cache = readDecorateDefs(reader, defs);
+		if (from_cache && etype_decorate)
+		{
+			for (auto& source : sources.list())
+				if (source.entry->getType() != etype_decorate)
+					source.entry->setType(etype_decorate);
+		}
+	}
+
+	// Otherwise parse DECORATE entries and cache the result
+	if (!from_cache)
+	{
+		defs.clear();
+		sources.clear();
+		for (auto entry : decorate_entries)
+			sources.add(entry);
+		for (auto entry : decorate_entries)
+			parseDecorateEntry(entry, defs, &sources);
+
+		DefinitionCache::Writer writer;
+		writeDecorateDefs(writer, defs);
+		DefinitionCache::save(archive, "decorate", decorate_entries, 0, sources, writer);
+	}
+
+	// Add parsed definitions
+	for (auto& def : defs)
+		applyDecorateDef(def, types, parsed);
 
 	return true;
 }
@@ -677,7 +809,12 @@ CONSOLE_COMMAND(test_decorate, 0, false)
 	{
 		auto entry = archive->entryAtPath(args[0]);
 		if (entry)
-			parseDecorateEntry(entry, types, parsed);
+		{
+			vector<DecorateDef> defs;
+			parseDecorateEntry(entry, defs);
+			for (auto& def : defs)
+				applyDecorateDef(def, types, parsed);
+		}
 		else
 			Log::console("Entry not found");
 	}
@@ -0,0 +1,424 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    DefinitionCache.cpp
+// Description: On-disk cache for parsed game definitions (ZScript, DECORATE,
+//              MAPINFO etc.) from archives
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "DefinitionCache.h"
+#include "App.h"
+#include "Archive/Archive.h"
+#include "General/Console/Console.h"
+#include "General/Misc.h"
+#include "Utility/PropertyList/PropertyList.h"
+
+using namespace Game;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, definition_cache, true, CVAR_SAVE)
+
+namespace
+{
+// Increase this whenever the format of any cached data changes (or the parsing
+// of any cached definitions changes in a way that would give different results)
+const uint32_t CACHE_VERSION = 1;
+const uint32_t CACHE_MAGIC   = 0x46434453; // SDCF
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the cache directory path
+// -----------------------------------------------------------------------------
+string cacheDir()
+{
+	return App::path("defcache", App::Dir::User);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the cache file for [type] definitions from [archive]
+// -----------------------------------------------------------------------------
+string cacheFilename(Archive* archive, const string& type)
+{
+	auto path = archive->filename().ToUTF8();
+	auto hash = Misc::crc((const uint8_t*)path.data(), path.length());
+	return App::path(S_FMT("defcache/%s_%08x.dat", type, hash), App::Dir::User);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// DefinitionCache::Writer Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Writes [size] bytes of [data]
+// -----------------------------------------------------------------------------
+void DefinitionCache::Writer::writeRaw(const void* data, size_t size)
+{
+	auto bytes = (const uint8_t*)data;
+	data_.insert(data_.end(), bytes, bytes + size);
+}
+
+// -----------------------------------------------------------------------------
+// Writes [value]
+// -----------------------------------------------------------------------------
+void DefinitionCache::Writer::write(int value)
+{
+	writeRaw(&value, sizeof(int));
+}
+void DefinitionCache::Writer::write(unsigned value)
+{
+	writeRaw(&value, sizeof(unsigned));
+}
+void DefinitionCache::Writer::write(bool value)
+{
+	uint8_t b = value ? 1 : 0;
+	writeRaw(&b, 1);
+}
+void DefinitionCache::Writer::write(double value)
+{
+	writeRaw(&value, sizeof(double));
+}
+void DefinitionCache::Writer::write(const string& value)
+{
+	auto utf8 = value.ToUTF8();
+	write((unsigned)utf8.length());
+	writeRaw(utf8.data(), utf8.length());
+}
+
+// -----------------------------------------------------------------------------
+// Writes all properties in [props]
+// -----------------------------------------------------------------------------
+void DefinitionCache::Writer::write(PropertyList& props)
+{
+	vector<string> names;
+	props.allPropertyNames(names);
+
+	write((unsigned)names.size());
+	for (auto& name : names)
+	{
+		auto& prop = props[name];
+		write(name);
+		uint8_t type = prop.getType();
+		writeRaw(&type, 1);
+
+		switch (type)
+		{
+		case PROP_BOOL: write(prop.getBoolValue()); break;
+		case PROP_INT: write(prop.getIntValue()); break;
+		case PROP_FLOAT: write(prop.getFloatValue()); break;
+		case PROP_STRING: write(prop.getStringValue()); break;
+		case PROP_UINT: write(prop.getUnsignedValue()); break;
+		default: break;
+		}
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// DefinitionCache::Reader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Reads [size] bytes into [data]. Returns false if there isn't enough data
+// remaining
+// -----------------------------------------------------------------------------
+bool DefinitionCache::Reader::readRaw(void* data, size_t size)
+{
+	if (!ok_ || position_ + size > data_.size())
+	{
+		ok_ = false;
+		return false;
+	}
+
+	memcpy(data, data_.data() + position_, size);
+	position_ += size;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads a value of the respective type
+// -----------------------------------------------------------------------------
+int DefinitionCache::Reader::readInt()
+{
+	int value = 0;
+	readRaw(&value, sizeof(int));
+	return value;
+}
+unsigned DefinitionCache::Reader::readUInt()
+{
+	unsigned value = 0;
+	readRaw(&value, sizeof(unsigned));
+	return value;
+}
+bool DefinitionCache::Reader::readBool()
+{
+	uint8_t value = 0;
+	readRaw(&value, 1);
+	return value != 0;
+}
+double DefinitionCache::Reader::readDouble()
+{
+	double value = 0;
+	readRaw(&value, sizeof(double));
+	return value;
+}
+string DefinitionCache::Reader::readString()
+{
+	auto length = readUInt();
+	if (!ok_ || position_ + length > data_.size())
+	{
+		ok_ = false;
+		return wxEmptyString;
+	}
+
+	auto str = wxString::FromUTF8((const char*)data_.data() + position_, length);
+	position_ += length;
+	return str;
+}
+
+// -----------------------------------------------------------------------------
+// Reads properties into [props]
+// -----------------------------------------------------------------------------
+void DefinitionCache::Reader::readProps(PropertyList& props)
+{
+	auto count = readUInt();
+	for (unsigned a = 0; a < count && ok_; a++)
+	{
+		auto    name = readString();
+		uint8_t type = PROP_BOOL;
+		readRaw(&type, 1);
+
+		switch (type)
+		{
+		case PROP_BOOL: props[name] = readBool(); break;
+		case PROP_INT: props[name] = readInt(); break;
+		case PROP_FLOAT: props[name] = readDouble(); break;
+		case PROP_STRING: props[name] = readString(); break;
+		case PROP_UINT: props[name] = readUInt(); break;
+		case PROP_FLAG: props.addFlag(name); break;
+		default: ok_ = false; break;
+		}
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// DefinitionCache::Sources Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the entry for the source at [index]
+// -----------------------------------------------------------------------------
+ArchiveEntry* DefinitionCache::Sources::entry(unsigned index) const
+{
+	return index < sources_.size() ? sources_[index].entry : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [entry] as a source (if it isn't already) and returns its index
+// -----------------------------------------------------------------------------
+unsigned DefinitionCache::Sources::add(ArchiveEntry* entry)
+{
+	for (unsigned a = 0; a < sources_.size(); a++)
+		if (sources_[a].entry == entry)
+			return a;
+
+	sources_.push_back({ entry, entry->getPath(true), entry->getSize(), entry->getMCData().crc() });
+	return sources_.size() - 1;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// DefinitionCache Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Loads cached [type] definitions for [archive], parsed from [roots] (and with
+// the same [key], if any other state affects the parsed definitions).
+// If the cache exists and all source entries are unchanged, [sources] is
+// populated and the cached definitions data is written to [data].
+// Returns false if there is no valid cache
+// -----------------------------------------------------------------------------
+bool DefinitionCache::load(
+	Archive*                     archive,
+	const string&                type,
+	const vector<ArchiveEntry*>& roots,
+	uint32_t                     key,
+	Sources&                     sources,
+	vector<uint8_t>&             data)
+{
+	if (!definition_cache || !archive || !archive->isOnDisk() || roots.empty())
+		return false;
+
+	// Read cache file
+	auto filename = cacheFilename(archive, type);
+	if (!wxFileExists(filename))
+		return false;
+	wxFile          file(filename);
+	vector<uint8_t> file_data(file.IsOpened() ? file.Length() : 0);
+	if (file_data.empty() || file.Read(file_data.data(), file_data.size()) != (ssize_t)file_data.size())
+		return false;
+	file.Close();
+
+	// Check header
+	Reader reader(file_data);
+	if (reader.readUInt() != CACHE_MAGIC || reader.readUInt() != CACHE_VERSION || reader.readString() != type
+		|| reader.readString() != archive->filename() || reader.readUInt() != key)
+		return false;
+
+	// Check all source entries are unchanged
+	auto num_roots   = reader.readUInt();
+	auto num_sources = reader.readUInt();
+	if (!reader.ok() || num_roots != roots.size() || num_sources < num_roots)
+		return false;
+	sources.clear();
+	for (unsigned a = 0; a < num_sources; a++)
+	{
+		Sources::Source source;
+		source.path = reader.readString();
+		source.size = reader.readUInt();
+		source.crc  = reader.readUInt();
+		if (!reader.ok())
+			return false;
+
+		source.entry = a < num_roots ? roots[a] : archive->entryAtPath(source.path);
+		if (!source.entry || source.entry->getPath(true) != source.path || source.entry->getSize() != source.size
+			|| source.entry->getMCData().crc() != source.crc)
+		{
+			LOG_MESSAGE(2, "Cached %s definitions for %s are out of date", type, archive->filename());
+			return false;
+		}
+
+		sources.add(source);
+	}
+
+	// Read definitions data
+	data.resize(reader.readUInt());
+	if (!reader.readRaw(data.data(), data.size()))
+		return false;
+
+	LOG_MESSAGE(2, "Loaded cached %s definitions for %s", type, archive->filename());
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [data] (cached [type] definitions for [archive], parsed from [roots])
+// to the cache. See DefinitionCache::load
+// -----------------------------------------------------------------------------
+void DefinitionCache::save(
+	Archive*                     archive,
+	const string&                type,
+	const vector<ArchiveEntry*>& roots,
+	uint32_t                     key,
+	const Sources&               sources,
+	const Writer&                data)
+{
+	if (!definition_cache || !archive || !archive->isOnDisk() || roots.empty())
+		return;
+
+	// Header
+	Writer header;
+	header.write(CACHE_MAGIC);
+	header.write(CACHE_VERSION);
+	header.write(type);
+	header.write(archive->filename());
+	header.write(key);
+
+	// Sources
+	header.write((unsigned)roots.size());
+	header.write((unsigned)sources.list().size());
+	for (auto& source : sources.list())
+	{
+		header.write(source.path);
+		header.write(source.size);
+		header.write(source.crc);
+	}
+	header.write((unsigned)data.data().size());
+
+	// Write to file
+	if (!wxDirExists(cacheDir()))
+		wxMkdir(cacheDir());
+	wxFile file(cacheFilename(archive, type), wxFile::write);
+	if (!file.IsOpened())
+		return;
+	file.Write(header.data().data(), header.data().size());
+	file.Write(data.data().data(), data.data().size());
+}
+
+// -----------------------------------------------------------------------------
+// Deletes all cache files
+// -----------------------------------------------------------------------------
+void DefinitionCache::clear()
+{
+	if (!wxDirExists(cacheDir()))
+		return;
+
+	wxArrayString files;
+	wxDir::GetAllFiles(cacheDir(), &files, "*.dat", wxDIR_FILES);
+	for (auto& file : files)
+		wxRemoveFile(file);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+CONSOLE_COMMAND(definition_cache_clear, 0, true)
+{
+	DefinitionCache::clear();
+	Log::console("Cleared definition cache");
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+class Archive;
+class ArchiveEntry;
+class PropertyList;
+
+// Caches parsed definitions (ZScript, DECORATE, MAPINFO etc.) from archives on
+// disk, so that unchanged definitions don't need to be tokenized and parsed
+// again each time they are loaded. Each cache file is validated against the
+// size and CRC of every entry the definitions were parsed from
+namespace Game
+{
+namespace DefinitionCache
+{
+	// Writes cached data in a simple binary format
+	class Writer
+	{
+	public:
+		void write(int value);
+		void write(unsigned value);
+		void write(bool value);
+		void write(double value);
+		void write(const string& value);
+		void write(PropertyList& props);
+		void writeRaw(const void* data, size_t size);
+
+		const vector<uint8_t>& data() const { return data_; }
+
+	private:
+		vector<uint8_t> data_;
+	};
+
+	// Reads data written by a Writer. Reading past the end of the data gives
+	// default values and sets the reader to not ok
+	class Reader
+	{
+	public:
+		Reader(const vector<uint8_t>& data) : data_{ data } {}
+
+		bool ok() const { return ok_; }
+
+		int      readInt();
+		unsigned readUInt();
+		bool     readBool();
+		double   readDouble();
+		string   readString();
+		void     readProps(PropertyList& props);
+		bool     readRaw(void* data, size_t size);
+
+	private:
+		const vector<uint8_t>& data_;
+		size_t                 position_ = 0;
+		bool                   ok_       = true;
+	};
+
+	// The entries that definitions were parsed from. Root entries (the
+	// entries parsing started from) are always added first, followed by any
+	// #included entries as they are found
+	class Sources
+	{
+	public:
+		struct Source
+		{
+			ArchiveEntry* entry;
+			string        path;
+			uint32_t      size;
+			uint32_t      crc;
+		};
+
+		const vector<Source>& list() const { return sources_; }
+		ArchiveEntry*         entry(unsigned index) const;
+
+		unsigned add(ArchiveEntry* entry);
+		void     add(const Source& source) { sources_.push_back(source); }
+		void     clear() { sources_.clear(); }
+
+	private:
+		vector<Source> sources_;
+	};
+
+	bool load(
+		Archive*                     archive,
+		const string&                type,
+		const vector<ArchiveEntry*>& roots,
+		uint32_t                     key,
+		Sources&                     sources,
+		vector<uint8_t>&             data);
+	void save(
+		Archive*                     archive,
+		const string&                type,
+		const vector<ArchiveEntry*>& roots,
+		uint32_t                     key,
+		const Sources&               sources,
+		const Writer&                data);
+	void clear();
+} // namespace DefinitionCache
+} // namespace Game
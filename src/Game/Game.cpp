@@ -345,8 +345,10 @@ TagType Game::parseTagged(ParseTreeNode* tagged)
 
 // -----------------------------------------------------------------------------
 // Game related initialisation (read basic definitions, etc.)
+// If [background_zdoom] is false, zdoom.pk3 is parsed before returning rather
+// than on a separate thread
 // -----------------------------------------------------------------------------
-void Game::init()
+void Game::init(bool background_zdoom)
 {
 	// Init static ThingTypes
 	ThingType::initGlobal();
@@ -460,7 +462,7 @@ void Game::init()
 			}
 			else
 			{
-				zscript_base.parseZScript(zscript_entry);
+				zscript_base.parseZScript(&zdoom_pk3, { zscript_entry });
 
 				auto lang = TextLanguage::fromId("zscript");
 				if (lang)
@@ -471,7 +473,11 @@ void Game::init()
 				config_current.parseMapInfo(&zdoom_pk3);
 			}
 		});
-		thread.detach();
+
+		if (background_zdoom)
+			thread.detach();
+		else
+			thread.join();
 	}
 
 	// Init game listener
@@ -89,7 +89,7 @@ enum class TagType
 };
 
 // General
-void init();
+void init(bool background_zdoom = true);
 
 // Basic Game/Port Definitions
 const std::map<string, GameDef>& gameDefs();
@@ -0,0 +1,83 @@
+#pragma once
+
+namespace Game
+{
+// -----------------------------------------------------------------------------
+// Flattened lookup table for definitions stored in a std::map keyed by id
+// (thing types, action specials etc.). Ids from 0 up to the highest defined
+// id (within a limit) are looked up directly in an array, with any others
+// looked up via a binary search of a sorted list.
+//
+// The table stores pointers into the source map, so it must be rebuilt
+// (or invalidated) whenever entries are added to or removed from the map
+// -----------------------------------------------------------------------------
+template<typename T> class IdLookup
+{
+public:
+	// Maximum size of the dense (array) part of the table
+	static const int DENSE_MAX = 65536;
+
+	bool valid() const { return valid_; }
+	void invalidate() { valid_ = false; }
+
+	// -------------------------------------------------------------------------
+	// Builds the table from all defined entries in [defs]. Lookups of ids
+	// without a defined entry will return [undefined]
+	// -------------------------------------------------------------------------
+	void build(const std::map<int, T>& defs, const T* undefined)
+	{
+		dense_.clear();
+		sparse_.clear();
+
+		// Determine dense range
+		int max_id = -1;
+		for (auto& def : defs)
+			if (def.second.defined() && def.first >= 0 && def.first < DENSE_MAX)
+				max_id = def.first;
+		dense_.assign(max_id + 1, undefined);
+
+		// Add defined entries (std::map is ordered, so sparse_ will be sorted)
+		for (auto& def : defs)
+		{
+			if (!def.second.defined())
+				continue;
+
+			if (def.first >= 0 && def.first <= max_id)
+				dense_[def.first] = &def.second;
+			else
+				sparse_.emplace_back(def.first, &def.second);
+		}
+
+		undefined_ = undefined;
+		valid_     = true;
+	}
+
+	// -------------------------------------------------------------------------
+	// Returns the entry for [id], or the 'undefined' entry given to build if
+	// there is none
+	// -------------------------------------------------------------------------
+	const T* get(int id) const
+	{
+		if ((unsigned)id < dense_.size())
+			return dense_[id];
+
+		if (sparse_.empty())
+			return undefined_;
+
+		auto it = std::lower_bound(
+			sparse_.begin(), sparse_.end(), id, [](const std::pair<int, const T*>& e, int id) {
+				return e.first < id;
+			});
+		if (it != sparse_.end() && it->first == id)
+			return it->second;
+
+		return undefined_;
+	}
+
+private:
+	vector<const T*>                 dense_;
+	vector<std::pair<int, const T*>> sparse_;
+	const T*                         undefined_ = nullptr;
+	bool                             valid_     = false;
+};
+} // namespace Game
@@ -32,10 +32,97 @@
 #include "Main.h"
 #include "MapInfo.h"
 #include "Archive/Archive.h"
+#include "DefinitionCache.h"
+#include "General/Misc.h"
 
 using namespace Game;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Writes colour [col] to the definition cache [writer]
+// -----------------------------------------------------------------------------
+void writeColour(DefinitionCache::Writer& writer, const rgba_t& col)
+{
+	writer.writeRaw(&col.r, 4);
+	writer.write((int)col.index);
+	writer.write((int)col.blend);
+}
+
+// -----------------------------------------------------------------------------
+// Reads a colour from the definition cache [reader] into [col]
+// -----------------------------------------------------------------------------
+void readColour(DefinitionCache::Reader& reader, rgba_t& col)
+{
+	reader.readRaw(&col.r, 4);
+	col.index = reader.readInt();
+	col.blend = reader.readInt();
+}
+
+// -----------------------------------------------------------------------------
+// Writes map info [map] to the definition cache [writer]
+// -----------------------------------------------------------------------------
+void writeMap(DefinitionCache::Writer& writer, const MapInfo::Map& map)
+{
+	writer.write(map.name);
+	writer.write(map.lookup_name);
+	writer.write(map.entry_name);
+	writer.write(map.level_num);
+	writer.write(map.sky1);
+	writer.write((double)map.sky1_scroll_speed);
+	writer.write(map.sky2);
+	writer.write((double)map.sky2_scroll_speed);
+	writer.write(map.sky_double);
+	writer.write(map.sky_force_no_stretch);
+	writer.write(map.sky_stretch);
+	writeColour(writer, map.fade);
+	writeColour(writer, map.fade_outside);
+	writer.write(map.music);
+	writer.write(map.lighting_smooth);
+	writer.write(map.lighting_wallshade_v);
+	writer.write(map.lighting_wallshade_h);
+	writer.write(map.force_fake_contrast);
+	writer.write(map.fog_density);
+	writer.write(map.fog_density_outside);
+	writer.write(map.fog_density_sky);
+}
+
+// -----------------------------------------------------------------------------
+// Reads map info from the definition cache [reader] into [map]
+// -----------------------------------------------------------------------------
+void readMap(DefinitionCache::Reader& reader, MapInfo::Map& map)
+{
+	map.name                 = reader.readString();
+	map.lookup_name          = reader.readBool();
+	map.entry_name           = reader.readString();
+	map.level_num            = reader.readInt();
+	map.sky1                 = reader.readString();
+	map.sky1_scroll_speed    = reader.readDouble();
+	map.sky2                 = reader.readString();
+	map.sky2_scroll_speed    = reader.readDouble();
+	map.sky_double           = reader.readBool();
+	map.sky_force_no_stretch = reader.readBool();
+	map.sky_stretch          = reader.readBool();
+	readColour(reader, map.fade);
+	readColour(reader, map.fade_outside);
+	map.music                = reader.readString();
+	map.lighting_smooth      = reader.readBool();
+	map.lighting_wallshade_v = reader.readInt();
+	map.lighting_wallshade_h = reader.readInt();
+	map.force_fake_contrast  = reader.readBool();
+	map.fog_density          = reader.readInt();
+	map.fog_density_outside  = reader.readInt();
+	map.fog_density_sky      = reader.readInt();
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapInfo Class Functions
@@ -108,11 +195,13 @@ bool MapInfo::readMapInfo(Archive* archive)
 	vector<ArchiveEntry*> entries;
 	archive->getEntryTreeAsList(entries);
 
+	// Get all parseable MAPINFO entries
+	vector<ArchiveEntry*> mapinfo_entries;
 	for (auto entry : entries)
 	{
 		// ZMapInfo
 		if (entry->getType()->id() == "zmapinfo")
-			parseZMapInfo(entry);
+			mapinfo_entries.push_back(entry);
 
 		// TODO: EMapInfo
 		else if (entry->getType()->id() == "emapinfo")
@@ -125,12 +214,87 @@ bool MapInfo::readMapInfo(Archive* archive)
 			auto format = detectMapInfoType(entry);
 
 			if (format == Format::ZDoomNew)
-				parseZMapInfo(entry);
+				mapinfo_entries.push_back(entry);
 			else
 				Log::info("MAPINFO not implemented");
 		}
 	}
 
+	if (mapinfo_entries.empty())
+		return false;
+
+	// Parsed maps are based on the current default map, so include it in the
+	// cache key
+	DefinitionCache::Writer key_writer;
+	writeMap(key_writer, default_map_);
+	auto key = Misc::crc(key_writer.data().data(), key_writer.data().size());
+
+	// Load cached definitions if possible
+	MapInfo                  parsed;
+	DefinitionCache::Sources sources;
+	vector<uint8_t>          cached;
+	bool                     from_cache = false;
+	if (DefinitionCache::load(archive, "mapinfo", mapinfo_entries, key, sources, cached))
+	{
+		DefinitionCache::Reader reader(cached);
+
+		auto num_maps = reader.readUInt();
+		for (unsigned a = 0; a < num_maps && reader.ok(); a++)
+		{
+			parsed.maps_.emplace_back();
+			readMap(reader, parsed.maps_.back());
+		}
+
+		auto num_ednums = reader.readUInt();
+		for (unsigned a = 0; a < num_ednums && reader.ok(); a++)
+		{
+			auto& ednum       = parsed.editor_nums_[reader.readInt()];
+			ednum.actor_class = reader.readString();
+			ednum.special     = reader.readString();
+			for (int arg = 0; arg < 5; arg++)
+				ednum.args[arg] = reader.readInt();
+		}
+
+		readMap(reader, parsed.default_map_);
+		from_cache = reader.ok();
+	}
+
+	// Otherwise parse entries
+	if (!from_cache)
+	{
+		parsed.clear();
+		parsed.default_map_ = default_map_;
+		sources.clear();
+		for (auto entry : mapinfo_entries)
+			sources.add(entry);
+		for (auto entry : mapinfo_entries)
+			parsed.parseZMapInfo(entry, &sources);
+
+		// Write to cache
+		DefinitionCache::Writer writer;
+		writer.write((unsigned)parsed.maps_.size());
+		for (auto& map : parsed.maps_)
+			writeMap(writer, map);
+		writer.write((unsigned)parsed.editor_nums_.size());
+		for (auto& ednum : parsed.editor_nums_)
+		{
+			writer.write(ednum.first);
+			writer.write(ednum.second.actor_class);
+			writer.write(ednum.second.special);
+			for (int arg : ednum.second.args)
+				writer.write(arg);
+		}
+		writeMap(writer, parsed.default_map_);
+		DefinitionCache::save(archive, "mapinfo", mapinfo_entries, key, sources, writer);
+	}
+
+	// Add parsed definitions
+	for (auto& map : parsed.maps_)
+		addOrUpdateMap(map);
+	for (auto& ednum : parsed.editor_nums_)
+		editor_nums_[ednum.first] = ednum.second;
+	default_map_ = parsed.default_map_;
+
 	return false;
 }
 
@@ -187,9 +351,10 @@ bool MapInfo::strToCol(const string& str, rgba_t& col)
 }
 
 // -----------------------------------------------------------------------------
-// Parses ZMAPINFO-format definitions in [entry]
+// Parses ZMAPINFO-format definitions in [entry]. Any included entries are
+// added to [sources] if given
 // -----------------------------------------------------------------------------
-bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
+bool MapInfo::parseZMapInfo(ArchiveEntry* entry, DefinitionCache::Sources* sources)
 {
 	Tokenizer tz;
 	tz.setReadLowerCase(true);
@@ -211,8 +376,14 @@ bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
 					CHR(tz.current().text),
 					tz.lineNo()));
 			}
-			else if (!parseZMapInfo(include_entry))
-				return false;
+			else
+			{
+				if (sources)
+					sources->add(include_entry);
+
+				if (!parseZMapInfo(include_entry, sources))
+					return false;
+			}
 		}
 
 		// Map
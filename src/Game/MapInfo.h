@@ -7,6 +7,11 @@ class ArchiveEntry;
 
 namespace Game
 {
+namespace DefinitionCache
+{
+	class Sources;
+}
+
 class MapInfo
 {
 public:
@@ -37,6 +42,7 @@ public:
 		int fog_density_sky;
 
 		Map() :
+			lookup_name{ false },
 			level_num{ 0 },
 			sky1{ "SKY1" },
 			sky1_scroll_speed{ 0 },
@@ -49,7 +55,10 @@ public:
 			lighting_smooth{ false },
 			lighting_wallshade_v{ 0 },
 			lighting_wallshade_h{ 0 },
-			force_fake_contrast{ false }
+			force_fake_contrast{ false },
+			fog_density{ 0 },
+			fog_density_outside{ 0 },
+			fog_density_sky{ 0 }
 		{
 		}
 	};
@@ -94,7 +103,7 @@ public:
 	bool strToCol(const string& str, rgba_t& col);
 
 	// ZDoom MAPINFO parsing
-	bool parseZMapInfo(ArchiveEntry* entry);
+	bool parseZMapInfo(ArchiveEntry* entry, DefinitionCache::Sources* sources = nullptr);
 	bool parseZMap(Tokenizer& tz, string type);
 	bool parseDoomEdNums(Tokenizer& tz);
 
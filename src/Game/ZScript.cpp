@@ -33,7 +33,10 @@
 #include "ZScript.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
+#include "DefinitionCache.h"
 #include "Utility/Tokenizer.h"
+#include <atomic>
+#include <thread>
 
 using namespace ZScript;
 
@@ -61,8 +64,29 @@ bool dump_parsed_states    = false;
 bool dump_parsed_functions = false;
 
 string db_comment = "//$";
+
+// A single ZScript entry parsed into statements, with its #includes recorded
+// (rather than parsed in place) so that entries can be parsed independently
+struct ParsedFile
+{
+	struct Include
+	{
+		string        path;
+		unsigned      line;
+		size_t        index; // Position in statements the #include was at
+		ArchiveEntry* entry;
+	};
+
+	ArchiveEntry*           entry = nullptr;
+	vector<ParsedStatement> statements;
+	vector<Include>         includes;
+	unsigned                uses      = 0;
+	bool                    including = false;
+};
 } // namespace ZScript
 
+CVAR(Int, zscript_parse_threads, 0, CVAR_SAVE) // 0 = use all available cores
+
 
 // -----------------------------------------------------------------------------
 //
@@ -183,18 +207,54 @@ bool checkKeywordValueStatement(const vector<string>& tokens, unsigned index, co
 }
 
 // -----------------------------------------------------------------------------
-// Parses all statements/blocks in [entry], adding them to [parsed]
+// Calls [func] for each index from 0 to [count]-1, spread across multiple
+// threads (the order in which indices are processed is undefined)
 // -----------------------------------------------------------------------------
-void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
+void runParallel(size_t count, const std::function<void(size_t)>& func)
+{
+	// Determine number of threads to use
+	unsigned n_threads = zscript_parse_threads > 0 ? (unsigned)zscript_parse_threads
+												   : std::thread::hardware_concurrency();
+	if (dump_parsed_blocks || dump_parsed_states || dump_parsed_functions)
+		n_threads = 1; // Keep dumped output in order
+	n_threads = MIN(n_threads, count);
+	if (n_threads <= 1)
+	{
+		for (size_t a = 0; a < count; a++)
+			func(a);
+		return;
+	}
+
+	// Each thread takes the next index until none remain
+	std::atomic<size_t> next(0);
+	auto                worker = [&]() {
+		for (size_t a = next++; a < count; a = next++)
+			func(a);
+	};
+
+	vector<std::thread> threads;
+	for (unsigned t = 1; t < n_threads; t++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+}
+
+// -----------------------------------------------------------------------------
+// Parses all statements/blocks in [file]'s entry. Any #includes are recorded
+// in the file's include list to be resolved later.
+// This only reads the entry's data, so can be called from any thread as long
+// as the data is already loaded
+// -----------------------------------------------------------------------------
+void parseFile(ParsedFile& file)
 {
 	Tokenizer tz;
 	tz.setSpecialCharacters(CHR(Tokenizer::DEFAULT_SPECIAL_CHARACTERS + "()+-[]&!?."));
 	tz.enableDecorate(true);
 	tz.setCommentTypes(Tokenizer::CommentTypes::CPPStyle | Tokenizer::CommentTypes::CStyle);
-	tz.openMem(entry->getMCData(), "ZScript");
-
-	// Log::info(2, S_FMT("Parsing ZScript entry \"%s\"", entry->getPath(true)));
+	tz.openMem(file.entry->getMCData(), "ZScript");
 
+	auto& parsed = file.statements;
 	while (!tz.atEnd())
 	{
 		// Preprocessor
@@ -202,20 +262,8 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
 		{
 			if (tz.checkNC("#include"))
 			{
-				auto inc_entry = entry->relativeEntry(tz.next().text);
-
-				// Check #include path could be resolved
-				if (!inc_entry)
-				{
-					Log::warning(S_FMT(
-						"Warning parsing ZScript entry %s: "
-						"Unable to find #included entry \"%s\" at line %u, skipping",
-						CHR(entry->getName()),
-						CHR(tz.current().text),
-						tz.current().line_no));
-				}
-				else
-					parseBlocks(inc_entry, parsed);
+				auto line = tz.current().line_no;
+				file.includes.push_back({ tz.next().text, line, parsed.size(), nullptr });
 			}
 
 			tz.advToNextLine();
@@ -231,14 +279,204 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
 
 		// ZScript
 		parsed.push_back({});
-		parsed.back().entry = entry;
+		parsed.back().entry = file.entry;
 		if (!parsed.back().parse(tz))
 			parsed.pop_back();
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Counts the number of times [file] (and any files it #includes) will be
+// added by flattenFile
+// -----------------------------------------------------------------------------
+void countUses(ParsedFile& file, std::map<ArchiveEntry*, ParsedFile>& files)
+{
+	file.uses++;
+
+	file.including = true;
+	for (auto& include : file.includes)
+		if (include.entry && !files[include.entry].including)
+			countUses(files[include.entry], files);
+	file.including = false;
+}
+
+// -----------------------------------------------------------------------------
+// Adds all statements from [file] to [parsed], with the statements from any
+// #included files inserted in place of each #include. Included entries are
+// added to [sources] if given
+// -----------------------------------------------------------------------------
+void flattenFile(
+	ParsedFile&                         file,
+	std::map<ArchiveEntry*, ParsedFile>& files,
+	vector<ParsedStatement>&            parsed,
+	Game::DefinitionCache::Sources*     sources)
+{
+	// Statements can be moved rather than copied if this is the last time the
+	// file is used
+	bool last_use = --file.uses == 0;
+	auto add_statements = [&](size_t from, size_t to) {
+		for (auto a = from; a < to; a++)
+			if (last_use)
+				parsed.push_back(std::move(file.statements[a]));
+			else
+				parsed.push_back(file.statements[a]);
+	};
+
+	file.including = true;
+	size_t index   = 0;
+	for (auto& include : file.includes)
+	{
+		add_statements(index, include.index);
+		index = include.index;
+
+		if (!include.entry)
+			continue;
+
+		if (sources)
+			sources->add(include.entry);
+
+		auto& inc_file = files[include.entry];
+		if (inc_file.including)
+		{
+			Log::warning(S_FMT(
+				"Warning parsing ZScript entry %s: Recursive #include of \"%s\" at line %u, skipping",
+				CHR(file.entry->getName()),
+				CHR(include.path),
+				include.line));
+			continue;
+		}
+
+		flattenFile(inc_file, files, parsed, sources);
+	}
+	add_statements(index, file.statements.size());
+	file.including = false;
+}
+
+// -----------------------------------------------------------------------------
+// Parses all statements/blocks in each of [entries] (and any entries they
+// #include), adding them to the respective list in [parsed].
+// Any #included entries are added to [sources] if given.
+//
+// The #include graph is discovered a 'level' at a time, with each entry in
+// the level tokenized and parsed on its own thread. The parsed statements are
+// then merged in the same order as if each #include was parsed in place
+// -----------------------------------------------------------------------------
+void parseBlocks(
+	const vector<ArchiveEntry*>&     entries,
+	vector<vector<ParsedStatement>>& parsed,
+	Game::DefinitionCache::Sources*  sources = nullptr)
+{
+	std::map<ArchiveEntry*, ParsedFile> files;
+	vector<ParsedFile*>                 pending;
+	for (auto entry : entries)
+	{
+		auto& file = files[entry];
+		if (!file.entry)
+		{
+			file.entry = entry;
+			pending.push_back(&file);
+		}
+	}
+
+	while (!pending.empty())
+	{
+		// Load entry data here first, reading from the archive isn't thread-safe
+		for (auto file : pending)
+			file->entry->getMCData();
+
+		// Parse entries
+		runParallel(pending.size(), [&](size_t index) { parseFile(*pending[index]); });
+
+		// Resolve #includes, any newly found entries are parsed next
+		vector<ParsedFile*> next;
+		for (auto file : pending)
+			for (auto& include : file->includes)
+			{
+				include.entry = file->entry->relativeEntry(include.path);
+
+				// Check #include path could be resolved
+				if (!include.entry)
+				{
+					Log::warning(S_FMT(
+						"Warning parsing ZScript entry %s: "
+						"Unable to find #included entry \"%s\" at line %u, skipping",
+						CHR(file->entry->getName()),
+						CHR(include.path),
+						include.line));
+					continue;
+				}
+
+				auto& inc_file = files[include.entry];
+				if (!inc_file.entry)
+				{
+					inc_file.entry = include.entry;
+					next.push_back(&inc_file);
+				}
+			}
+
+		pending = next;
+	}
+
+	// Set entry types
+	if (etype_zscript)
+		for (auto& file : files)
+			if (file.first->getType() != etype_zscript)
+				file.first->setType(etype_zscript);
+
+	// Merge parsed statements
+	for (auto entry : entries)
+		countUses(files[entry], files);
+	parsed.resize(entries.size());
+	for (unsigned a = 0; a < entries.size(); a++)
+		flattenFile(files[entries[a]], files, parsed[a], sources);
+}
 
-	// Set entry type
-	if (etype_zscript && entry->getType() != etype_zscript)
-		entry->setType(etype_zscript);
+// -----------------------------------------------------------------------------
+// Parses all statements/blocks in [entry], adding them to [parsed]. Any
+// #included entries are added to [sources] if given
+// -----------------------------------------------------------------------------
+void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, Game::DefinitionCache::Sources* sources = nullptr)
+{
+	vector<vector<ParsedStatement>> parsed_entries;
+	parseBlocks(vector<ArchiveEntry*>{ entry }, parsed_entries, sources);
+
+	for (auto& statement : parsed_entries[0])
+		parsed.push_back(std::move(statement));
+}
+
+// -----------------------------------------------------------------------------
+// Writes [statement] (and its block) to [writer] for the definition cache
+// -----------------------------------------------------------------------------
+void writeStatement(Game::DefinitionCache::Writer& writer, const ParsedStatement& statement)
+{
+	writer.write(statement.line);
+	writer.write((unsigned)statement.tokens.size());
+	for (auto& token : statement.tokens)
+		writer.write(token);
+	writer.write((unsigned)statement.block.size());
+	for (auto& child : statement.block)
+		writeStatement(writer, child);
+}
+
+// -----------------------------------------------------------------------------
+// Reads [statement] (and its block) from [reader], setting the entry of it
+// and all its children to [entry]
+// -----------------------------------------------------------------------------
+void readStatement(Game::DefinitionCache::Reader& reader, ParsedStatement& statement, ArchiveEntry* entry)
+{
+	statement.entry = entry;
+	statement.line  = reader.readUInt();
+
+	auto count = reader.readUInt();
+	for (unsigned a = 0; a < count && reader.ok(); a++)
+		statement.tokens.push_back(reader.readString());
+
+	count = reader.readUInt();
+	for (unsigned a = 0; a < count && reader.ok(); a++)
+	{
+		statement.block.emplace_back();
+		readStatement(reader, statement.block.back(), entry);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -922,12 +1160,26 @@ bool Definitions::parseZScript(ArchiveEntry* entry)
 	vector<ParsedStatement> parsed;
 	parseBlocks(entry, parsed);
 	Log::debug(2, S_FMT("parseBlocks: %ldms", App::runTimer() - start));
-	start = App::runTimer();
 
-	for (auto& block : parsed)
-	{
+	return parseStatements(parsed);
+}
+
+// -----------------------------------------------------------------------------
+// Parses ZScript definitions from [parsed] statements
+// -----------------------------------------------------------------------------
+bool Definitions::parseStatements(vector<ParsedStatement>& parsed)
+{
+	auto start = App::runTimer();
+
+	// Parse each class/struct/enum definition (these are independent of each
+	// other, so can be parsed in parallel)
+	vector<std::unique_ptr<Class>>      parsed_classes(parsed.size());
+	vector<std::unique_ptr<Enumerator>> parsed_enums(parsed.size());
+	vector<uint8_t>                     parsed_ok(parsed.size(), 1);
+	runParallel(parsed.size(), [&](size_t index) {
+		auto& block = parsed[index];
 		if (block.tokens.empty())
-			continue;
+			return;
 
 		if (dump_parsed_blocks)
 			block.dump();
@@ -935,24 +1187,41 @@ bool Definitions::parseZScript(ArchiveEntry* entry)
 		// Class
 		if (S_CMPNOCASE(block.tokens[0], "class"))
 		{
-			Class nc(Class::Type::Class);
-
-			if (!nc.parse(block))
-				return false;
-
-			classes_.push_back(nc);
+			parsed_classes[index] = std::make_unique<Class>(Class::Type::Class);
+			if (!parsed_classes[index]->parse(block))
+				parsed_ok[index] = 0;
 		}
 
 		// Struct
 		else if (S_CMPNOCASE(block.tokens[0], "struct"))
 		{
-			Class nc(Class::Type::Struct);
-
-			if (!nc.parse(block))
-				return false;
+			parsed_classes[index] = std::make_unique<Class>(Class::Type::Struct);
+			if (!parsed_classes[index]->parse(block))
+				parsed_ok[index] = 0;
+		}
 
-			classes_.push_back(nc);
+		// Enum
+		else if (S_CMPNOCASE(block.tokens[0], "enum"))
+		{
+			parsed_enums[index] = std::make_unique<Enumerator>();
+			if (!parsed_enums[index]->parse(block))
+				parsed_ok[index] = 0;
 		}
+	});
+
+	// Add parsed definitions in order
+	for (unsigned a = 0; a < parsed.size(); a++)
+	{
+		auto& block = parsed[a];
+		if (block.tokens.empty())
+			continue;
+
+		if (!parsed_ok[a])
+			return false;
+
+		// Class/Struct
+		if (parsed_classes[a])
+			classes_.push_back(std::move(*parsed_classes[a]));
 
 		// Extend Class
 		else if (
@@ -967,15 +1236,8 @@ bool Definitions::parseZScript(ArchiveEntry* entry)
 		}
 
 		// Enum
-		else if (S_CMPNOCASE(block.tokens[0], "enum"))
-		{
-			Enumerator e;
-
-			if (!e.parse(block))
-				return false;
-
-			enumerators_.push_back(e);
-		}
+		else if (parsed_enums[a])
+			enumerators_.push_back(std::move(*parsed_enums[a]));
 	}
 
 	Log::debug(2, S_FMT("ZScript: %ldms", App::runTimer() - start));
@@ -998,15 +1260,77 @@ bool Definitions::parseZScript(Archive* archive)
 
 	Log::info(2, S_FMT("Parsing ZScript entries found in archive %s", archive->filename()));
 
+	return parseZScript(archive, zscript_enries);
+}
+
+// -----------------------------------------------------------------------------
+// Parses ZScript in [entries] (from [archive]). The parsed statements are read
+// from the definition cache if none of the entries (or any entries they
+// #include) have changed since they were last parsed
+// -----------------------------------------------------------------------------
+bool Definitions::parseZScript(Archive* archive, const vector<ArchiveEntry*>& entries)
+{
 	// Get ZScript entry type (all parsed ZScript entries will be set to this)
 	etype_zscript = EntryType::fromId("zscript");
 	if (etype_zscript == EntryType::unknownType())
 		etype_zscript = nullptr;
 
-	// Parse ZScript entries
+	// Read parsed statements from the cache if possible
+	Game::DefinitionCache::Sources  sources;
+	vector<vector<ParsedStatement>> parsed;
+	vector<uint8_t>                 cached;
+	if (Game::DefinitionCache::load(archive, "zscript", entries, 0, sources, cached))
+	{
+		Game::DefinitionCache::Reader reader(cached);
+		parsed.resize(reader.readUInt());
+		for (auto& statements : parsed)
+		{
+			auto count = reader.readUInt();
+			for (unsigned a = 0; a < count && reader.ok(); a++)
+			{
+				statements.emplace_back();
+				auto entry = sources.entry(reader.readUInt());
+				readStatement(reader, statements.back(), entry);
+			}
+		}
+
+		if (!reader.ok() || parsed.size() != entries.size())
+			parsed.clear();
+		else if (etype_zscript)
+		{
+			for (auto& source : sources.list())
+				if (source.entry->getType() != etype_zscript)
+					source.entry->setType(etype_zscript);
+		}
+	}
+
+	// Otherwise parse the entries and cache the result
+	if (parsed.empty())
+	{
+		sources.clear();
+		for (auto entry : entries)
+			sources.add(entry);
+
+		parseBlocks(entries, parsed, &sources);
+
+		Game::DefinitionCache::Writer writer;
+		writer.write((unsigned)parsed.size());
+		for (auto& statements : parsed)
+		{
+			writer.write((unsigned)statements.size());
+			for (auto& statement : statements)
+			{
+				writer.write(sources.add(statement.entry));
+				writeStatement(writer, statement);
+			}
+		}
+		Game::DefinitionCache::save(archive, "zscript", entries, 0, sources, writer);
+	}
+
+	// Parse definitions
 	bool ok = true;
-	for (auto entry : zscript_enries)
-		if (!parseZScript(entry))
+	for (auto& statements : parsed)
+		if (!parseStatements(statements))
 			ok = false;
 
 	return ok;
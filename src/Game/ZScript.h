@@ -179,6 +179,7 @@ public:
 	void clear();
 	bool parseZScript(ArchiveEntry* entry);
 	bool parseZScript(Archive* archive);
+	bool parseZScript(Archive* archive, const vector<ArchiveEntry*>& entries);
 
 	void exportThingTypes(std::map<int, Game::ThingType>& types, vector<Game::ThingType>& parsed);
 
@@ -187,5 +188,7 @@ private:
 	vector<Enumerator> enumerators_;
 	vector<Variable>   variables_;
 	vector<Function>   functions_; // needed? dunno if global functions are a thing
+
+	bool parseStatements(vector<ParsedStatement>& parsed);
 };
 } // namespace ZScript
@@ -32,6 +32,7 @@
 #include "Main.h"
 #include "App.h"
 #include <fstream>
+#include <mutex>
 
 
 // ----------------------------------------------------------------------------
@@ -43,6 +44,7 @@ namespace Log
 {
 	vector<Message>	log;
 	std::ofstream	log_file;
+	std::mutex		log_mutex;	// Messages can be logged from worker threads
 }
 CVAR(Int, log_verbosity, 1, CVAR_SAVE)
 
@@ -137,11 +139,18 @@ void Log::init()
 // ----------------------------------------------------------------------------
 // Log::history
 //
-// Returns the log message history
+// Returns a copy of the log message history, from message index [start]
+// onwards (the log can't be accessed directly since messages can be added
+// from other threads)
 // ----------------------------------------------------------------------------
-const vector<Log::Message>& Log::history()
+vector<Log::Message> Log::history(unsigned start)
 {
-	return log;
+	std::lock_guard<std::mutex> lock(log_mutex);
+
+	if (start >= log.size())
+		return {};
+
+	return vector<Message>(log.begin() + start, log.end());
 }
 
 // ----------------------------------------------------------------------------
@@ -172,6 +181,8 @@ void Log::setVerbosity(int verbosity)
 // ----------------------------------------------------------------------------
 void Log::message(MessageType type, const char* text)
 {
+	std::lock_guard<std::mutex> lock(log_mutex);
+
 	// Add log message
 	log.push_back({ text, type, wxDateTime::Now().GetTicks() });
 
@@ -188,15 +199,17 @@ void Log::message(MessageType type, const wxString& text)
 // ----------------------------------------------------------------------------
 // Log::since
 //
-// Returns a list of log messages of [type] that have been recorded since
+// Returns a copy of all log messages of [type] that have been recorded since
 // [time]
 // ----------------------------------------------------------------------------
-vector<Log::Message*> Log::since(time_t time, MessageType type)
+vector<Log::Message> Log::since(time_t time, MessageType type)
 {
-	vector<Message*> list;
+	std::lock_guard<std::mutex> lock(log_mutex);
+
+	vector<Message> list;
 	for (auto& msg : log)
 		if (msg.timestamp >= time && (type == MessageType::Any || msg.type == type))
-			list.push_back(&msg);
+			list.push_back(msg);
 	return list;
 }
 
@@ -242,6 +255,8 @@ void Log::message(MessageType type, int level, const char* text)
 	if (level > log_verbosity)
 		return;
 
+	std::lock_guard<std::mutex> lock(log_mutex);
+
 	// Add log message
 	log.push_back({ text, type, wxDateTime::Now().GetTicks() });
 
@@ -22,7 +22,7 @@ namespace Log
 		string	formattedMessageLine() const;
 	};
 
-	const vector<Message>&	history();
+	vector<Message>			history(unsigned start = 0);
 	int						verbosity();
 
 	void	setVerbosity(int verbosity);
@@ -34,7 +34,7 @@ namespace Log
 	void message(MessageType type, const char* text);
 	void message(MessageType type, const wxString& text);
 
-	vector<Message*>	since(time_t time, MessageType type = MessageType::Any);
+	vector<Message>	since(time_t time, MessageType type = MessageType::Any);
 
 	inline void	info(int level, const char* text) { message(MessageType::Info, level, text); }
 	inline void	info(int level, const wxString& text) { message(MessageType::Info, level, text); }
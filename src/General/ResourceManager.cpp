@@ -47,6 +47,40 @@ ResourceManager* ResourceManager::instance_ = nullptr;
 string ResourceManager::doom64_hash_table_[65536];
 
 
+// ----------------------------------------------------------------------------
+//
+// Functions
+//
+// ----------------------------------------------------------------------------
+namespace
+{
+	// ------------------------------------------------------------------------
+	// Returns pointers to all items in resource [map], sorted by name
+	// ------------------------------------------------------------------------
+	template<typename M> vector<typename M::value_type*> sortedByName(M& map)
+	{
+		vector<typename M::value_type*> sorted;
+		sorted.reserve(map.size());
+		for (auto& i : map)
+			sorted.push_back(&i);
+
+		std::sort(sorted.begin(), sorted.end(),
+			[](typename M::value_type* a, typename M::value_type* b) { return a->first < b->first; });
+
+		return sorted;
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns the resource in [map] with [name], or nullptr if none exists
+	// ------------------------------------------------------------------------
+	template<typename M> typename M::mapped_type* findResource(M& map, const string& name)
+	{
+		auto i = map.find(name);
+		return i != map.end() ? &i->second : nullptr;
+	}
+}
+
+
 // ----------------------------------------------------------------------------
 //
 // EntryResource Class Functions
@@ -233,7 +267,7 @@ void ResourceManager::removeArchive(Archive* archive)
 	vector<ArchiveEntry::SPtr> entries;
 	archive->getEntryTreeAsList(entries);
 	for (auto& entry : entries)
-		removeEntry(entry, false, true);
+		removeEntry(entry);
 
 	// Announce resource update
 	announce("resources_updated");
@@ -258,6 +292,18 @@ uint16_t ResourceManager::getTextureHash(const string& name)
 	return (uint16_t)hash;
 }
 
+// ----------------------------------------------------------------------------
+// ResourceManager::addToResource
+//
+// Adds [entry] to the resource [key] in [map], and records it in the entry's
+// index so it can be removed later
+// ----------------------------------------------------------------------------
+void ResourceManager::addToResource(EntryResourceMap& map, const string& key, ArchiveEntry::SPtr& entry)
+{
+	map[key].add(entry);
+	indexed_entries_[entry.get()].resources.emplace_back(&map, key);
+}
+
 // ----------------------------------------------------------------------------
 // ResourceManager::addEntry
 //
@@ -268,6 +314,12 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 	if (!entry.get())
 		return;
 
+	// Remove first if already added
+	if (indexed_entries_.count(entry.get()))
+		removeEntry(entry);
+
+	generation_++;
+
 	// Detect type if unknown
 	if (entry->getType() == EntryType::unknownType())
 		EntryType::detectEntryType(entry.get());
@@ -286,7 +338,7 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 
 	// Check for palette entry
 	if (type->id() == "palette")
-		palettes_[name].add(entry);
+		addToResource(palettes_, name, entry);
 
 	// Check for various image entries, so only accept images
 	if (type->editor() == "gfx")
@@ -312,13 +364,13 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 			{
 				addToFpOnly = false;
 			}
-			patches_[name].add(entry);
+			addToResource(patches_, name, entry);
 			if (!entry->getParent()->isTreeless())
 			{
-				patches_fp_[path].add(entry);
+				addToResource(patches_fp_, path, entry);
 				if ((lname.Len() > 8 || patches_[name].length() > 0) && addToFpOnly)
 				{
-					patches_fp_only_[path].add(entry);
+					addToResource(patches_fp_only_, path, entry);
 				}
 			}
 		}
@@ -332,13 +384,13 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 			{
 				addToFpOnly = false;
 			}
-			flats_[name].add(entry);
+			addToResource(flats_, name, entry);
 			if (!entry->getParent()->isTreeless())
 			{
-				flats_fp_[path].add(entry);
+				addToResource(flats_fp_, path, entry);
 				if ((lname.Len() > 8 || flats_[name].length() > 0) && addToFpOnly)
 				{
-					flats_fp_only_[path].add(entry);
+					addToResource(flats_fp_only_, path, entry);
 				}
 			}
 		}
@@ -346,10 +398,10 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 		// Check for stand-alone texture entry
 		if (entry->isInNamespace("textures") || entry->isInNamespace("hires"))
 		{
-			satextures_[name].add(entry);
+			addToResource(satextures_, name, entry);
 			if (!entry->getParent()->isTreeless())
 			{
-				satextures_fp_[path].add(entry);
+				addToResource(satextures_fp_, path, entry);
 			}
 
 			// Add name to hash table
@@ -384,78 +436,72 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 			tx.readTEXTURESData(entry.get());
 
 		// Add all textures to resources
+		auto& indexed  = indexed_entries_[entry.get()];
+		indexed.parent = entry->getParent();
 		CTexture* tex;
 		for (unsigned a = 0; a < tx.nTextures(); a++)
 		{
 			tex = tx.getTexture(a);
 			textures_[tex->getName()].add(tex, entry->getParent());
+			indexed.textures.push_back(tex->getName());
 		}
 	}
 }
 
-void removeEntryFromMap(EntryResourceMap& map, const string& name, ArchiveEntry::SPtr& entry, bool full_check)
-{
-	if (full_check)
-		for (auto& i : map)
-			i.second.remove(entry);
-	else
-		map[name].remove(entry);
-}
-
 // ----------------------------------------------------------------------------
 // ResourceManager::removeEntry
 //
-// Removes a managed entry
+// Removes a managed entry. The entry is removed from all resources it was
+// added to, regardless of its current name or data. If [full_check] is true,
+// all resources are searched for the entry as well
 // ----------------------------------------------------------------------------
 void ResourceManager::removeEntry(ArchiveEntry::SPtr& entry, bool log, bool full_check)
 {
 	if (!entry.get())
 		return;
 
-	// Get resource name (extension cut, uppercase)
-	string name = entry->getUpperNameNoExt().Truncate(8);
-	string path = entry->getPath(true).Upper().Mid(1);
-
 	if (log)
-		Log::debug(S_FMT("Removing entry %s from resource manager", path));
+		Log::debug(S_FMT("Removing entry %s from resource manager", entry->getPath(true).Upper().Mid(1)));
 
-	// Remove from palettes
-	removeEntryFromMap(palettes_, name, entry, full_check);
+	if (full_check)
+	{
+		for (auto map : { &palettes_, &patches_, &patches_fp_, &patches_fp_only_, &flats_, &flats_fp_,
+						  &flats_fp_only_, &satextures_, &satextures_fp_ })
+			for (auto& i : *map)
+				i.second.remove(entry);
+	}
 
-	// Remove from patches
-	removeEntryFromMap(patches_, name, entry, full_check);
-	removeEntryFromMap(patches_fp_, path, entry, full_check);
-	removeEntryFromMap(patches_fp_only_, path, entry, full_check);
+	// Check entry was added
+	auto indexed = indexed_entries_.find(entry.get());
+	if (indexed == indexed_entries_.end())
+		return;
 
-	// Remove from flats
-	removeEntryFromMap(flats_, name, entry, full_check);
-	removeEntryFromMap(flats_fp_, path, entry, full_check);
-	removeEntryFromMap(flats_fp_only_, path, entry, full_check);
+	// Remove from entry resources (and remove any resources left empty)
+	for (auto& res : indexed->second.resources)
+	{
+		auto i = res.first->find(res.second);
+		if (i == res.first->end())
+			continue;
 
-	// Remove from stand-alone textures
-	removeEntryFromMap(satextures_, name, entry, full_check);
-	removeEntryFromMap(satextures_fp_, path, entry, full_check);
+		i->second.remove(entry);
+		if (i->second.length() == 0)
+			res.first->erase(i);
+	}
 
-	// Check for TEXTUREx entry
-	int txentry = 0;
-	if (entry->getType()->id() == "texturex")
-		txentry = 1;
-	else if (entry->getType()->id() == "zdtextures")
-		txentry = 2;
-	if (txentry > 0)
+	// Remove texture resources (from TEXTUREx entry)
+	for (auto& name : indexed->second.textures)
 	{
-		// Read texture list
-		TextureXList tx;
-		PatchTable ptable;
-		if (txentry == 1)
-			tx.readTEXTUREXData(entry.get(), ptable);
-		else
-			tx.readTEXTURESData(entry.get());
+		auto i = textures_.find(name);
+		if (i == textures_.end())
+			continue;
 
-		// Remove all texture resources
-		for (unsigned a = 0; a < tx.nTextures(); a++)
-			textures_[tx.getTexture(a)->getName()].remove(entry->getParent());
+		i->second.remove(indexed->second.parent);
+		if (i->second.length() == 0)
+			textures_.erase(i);
 	}
+
+	indexed_entries_.erase(indexed);
+	generation_++;
 }
 
 // ----------------------------------------------------------------------------
@@ -465,12 +511,8 @@ void ResourceManager::removeEntry(ArchiveEntry::SPtr& entry, bool log, bool full
 // ----------------------------------------------------------------------------
 void ResourceManager::listAllPatches()
 {
-	EntryResourceMap::iterator i = patches_.begin();
-	while (i != patches_.end())
-	{
+	for (auto i : sortedByName(patches_))
 		LOG_MESSAGE(1, "%s (%d)", i->first, i->second.length());
-		++i;
-	}
 }
 
 // ----------------------------------------------------------------------------
@@ -480,22 +522,34 @@ void ResourceManager::listAllPatches()
 // ----------------------------------------------------------------------------
 void ResourceManager::getAllPatchEntries(vector<ArchiveEntry*>& list, Archive* priority, bool fullPath)
 {
-	for (auto& i : patches_)
+	// Rebuild cached list if needed
+	auto& cache = patch_cache_;
+	if (cache.generation != generation_ || cache.priority != priority || cache.full_path != fullPath)
 	{
-		auto entry = i.second.getEntry(priority);
-		if (entry)
-			list.push_back(entry);
-	}
+		cache.entries.clear();
+		for (auto i : sortedByName(patches_))
+		{
+			auto entry = i->second.getEntry(priority);
+			if (entry)
+				cache.entries.push_back(entry);
+		}
 
-	if (!fullPath)
-		return;
+		if (fullPath)
+		{
+			for (auto i : sortedByName(patches_fp_only_))
+			{
+				auto entry = i->second.getEntry(priority);
+				if (entry)
+					cache.entries.push_back(entry);
+			}
+		}
 
-	for (auto& i : patches_fp_only_)
-	{
-		auto entry = i.second.getEntry(priority);
-		if (entry)
-			list.push_back(entry);
+		cache.generation	= generation_;
+		cache.priority		= priority;
+		cache.full_path		= fullPath;
 	}
+
+	list.insert(list.end(), cache.entries.begin(), cache.entries.end());
 }
 
 // ----------------------------------------------------------------------------
@@ -505,37 +559,53 @@ void ResourceManager::getAllPatchEntries(vector<ArchiveEntry*>& list, Archive* p
 // ----------------------------------------------------------------------------
 void ResourceManager::getAllTextures(vector<TextureResource::Texture*>& list, Archive* priority, Archive* ignore)
 {
+	// Use cached list if possible
+	auto& cache = texture_cache_;
+	if (cache.generation == generation_ && cache.priority == priority && cache.ignore == ignore)
+	{
+		list.insert(list.end(), cache.textures.begin(), cache.textures.end());
+		return;
+	}
+	cache.textures.clear();
+
 	// Add all primary textures to the list
-	for (auto& i : textures_)
+	for (auto i : sortedByName(textures_))
 	{
+		auto& resource = i->second;
+
 		// Skip if no entries
-		if (i.second.length() == 0)
+		if (resource.length() == 0)
 			continue;
 
 		// Go through resource textures
-		TextureResource::Texture* res = i.second.textures_[0].get();
-		for (int a = 0; a < i.second.length(); a++)
+		TextureResource::Texture* res = resource.textures_[0].get();
+		for (int a = 0; a < resource.length(); a++)
 		{
-			res = i.second.textures_[a].get();
+			res = resource.textures_[a].get();
 
 			// Skip if it's in the 'ignore' archive
 			if (res->parent == ignore)
 				continue;
 
 			// If it's in the 'priority' archive, exit loop
-			if (priority && i.second.textures_[a]->parent == priority)
+			if (priority && resource.textures_[a]->parent == priority)
 				break;
 
 			// Otherwise, if it's in a 'later' archive than the current resource, set it
 			if (App::archiveManager().archiveIndex(res->parent) <=
-			        App::archiveManager().archiveIndex(i.second.textures_[a]->parent))
-				res = i.second.textures_[a].get();
+			        App::archiveManager().archiveIndex(resource.textures_[a]->parent))
+				res = resource.textures_[a].get();
 		}
 
 		// Add texture resource to the list
 		if (res->parent != ignore)
-			list.push_back(res);
+			cache.textures.push_back(res);
 	}
+
+	cache.generation	= generation_;
+	cache.priority		= priority;
+	cache.ignore		= ignore;
+	list.insert(list.end(), cache.textures.begin(), cache.textures.end());
 }
 
 // ----------------------------------------------------------------------------
@@ -545,10 +615,20 @@ void ResourceManager::getAllTextures(vector<TextureResource::Texture*>& list, Ar
 // ----------------------------------------------------------------------------
 void ResourceManager::getAllTextureNames(vector<string>& list)
 {
-	// Add all primary textures to the list
-	for (auto& i : textures_)
-		if (i.second.length() > 0)	// Ignore if no entries
-			list.push_back(i.first);
+	// Rebuild cached list if needed
+	auto& cache = texture_names_cache_;
+	if (cache.generation != generation_)
+	{
+		// Add all primary textures to the list
+		cache.names.clear();
+		for (auto i : sortedByName(textures_))
+			if (i->second.length() > 0)	// Ignore if no entries
+				cache.names.push_back(i->first);
+
+		cache.generation = generation_;
+	}
+
+	list.insert(list.end(), cache.names.begin(), cache.names.end());
 }
 
 // ----------------------------------------------------------------------------
@@ -558,22 +638,34 @@ void ResourceManager::getAllTextureNames(vector<string>& list)
 // ----------------------------------------------------------------------------
 void ResourceManager::getAllFlatEntries(vector<ArchiveEntry*>& list, Archive* priority, bool fullPath)
 {
-	for (auto& i : flats_)
+	// Rebuild cached list if needed
+	auto& cache = flat_cache_;
+	if (cache.generation != generation_ || cache.priority != priority || cache.full_path != fullPath)
 	{
-		auto entry = i.second.getEntry(priority);
-		if (entry)
-			list.push_back(entry);
-	}
+		cache.entries.clear();
+		for (auto i : sortedByName(flats_))
+		{
+			auto entry = i->second.getEntry(priority);
+			if (entry)
+				cache.entries.push_back(entry);
+		}
 
-	if (!fullPath)
-		return;
+		if (fullPath)
+		{
+			for (auto i : sortedByName(flats_fp_only_))
+			{
+				auto entry = i->second.getEntry(priority);
+				if (entry)
+					cache.entries.push_back(entry);
+			}
+		}
 
-	for (auto& i : flats_fp_only_)
-	{
-		auto entry = i.second.getEntry(priority);
-		if (entry)
-			list.push_back(entry);
+		cache.generation	= generation_;
+		cache.priority		= priority;
+		cache.full_path		= fullPath;
 	}
+
+	list.insert(list.end(), cache.entries.begin(), cache.entries.end());
 }
 
 // ----------------------------------------------------------------------------
@@ -583,10 +675,20 @@ void ResourceManager::getAllFlatEntries(vector<ArchiveEntry*>& list, Archive* pr
 // ----------------------------------------------------------------------------
 void ResourceManager::getAllFlatNames(vector<string>& list)
 {
-	// Add all primary flats to the list
-	for (auto& i : flats_)
-		if (i.second.length() > 0)	// Ignore if no entries
-			list.push_back(i.first);
+	// Rebuild cached list if needed
+	auto& cache = flat_names_cache_;
+	if (cache.generation != generation_)
+	{
+		// Add all primary flats to the list
+		cache.names.clear();
+		for (auto i : sortedByName(flats_))
+			if (i->second.length() > 0)	// Ignore if no entries
+				cache.names.push_back(i->first);
+
+		cache.generation = generation_;
+	}
+
+	list.insert(list.end(), cache.names.begin(), cache.names.end());
 }
 
 // ----------------------------------------------------------------------------
@@ -597,7 +699,8 @@ void ResourceManager::getAllFlatNames(vector<string>& list)
 // ----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getPaletteEntry(const string& palette, Archive* priority)
 {
-	return palettes_[palette.Upper()].getEntry(priority);
+	auto res = findResource(palettes_, palette.Upper());
+	return res ? res->getEntry(priority) : nullptr;
 }
 
 // ----------------------------------------------------------------------------
@@ -616,11 +719,14 @@ ArchiveEntry* ResourceManager::getPatchEntry(const string& patch, const string&
 	if (!nspace.CmpNoCase("textures"))
 		return getTextureEntry(patch, "textures", priority);
 
-	ArchiveEntry* entry = patches_[patch.Upper()].getEntry(priority, nspace, true);
+	string name = patch.Upper();
+	auto res = findResource(patches_, name);
+	ArchiveEntry* entry = res ? res->getEntry(priority, nspace, true) : nullptr;
 	if (entry)
 		return entry;
 
-	entry = patches_fp_[patch.Upper()].getEntry(priority, nspace, true);
+	res = findResource(patches_fp_, name);
+	entry = res ? res->getEntry(priority, nspace, true) : nullptr;
 	if (entry)
 		return entry;
 
@@ -636,14 +742,16 @@ ArchiveEntry* ResourceManager::getPatchEntry(const string& patch, const string&
 ArchiveEntry* ResourceManager::getFlatEntry(const string& flat, Archive* priority)
 {
 	// Check resource with matching name exists
-	EntryResource& res = flats_[flat.Upper()];
+	string name = flat.Upper();
+	auto res = findResource(flats_, name);
 
 	// Return most relevant entry
-	ArchiveEntry* entry = res.getEntry(priority);
+	ArchiveEntry* entry = res ? res->getEntry(priority) : nullptr;
 	if (entry)
 		return entry;
 
-	entry = flats_fp_[flat.Upper()].getEntry(priority, "flats", true);
+	res = findResource(flats_fp_, name);
+	entry = res ? res->getEntry(priority, "flats", true) : nullptr;
 	if (entry)
 		return entry;
 
@@ -658,11 +766,14 @@ ArchiveEntry* ResourceManager::getFlatEntry(const string& flat, Archive* priorit
 // ----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getTextureEntry(const string& texture, const string& nspace, Archive* priority)
 {
-	ArchiveEntry* entry = satextures_[texture.Upper()].getEntry(priority, nspace, true);
+	string name = texture.Upper();
+	auto res = findResource(satextures_, name);
+	ArchiveEntry* entry = res ? res->getEntry(priority, nspace, true) : nullptr;
 	if (entry)
 		return entry;
 
-	entry = satextures_fp_[texture.Upper()].getEntry(priority, nspace, true);
+	res = findResource(satextures_fp_, name);
+	entry = res ? res->getEntry(priority, nspace, true) : nullptr;
 	if (entry)
 		return entry;
 
@@ -678,9 +789,10 @@ ArchiveEntry* ResourceManager::getTextureEntry(const string& texture, const stri
 CTexture* ResourceManager::getTexture(const string& texture, Archive* priority, Archive* ignore)
 {
 	// Check texture resource with matching name exists
-	TextureResource& res = textures_[texture.Upper()];
-	if (res.textures_.empty())
+	auto resource = findResource(textures_, texture.Upper());
+	if (!resource || resource->textures_.empty())
 		return nullptr;
+	auto& res = *resource;
 
 	// Go through resource textures
 	CTexture* tex = &res.textures_[0].get()->tex;
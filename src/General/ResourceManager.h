@@ -4,6 +4,7 @@
 #include "Archive/Archive.h"
 #include "General/ListenerAnnouncer.h"
 #include "Graphics/CTexture/CTexture.h"
+#include <unordered_map>
 
 class ResourceManager;
 
@@ -67,8 +68,8 @@ private:
 	vector<std::unique_ptr<Texture>>	textures_;
 };
 
-typedef std::map<string, EntryResource> EntryResourceMap;
-typedef std::map<string, TextureResource> TextureResourceMap;
+typedef std::unordered_map<string, EntryResource, wxStringHash, wxStringEqual> EntryResourceMap;
+typedef std::unordered_map<string, TextureResource, wxStringHash, wxStringEqual> TextureResourceMap;
 
 class ResourceManager : public Listener, public Announcer
 {
@@ -111,6 +112,37 @@ public:
 	static string	getTextureName(uint16_t hash) { return doom64_hash_table_[hash]; }
 
 private:
+	// The resources an entry was added to, so it can be removed again without
+	// searching every resource (or depending on its current name/data)
+	struct IndexedEntry
+	{
+		vector<std::pair<EntryResourceMap*, string>>	resources;
+		vector<string>									textures;
+		Archive*										parent = nullptr;
+	};
+
+	// Cached results of the getAll* functions, rebuilt only when resources
+	// have changed since (or different parameters are given)
+	struct EntryListCache
+	{
+		unsigned				generation	= 0;
+		Archive*				priority	= nullptr;
+		bool					full_path	= false;
+		vector<ArchiveEntry*>	entries;
+	};
+	struct TextureListCache
+	{
+		unsigned							generation	= 0;
+		Archive*							priority	= nullptr;
+		Archive*							ignore		= nullptr;
+		vector<TextureResource::Texture*>	textures;
+	};
+	struct NameListCache
+	{
+		unsigned		generation = 0;
+		vector<string>	names;
+	};
+
 	EntryResourceMap	palettes_;
 	EntryResourceMap	patches_;
 	EntryResourceMap	patches_fp_; // Full path
@@ -124,6 +156,16 @@ private:
 	//EntryResourceMap	satextures_fp_only_; // Probably not needed
 	TextureResourceMap	textures_;		// Composite textures (defined in a TEXTUREx/TEXTURES lump)
 
+	std::unordered_map<ArchiveEntry*, IndexedEntry>	indexed_entries_;
+	unsigned										generation_ = 1;	// Incremented whenever resources change
+	EntryListCache									patch_cache_;
+	EntryListCache									flat_cache_;
+	TextureListCache								texture_cache_;
+	NameListCache									texture_names_cache_;
+	NameListCache									flat_names_cache_;
+
+	void	addToResource(EntryResourceMap& map, const string& key, ArchiveEntry::SPtr& entry);
+
 	static ResourceManager*	instance_;
 	static string			doom64_hash_table_[65536];
 };
@@ -135,6 +135,16 @@ void UndoLevel::createMerged(vector<UndoLevel*>& levels)
 	}
 }
 
+/* UndoLevel::getObjectIds
+ * Adds the ids of any objects that can be restored by steps in this
+ * level to [list]
+ *******************************************************************/
+void UndoLevel::getObjectIds(vector<unsigned>& list)
+{
+	for (unsigned a = 0; a < undo_steps.size(); a++)
+		undo_steps[a]->getObjectIds(list);
+}
+
 
 /*******************************************************************
  * UNDOMANAGER CLASS FUNCTIONS
@@ -363,6 +373,19 @@ bool UndoManager::createMergedLevel(UndoManager* manager, string name)
 	return true;
 }
 
+/* UndoManager::getObjectIds
+ * Adds the ids of any objects that can be restored by any undo level
+ * (including the level currently being recorded) to [list]
+ *******************************************************************/
+void UndoManager::getObjectIds(vector<unsigned>& list)
+{
+	for (unsigned a = 0; a < undo_levels.size(); a++)
+		undo_levels[a]->getObjectIds(list);
+
+	if (current_level)
+		current_level->getObjectIds(list);
+}
+
 
 /*******************************************************************
  * UNDOREDO NAMESPACE FUNCTIONS
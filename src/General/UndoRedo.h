@@ -18,6 +18,9 @@ public:
 	virtual bool	writeFile(MemChunk& mc) { return true; }
 	virtual bool	readFile(MemChunk& mc) { return true; }
 	virtual bool	isOk() { return true; }
+
+	// Adds the ids of any (map) objects this step can restore to [list]
+	virtual void	getObjectIds(vector<unsigned>& list) {}
 };
 
 class UndoLevel
@@ -40,6 +43,7 @@ public:
 	bool	writeFile(string filename);
 	bool	readFile(string filename);
 	void	createMerged(vector<UndoLevel*>& levels);
+	void	getObjectIds(vector<unsigned>& list);
 };
 
 class SLADEMap;
@@ -74,6 +78,7 @@ public:
 
 	void	clear();
 	bool	createMergedLevel(UndoManager* manager, string name);
+	void	getObjectIds(vector<unsigned>& list);
 
 	typedef std::unique_ptr<UndoManager> UPtr;
 };
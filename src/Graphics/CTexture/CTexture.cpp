@@ -31,9 +31,9 @@
 #include "Main.h"
 #include "Archive/ArchiveManager.h"
 #include "CTexture.h"
-#include "General/Misc.h"
 #include "General/ResourceManager.h"
 #include "Graphics/SImage/SImage.h"
+#include "TextureCache.h"
 #include "TextureXList.h"
 #include "Utility/Tokenizer.h"
 
@@ -430,6 +430,8 @@ CTexture::~CTexture()
 {
 	for (unsigned a = 0; a < patches.size(); a++)
 		delete patches[a];
+
+	TextureCache::removeTexture(this);
 }
 
 /* CTexture::copyTexture
@@ -934,9 +936,29 @@ bool CTexture::convertRegular()
 
 /* CTexture::toImage
  * Generates a SImage representation of this texture, using patches
- * from [parent] primarily, and the palette [pal]
+ * from [parent] primarily, and the palette [pal]. The result is
+ * cached, so subsequent calls with the same parameters are fast as
+ * long as nothing the texture uses has changed
  *******************************************************************/
 bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_rgba)
+{
+	// Check for a valid cached image
+	if (TextureCache::getComposite(this, image, parent, pal, force_rgba))
+		return true;
+
+	// Composite the texture
+	TextureCache::beginComposite();
+	bool ok = compositeImage(image, parent, pal, force_rgba);
+	TextureCache::endComposite(this, image, parent, pal, force_rgba, ok);
+
+	return ok;
+}
+
+/* CTexture::compositeImage
+ * Draws all patches of this texture to [image], using patches from
+ * [parent] primarily, and the palette [pal]
+ *******************************************************************/
+bool CTexture::compositeImage(SImage& image, Archive* parent, Palette* pal, bool force_rgba)
 {
 	// Init image
 	image.clear();
@@ -1044,7 +1066,7 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 		for (unsigned a = 0; a < patches.size(); a++)
 		{
 			CTPatch* patch = patches[a];
-			if (Misc::loadImageFromEntry(&p_img, patch->getPatchEntry(parent)))
+			if (TextureCache::loadPatch(patch->getPatchEntry(parent), p_img))
 				image.drawImage(p_img, patch->xOffset(), patch->yOffset(), dp, pal, pal);
 		}
 	}
@@ -1100,13 +1122,13 @@ bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, P
 
 	// Load entry to image if valid
 	if (entry)
-		return Misc::loadImageFromEntry(&image, entry);
+		return TextureCache::loadPatch(entry, image);
 
 	// Maybe it's a texture?
 	entry = theResourceManager->getTextureEntry(patch->getName(), "", parent);
 
 	if (entry)
-		return Misc::loadImageFromEntry(&image, entry);
+		return TextureCache::loadPatch(entry, image);
 
 	return false;
 }
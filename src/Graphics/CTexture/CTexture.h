@@ -124,6 +124,8 @@ private:
 	uint8_t			state;
 	TextureXList*	in_list;
 
+	bool	compositeImage(SImage& image, Archive* parent, Palette* pal, bool force_rgba);
+
 public:
 	CTexture(bool extended = false);
 	~CTexture();
@@ -0,0 +1,520 @@
+// ----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextureCache.cpp
+// Description: Caches decoded patch images (keyed by patch entry) and
+//              composited CTexture images, with size limits on both.
+//              Cached patches are invalidated when their entry is modified
+//              or removed, cached composites when the texture definition,
+//              any patch used or the available resources change
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// ----------------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------------
+//
+// Includes
+//
+// ----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextureCache.h"
+#include "Archive/ArchiveEntry.h"
+#include "CTexture.h"
+#include "General/Console/Console.h"
+#include "General/Misc.h"
+#include "General/ResourceManager.h"
+#include "Graphics/SImage/SImage.h"
+
+
+// ----------------------------------------------------------------------------
+//
+// Variables
+//
+// ----------------------------------------------------------------------------
+CVAR(Int, texture_cache_patch_size, 64, CVAR_SAVE)		// In MB
+CVAR(Int, texture_cache_composite_size, 128, CVAR_SAVE)	// In MB
+EXTERN_CVAR(Int, col_match)
+
+namespace TextureCache
+{
+	// Things a cached composite depends on, other than its own definition
+	struct Dependencies
+	{
+		struct Entry
+		{
+			ArchiveEntry::WPtr	entry;
+			unsigned			modified;
+		};
+		struct Texture
+		{
+			CTexture*	texture;
+			string		signature;
+		};
+
+		vector<Entry>	entries;	// Patch entries used
+		vector<Texture>	textures;	// Textures used as patches
+		bool			cacheable = true;
+	};
+
+	struct Patch
+	{
+		ArchiveEntry::WPtr		entry;
+		unsigned				modified = 0;
+		std::unique_ptr<SImage>	image;
+		size_t					size = 0;
+		unsigned long			last_used = 0;
+	};
+
+	struct Composite
+	{
+		string					signature;
+		bool					has_palette = false;
+		Palette					palette;
+		int						col_match = 0;
+		unsigned				generation = 0;
+		Dependencies			deps;
+		std::unique_ptr<SImage>	image;
+		size_t					size = 0;
+		unsigned long			last_used = 0;
+	};
+
+	typedef std::tuple<CTexture*, Archive*, bool> CompositeKey;
+
+	// Invalidates all composites when resources are updated
+	class ResourceListener : public Listener
+	{
+	public:
+		ResourceListener() { listenTo(theResourceManager); }
+
+		void onAnnouncement(Announcer* announcer, string event_name, MemChunk& event_data) override;
+	};
+
+	// All cache state, allocated on first use and never freed (textures
+	// can be destroyed very late during shutdown)
+	struct State
+	{
+		std::map<ArchiveEntry*, Patch>		patches;
+		std::map<CompositeKey, Composite>	composites;
+		size_t								patches_size = 0;
+		size_t								composites_size = 0;
+		unsigned long						usage_counter = 0;
+		unsigned							generation = 0;
+		vector<Dependencies>				recording;
+		ResourceListener					listener;
+	};
+	State* state = nullptr;
+}
+
+
+// ----------------------------------------------------------------------------
+//
+// TextureCache Namespace Functions
+//
+// ----------------------------------------------------------------------------
+namespace TextureCache
+{
+	// ------------------------------------------------------------------------
+	// Returns the cache state, creating it if needed
+	// ------------------------------------------------------------------------
+	State& cache()
+	{
+		if (!state)
+			state = new State();
+
+		return *state;
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns the (approximate) memory used by [image]
+	// ------------------------------------------------------------------------
+	size_t imageSize(SImage& image)
+	{
+		size_t pixels = image.getWidth() * image.getHeight();
+		if (image.getType() == PALMASK)
+			return pixels * 2;
+		else
+			return pixels * image.getBpp();
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns a string uniquely identifying the current definition of
+	// [texture]
+	// ------------------------------------------------------------------------
+	string signature(CTexture* texture)
+	{
+		string sig = S_FMT(
+			"%s %d %d %1.4f %1.4f\n",
+			texture->getName(),
+			texture->getWidth(),
+			texture->getHeight(),
+			texture->getScaleX(),
+			texture->getScaleY());
+
+		if (texture->isExtended())
+			sig += texture->asText();
+		else
+		{
+			for (unsigned a = 0; a < texture->nPatches(); a++)
+			{
+				CTPatch* patch = texture->getPatch(a);
+				sig += S_FMT("%s %d %d\n", patch->getName(), patch->xOffset(), patch->yOffset());
+			}
+		}
+
+		return sig;
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns true if [a] and [b] contain the same colours
+	// ------------------------------------------------------------------------
+	bool samePalette(Palette& a, Palette& b)
+	{
+		for (unsigned c = 0; c < 256; c++)
+			if (!a.colour(c).equals(b.colour(c), true))
+				return false;
+
+		return true;
+	}
+
+	// ------------------------------------------------------------------------
+	// Adds [deps] to the dependencies of the composite currently being
+	// built, if any. If [texture] is given, it is also added as a dependency
+	// with [sig] as its signature
+	// ------------------------------------------------------------------------
+	void addDependencies(const Dependencies& deps, CTexture* texture = nullptr, const string& sig = "")
+	{
+		auto& recording = cache().recording;
+		if (recording.empty())
+			return;
+
+		auto& current = recording.back();
+		current.entries.insert(current.entries.end(), deps.entries.begin(), deps.entries.end());
+		current.textures.insert(current.textures.end(), deps.textures.begin(), deps.textures.end());
+		if (texture)
+			current.textures.push_back({ texture, sig });
+		if (!deps.cacheable)
+			current.cacheable = false;
+	}
+
+	// ------------------------------------------------------------------------
+	// Removes the least recently used items from [items] until its total
+	// size is well below [limit]
+	// ------------------------------------------------------------------------
+	template<typename K, typename V>
+	void trim(std::map<K, V>& items, size_t& total, size_t limit)
+	{
+		if (total <= limit)
+			return;
+
+		vector<std::pair<unsigned long, K>> order;
+		for (auto& item : items)
+			order.emplace_back(item.second.last_used, item.first);
+		std::sort(order.begin(), order.end());
+
+		// Trim to 3/4 of the limit so we don't end up doing this every time
+		// something new is added
+		for (auto& o : order)
+		{
+			if (total <= limit / 4 * 3)
+				break;
+
+			auto item = items.find(o.second);
+			total -= item->second.size;
+			items.erase(item);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns the patch cache size limit in bytes
+	// ------------------------------------------------------------------------
+	size_t patchLimit()
+	{
+		return (size_t)MAX(0, (int)texture_cache_patch_size) * 1024 * 1024;
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns the composite cache size limit in bytes
+	// ------------------------------------------------------------------------
+	size_t compositeLimit()
+	{
+		return (size_t)MAX(0, (int)texture_cache_composite_size) * 1024 * 1024;
+	}
+}
+
+// ----------------------------------------------------------------------------
+// TextureCache::ResourceListener::onAnnouncement
+//
+// Called when an announcement is recieved from the resource manager
+// ----------------------------------------------------------------------------
+void TextureCache::ResourceListener::onAnnouncement(Announcer* announcer, string event_name, MemChunk& event_data)
+{
+	// Resources changed, patch names may now resolve to different entries so
+	// all composites need to be rebuilt. Cached patches are still valid
+	if (event_name == "resources_updated")
+		cache().generation++;
+}
+
+// ----------------------------------------------------------------------------
+// TextureCache::loadPatch
+//
+// Loads the image from patch [entry] into [image], from the cache if it was
+// previously loaded (and hasn't been modified since)
+// ----------------------------------------------------------------------------
+bool TextureCache::loadPatch(ArchiveEntry* entry, SImage& image)
+{
+	if (!entry)
+		return false;
+
+	auto& c = cache();
+
+	// Check for cached patch
+	auto cached = c.patches.find(entry);
+	if (cached != c.patches.end())
+	{
+		auto& patch = cached->second;
+		if (patch.entry.lock().get() == entry && patch.modified == entry->modifiedCount())
+		{
+			image.copyImage(patch.image.get());
+			patch.last_used = ++c.usage_counter;
+
+			Dependencies deps;
+			deps.entries.push_back({ patch.entry, patch.modified });
+			addDependencies(deps);
+
+			return true;
+		}
+
+		// Outdated
+		c.patches_size -= patch.size;
+		c.patches.erase(cached);
+	}
+
+	// Load the patch
+	bool ok = Misc::loadImageFromEntry(&image, entry);
+
+	// Record dependency on the entry, can't cache anything if the entry
+	// isn't in an archive
+	Dependencies deps;
+	ArchiveEntry::WPtr entry_ref = entry->getShared();
+	if (entry_ref.expired())
+		deps.cacheable = false;
+	else
+		deps.entries.push_back({ entry_ref, entry->modifiedCount() });
+	addDependencies(deps);
+
+	if (!ok || entry_ref.expired())
+		return ok;
+
+	// Add to cache
+	size_t size = imageSize(image);
+	if (size > patchLimit())
+		return true;
+
+	auto& patch = c.patches[entry];
+	patch.entry = entry_ref;
+	patch.modified = entry->modifiedCount();
+	patch.image.reset(new SImage());
+	patch.image->copyImage(&image);
+	patch.size = size;
+	patch.last_used = ++c.usage_counter;
+	c.patches_size += size;
+	trim(c.patches, c.patches_size, patchLimit());
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+// TextureCache::getComposite
+//
+// Loads the cached composite image of [texture] into [image], if it exists
+// and is still valid for the given parameters. Returns false if the texture
+// needs to be (re)composited
+// ----------------------------------------------------------------------------
+bool TextureCache::getComposite(CTexture* texture, SImage& image, Archive* parent, Palette* pal, bool force_rgba)
+{
+	auto& c = cache();
+
+	auto cached = c.composites.find(CompositeKey(texture, parent, force_rgba));
+	if (cached == c.composites.end())
+		return false;
+
+	// Check global invalidation
+	auto& comp = cached->second;
+	if (comp.generation != c.generation || comp.col_match != col_match)
+		return false;
+
+	// Check palette
+	if (comp.has_palette != (pal != nullptr))
+		return false;
+	if (pal && !samePalette(comp.palette, *pal))
+		return false;
+
+	// Check texture definition
+	if (comp.signature != signature(texture))
+		return false;
+
+	// Check patch entries
+	for (auto& dep : comp.deps.entries)
+	{
+		auto entry = dep.entry.lock();
+		if (!entry || entry->modifiedCount() != dep.modified)
+			return false;
+	}
+
+	// Check textures used as patches
+	for (auto& dep : comp.deps.textures)
+		if (signature(dep.texture) != dep.signature)
+			return false;
+
+	// Valid, use it
+	image.copyImage(comp.image.get());
+	comp.last_used = ++c.usage_counter;
+
+	// Pass dependencies on if this texture is being used as a patch
+	addDependencies(comp.deps, texture, comp.signature);
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+// TextureCache::beginComposite
+//
+// Begins recording dependencies for a texture being composited
+// ----------------------------------------------------------------------------
+void TextureCache::beginComposite()
+{
+	cache().recording.emplace_back();
+}
+
+// ----------------------------------------------------------------------------
+// TextureCache::endComposite
+//
+// Finishes compositing [texture] (begun with beginComposite), adding the
+// resulting [image] to the cache if compositing was successful
+// ----------------------------------------------------------------------------
+void TextureCache::endComposite(CTexture* texture, SImage& image, Archive* parent, Palette* pal, bool force_rgba, bool success)
+{
+	auto& c = cache();
+	if (c.recording.empty())
+		return;
+
+	Dependencies deps = std::move(c.recording.back());
+	c.recording.pop_back();
+
+	// Pass dependencies on if this texture is being used as a patch
+	string sig = signature(texture);
+	addDependencies(deps, texture, sig);
+
+	if (!success || !deps.cacheable)
+		return;
+
+	// Add to cache
+	size_t size = imageSize(image);
+	if (size > compositeLimit())
+		return;
+
+	auto& comp = c.composites[CompositeKey(texture, parent, force_rgba)];
+	c.composites_size -= comp.size;
+	comp.signature = sig;
+	comp.has_palette = (pal != nullptr);
+	if (pal)
+		comp.palette.copyPalette(pal);
+	comp.col_match = col_match;
+	comp.generation = c.generation;
+	comp.deps = std::move(deps);
+	comp.image.reset(new SImage());
+	comp.image->copyImage(&image);
+	comp.size = size;
+	comp.last_used = ++c.usage_counter;
+	c.composites_size += size;
+	trim(c.composites, c.composites_size, compositeLimit());
+}
+
+// ----------------------------------------------------------------------------
+// TextureCache::removeTexture
+//
+// Removes all cached composites of [texture] (eg. when it is deleted)
+// ----------------------------------------------------------------------------
+void TextureCache::removeTexture(CTexture* texture)
+{
+	if (!state)
+		return;
+
+	auto it = state->composites.lower_bound(CompositeKey(texture, nullptr, false));
+	while (it != state->composites.end() && std::get<0>(it->first) == texture)
+	{
+		state->composites_size -= it->second.size;
+		it = state->composites.erase(it);
+	}
+
+	// Other composites may have used the texture as a patch
+	state->generation++;
+}
+
+// ----------------------------------------------------------------------------
+// TextureCache::texturesChanged
+//
+// Invalidates all cached composites, should be called when a texture list
+// is modified (textures added, removed, reordered etc.)
+// ----------------------------------------------------------------------------
+void TextureCache::texturesChanged()
+{
+	if (state)
+		state->generation++;
+}
+
+// ----------------------------------------------------------------------------
+// TextureCache::clear
+//
+// Clears all cached patches and composites
+// ----------------------------------------------------------------------------
+void TextureCache::clear()
+{
+	if (!state)
+		return;
+
+	state->patches.clear();
+	state->composites.clear();
+	state->patches_size = 0;
+	state->composites_size = 0;
+	state->generation++;
+}
+
+
+// ----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// ----------------------------------------------------------------------------
+
+CONSOLE_COMMAND(texture_cache_info, 0, false)
+{
+	auto& c = TextureCache::cache();
+	Log::console(S_FMT(
+		"Patches: %d (%1.2fMB), Composites: %d (%1.2fMB)",
+		(int)c.patches.size(),
+		(double)c.patches_size / (1024.0 * 1024.0),
+		(int)c.composites.size(),
+		(double)c.composites_size / (1024.0 * 1024.0)));
+}
+
+CONSOLE_COMMAND(texture_cache_clear, 0, false)
+{
+	TextureCache::clear();
+}
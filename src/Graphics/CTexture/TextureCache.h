@@ -0,0 +1,26 @@
+#pragma once
+
+class ArchiveEntry;
+class Archive;
+class CTexture;
+class Palette;
+class SImage;
+
+// Caches decoded patch images and composited texture images, so that
+// CTexture::toImage doesn't have to reload and decode every patch entry
+// (or recomposite the whole texture) each time it is called
+namespace TextureCache
+{
+	// Patches
+	bool	loadPatch(ArchiveEntry* entry, SImage& image);
+
+	// Composite textures
+	bool	getComposite(CTexture* texture, SImage& image, Archive* parent, Palette* pal, bool force_rgba);
+	void	beginComposite();
+	void	endComposite(CTexture* texture, SImage& image, Archive* parent, Palette* pal, bool force_rgba, bool success);
+
+	// Invalidation
+	void	removeTexture(CTexture* texture);
+	void	texturesChanged();
+	void	clear();
+}
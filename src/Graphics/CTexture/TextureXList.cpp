@@ -32,6 +32,7 @@
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
 #include "MainEditor/MainEditor.h"
+#include "TextureCache.h"
 #include "Utility/Tokenizer.h"
 
 
@@ -127,6 +128,9 @@ void TextureXList::addTexture(CTexture* tex, int position)
 
 	tex->in_list = this;
 	tex->index = position;
+
+	// Textures-as-patches may now resolve differently
+	TextureCache::texturesChanged();
 }
 
 /* TextureXList::removeTexture
@@ -145,6 +149,7 @@ CTexture* TextureXList::removeTexture(unsigned index, bool delete_texture)
 	// Remove the texture from the list
 	CTexture* removed = textures[index];
 	textures.erase(textures.begin() + index);
+	TextureCache::texturesChanged();
 
 	return delete_texture ? NULL : removed;
 }
@@ -167,6 +172,8 @@ void TextureXList::swapTextures(unsigned index1, unsigned index2)
 	int ti = textures[index1]->index;
 	textures[index1]->index = textures[index2]->index;
 	textures[index2]->index = ti;
+
+	TextureCache::texturesChanged();
 }
 
 /* TextureXList::replaceTexture
@@ -184,6 +191,7 @@ CTexture* TextureXList::replaceTexture(unsigned index, CTexture* replacement)
 	textures[index] = replacement;
 	replacement->in_list = this;
 	replacement->index = index;
+	TextureCache::texturesChanged();
 
 	return replaced;
 }
@@ -197,6 +205,7 @@ void TextureXList::clear(bool clear_patches)
 	for (unsigned a = 0; a < textures.size(); a++)
 		delete textures[a];
 	textures.clear();
+	TextureCache::texturesChanged();
 }
 
 // Some structs for reading TEXTUREx data
@@ -358,6 +358,7 @@ public:
 		this->name = "Doom Gfx";
 		this->extension = "lmp";
 		this->reliability = 230;
+		this->size_min = sizeof(patch_header_t) + 1;
 	}
 
 	~SIFDoomGfx() {}
@@ -484,6 +485,7 @@ public:
 	{
 		this->name = "Doom Gfx (Alpha)";
 		this->reliability = 100;
+		this->size_min = sizeof(oldpatch_header_t) + 1;
 	}
 	~SIFDoomAlphaGfx();
 
@@ -557,6 +559,7 @@ public:
 		name = "Doom Arah";
 		extension = "lmp";
 		reliability = 100;
+		size_min = sizeof(patch_header_t);
 	}
 	~SIFDoomArah() {}
 
@@ -640,6 +643,7 @@ public:
 	{
 		name = "Doom Snea";
 		extension = "lmp";
+		size_min = 6;
 	};
 	~SIFDoomSnea() {}
 
@@ -708,6 +712,7 @@ public:
 		name = "Doom PSX";
 		extension = "lmp";
 		reliability = 100;
+		size_min = sizeof(psxpic_header_t);
 	}
 	~SIFDoomPSX() {}
 
@@ -792,6 +797,7 @@ public:
 		name = "Doom Jaguar";
 		extension = "lmp";
 		reliability = 85;
+		size_min = sizeof(jagpic_header_t);
 	}
 	~SIFDoomJaguar() {}
 
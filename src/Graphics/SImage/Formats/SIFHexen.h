@@ -177,6 +177,7 @@ public:
 		name = "Planar";
 		extension = "lmp";
 		reliability = 240;
+		valid_sizes = { 153648 };
 	}
 	~SIFPlanar();
 
@@ -338,6 +339,7 @@ public:
 		name = "4-bit";
 		extension = "lmp";
 		reliability = 80;
+		valid_sizes = { 32, 184 };
 	}
 	~SIF4BitChunk() {}
 
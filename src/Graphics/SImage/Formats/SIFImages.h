@@ -367,17 +367,24 @@ protected:
 		// Flip the image
 		FreeImage_FlipVertical(bm);
 
-		// Write the image to a temp file
-		FreeImage_Save(FIF_PNG, bm, CHR(App::path("temp.png", App::Dir::Temp)));
-
-		// Load it into a memchunk
+		// Write the image to memory (not a temp file, since images can be
+		// converted on multiple threads at once in batch mode)
 		MemChunk png;
-		png.importFile(App::path("temp.png", App::Dir::Temp));
+		FIMEMORY* mem = FreeImage_OpenMemory();
+		if (FreeImage_SaveToMemory(FIF_PNG, bm, mem))
+		{
+			BYTE* mem_data = nullptr;
+			DWORD mem_size = 0;
+			FreeImage_AcquireMemory(mem, &mem_data, &mem_size);
+			png.importMem(mem_data, mem_size);
+		}
+		FreeImage_CloseMemory(mem);
+		FreeImage_Unload(bm);
 
-		// Check it loaded ok
-		if (png.getSize() == 0)
+		// Check it was written ok
+		if (png.getSize() <= 33)
 		{
-			LOG_MESSAGE(1, "Error reading temporary file");
+			LOG_MESSAGE(1, "Error writing PNG data");
 			return false;
 		}
 
@@ -405,9 +412,6 @@ protected:
 		// Write remaining PNG data
 		data.write(png_data + 33, png.getSize() - 33);
 
-		// Clean up
-		wxRemoveFile(App::path("temp.png", App::Dir::Temp));
-
 		// Success
 		return true;
 	}
@@ -417,6 +421,8 @@ public:
 	{
 		name = "PNG";
 		extension = "png";
+		size_min = 9;
+		signature = { 137, 80, 78, 71, 13, 10, 26, 10 };
 	}
 
 	bool isThisFormat(MemChunk& mc)
@@ -60,6 +60,7 @@ public:
 		name = "Half-Life Texture";
 		extension = "hlt";
 		reliability = 20;
+		size_min = 812;
 	}
 	~SIFHalfLifeTex() {}
 
@@ -139,6 +140,7 @@ public:
 		name = "Shadowcaster Sprite";
 		extension = "dat";
 		reliability = 110;
+		size_min = 4;
 	}
 	~SIFSCSprite() {}
 
@@ -237,6 +239,7 @@ public:
 		name = "Shadowcaster Gfx";
 		extension = "dat";
 		reliability = 100;
+		size_min = sizeof(patch_header_t);
 	}
 	~SIFSCGfx() {}
 
@@ -315,6 +318,7 @@ public:
 		name = "Shadowcaster Wall";
 		extension = "dat";
 		reliability = 101;
+		size_min = 194;
 	}
 	~SIFSCWall() {}
 
@@ -368,6 +372,7 @@ public:
 		name = "Amulets & Armor";
 		extension = "dat";
 		reliability = 100;
+		size_min = 4;
 	}
 	~SIFAnaMip() {}
 
@@ -500,6 +505,8 @@ public:
 		name = "Build ART";
 		extension = "art";
 		reliability = 100;
+		size_min = 16;
+		signature = { 1, 0, 0, 0 };
 	}
 	~SIFBuildTile() {}
 
@@ -585,6 +592,8 @@ public:
 		name = "Heretic 2 8bpp";
 		extension = "dat";
 		reliability = 80;
+		size_min = 1040;
+		signature = { 2, 0, 0, 0 };
 	}
 	~SIFHeretic2M8() {}
 
@@ -657,6 +666,8 @@ public:
 		name = "Heretic 2 32bpp";
 		extension = "dat";
 		reliability = 80;
+		size_min = 1040;
+		signature = { 4, 0, 0, 0 };
 	}
 	~SIFHeretic2M32() {}
 
@@ -718,6 +729,7 @@ public:
 		name = "Wolf3d Pic";
 		extension = "dat";
 		reliability = 200;
+		size_min = 4;
 	}
 	~SIFWolfPic() {}
 
@@ -785,6 +797,8 @@ public:
 		name = "Wolf3d Sprite";
 		extension = "dat";
 		reliability = 200;
+		size_min = 8;
+		size_max = 4228;
 	}
 	~SIFWolfSprite() {}
 
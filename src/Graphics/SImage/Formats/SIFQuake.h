@@ -95,6 +95,7 @@ public:
 	{
 		name = "Quake Gfx";
 		extension = "dat";
+		size_min = 9;
 	}
 	~SIFQuakeGfx() {}
 
@@ -249,6 +250,8 @@ public:
 	{
 		name = "Quake Sprite";
 		extension = "dat";
+		size_min = 64;
+		signature = { 'I', 'D', 'S', 'P' };
 	}
 	~SIFQuakeSprite() {}
 
@@ -302,6 +305,7 @@ public:
 		name = "Quake Texture";
 		extension = "dat";
 		reliability = 11;
+		size_min = 125;
 	}
 	~SIFQuakeTex() {}
 
@@ -377,6 +381,7 @@ public:
 		name = "Quake II Wall";
 		extension = "dat";
 		reliability = 21;
+		size_min = 101;
 	}
 	~SIFQuake2Wal() {}
 
@@ -100,6 +100,7 @@ public:
 		name = "ROTT Gfx";
 		extension = "dat";
 		reliability = 121;
+		size_min = sizeof(rottpatch_header_t) + 1;
 	}
 	~SIFRottGfx() {}
 
@@ -224,6 +225,8 @@ public:
 		name = "ROTT Lbm";
 		extension = "dat";
 		reliability = 80;
+		size_min = 801;
+		signature = { 0x40, 0x01, 0xC8, 0x00 };
 	}
 	~SIFRottLbm() {}
 
@@ -278,6 +281,7 @@ public:
 		name = "ROTT Raw";
 		extension = "dat";
 		reliability = 101;
+		size_min = sizeof(patch_header_t);
 	}
 	~SIFRottRaw() {}
 
@@ -356,6 +360,7 @@ public:
 		name = "ROTT Picture";
 		extension = "dat";
 		reliability = 60;
+		size_min = 8;
 	}
 	~SIFRottPic() {}
 
@@ -412,6 +417,7 @@ public:
 		name = "ROTT Flat";
 		extension = "dat";
 		reliability = 10;
+		valid_sizes = { 4096, 51200 };
 	}
 	~SIFRottWall() {}
 
@@ -62,6 +62,8 @@ public:
 	{
 		name = "IMGZ";
 		extension = "imgz";
+		size_min = sizeof(imgz_header_t);
+		signature = { 'I', 'M', 'G', 'Z' };
 	}
 	~SIFImgz() {}
 
@@ -33,7 +33,9 @@
 #undef BOOL
 #include "Archive/Archive.h"
 #include "Archive/EntryType/EntryType.h"
+#include "General/Console/Console.h"
 #include "General/Misc.h"
+#include "MainEditor/MainEditor.h"
 #include "SIFormat.h"
 
 
@@ -46,6 +48,14 @@ SIFormat*			sif_flat = nullptr;
 SIFormat*			sif_general = nullptr;
 SIFormat*			sif_unknown = nullptr;
 
+// Format detection dispatch table: for each possible first data byte, the
+// indices (into simage_formats, in registration order) of all formats that
+// could match data starting with that byte. Formats with a signature are
+// only listed under their first signature byte. Built once by initFormats,
+// so it is read-only (and safe to use from any thread) afterwards
+vector<unsigned>	sif_dispatch[256];
+vector<unsigned>	sif_dispatch_empty;	// Candidates for empty data
+
 
 /*******************************************************************
  * EXTERNAL VARIABLES
@@ -196,6 +206,10 @@ public:
 
 	bool isThisFormat(MemChunk& mc)
 	{
+		// Nothing to sniff
+		if (mc.getSize() == 0)
+			return false;
+
 		FIMEMORY* mem = FreeImage_OpenMemory((BYTE*)mc.getData(), mc.getSize());
 		FREE_IMAGE_FORMAT fif = FreeImage_GetFileTypeFromMemory(mem, 0);
 		FreeImage_CloseMemory(mem);
@@ -497,6 +511,8 @@ SIFormat::SIFormat(string id)
 	this->name = "Unknown";
 	this->extension = "dat";
 	this->reliability = 255;
+	this->size_min = 0;
+	this->size_max = 0;
 
 	// Add to list of formats
 	simage_formats.push_back(this);
@@ -577,6 +593,40 @@ void SIFormat::initFormats()
 	new SIFHeretic2M32();
 	new SIFWolfPic();
 	new SIFWolfSprite();
+
+	// Build format detection dispatch table
+	buildDispatchTable();
+}
+
+/* SIFormat::buildDispatchTable
+ * Builds the format detection dispatch table from the currently
+ * registered formats
+ *******************************************************************/
+void SIFormat::buildDispatchTable()
+{
+	for (unsigned b = 0; b < 256; b++)
+		sif_dispatch[b].clear();
+	sif_dispatch_empty.clear();
+
+	MemChunk empty;
+	for (unsigned a = 0; a < simage_formats.size(); a++)
+	{
+		SIFormat* format = simage_formats[a];
+
+		// Only formats without any size requirement can match empty data
+		if (format->couldBeThisFormat(empty))
+			sif_dispatch_empty.push_back(a);
+
+		// Formats with a signature can only match data starting with its
+		// first byte, others go in every list
+		if (!format->signature.empty())
+			sif_dispatch[format->signature[0]].push_back(a);
+		else
+		{
+			for (unsigned b = 0; b < 256; b++)
+				sif_dispatch[b].push_back(a);
+		}
+	}
 }
 
 /* SIFormat::getFormat
@@ -604,21 +654,28 @@ SIFormat* SIFormat::getFormat(string id)
 }
 
 /* SIFormat::determineFormat
- * Determines the format of the image data in [mc]
+ * Determines the format of the image data in [mc]. Only formats
+ * listed in the dispatch table for the first byte of [mc] and whose
+ * detection constraints are met are actually checked
  *******************************************************************/
 SIFormat* SIFormat::determineFormat(MemChunk& mc)
 {
-	// Go through all registered formats
+	// Get candidate formats
+	vector<unsigned>& candidates = mc.getSize() > 0 ? sif_dispatch[mc[0]] : sif_dispatch_empty;
+
+	// Go through candidate formats (in registration order)
 	SIFormat* format = sif_unknown;
-	for (unsigned a = 0; a < simage_formats.size(); a++)
+	for (unsigned a = 0; a < candidates.size(); a++)
 	{
+		SIFormat* candidate = simage_formats[candidates[a]];
+
 		// Don't bother checking if the format is less reliable
-		if (simage_formats[a]->reliability < format->reliability)
+		if (candidate->reliability < format->reliability)
 			continue;
 
 		// Check if data matches format
-		if (simage_formats[a]->isThisFormat(mc))
-			format = simage_formats[a];
+		if (candidate->couldBeThisFormat(mc) && candidate->isThisFormat(mc))
+			format = candidate;
 
 		// Stop if format detected is 100% reliable
 		if (format->reliability == 255)
@@ -679,3 +736,77 @@ void SIFormat::getAllFormats(vector<SIFormat*>& list)
 	list.push_back(sif_raw);
 	list.push_back(sif_flat);
 }
+
+
+/*******************************************************************
+ * CONSOLE COMMANDS
+ *******************************************************************/
+
+/* determineFormatAll
+ * Determines the format of [mc] by checking every registered format
+ * (ie. the old detection method, without the dispatch table). Used
+ * to verify and benchmark SIFormat::determineFormat
+ *******************************************************************/
+SIFormat* determineFormatAll(MemChunk& mc)
+{
+	SIFormat* format = sif_unknown;
+	for (unsigned a = 0; a < simage_formats.size(); a++)
+	{
+		if (simage_formats[a]->reliability < format->reliability)
+			continue;
+
+		if (simage_formats[a]->isThisFormat(mc))
+			format = simage_formats[a];
+
+		if (format->reliability == 255)
+			break;
+	}
+
+	return format;
+}
+
+CONSOLE_COMMAND(test_sif_detect, 0, false)
+{
+	Archive* archive = MainEditor::currentArchive();
+	if (!archive)
+		return;
+
+	long passes = 10;
+	if (args.size() > 0)
+		args[0].ToLong(&passes);
+
+	vector<ArchiveEntry*> entries;
+	archive->getEntryTreeAsList(entries);
+
+	// Check both methods give the same results
+	unsigned mismatches = 0;
+	for (unsigned a = 0; a < entries.size(); a++)
+	{
+		MemChunk& mc = entries[a]->getMCData();
+		SIFormat* fast = SIFormat::determineFormat(mc);
+		SIFormat* all = determineFormatAll(mc);
+		if (fast != all)
+		{
+			Log::console(S_FMT("Mismatch for %s: %s (dispatch) vs %s (all)",
+				entries[a]->getPath(true), fast->getId(), all->getId()));
+			mismatches++;
+		}
+	}
+
+	// Time all formats
+	long start = App::runTimer();
+	for (long p = 0; p < passes; p++)
+		for (unsigned a = 0; a < entries.size(); a++)
+			determineFormatAll(entries[a]->getMCData());
+	long time_all = App::runTimer() - start;
+
+	// Time dispatch table
+	start = App::runTimer();
+	for (long p = 0; p < passes; p++)
+		for (unsigned a = 0; a < entries.size(); a++)
+			SIFormat::determineFormat(entries[a]->getMCData());
+	long time_dispatch = App::runTimer() - start;
+
+	Log::console(S_FMT("%d entries x %ld passes: %ldms checking all formats, %ldms via dispatch table, %d mismatches",
+		(int)entries.size(), passes, time_all, time_dispatch, mismatches));
+}
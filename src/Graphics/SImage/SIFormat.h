@@ -13,6 +13,14 @@ protected:
 	string	extension;
 	uint8_t	reliability;
 
+	// Detection constraints, used to quickly rule out formats before calling
+	// isThisFormat (see SIFormat::determineFormat). These must only describe
+	// conditions that isThisFormat would also reject
+	unsigned			size_min;		// Minimum data size (0 = any)
+	unsigned			size_max;		// Maximum data size (0 = any)
+	vector<unsigned>	valid_sizes;	// Valid exact data sizes (empty = any)
+	vector<uint8_t>		signature;		// Bytes the data must begin with (empty = any)
+
 	// Stuff to access protected image data
 	uint8_t*		imageData(SImage& image) { return image.data; }
 	uint8_t*		imageMask(SImage& image) { return image.mask; }
@@ -59,6 +67,24 @@ public:
 
 	virtual bool	isThisFormat(MemChunk& mc) = 0;
 
+	// Returns false if [mc] can't possibly be in this format, based on the
+	// detection constraints above (without calling isThisFormat)
+	bool couldBeThisFormat(MemChunk& mc)
+	{
+		unsigned size = mc.getSize();
+		if (size < size_min || (size_max > 0 && size > size_max))
+			return false;
+		if (!valid_sizes.empty() && !(VECTOR_EXISTS(valid_sizes, size)))
+			return false;
+		if (size < signature.size())
+			return false;
+		for (unsigned a = 0; a < signature.size(); a++)
+			if (mc[a] != signature[a])
+				return false;
+
+		return true;
+	}
+
 	// Reading
 	virtual SImage::info_t	getInfo(MemChunk& mc, int index = 0) = 0;
 
@@ -118,6 +144,9 @@ public:
 	static SIFormat*	flatFormat();
 	static SIFormat*	generalFormat();
 	static void			getAllFormats(vector<SIFormat*>& list);
+
+private:
+	static void			buildDispatchTable();
 };
 
 #endif//__SIFORMAT_H__
@@ -35,6 +35,7 @@
 #include "Main.h"
 #include "SImage.h"
 #include "SIFormat.h"
+#include "SImageKernels.h"
 #include "Graphics/Translation.h"
 #include "Utility/MathStuff.h"
 
@@ -47,6 +48,21 @@ EXTERN_CVAR(Float, col_greyscale_r)
 EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
 
+
+/*******************************************************************
+ * FUNCTIONS
+ *******************************************************************/
+
+/* getPaletteRGBA
+ * Writes the 256 colours of [pal] to [rgba], as consecutive 4-byte
+ * RGBA values (for use with the SImageKernels functions)
+ *******************************************************************/
+void getPaletteRGBA(Palette* pal, uint8_t* rgba)
+{
+	for (unsigned a = 0; a < 256; a++)
+		pal->colour(a).write(rgba + a * 4);
+}
+
 /*******************************************************************
  * SIMAGE CLASS FUNCTIONS
  *******************************************************************/
@@ -104,21 +120,11 @@ bool SImage::getRGBAData(MemChunk& mc, Palette* pal)
 		if (has_palette || !pal)
 			pal = &palette;
 
-		uint8_t rgba[4];
-		for (int a = 0; a < width * height; a++)
-		{
-			// Get colour
-			rgba_t col = pal->colour(data[a]);
-
-			// Set alpha
-			if (mask)
-				col.a = mask[a];
-			else
-				col.a = 255;
-
-			col.write(rgba);	// Write colour to array
-			mc.write(rgba, 4);	// Write array to MemChunk
-		}
+		// Convert directly into the MemChunk
+		uint8_t pal_rgba[1024];
+		getPaletteRGBA(pal, pal_rgba);
+		SImageKernels::paletteToRGBA(data, mask, pal_rgba, &mc[0], width * height);
+		mc.seek(width * height * 4, SEEK_SET);
 
 		return true;
 	}
@@ -661,15 +667,26 @@ bool SImage::convertRGBA(Palette* pal)
 		return false;
 
 	// Get 32bit data
-	MemChunk rgba_data;
-	getRGBAData(rgba_data, pal);
+	uint8_t* rgba_data = new uint8_t[width * height * 4];
+	if (type == PALMASK)
+	{
+		// Convert paletted data directly
+		if (has_palette || !pal)
+			pal = &palette;
+		uint8_t pal_rgba[1024];
+		getPaletteRGBA(pal, pal_rgba);
+		SImageKernels::paletteToRGBA(data, mask, pal_rgba, rgba_data, width * height);
+	}
+	else
+	{
+		MemChunk mc;
+		getRGBAData(mc, pal);
+		memcpy(rgba_data, mc.getData(), width * height * 4);
+	}
 
 	// Clear current data
 	clearData(true);
-
-	// Copy it
-	data = new uint8_t[width * height * 4];
-	memcpy(data, rgba_data.getData(), width * height * 4);
+	data = rgba_data;
 
 	// Set new type & update variables
 	type = RGBA;
@@ -794,31 +811,18 @@ bool SImage::maskFromColour(rgba_t colour, Palette* pal)
 		if (has_palette || !pal)
 			pal = &palette;
 
-		// Palette+Mask type, go through the mask
-		for (int a = 0; a < width * height; a++)
-		{
-			if (pal->colour(data[a]).equals(colour))
-				mask[a] = 0;
-			else
-				mask[a] = 255;
-		}
+		// Palette+Mask type, build mask values for each palette index
+		uint8_t lut[256];
+		for (unsigned a = 0; a < 256; a++)
+			lut[a] = pal->colour(a).equals(colour) ? 0 : 255;
+
+		// Go through the mask
+		SImageKernels::mapBytes(data, mask, width * height, lut);
 	}
 	else if (type == RGBA)
 	{
 		// RGBA type, go through alpha channel
-		uint32_t c = 0;
-		for (int a = 0; a < width * height; a++)
-		{
-			rgba_t pix_col(data[c], data[c + 1], data[c + 2], 255);
-
-			if (pix_col.equals(colour))
-				data[c + 3] = 0;
-			else
-				data[c + 3] = 255;
-
-			// Skip to next pixel
-			c += 4;
-		}
+		SImageKernels::maskFromColour(data, width * height, colour.r, colour.g, colour.b);
 	}
 	else
 		return false;
@@ -841,25 +845,21 @@ bool SImage::maskFromBrightness(Palette* pal)
 		if (has_palette || !pal)
 			pal = &palette;
 
-		// Go through pixel data
-		for (int a = 0; a < width * height; a++)
+		// Build brightness values for each palette index
+		uint8_t lut[256];
+		for (unsigned a = 0; a < 256; a++)
 		{
-			// Set mask from pixel colour brightness value
-			rgba_t col = pal->colour(data[a]);
-			mask[a] = ((double)col.r*0.3)+((double)col.g*0.59)+((double)col.b*0.11);
+			rgba_t col = pal->colour(a);
+			lut[a] = ((double)col.r*0.3)+((double)col.g*0.59)+((double)col.b*0.11);
 		}
+
+		// Set mask from pixel colour brightness value
+		SImageKernels::mapBytes(data, mask, width * height, lut);
 	}
 	else if (type == RGBA)
 	{
-		// Go through pixel data
-		unsigned c = 0;
-		for (int a = 0; a < width * height; a++)
-		{
-			// Set alpha from pixel colour brightness value
-			data[c+3] = (double)data[c]*0.3 + (double)data[c+1]*0.59 + (double)data[c+2]*0.11;
-			// Skip alpha
-			c += 4;
-		}
+		// Set alpha from pixel colour brightness value
+		SImageKernels::maskFromBrightness(data, width * height);
 	}
 	// ALPHAMASK type is already a brightness mask
 
@@ -879,36 +879,17 @@ bool SImage::cutoffMask(uint8_t threshold)
 	if (type == PALMASK)
 	{
 		// Paletted, go through mask
-		for (int a = 0; a < width * height; a++)
-		{
-			if (mask[a] > threshold)
-				mask[a] = 255;
-			else
-				mask[a] = 0;
-		}
+		SImageKernels::cutoff(mask, width * height, threshold);
 	}
 	else if (type == RGBA)
 	{
 		// RGBA format, go through alpha channel
-		uint32_t c = 0;
-		for (int a = 3; a < width * height * 4; a += 4)
-		{
-			if (data[a] > threshold)
-				data[a] = 255;
-			else
-				data[a] = 0;
-		}
+		SImageKernels::cutoffAlpha(data, width * height, threshold);
 	}
 	else if (type == ALPHAMAP)
 	{
 		// Alpha map, go through pixels
-		for (int a = 0; a < width * height; a++)
-		{
-			if (data[a] > threshold)
-				data[a] = 255;
-			else
-				data[a] = 0;
-		}
+		SImageKernels::cutoff(data, width * height, threshold);
 	}
 	else
 		return false;
@@ -1324,6 +1305,13 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 	}
 	else newdata = data;
 
+	// Translated colours are cached, since translating (and for RGBA
+	// images, finding the nearest palette colour) is expensive and
+	// images generally only use a small number of different colours
+	rgba_t pal_trans[256];
+	bool pal_done[256] = {};
+	std::map<uint32_t, std::pair<bool, rgba_t>> rgba_trans;
+
 	// Go through pixels
 	for (int p = 0; p < width*height; p++)
 	{
@@ -1335,19 +1323,36 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 		rgba_t col;
 		int q = p * bpp;
 		if (type == PALMASK)
-			col.set(pal->colour(data[p]));
+		{
+			if (!pal_done[data[p]])
+			{
+				pal_trans[data[p]] = tr->translate(pal->colour(data[p]), pal);
+				pal_done[data[p]] = true;
+			}
+			col = pal_trans[data[p]];
+		}
 		else if (type == RGBA)
 		{
-			col.set(data[q], data[q + 1], data[q + 2], data[q + 3]);
+			uint32_t key = data[q] | (data[q + 1] << 8) | (data[q + 2] << 16) | (data[q + 3] << 24);
+			auto cached = rgba_trans.find(key);
+			if (cached == rgba_trans.end())
+			{
+				col.set(data[q], data[q + 1], data[q + 2], data[q + 3]);
+
+				// skip colours that don't match exactly to the palette
+				col.index = pal->nearestColour(col);
+				bool match = col.equals(pal->colour(col.index));
+				if (match)
+					col = tr->translate(col, pal);
 
-			// skip colours that don't match exactly to the palette
-			col.index = pal->nearestColour(col);
-			if (!col.equals(pal->colour(col.index)))
+				cached = rgba_trans.insert(std::make_pair(key, std::make_pair(match, col))).first;
+			}
+
+			if (!cached->second.first)
 				continue;
+			col = cached->second.second;
 		}
 
-		col = tr->translate(col, pal);
-
 		if (truecolor)
 		{
 			q = p*4;
@@ -1508,28 +1513,46 @@ bool SImage::drawImage(SImage& img, int x_pos, int y_pos, si_drawprops_t& proper
 	if (has_palette || !pal_dest)
 		pal_dest = &palette;
 
-	// Go through pixels
+	// Clip the source image to this image's bounds
+	int x_start = MAX(x_pos, 0);
+	int x_end = MIN(x_pos + img.width, width);
+	int y_start = MAX(y_pos, 0);
+	int y_end = MIN(y_pos + img.height, height);
+	if (x_start >= x_end || y_start >= y_end)
+		return true;
+
 	unsigned s_stride = img.getStride();
 	uint8_t s_bpp = img.getBpp();
-	unsigned sp = 0;
-	for (int y = y_pos; y < y_pos + img.height; y++)  		// Rows
+
+	// Fast path for the most common case (straight RGBA to RGBA copy),
+	// opaque pixels are copied directly and only translucent pixels
+	// need blending
+	if (type == RGBA && img.type == RGBA && properties.blend == NORMAL && properties.alpha == 1.0f && properties.src_alpha)
 	{
-		// Skip out-of-bounds rows
-		if (y < 0 || y >= height)
+		unsigned d_stride = getStride();
+		unsigned count = x_end - x_start;
+		for (int y = y_start; y < y_end; y++)
 		{
-			sp += s_stride;
-			continue;
-		}
+			uint8_t* src = img.data + (y - y_pos) * s_stride + (x_start - x_pos) * 4;
+			SImageKernels::copyOpaque(src, data + y * d_stride + x_start * 4, count);
 
-		for (int x = x_pos; x < x_pos + img.width; x++)  	// Columns
-		{
-			// Skip out-of-bounds columns
-			if (x < 0 || x >= width)
+			for (unsigned a = 0; a < count; a++)
 			{
-				sp += s_bpp;
-				continue;
+				uint8_t alpha = src[a * 4 + 3];
+				if (alpha > 0 && alpha < 255)
+					drawPixel(x_start + a, y, rgba_t(src[a * 4], src[a * 4 + 1], src[a * 4 + 2], alpha), properties, pal_dest);
 			}
+		}
+
+		return true;
+	}
 
+	// Go through pixels
+	for (int y = y_start; y < y_end; y++)  		// Rows
+	{
+		unsigned sp = (y - y_pos) * s_stride + (x_start - x_pos) * s_bpp;
+		for (int x = x_start; x < x_end; x++)  	// Columns
+		{
 			// Skip if source pixel is fully transparent
 			if ((img.type == PALMASK && img.mask[sp] == 0) ||
 			        (img.type == ALPHAMAP && img.data[sp] == 0) ||
@@ -1573,36 +1596,51 @@ bool SImage::colourise(rgba_t colour, Palette* pal, int start, int stop)
 	if (has_palette || !pal)
 		pal = &palette;
 
-	// Go through all pixels
-	uint8_t bpp = getBpp();
-	rgba_t col;
-	for (int a = 0; a < width*height*bpp; a+= bpp)
+	// Greyscale weightings for each possible channel value
+	double grey_r[256], grey_g[256], grey_b[256];
+	for (unsigned a = 0; a < 256; a++)
 	{
-		// Skip colors out of range if desired
-		if (type == PALMASK && start >= 0 && stop >= start && stop < 256) 
+		grey_r[a] = a*col_greyscale_r;
+		grey_g[a] = a*col_greyscale_g;
+		grey_b[a] = a*col_greyscale_b;
+	}
+
+	// Paletted, colourise each palette colour once and remap the pixels
+	if (type == PALMASK)
+	{
+		uint8_t lut[256];
+		bool range = (start >= 0 && stop >= start && stop < 256);
+		for (int a = 0; a < 256; a++)
 		{
-			if (data[a] < start || data[a] > stop)
+			// Skip colors out of range if desired
+			if (range && (a < start || a > stop))
+			{
+				lut[a] = a;
 				continue;
+			}
+
+			rgba_t col = pal->colour(a);
+			float grey = (grey_r[col.r] + grey_g[col.g] + grey_b[col.b]) / 255.0f;
+			if (grey > 1.0) grey = 1.0;
+			col.r = colour.r*grey;
+			col.g = colour.g*grey;
+			col.b = colour.b*grey;
+			lut[a] = pal->nearestColour(col);
 		}
 
-		// Get current pixel colour
-		if (type == RGBA)
-			col.set(data[a], data[a+1], data[a+2], data[a+3]);
-		else
-			col.set(pal->colour(data[a]));
+		SImageKernels::mapBytes(data, data, width * height, lut);
+		return true;
+	}
 
+	// Go through all pixels
+	for (int a = 0; a < width*height*4; a += 4)
+	{
 		// Colourise it
-		float grey = (col.r*col_greyscale_r + col.g*col_greyscale_g + col.b*col_greyscale_b) / 255.0f;
+		float grey = (grey_r[data[a]] + grey_g[data[a+1]] + grey_b[data[a+2]]) / 255.0f;
 		if (grey > 1.0) grey = 1.0;
-		col.r = colour.r*grey;
-		col.g = colour.g*grey;
-		col.b = colour.b*grey;
-
-		// Set pixel colour
-		if (type == RGBA)
-			col.write(data+a);
-		else
-			data[a] = pal->nearestColour(col);
+		data[a] = colour.r*grey;
+		data[a+1] = colour.g*grey;
+		data[a+2] = colour.b*grey;
 	}
 
 	return true;
@@ -1622,37 +1660,42 @@ bool SImage::tint(rgba_t colour, float amount, Palette* pal, int start, int stop
 	if (has_palette || !pal)
 		pal = &palette;
 
-	// Go through all pixels
-	uint8_t bpp = getBpp();
-	rgba_t col;
-	for (int a = 0; a < width*height*bpp; a+= bpp)
+	// Tinted values for each possible channel value
+	uint8_t tint_r[256], tint_g[256], tint_b[256];
+	float inv_amt = 1.0f - amount;
+	for (unsigned a = 0; a < 256; a++)
 	{
-		// Skip colors out of range if desired
-		if (type == PALMASK && start >= 0 && stop >= start && stop < 256)
+		tint_r[a] = a*inv_amt + colour.r*amount;
+		tint_g[a] = a*inv_amt + colour.g*amount;
+		tint_b[a] = a*inv_amt + colour.b*amount;
+	}
+
+	// Paletted, tint each palette colour once and remap the pixels
+	if (type == PALMASK)
+	{
+		uint8_t lut[256];
+		bool range = (start >= 0 && stop >= start && stop < 256);
+		for (int a = 0; a < 256; a++)
 		{
-			if (data[a] < start || data[a] > stop)
+			// Skip colors out of range if desired
+			if (range && (a < start || a > stop))
+			{
+				lut[a] = a;
 				continue;
-		}
-
-		// Get current pixel colour
-		if (type == RGBA)
-			col.set(data[a], data[a+1], data[a+2], data[a+3]);
-		else
-			col.set(pal->colour(data[a]));
+			}
 
-		// Tint it
-		float inv_amt = 1.0f - amount;
-		col.set(col.r*inv_amt + colour.r*amount,
-		        col.g*inv_amt + colour.g*amount,
-		        col.b*inv_amt + colour.b*amount, col.a);
+			rgba_t col = pal->colour(a);
+			col.set(tint_r[col.r], tint_g[col.g], tint_b[col.b], col.a);
+			lut[a] = pal->nearestColour(col);
+		}
 
-		// Set pixel colour
-		if (type == RGBA)
-			col.write(data+a);
-		else
-			data[a] = pal->nearestColour(col);
+		SImageKernels::mapBytes(data, data, width * height, lut);
+		return true;
 	}
 
+	// Go through all pixels
+	SImageKernels::mapChannels(data, width * height, tint_r, tint_g, tint_b);
+
 	return true;
 }
 
@@ -0,0 +1,657 @@
+
+/*******************************************************************
+ * SLADE - It's a Doom Editor
+ * Copyright (C) 2008-2014 Simon Judd
+ *
+ * Email:       sirjuddington@gmail.com
+ * Web:         http://slade.mancubus.net
+ * Filename:    SImageKernels.cpp
+ * Description: Low-level pixel processing kernels used by SImage,
+ *              with scalar, SSE2 and AVX2 implementations. The
+ *              implementation used is selected at runtime depending
+ *              on what the CPU supports
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *******************************************************************/
+
+
+/*******************************************************************
+ * INCLUDES
+ *******************************************************************/
+#include "Main.h"
+#include "SImageKernels.h"
+#include "SImage.h"
+#include "App.h"
+#include "General/Console/Console.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIK_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define SIK_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SIK_TARGET_AVX2
+#else
+#define SIK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+
+/*******************************************************************
+ * VARIABLES
+ *******************************************************************/
+namespace SImageKernels
+{
+	Level	detected = SCALAR;
+	Level	current = SCALAR;
+	bool	initialised = false;
+}
+
+
+/*******************************************************************
+ * SCALAR KERNELS
+ *******************************************************************/
+namespace
+{
+	void paletteToRGBAScalar(const uint8_t* src, const uint8_t* mask, const uint8_t* pal_rgba, uint8_t* dest, unsigned count)
+	{
+		for (unsigned a = 0; a < count; a++)
+		{
+			const uint8_t* col = pal_rgba + src[a] * 4;
+			dest[0] = col[0];
+			dest[1] = col[1];
+			dest[2] = col[2];
+			dest[3] = mask ? mask[a] : 255;
+			dest += 4;
+		}
+	}
+
+	void cutoffScalar(uint8_t* data, unsigned count, unsigned stride, uint8_t threshold)
+	{
+		for (unsigned a = 0; a < count * stride; a += stride)
+			data[a] = (data[a] > threshold) ? 255 : 0;
+	}
+
+	void maskFromColourScalar(uint8_t* rgba, unsigned count, uint8_t r, uint8_t g, uint8_t b)
+	{
+		for (unsigned a = 0; a < count * 4; a += 4)
+			rgba[a + 3] = (rgba[a] == r && rgba[a + 1] == g && rgba[a + 2] == b) ? 0 : 255;
+	}
+
+	void maskFromBrightnessScalar(uint8_t* rgba, unsigned count)
+	{
+		for (unsigned a = 0; a < count * 4; a += 4)
+			rgba[a + 3] = (double)rgba[a]*0.3 + (double)rgba[a + 1]*0.59 + (double)rgba[a + 2]*0.11;
+	}
+
+	void copyOpaqueScalar(const uint8_t* src, uint8_t* dest, unsigned count)
+	{
+		for (unsigned a = 0; a < count * 4; a += 4)
+		{
+			if (src[a + 3] == 255)
+				memcpy(dest + a, src + a, 4);
+		}
+	}
+}
+
+
+/*******************************************************************
+ * SSE2 KERNELS
+ *******************************************************************/
+#ifdef SIK_SSE2
+namespace
+{
+	// Returns a mask of bytes in [v] greater than [threshold] (must be < 255)
+	inline __m128i greaterSSE2(__m128i v, __m128i threshold_plus_one)
+	{
+		return _mm_cmpeq_epi8(_mm_max_epu8(v, threshold_plus_one), v);
+	}
+
+	void cutoffSSE2(uint8_t* data, unsigned count, uint8_t threshold)
+	{
+		__m128i t1 = _mm_set1_epi8((char)(threshold + 1));
+		unsigned a = 0;
+		for (; a + 16 <= count; a += 16)
+		{
+			__m128i v = _mm_loadu_si128((__m128i*)(data + a));
+			_mm_storeu_si128((__m128i*)(data + a), greaterSSE2(v, t1));
+		}
+		cutoffScalar(data + a, count - a, 1, threshold);
+	}
+
+	void cutoffAlphaSSE2(uint8_t* rgba, unsigned count, uint8_t threshold)
+	{
+		__m128i t1 = _mm_set1_epi8((char)(threshold + 1));
+		__m128i amask = _mm_set1_epi32(0xFF000000);
+		unsigned a = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			__m128i v = _mm_loadu_si128((__m128i*)(rgba + a * 4));
+			__m128i res = _mm_or_si128(_mm_andnot_si128(amask, v), _mm_and_si128(amask, greaterSSE2(v, t1)));
+			_mm_storeu_si128((__m128i*)(rgba + a * 4), res);
+		}
+		cutoffScalar(rgba + a * 4 + 3, count - a, 4, threshold);
+	}
+
+	void maskFromColourSSE2(uint8_t* rgba, unsigned count, uint8_t r, uint8_t g, uint8_t b)
+	{
+		__m128i cmask = _mm_set1_epi32(0x00FFFFFF);
+		__m128i amask = _mm_set1_epi32(0xFF000000);
+		__m128i col = _mm_set1_epi32(r | (g << 8) | (b << 16));
+		unsigned a = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			__m128i v = _mm_and_si128(_mm_loadu_si128((__m128i*)(rgba + a * 4)), cmask);
+			__m128i eq = _mm_cmpeq_epi32(v, col);
+			_mm_storeu_si128((__m128i*)(rgba + a * 4), _mm_or_si128(v, _mm_andnot_si128(eq, amask)));
+		}
+		maskFromColourScalar(rgba + a * 4, count - a, r, g, b);
+	}
+
+	void maskFromBrightnessSSE2(uint8_t* rgba, unsigned count)
+	{
+		__m128i cmask = _mm_set1_epi32(0x00FFFFFF);
+		__m128i bmask = _mm_set1_epi32(0xFF);
+		__m128d wr = _mm_set1_pd(0.3);
+		__m128d wg = _mm_set1_pd(0.59);
+		__m128d wb = _mm_set1_pd(0.11);
+		unsigned a = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			__m128i v = _mm_loadu_si128((__m128i*)(rgba + a * 4));
+			__m128i r = _mm_and_si128(v, bmask);
+			__m128i g = _mm_and_si128(_mm_srli_epi32(v, 8), bmask);
+			__m128i b = _mm_and_si128(_mm_srli_epi32(v, 16), bmask);
+
+			// Same operations (and order) as the scalar version, in double
+			// precision, 2 pixels at a time
+			__m128d lo = _mm_add_pd(_mm_add_pd(
+				_mm_mul_pd(_mm_cvtepi32_pd(r), wr),
+				_mm_mul_pd(_mm_cvtepi32_pd(g), wg)),
+				_mm_mul_pd(_mm_cvtepi32_pd(b), wb));
+			__m128d hi = _mm_add_pd(_mm_add_pd(
+				_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2))), wr),
+				_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(g, _MM_SHUFFLE(1, 0, 3, 2))), wg)),
+				_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2))), wb));
+			__m128i alpha = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+
+			v = _mm_or_si128(_mm_and_si128(v, cmask), _mm_slli_epi32(alpha, 24));
+			_mm_storeu_si128((__m128i*)(rgba + a * 4), v);
+		}
+		maskFromBrightnessScalar(rgba + a * 4, count - a);
+	}
+
+	void copyOpaqueSSE2(const uint8_t* src, uint8_t* dest, unsigned count)
+	{
+		__m128i amask = _mm_set1_epi32(0xFF000000);
+		unsigned a = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i*)(src + a * 4));
+			__m128i d = _mm_loadu_si128((__m128i*)(dest + a * 4));
+			__m128i opaque = _mm_cmpeq_epi32(_mm_and_si128(s, amask), amask);
+			d = _mm_or_si128(_mm_and_si128(opaque, s), _mm_andnot_si128(opaque, d));
+			_mm_storeu_si128((__m128i*)(dest + a * 4), d);
+		}
+		copyOpaqueScalar(src + a * 4, dest + a * 4, count - a);
+	}
+}
+#endif
+
+
+/*******************************************************************
+ * AVX2 KERNELS
+ *******************************************************************/
+#ifdef SIK_AVX2
+namespace
+{
+	SIK_TARGET_AVX2 void paletteToRGBAAVX2(const uint8_t* src, const uint8_t* mask, const uint8_t* pal_rgba, uint8_t* dest, unsigned count)
+	{
+		__m256i cmask = _mm256_set1_epi32(0x00FFFFFF);
+		__m256i opaque = _mm256_set1_epi32(0xFF000000);
+		unsigned a = 0;
+		for (; a + 8 <= count; a += 8)
+		{
+			__m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + a)));
+			__m256i col = _mm256_and_si256(_mm256_i32gather_epi32((const int*)pal_rgba, idx, 4), cmask);
+			if (mask)
+			{
+				__m256i alpha = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(mask + a)));
+				col = _mm256_or_si256(col, _mm256_slli_epi32(alpha, 24));
+			}
+			else
+				col = _mm256_or_si256(col, opaque);
+			_mm256_storeu_si256((__m256i*)(dest + a * 4), col);
+		}
+		paletteToRGBAScalar(src + a, mask ? mask + a : nullptr, pal_rgba, dest + a * 4, count - a);
+	}
+
+	SIK_TARGET_AVX2 void cutoffAVX2(uint8_t* data, unsigned count, uint8_t threshold)
+	{
+		__m256i t1 = _mm256_set1_epi8((char)(threshold + 1));
+		unsigned a = 0;
+		for (; a + 32 <= count; a += 32)
+		{
+			__m256i v = _mm256_loadu_si256((__m256i*)(data + a));
+			_mm256_storeu_si256((__m256i*)(data + a), _mm256_cmpeq_epi8(_mm256_max_epu8(v, t1), v));
+		}
+		cutoffScalar(data + a, count - a, 1, threshold);
+	}
+
+	SIK_TARGET_AVX2 void cutoffAlphaAVX2(uint8_t* rgba, unsigned count, uint8_t threshold)
+	{
+		__m256i t1 = _mm256_set1_epi8((char)(threshold + 1));
+		__m256i amask = _mm256_set1_epi32(0xFF000000);
+		unsigned a = 0;
+		for (; a + 8 <= count; a += 8)
+		{
+			__m256i v = _mm256_loadu_si256((__m256i*)(rgba + a * 4));
+			__m256i gt = _mm256_cmpeq_epi8(_mm256_max_epu8(v, t1), v);
+			_mm256_storeu_si256((__m256i*)(rgba + a * 4), _mm256_blendv_epi8(v, gt, amask));
+		}
+		cutoffScalar(rgba + a * 4 + 3, count - a, 4, threshold);
+	}
+
+	SIK_TARGET_AVX2 void maskFromColourAVX2(uint8_t* rgba, unsigned count, uint8_t r, uint8_t g, uint8_t b)
+	{
+		__m256i cmask = _mm256_set1_epi32(0x00FFFFFF);
+		__m256i amask = _mm256_set1_epi32(0xFF000000);
+		__m256i col = _mm256_set1_epi32(r | (g << 8) | (b << 16));
+		unsigned a = 0;
+		for (; a + 8 <= count; a += 8)
+		{
+			__m256i v = _mm256_and_si256(_mm256_loadu_si256((__m256i*)(rgba + a * 4)), cmask);
+			__m256i eq = _mm256_cmpeq_epi32(v, col);
+			_mm256_storeu_si256((__m256i*)(rgba + a * 4), _mm256_or_si256(v, _mm256_andnot_si256(eq, amask)));
+		}
+		maskFromColourScalar(rgba + a * 4, count - a, r, g, b);
+	}
+
+	SIK_TARGET_AVX2 void maskFromBrightnessAVX2(uint8_t* rgba, unsigned count)
+	{
+		__m256i cmask = _mm256_set1_epi32(0x00FFFFFF);
+		__m256i bmask = _mm256_set1_epi32(0xFF);
+		__m256d wr = _mm256_set1_pd(0.3);
+		__m256d wg = _mm256_set1_pd(0.59);
+		__m256d wb = _mm256_set1_pd(0.11);
+		unsigned a = 0;
+		for (; a + 8 <= count; a += 8)
+		{
+			__m256i v = _mm256_loadu_si256((__m256i*)(rgba + a * 4));
+			__m256i r = _mm256_and_si256(v, bmask);
+			__m256i g = _mm256_and_si256(_mm256_srli_epi32(v, 8), bmask);
+			__m256i b = _mm256_and_si256(_mm256_srli_epi32(v, 16), bmask);
+
+			// Same operations (and order) as the scalar version, in double
+			// precision, 4 pixels at a time
+			__m256d lo = _mm256_add_pd(_mm256_add_pd(
+				_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(r)), wr),
+				_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(g)), wg)),
+				_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(b)), wb));
+			__m256d hi = _mm256_add_pd(_mm256_add_pd(
+				_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(r, 1)), wr),
+				_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(g, 1)), wg)),
+				_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(b, 1)), wb));
+			__m256i alpha = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm256_cvttpd_epi32(lo)),
+				_mm256_cvttpd_epi32(hi),
+				1);
+
+			v = _mm256_or_si256(_mm256_and_si256(v, cmask), _mm256_slli_epi32(alpha, 24));
+			_mm256_storeu_si256((__m256i*)(rgba + a * 4), v);
+		}
+		maskFromBrightnessScalar(rgba + a * 4, count - a);
+	}
+
+	SIK_TARGET_AVX2 void copyOpaqueAVX2(const uint8_t* src, uint8_t* dest, unsigned count)
+	{
+		__m256i amask = _mm256_set1_epi32(0xFF000000);
+		unsigned a = 0;
+		for (; a + 8 <= count; a += 8)
+		{
+			__m256i s = _mm256_loadu_si256((const __m256i*)(src + a * 4));
+			__m256i d = _mm256_loadu_si256((__m256i*)(dest + a * 4));
+			__m256i opaque = _mm256_cmpeq_epi32(_mm256_and_si256(s, amask), amask);
+			_mm256_storeu_si256((__m256i*)(dest + a * 4), _mm256_blendv_epi8(d, s, opaque));
+		}
+		copyOpaqueScalar(src + a * 4, dest + a * 4, count - a);
+	}
+
+	// Returns true if the CPU and OS support AVX2
+	bool cpuHasAVX2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		// Check OSXSAVE + AVX, and that the OS saves the YMM registers
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+			return false;
+		if ((_xgetbv(0) & 6) != 6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+}
+#endif
+
+
+/*******************************************************************
+ * SIMAGEKERNELS NAMESPACE FUNCTIONS
+ *******************************************************************/
+
+/* SImageKernels::detectedLevel
+ * Returns the best kernel implementation level supported by the CPU
+ *******************************************************************/
+SImageKernels::Level SImageKernels::detectedLevel()
+{
+	if (!initialised)
+	{
+#ifdef SIK_SSE2
+		detected = SSE2;
+#endif
+#ifdef SIK_AVX2
+		if (cpuHasAVX2())
+			detected = AVX2;
+#endif
+		current = detected;
+		initialised = true;
+	}
+
+	return detected;
+}
+
+/* SImageKernels::level
+ * Returns the kernel implementation level currently in use
+ *******************************************************************/
+SImageKernels::Level SImageKernels::level()
+{
+	if (!initialised)
+		detectedLevel();
+
+	return current;
+}
+
+/* SImageKernels::setMaxLevel
+ * Limits the kernel implementation level used to [max] (or the best
+ * supported level if lower). Mostly useful for testing
+ *******************************************************************/
+void SImageKernels::setMaxLevel(Level max)
+{
+	current = MIN(max, detectedLevel());
+}
+
+/* SImageKernels::levelName
+ * Returns the name of the kernel implementation [level]
+ *******************************************************************/
+string SImageKernels::levelName(Level level)
+{
+	switch (level)
+	{
+	case SSE2: return "SSE2";
+	case AVX2: return "AVX2";
+	default: return "Scalar";
+	}
+}
+
+/* SImageKernels::paletteToRGBA
+ * Converts [count] palette indices in [src] to RGBA in [dest], using
+ * the 256 RGBA colours in [pal_rgba]. Alpha is taken from [mask] if
+ * given, otherwise it is set to 255
+ *******************************************************************/
+void SImageKernels::paletteToRGBA(const uint8_t* src, const uint8_t* mask, const uint8_t* pal_rgba, uint8_t* dest, unsigned count)
+{
+#ifdef SIK_AVX2
+	if (level() >= AVX2)
+		return paletteToRGBAAVX2(src, mask, pal_rgba, dest, count);
+#endif
+	paletteToRGBAScalar(src, mask, pal_rgba, dest, count);
+}
+
+/* SImageKernels::cutoff
+ * Sets each of [count] bytes in [data] to 255 if greater than
+ * [threshold], 0 otherwise
+ *******************************************************************/
+void SImageKernels::cutoff(uint8_t* data, unsigned count, uint8_t threshold)
+{
+	// Nothing can be greater than 255
+	if (threshold == 255)
+	{
+		memset(data, 0, count);
+		return;
+	}
+
+#ifdef SIK_AVX2
+	if (level() >= AVX2)
+		return cutoffAVX2(data, count, threshold);
+#endif
+#ifdef SIK_SSE2
+	if (level() >= SSE2)
+		return cutoffSSE2(data, count, threshold);
+#endif
+	cutoffScalar(data, count, 1, threshold);
+}
+
+/* SImageKernels::cutoffAlpha
+ * Sets the alpha channel of [count] RGBA pixels to 255 if greater
+ * than [threshold], 0 otherwise
+ *******************************************************************/
+void SImageKernels::cutoffAlpha(uint8_t* rgba, unsigned count, uint8_t threshold)
+{
+	if (threshold < 255)
+	{
+#ifdef SIK_AVX2
+		if (level() >= AVX2)
+			return cutoffAlphaAVX2(rgba, count, threshold);
+#endif
+#ifdef SIK_SSE2
+		if (level() >= SSE2)
+			return cutoffAlphaSSE2(rgba, count, threshold);
+#endif
+	}
+	cutoffScalar(rgba + 3, count, 4, threshold);
+}
+
+/* SImageKernels::maskFromColour
+ * Sets the alpha channel of [count] RGBA pixels to 0 if the pixel
+ * colour matches [r],[g],[b], 255 otherwise
+ *******************************************************************/
+void SImageKernels::maskFromColour(uint8_t* rgba, unsigned count, uint8_t r, uint8_t g, uint8_t b)
+{
+#ifdef SIK_AVX2
+	if (level() >= AVX2)
+		return maskFromColourAVX2(rgba, count, r, g, b);
+#endif
+#ifdef SIK_SSE2
+	if (level() >= SSE2)
+		return maskFromColourSSE2(rgba, count, r, g, b);
+#endif
+	maskFromColourScalar(rgba, count, r, g, b);
+}
+
+/* SImageKernels::maskFromBrightness
+ * Sets the alpha channel of [count] RGBA pixels to the pixel
+ * brightness
+ *******************************************************************/
+void SImageKernels::maskFromBrightness(uint8_t* rgba, unsigned count)
+{
+#ifdef SIK_AVX2
+	if (level() >= AVX2)
+		return maskFromBrightnessAVX2(rgba, count);
+#endif
+#ifdef SIK_SSE2
+	if (level() >= SSE2)
+		return maskFromBrightnessSSE2(rgba, count);
+#endif
+	maskFromBrightnessScalar(rgba, count);
+}
+
+/* SImageKernels::copyOpaque
+ * Copies all fully opaque pixels of [count] RGBA pixels in [src] to
+ * [dest] (other pixels in [dest] are left untouched)
+ *******************************************************************/
+void SImageKernels::copyOpaque(const uint8_t* src, uint8_t* dest, unsigned count)
+{
+#ifdef SIK_AVX2
+	if (level() >= AVX2)
+		return copyOpaqueAVX2(src, dest, count);
+#endif
+#ifdef SIK_SSE2
+	if (level() >= SSE2)
+		return copyOpaqueSSE2(src, dest, count);
+#endif
+	copyOpaqueScalar(src, dest, count);
+}
+
+/* SImageKernels::mapBytes
+ * Maps each of [count] bytes in [src] through [lut] into [dest]
+ *******************************************************************/
+void SImageKernels::mapBytes(const uint8_t* src, uint8_t* dest, unsigned count, const uint8_t* lut)
+{
+	for (unsigned a = 0; a < count; a++)
+		dest[a] = lut[src[a]];
+}
+
+/* SImageKernels::mapChannels
+ * Maps the r, g and b channels of [count] RGBA pixels through
+ * [lut_r], [lut_g] and [lut_b] respectively
+ *******************************************************************/
+void SImageKernels::mapChannels(uint8_t* rgba, unsigned count, const uint8_t* lut_r, const uint8_t* lut_g, const uint8_t* lut_b)
+{
+	for (unsigned a = 0; a < count * 4; a += 4)
+	{
+		rgba[a] = lut_r[rgba[a]];
+		rgba[a + 1] = lut_g[rgba[a + 1]];
+		rgba[a + 2] = lut_b[rgba[a + 2]];
+	}
+}
+
+
+/*******************************************************************
+ * CONSOLE COMMANDS
+ *******************************************************************/
+
+/* benchmarkKernelOp
+ * Runs [op] on a copy of [source] [passes] times, using kernel
+ * [level]. Returns the total time taken (in ms), the resulting RGBA
+ * data is written to [result]
+ *******************************************************************/
+long benchmarkKernelOp(SImage& source, std::function<void(SImage&)> op, SImageKernels::Level level, int passes, MemChunk& result)
+{
+	SImageKernels::setMaxLevel(level);
+
+	SImage image;
+	long total = 0;
+	for (int p = 0; p < passes; p++)
+	{
+		image.copyImage(&source);
+		long start = App::runTimer();
+		op(image);
+		total += App::runTimer() - start;
+	}
+	image.getRGBAData(result);
+
+	SImageKernels::setMaxLevel(SImageKernels::detectedLevel());
+
+	return total;
+}
+
+CONSOLE_COMMAND(test_simage_kernels, 0, false)
+{
+	SImageKernels::Level best = SImageKernels::detectedLevel();
+	Log::console(S_FMT("Best supported kernel level: %s", SImageKernels::levelName(best)));
+
+	// Build a palette for paletted tests
+	Palette pal;
+	for (unsigned a = 0; a < 256; a++)
+		pal.setColour(a, rgba_t(a, 255 - a, (a * 7) & 255, 255));
+
+	std::map<string, std::function<void(SImage&)>> ops;
+	ops["convertRGBA"] = [&](SImage& img) { img.convertRGBA(&pal); };
+	ops["maskFromColour"] = [&](SImage& img) { img.maskFromColour(rgba_t(0, 0, 0), &pal); };
+	ops["maskFromBrightness"] = [&](SImage& img) { img.maskFromBrightness(&pal); };
+	ops["cutoffMask"] = [&](SImage& img) { img.cutoffMask(127); };
+	ops["colourise"] = [&](SImage& img) { img.colourise(rgba_t(255, 128, 0), &pal); };
+	ops["tint"] = [&](SImage& img) { img.tint(rgba_t(255, 128, 0), 0.5f, &pal); };
+	ops["drawImage"] = [&](SImage& img)
+	{
+		si_drawprops_t props;
+		SImage copy;
+		copy.copyImage(&img);
+		img.drawImage(copy, img.getWidth() / 4, img.getHeight() / 4, props, &pal, &pal);
+	};
+
+	int sizes[] = { 64, 256, 1024, 4096 };
+	for (int size : sizes)
+	{
+		// Number of passes so each size processes a similar number of pixels
+		int passes = MAX(1, (1024 * 1024) / (size * size));
+
+		// Build test images with pseudo-random content
+		SImage rgba(RGBA), paletted(PALMASK);
+		rgba.create(size, size, RGBA);
+		paletted.create(size, size, PALMASK, &pal);
+		uint32_t seed = 12345;
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				seed = seed * 1103515245 + 12345;
+				rgba.setPixel(x, y, rgba_t(seed >> 24, seed >> 16, seed >> 8, (seed >> 4) & 1 ? 255 : seed));
+				paletted.setPixel(x, y, seed >> 24, (seed >> 4) & 1 ? 255 : seed >> 16);
+			}
+		}
+
+		for (auto& op : ops)
+		{
+			SImage* images[] = { &rgba, &paletted };
+			for (SImage* image : images)
+			{
+				// Skip paletted colourise/tint on big images (nearest colour
+				// matching dominates and isn't what's being tested here)
+				if (image == &paletted && size > 256 && (op.first == "colourise" || op.first == "tint"))
+					continue;
+
+				MemChunk res_scalar, res_best;
+				long t_scalar = benchmarkKernelOp(*image, op.second, SImageKernels::SCALAR, passes, res_scalar);
+				long t_best = benchmarkKernelOp(*image, op.second, best, passes, res_best);
+				bool exact = res_scalar.getSize() == res_best.getSize() &&
+					memcmp(res_scalar.getData(), res_best.getData(), res_scalar.getSize()) == 0;
+
+				Log::console(S_FMT(
+					"%dx%d %s %s (x%d): %ldms scalar, %ldms %s%s",
+					size, size,
+					image == &rgba ? "RGBA" : "Paletted",
+					op.first,
+					passes,
+					t_scalar,
+					t_best,
+					SImageKernels::levelName(best),
+					exact ? "" : " - RESULTS DIFFER"));
+			}
+		}
+	}
+}
@@ -0,0 +1,53 @@
+
+#ifndef __SIMAGE_KERNELS_H__
+#define __SIMAGE_KERNELS_H__
+
+// Low-level pixel processing kernels used by SImage. Each kernel has a
+// scalar implementation and, where possible, SSE2/AVX2 implementations
+// selected at runtime. All implementations give bit-exact results
+namespace SImageKernels
+{
+	enum Level
+	{
+		SCALAR = 0,
+		SSE2,
+		AVX2,
+	};
+
+	Level		level();
+	Level		detectedLevel();
+	void		setMaxLevel(Level max);
+	string		levelName(Level level);
+
+	// Converts [count] palette indices in [src] to RGBA in [dest], using the
+	// 256 RGBA colours in [pal_rgba]. Alpha is taken from [mask] if given,
+	// otherwise it is set to 255
+	void	paletteToRGBA(const uint8_t* src, const uint8_t* mask, const uint8_t* pal_rgba, uint8_t* dest, unsigned count);
+
+	// Sets each of [count] bytes in [data] to 255 if greater than [threshold],
+	// 0 otherwise
+	void	cutoff(uint8_t* data, unsigned count, uint8_t threshold);
+
+	// As above, but only for the alpha channel of [count] RGBA pixels
+	void	cutoffAlpha(uint8_t* rgba, unsigned count, uint8_t threshold);
+
+	// Sets the alpha channel of [count] RGBA pixels to 0 if the pixel colour
+	// matches [r],[g],[b], 255 otherwise
+	void	maskFromColour(uint8_t* rgba, unsigned count, uint8_t r, uint8_t g, uint8_t b);
+
+	// Sets the alpha channel of [count] RGBA pixels to the pixel brightness
+	void	maskFromBrightness(uint8_t* rgba, unsigned count);
+
+	// Copies all fully opaque pixels of [count] RGBA pixels in [src] to [dest]
+	// (other pixels in [dest] are left untouched)
+	void	copyOpaque(const uint8_t* src, uint8_t* dest, unsigned count);
+
+	// Maps each of [count] bytes in [src] through [lut] into [dest]
+	void	mapBytes(const uint8_t* src, uint8_t* dest, unsigned count, const uint8_t* lut);
+
+	// Maps the r, g and b channels of [count] RGBA pixels through [lut_r],
+	// [lut_g] and [lut_b] respectively
+	void	mapChannels(uint8_t* rgba, unsigned count, const uint8_t* lut_r, const uint8_t* lut_g, const uint8_t* lut_b);
+}
+
+#endif//__SIMAGE_KERNELS_H__
@@ -58,9 +58,10 @@ typedef std::map<int, vector<ArchiveEntry*> > CRCMap;
 
 /* ArchiveOperations::removeUnusedPatches
  * Removes any patches and associated entries from [archive] that
- * are not used in any texture definitions
+ * are not used in any texture definitions. If [interactive] is
+ * false, no message box is shown when done
  *******************************************************************/
-bool ArchiveOperations::removeUnusedPatches(Archive* archive)
+bool ArchiveOperations::removeUnusedPatches(Archive* archive, bool interactive)
 {
 	if (!archive)
 		return false;
@@ -106,7 +107,18 @@ bool ArchiveOperations::removeUnusedPatches(Archive* archive)
 			// Unused
 
 			// If its entry is in the archive, flag it to be removed
-			ArchiveEntry* entry = theResourceManager->getPatchEntry(p.name, "patches", archive);
+			ArchiveEntry* entry;
+			if (App::archiveManager().archiveIndex(archive) >= 0)
+				entry = theResourceManager->getPatchEntry(p.name, "patches", archive);
+			else
+			{
+				// Archive isn't open in the resource manager (eg. batch mode),
+				// so look for it directly
+				Archive::SearchOptions popt;
+				popt.match_name = p.name;
+				popt.match_namespace = "patches";
+				entry = archive->findLast(popt);
+			}
 			if (entry && entry->getParent() == archive)
 				to_remove.push_back(entry);
 
@@ -140,7 +152,8 @@ bool ArchiveOperations::removeUnusedPatches(Archive* archive)
 		delete tx_lists[a];
 
 	// Notify user
-	wxMessageBox(S_FMT("Removed %d patches and %lu entries. See console log for details.", removed, to_remove.size()), "Removed Unused Patches", wxOK|wxICON_INFORMATION);
+	if (interactive)
+		wxMessageBox(S_FMT("Removed %d patches and %lu entries. See console log for details.", removed, to_remove.size()), "Removed Unused Patches", wxOK|wxICON_INFORMATION);
 
 	return true;
 }
@@ -427,11 +440,11 @@ struct texused_t
 	texused_t() { used = false; }
 };
 WX_DECLARE_STRING_HASH_MAP(texused_t, TexUsedMap);
-void ArchiveOperations::removeUnusedTextures(Archive* archive)
+int ArchiveOperations::removeUnusedTextures(Archive* archive, bool interactive)
 {
 	// Check archive was given
 	if (!archive)
-		return;
+		return 0;
 
 	// --- Build list of used textures ---
 	TexUsedMap used_textures;
@@ -511,7 +524,7 @@ void ArchiveOperations::removeUnusedTextures(Archive* archive)
 
 	// Check if any maps were found
 	if (total_maps == 0)
-		return;
+		return 0;
 
 	// Find all TEXTUREx entries
 	opt.match_name = "";
@@ -560,9 +573,6 @@ void ArchiveOperations::removeUnusedTextures(Archive* archive)
 		}
 	}
 
-	// Pop up a dialog with a checkbox list of unused textures
-	wxMultiChoiceDialog dialog(theMainWindow, "The following textures are not used in any map,\nselect which textures to delete", "Delete Unused Textures", unused_tex);
-
 	// Get base resource textures (if any)
 	Archive* base_resource = App::archiveManager().baseResourceArchive();
 	vector<ArchiveEntry*> base_tx_entries;
@@ -619,14 +629,24 @@ void ArchiveOperations::removeUnusedTextures(Archive* archive)
 		if (!swtex && !br_tex)
 			selection.Add(a);
 	}
-	dialog.SetSelections(selection);
 
-	int n_removed = 0;
-	if (dialog.ShowModal() == wxID_OK)
+	// Pop up a dialog with a checkbox list of unused textures (if interactive,
+	// otherwise just remove the initially checked ones)
+	bool do_remove = true;
+	if (interactive)
 	{
+		wxMultiChoiceDialog dialog(theMainWindow, "The following textures are not used in any map,\nselect which textures to delete", "Delete Unused Textures", unused_tex);
+		dialog.SetSelections(selection);
+		do_remove = (dialog.ShowModal() == wxID_OK);
+
 		// Get selected textures
-		selection = dialog.GetSelections();
+		if (do_remove)
+			selection = dialog.GetSelections();
+	}
 
+	int n_removed = 0;
+	if (do_remove)
+	{
 		// Go through texture lists
 		for (unsigned a = 0; a < tx_entries.size(); a++)
 		{
@@ -652,14 +672,17 @@ void ArchiveOperations::removeUnusedTextures(Archive* archive)
 		}
 	}
 
-	wxMessageBox(S_FMT("Removed %d unused textures", n_removed));
+	if (interactive)
+		wxMessageBox(S_FMT("Removed %d unused textures", n_removed));
+
+	return n_removed;
 }
 
-void ArchiveOperations::removeUnusedFlats(Archive* archive)
+int ArchiveOperations::removeUnusedFlats(Archive* archive, bool interactive)
 {
 	// Check archive was given
 	if (!archive)
-		return;
+		return 0;
 
 	// --- Build list of used flats ---
 	TexUsedMap used_textures;
@@ -737,7 +760,7 @@ void ArchiveOperations::removeUnusedFlats(Archive* archive)
 
 	// Check if any maps were found
 	if (total_maps == 0)
-		return;
+		return 0;
 
 	// Find all flats
 	opt.match_name = "";
@@ -784,20 +807,29 @@ void ArchiveOperations::removeUnusedFlats(Archive* archive)
 			unused_tex.Add(flatname);
 	}
 
-	// Pop up a dialog with a checkbox list of unused textures
-	wxMultiChoiceDialog dialog(theMainWindow, "The following textures are not used in any map,\nselect which textures to delete", "Delete Unused Textures", unused_tex);
-
 	// Select all flats initially
 	wxArrayInt selection;
 	for (unsigned a = 0; a < unused_tex.size(); a++)
 		selection.push_back(a);
-	dialog.SetSelections(selection);
+
+	// Pop up a dialog with a checkbox list of unused flats (if interactive,
+	// otherwise just remove them all)
+	bool do_remove = true;
+	if (interactive)
+	{
+		wxMultiChoiceDialog dialog(theMainWindow, "The following textures are not used in any map,\nselect which textures to delete", "Delete Unused Textures", unused_tex);
+		dialog.SetSelections(selection);
+		do_remove = (dialog.ShowModal() == wxID_OK);
+
+		// Get selected flats
+		if (do_remove)
+			selection = dialog.GetSelections();
+	}
 
 	int n_removed = 0;
-	if (dialog.ShowModal() == wxID_OK)
+	if (do_remove)
 	{
 		// Go through selected flats
-		selection = dialog.GetSelections();
 		opt.match_namespace = "flats";
 		for (unsigned a = 0; a < selection.size(); a++)
 		{
@@ -808,7 +840,10 @@ void ArchiveOperations::removeUnusedFlats(Archive* archive)
 		}
 	}
 
-	wxMessageBox(S_FMT("Removed %d unused flats", n_removed));
+	if (interactive)
+		wxMessageBox(S_FMT("Removed %d unused flats", n_removed));
+
+	return n_removed;
 }
 
 
@@ -6,11 +6,11 @@
 
 namespace ArchiveOperations
 {
-	bool	removeUnusedPatches(Archive* archive);
+	bool	removeUnusedPatches(Archive* archive, bool interactive = true);
 	bool	checkDuplicateEntryNames(Archive* archive);
 	bool	checkDuplicateEntryContent(Archive* archive);
-	void	removeUnusedTextures(Archive* archive);
-	void	removeUnusedFlats(Archive* archive);
+	int		removeUnusedTextures(Archive* archive, bool interactive = true);
+	int		removeUnusedFlats(Archive* archive, bool interactive = true);
 	void	removeEntriesUnchangedFromIWAD(Archive* archive);
 
 	// Search and replace in maps
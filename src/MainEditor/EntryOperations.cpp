@@ -147,7 +147,12 @@ bool EntryOperations::gfxConvert(ArchiveEntry* entry, string target_format, SIFo
 		image.convertRGBA(opt.pal_current);
 
 	// Finally, write new image data back to the entry
-	fmt->saveImage(image, entry->getMCData(), opt.pal_target);
+	MemChunk mc;
+	if (!fmt->saveImage(image, mc, opt.pal_target))
+		return false;
+	entry->importMemChunk(mc);
+	EntryType::detectEntryType(entry);
+	entry->setExtensionByType();
 
 	return true;
 }
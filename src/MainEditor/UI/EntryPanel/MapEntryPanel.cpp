@@ -92,6 +92,7 @@ MapEntryPanel::MapEntryPanel(wxWindow* parent) : EntryPanel(parent, "map")
 
 	// Bind events
 	cb_show_things_->Bind(wxEVT_CHECKBOX, &MapEntryPanel::onCBShowThings, this);
+	map_canvas_->Bind(wxEVT_MAPPREVIEW_LOADED, &MapEntryPanel::onMapLoaded, this);
 
 	// Layout
 	Layout();
@@ -134,20 +135,13 @@ bool MapEntryPanel::loadEntry(ArchiveEntry* entry)
 		return false;
 	}
 
-	// Load map into preview canvas
-	if (map_canvas_->openMap(thismap))
+	// Load map into preview canvas (in the background if it isn't cached)
+	if (map_canvas_->openMap(thismap, true))
 	{
-		label_stats_->SetLabel(
-			S_FMT(
-				"Vertices: %d, Sides: %d, Lines: %d, Sectors: %d, Things: %d, Total Size: %dx%d",
-				map_canvas_->nVertices(),
-				map_canvas_->nSides(),
-				map_canvas_->nLines(),
-				map_canvas_->nSectors(),
-				map_canvas_->nThings(),
-				map_canvas_->getWidth(),
-				map_canvas_->getHeight()
-		));
+		if (map_canvas_->isLoading())
+			label_stats_->SetLabel("Loading...");
+		else
+			updateStats();
 		return true;
 	}
 
@@ -155,6 +149,26 @@ bool MapEntryPanel::loadEntry(ArchiveEntry* entry)
 	return false;
 }
 
+// ----------------------------------------------------------------------------
+// MapEntryPanel::updateStats
+//
+// Updates the map stats label from the loaded map preview
+// ----------------------------------------------------------------------------
+void MapEntryPanel::updateStats()
+{
+	label_stats_->SetLabel(
+		S_FMT(
+			"Vertices: %d, Sides: %d, Lines: %d, Sectors: %d, Things: %d, Total Size: %dx%d",
+			map_canvas_->nVertices(),
+			map_canvas_->nSides(),
+			map_canvas_->nLines(),
+			map_canvas_->nSectors(),
+			map_canvas_->nThings(),
+			map_canvas_->getWidth(),
+			map_canvas_->getHeight()
+	));
+}
+
 // ----------------------------------------------------------------------------
 // MapEntryPanel::saveEntry
 //
@@ -248,3 +262,16 @@ void MapEntryPanel::onCBShowThings(wxCommandEvent& e)
 	map_view_things = cb_show_things_->GetValue();
 	map_canvas_->Refresh();
 }
+
+// ----------------------------------------------------------------------------
+// MapEntryPanel::onMapLoaded
+//
+// Called when the map preview has finished loading in the background
+// ----------------------------------------------------------------------------
+void MapEntryPanel::onMapLoaded(wxEvent& e)
+{
+	if (((wxCommandEvent&)e).GetInt())
+		updateStats();
+	else
+		label_stats_->SetLabel("Invalid map");
+}
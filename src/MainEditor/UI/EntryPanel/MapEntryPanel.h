@@ -21,5 +21,8 @@ private:
 	wxCheckBox*			cb_show_things_	= nullptr;
 	wxStaticText*		label_stats_	= nullptr;
 
+	void	updateStats();
+
 	void	onCBShowThings(wxCommandEvent& e);
+	void	onMapLoaded(wxEvent& e);
 };
@@ -105,6 +105,24 @@ bool PatchBrowserItem::loadImage()
 	return image_->loadImage(&img, parent_->getPalette());
 }
 
+// ----------------------------------------------------------------------------
+// PatchBrowserItem::requestThumbnail
+//
+// Requests a background-generated thumbnail of the item's patch entry.
+// Textures are composited from multiple patches so are always loaded directly
+// ----------------------------------------------------------------------------
+ThumbnailCache::RequestPtr PatchBrowserItem::requestThumbnail(int max_size)
+{
+	if (type_ != 0)
+		return nullptr;
+
+	return ThumbnailCache::request(
+		theResourceManager->getPatchEntry(name_, nspace_, archive_),
+		parent_->getPalette(),
+		max_size
+	);
+}
+
 // ----------------------------------------------------------------------------
 // PatchBrowserItem::itemInfo
 //
@@ -115,8 +133,10 @@ string PatchBrowserItem::itemInfo()
 	string info;
 
 	// Add dimensions if known
-	if (image_)
+	if (image_ && image_->isLoaded())
 		info += S_FMT("%dx%d", image_->getWidth(), image_->getHeight());
+	else if (thumb_ && thumb_->isLoaded())
+		info += S_FMT("%dx%d", thumb_width_, thumb_height_);
 	else
 		info += "Unknown size";
 
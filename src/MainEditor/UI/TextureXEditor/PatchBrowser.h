@@ -23,8 +23,9 @@ public:
 
 	~PatchBrowserItem();
 
-	bool	loadImage() override;
-	string	itemInfo() override;
+	bool						loadImage() override;
+	ThumbnailCache::RequestPtr	requestThumbnail(int max_size) override;
+	string						itemInfo() override;
 
 private:
 	Archive*	archive_;
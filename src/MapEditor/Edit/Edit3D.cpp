@@ -34,11 +34,26 @@
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapTextureManager.h"
 #include "MapEditor/UndoSteps.h"
+#include "MapTraversal.h"
 #include "Utility/MathStuff.h"
 
 using MapEditor::ItemType;
 
 
+/*******************************************************************
+ * FUNCTIONS
+ *******************************************************************/
+
+/* wallKey
+ * Returns a unique key for wall [item] (side index + part), for use
+ * with MapTraversal
+ *******************************************************************/
+static unsigned wallKey(const MapEditor::Item& item)
+{
+	return item.index * 3 + ((int)item.type - (int)ItemType::WallTop);
+}
+
+
 /*******************************************************************
  * EDIT3D CLASS FUNCTIONS
  *******************************************************************/
@@ -454,14 +469,11 @@ void Edit3D::autoAlignX(MapEditor::Item start) const
 	if (gl_tex)
 		tex_width = gl_tex->getWidth();
 
-	// Init aligned wall list
-	vector<MapEditor::Item> walls_done;
-
 	// Begin undo level
 	context_.beginUndoRecord("Auto Align X", true, false, false);
 
 	// Do alignment
-	doAlignX(side, side->intProperty("offsetx"), tex, walls_done, tex_width);
+	doAlignX(context_.map(), side, side->intProperty("offsetx"), tex, tex_width);
 
 	// End undo level
 	context_.endUndoRecord();
@@ -912,20 +924,37 @@ void Edit3D::floodFill(CopyType type)
 	// Restrict floodfill to selection, if any
 	if (selection.size() > 0)
 	{
-		for (auto i = items.begin(); i < items.end(); ++i)
+		// Mark selected walls and flats
+		auto& map = context_.map();
+		vector<bool> selected_walls(map.nSides() * 3, false);
+		vector<bool> selected_flats(map.nSectors() * 2, false);
+		for (unsigned a = 0; a < selection.size(); a++)
 		{
-			bool found = false;
-			for (unsigned a = 0; a < selection.size(); a++)
+			auto& item = selection[a];
+			if (item.index < 0)
+				continue;
+
+			if (item.type == ItemType::WallTop ||
+				item.type == ItemType::WallMiddle ||
+				item.type == ItemType::WallBottom)
 			{
-				if (selection[a].type == i->type && selection[a].index == i->index)
-				{
-					found = true;
-					break;
-				}
+				if ((unsigned)item.index < map.nSides())
+					selected_walls[wallKey(item)] = true;
+			}
+			else if (item.type == ItemType::Floor || item.type == ItemType::Ceiling)
+			{
+				if ((unsigned)item.index < map.nSectors())
+					selected_flats[item.index * 2 + (item.type == ItemType::Ceiling ? 1 : 0)] = true;
 			}
-			if (!found)
-				items.erase(i);
 		}
+
+		// Remove any unselected items
+		items.erase(std::remove_if(items.begin(), items.end(), [&](const MapEditor::Item& item)
+		{
+			if (item.type == ItemType::Floor || item.type == ItemType::Ceiling)
+				return !selected_flats[item.index * 2 + (item.type == ItemType::Ceiling ? 1 : 0)];
+			return !selected_walls[wallKey(item)];
+		}), items.end());
 	}
 
 	// Begin undo step
@@ -1436,23 +1465,15 @@ bool Edit3D::wallMatches(MapSide* side, ItemType part, string tex)
  *******************************************************************/
 void Edit3D::getAdjacentWalls(MapEditor::Item item, vector<MapEditor::Item>& list) const
 {
-	// Add item to list if needed
-	for (unsigned a = 0; a < list.size(); a++)
-	{
-		if (list[a].type == item.type && list[a].index == item.index)
-			return;
-	}
-	list.push_back(item);
+	auto& map = context_.map();
 
 	// Get initial side
-	auto side = context_.map().getSide(item.index);
+	auto side = map.getSide(item.index);
 	if (!side)
+	{
+		list.push_back(item);
 		return;
-
-	// Get initial line
-	auto line = side->getParentLine();
-	if (!line)
-		return;
+	}
 
 	// Get texture to match
 	string tex;
@@ -1463,92 +1484,49 @@ void Edit3D::getAdjacentWalls(MapEditor::Item item, vector<MapEditor::Item>& lis
 	else
 		tex = side->stringProperty("texturetop");
 
-	// Go through attached lines (vertex 1)
-	for (unsigned a = 0; a < line->v1()->nConnectedLines(); a++)
+	// Go through connected walls
+	MapTraversal<MapEditor::Item> traversal(map.nSides() * 3);
+	vector<MapEditor::Item> adjacent;
+	traversal.push(item);
+	while (traversal.next(item))
 	{
-		auto oline = line->v1()->connectedLine(a);
-		if (!oline || oline == line)
+		// Skip if already listed
+		if (!traversal.visit(wallKey(item)))
 			continue;
+		list.push_back(item);
 
-		// Get line sides
-		auto side1 = oline->s1();
-		auto side2 = oline->s2();
-
-		// Front side
-		if (side1)
-		{
-			// Upper texture
-			if (wallMatches(side1, ItemType::WallTop, tex))
-				getAdjacentWalls({ (int)side1->getIndex(), ItemType::WallTop }, list);
-
-			// Middle texture
-			if (wallMatches(side1, ItemType::WallMiddle, tex))
-				getAdjacentWalls({ (int)side1->getIndex(), ItemType::WallMiddle }, list);
-
-			// Lower texture
-			if (wallMatches(side1, ItemType::WallBottom, tex))
-				getAdjacentWalls({ (int)side1->getIndex(), ItemType::WallBottom }, list);
-		}
-
-		// Back side
-		if (side2)
-		{
-			// Upper texture
-			if (wallMatches(side2, ItemType::WallTop, tex))
-				getAdjacentWalls({ (int)side2->getIndex(), ItemType::WallTop }, list);
-
-			// Middle texture
-			if (wallMatches(side2, ItemType::WallMiddle, tex))
-				getAdjacentWalls({ (int)side2->getIndex(), ItemType::WallMiddle }, list);
-
-			// Lower texture
-			if (wallMatches(side2, ItemType::WallBottom, tex))
-				getAdjacentWalls({ (int)side2->getIndex(), ItemType::WallBottom }, list);
-		}
-	}
-
-	// Go through attached lines (vertex 2)
-	for (unsigned a = 0; a < line->v2()->nConnectedLines(); a++)
-	{
-		auto oline = line->v2()->connectedLine(a);
-		if (!oline || oline == line)
+		// Get line
+		auto line = map.getSide(item.index)->getParentLine();
+		if (!line)
 			continue;
 
-		// Get line sides
-		auto side1 = oline->s1();
-		auto side2 = oline->s2();
-
-		// Front side
-		if (side1)
+		// Go through attached lines (vertex 1 then vertex 2)
+		adjacent.clear();
+		for (auto vertex : { line->v1(), line->v2() })
 		{
-			// Upper texture
-			if (wallMatches(side1, ItemType::WallTop, tex))
-				getAdjacentWalls({ (int)side1->getIndex(), ItemType::WallTop }, list);
+			for (unsigned a = 0; a < vertex->nConnectedLines(); a++)
+			{
+				auto oline = vertex->connectedLine(a);
+				if (!oline || oline == line)
+					continue;
 
-			// Middle texture
-			if (wallMatches(side1, ItemType::WallMiddle, tex))
-				getAdjacentWalls({ (int)side1->getIndex(), ItemType::WallMiddle }, list);
+				// Check front and back side textures
+				for (auto oside : { oline->s1(), oline->s2() })
+				{
+					if (!oside)
+						continue;
 
-			// Lower texture
-			if (wallMatches(side1, ItemType::WallBottom, tex))
-				getAdjacentWalls({ (int)side1->getIndex(), ItemType::WallBottom }, list);
+					for (auto part : { ItemType::WallTop, ItemType::WallMiddle, ItemType::WallBottom })
+						if (wallMatches(oside, part, tex))
+							adjacent.push_back({ (int)oside->getIndex(), part });
+				}
+			}
 		}
 
-		// Back side
-		if (side2)
-		{
-			// Upper texture
-			if (wallMatches(side2, ItemType::WallTop, tex))
-				getAdjacentWalls({ (int)side2->getIndex(), ItemType::WallTop }, list);
-
-			// Middle texture
-			if (wallMatches(side2, ItemType::WallMiddle, tex))
-				getAdjacentWalls({ (int)side2->getIndex(), ItemType::WallMiddle }, list);
-
-			// Lower texture
-			if (wallMatches(side2, ItemType::WallBottom, tex))
-				getAdjacentWalls({ (int)side2->getIndex(), ItemType::WallBottom }, list);
-		}
+		// Add to work stack (reversed so they are processed in order)
+		for (auto i = adjacent.rbegin(); i != adjacent.rend(); ++i)
+			if (!traversal.visited(wallKey(*i)))
+				traversal.push(*i);
 	}
 }
 
@@ -1562,139 +1540,147 @@ void Edit3D::getAdjacentFlats(MapEditor::Item item, vector<MapEditor::Item>& lis
 	if (item.index < 0 || (item.type != ItemType::Floor && item.type != ItemType::Ceiling))
 		return;
 
-	// Add item
-	list.push_back(item);
-
-	// Get initial sector
-	auto sector = context_.map().getSector(item.index);
-	if (!sector) return;
-
-	// Go through sector lines
+	// Go through connected sectors
+	auto& map = context_.map();
+	MapTraversal<int> traversal(map.nSectors());
 	vector<MapLine*> lines;
-	sector->getLines(lines);
-	for (auto& line : lines)
+	vector<int> adjacent;
+	int index;
+	traversal.push(item.index);
+	while (traversal.next(index))
 	{
-		// Get sector on opposite side
-		auto osector = (line->frontSector() == sector) ? line->backSector() : line->frontSector();
+		// Skip if already listed
+		if (!traversal.visit(index))
+			continue;
+
+		// Add item
+		list.push_back({ index, item.type });
 
-		// Skip if no sector
-		if (!osector || osector == sector)
+		// Get sector
+		auto sector = map.getSector(index);
+		if (!sector)
 			continue;
 
-		// Check for match
-		plane_t this_plane, other_plane;
-		if (item.type == ItemType::Floor)
+		// Go through sector lines
+		lines.clear();
+		adjacent.clear();
+		sector->getLines(lines);
+		for (auto& line : lines)
 		{
-			// Check sector floor texture
-			if (osector->getFloorTex() != sector->getFloorTex())
-				continue;
+			// Get sector on opposite side
+			auto osector = (line->frontSector() == sector) ? line->backSector() : line->frontSector();
 
-			this_plane = sector->getFloorPlane();
-			other_plane = osector->getFloorPlane();
-		}
-		else
-		{
-			// Check sector ceiling texture
-			if (osector->getCeilingTex() != sector->getCeilingTex())
+			// Skip if no sector
+			if (!osector || osector == sector)
 				continue;
 
-			this_plane = sector->getCeilingPlane();
-			other_plane = osector->getCeilingPlane();
-		}
+			// Check for match
+			plane_t this_plane, other_plane;
+			if (item.type == ItemType::Floor)
+			{
+				// Check sector floor texture
+				if (osector->getFloorTex() != sector->getFloorTex())
+					continue;
 
-		// Check that planes meet
-		auto left = line->v1()->getPoint(0);
-		auto right = line->v2()->getPoint(0);
+				this_plane = sector->getFloorPlane();
+				other_plane = osector->getFloorPlane();
+			}
+			else
+			{
+				// Check sector ceiling texture
+				if (osector->getCeilingTex() != sector->getCeilingTex())
+					continue;
 
-		double this_left_z = this_plane.height_at(left);
-		double other_left_z = other_plane.height_at(left);
-		if (fabs(this_left_z - other_left_z) > 1)
-			continue;
+				this_plane = sector->getCeilingPlane();
+				other_plane = osector->getCeilingPlane();
+			}
 
-		double this_right_z = this_plane.height_at(right);
-		double other_right_z = other_plane.height_at(right);
-		if (fabs(this_right_z - other_right_z) > 1)
-			continue;
+			// Check that planes meet
+			auto left = line->v1()->getPoint(0);
+			auto right = line->v2()->getPoint(0);
 
-		// Check flat isn't already listed
-		bool listed = false;
-		for (auto& i : list)
-		{
-			if (i.type == item.type && i.index == osector->getIndex())
-			{
-				listed = true;
-				break;
-			}
-		}
+			double this_left_z = this_plane.height_at(left);
+			double other_left_z = other_plane.height_at(left);
+			if (fabs(this_left_z - other_left_z) > 1)
+				continue;
 
-		// Recursively list adjacent flats
-		if (!listed)
-		{
-			list.push_back(item);
-			getAdjacentFlats({ (int)osector->getIndex(), item.type }, list);
+			double this_right_z = this_plane.height_at(right);
+			double other_right_z = other_plane.height_at(right);
+			if (fabs(this_right_z - other_right_z) > 1)
+				continue;
+
+			adjacent.push_back(osector->getIndex());
 		}
+
+		// Add to work stack (reversed so they are processed in order)
+		for (auto i = adjacent.rbegin(); i != adjacent.rend(); ++i)
+			if (!traversal.visited(*i))
+				traversal.push(*i);
 	}
 }
 
 /* Edit3D::doAlignX
- * Recursive function to align textures on the x axis
+ * Aligns textures on the x axis, beginning at [side] with [offset]
+ * and continuing along connected walls matching [tex]
  *******************************************************************/
-void Edit3D::doAlignX(MapSide* side, int offset, string tex, vector<MapEditor::Item>& walls_done, int tex_width)
+void Edit3D::doAlignX(SLADEMap& map, MapSide* side, int offset, const string& tex, int tex_width)
 {
-	// Check if this wall has already been processed
-	for (unsigned a = 0; a < walls_done.size(); a++)
+	struct AlignItem
 	{
-		if (walls_done[a].index == side->getIndex())
-			return;
-	}
-
-	// Add to 'done' list
-	walls_done.push_back({ (int)side->getIndex(), ItemType::WallMiddle });
-
-	// Wrap offset
-	if (tex_width > 0)
+		MapSide*	side;
+		int			offset;
+	};
+
+	MapTraversal<AlignItem> traversal(map.nSides());
+	vector<MapSide*> next;
+	AlignItem item;
+	traversal.push({ side, offset });
+	while (traversal.next(item))
 	{
-		while (offset >= tex_width)
-			offset -= tex_width;
-	}
+		// Check if this wall has already been processed
+		side = item.side;
+		if (!traversal.visit(side->getIndex()))
+			continue;
 
-	// Set offset
-	side->setIntProperty("offsetx", offset);
+		// Wrap offset
+		offset = item.offset;
+		if (tex_width > 0)
+		{
+			while (offset >= tex_width)
+				offset -= tex_width;
+		}
 
-	// Get 'next' vertex
-	auto line = side->getParentLine();
-	auto vertex = line->v2();
-	if (side == line->s2())
-		vertex = line->v1();
+		// Set offset
+		side->setIntProperty("offsetx", offset);
 
-	// Get integral length of line
-	int intlen = MathStuff::round(line->getLength());
+		// Get 'next' vertex
+		auto line = side->getParentLine();
+		auto vertex = line->v2();
+		if (side == line->s2())
+			vertex = line->v1();
 
-	// Go through connected lines
-	for (unsigned a = 0; a < vertex->nConnectedLines(); a++)
-	{
-		auto l = vertex->connectedLine(a);
+		// Get integral length of line
+		int intlen = MathStuff::round(line->getLength());
 
-		// First side
-		auto s = l->s1();
-		if (s)
+		// Go through connected lines
+		next.clear();
+		for (unsigned a = 0; a < vertex->nConnectedLines(); a++)
 		{
-			// Check for matching texture
-			if (s->stringProperty("texturetop") == tex ||
-				s->stringProperty("texturemiddle") == tex ||
-				s->stringProperty("texturebottom") == tex)
-				doAlignX(s, offset + intlen, tex, walls_done, tex_width);
-		}
+			auto l = vertex->connectedLine(a);
 
-		// Second side
-		s = l->s2();
-		if (s)
-		{
-			// Check for matching texture
-			if (s->stringProperty("texturetop") == tex ||
-				s->stringProperty("texturemiddle") == tex ||
-				s->stringProperty("texturebottom") == tex)
-				doAlignX(s, offset + intlen, tex, walls_done, tex_width);
+			// Check first and second sides for matching texture
+			for (auto s : { l->s1(), l->s2() })
+			{
+				if (s && (s->stringProperty("texturetop") == tex ||
+					s->stringProperty("texturemiddle") == tex ||
+					s->stringProperty("texturebottom") == tex))
+					next.push_back(s);
+			}
 		}
+
+		// Add to work stack (reversed so they are processed in order)
+		for (auto i = next.rbegin(); i != next.rend(); ++i)
+			if (!traversal.visited((*i)->getIndex()))
+				traversal.push({ *i, offset + intlen });
 	}
 }
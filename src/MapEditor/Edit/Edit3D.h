@@ -5,6 +5,7 @@
 
 class MapEditContext;
 class MapSide;
+class SLADEMap;
 class UndoManager;
 
 class Edit3D
@@ -60,5 +61,5 @@ private:
 	void		getAdjacentFlats(MapEditor::Item item, vector<MapEditor::Item>& list) const;
 
 	// Helper for autoAlignX3d
-	static void doAlignX(MapSide* side, int offset, string tex, vector<MapEditor::Item>& walls_done, int tex_width);
+	static void doAlignX(SLADEMap& map, MapSide* side, int offset, const string& tex, int tex_width);
 };
@@ -0,0 +1,50 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// Helper for walking connected map objects (eg. adjacent walls or flats)
+// without recursion. Items to process are kept on an explicit work stack, and
+// a dense visited bitset indexed by [key] (eg. side or sector index) is used
+// to check if an object has already been processed.
+//
+// Items are processed depth-first: if the children of an item are pushed in
+// reverse order, they will be processed in the same order as the equivalent
+// recursive function would process them
+// -----------------------------------------------------------------------------
+template<typename T> class MapTraversal
+{
+public:
+	explicit MapTraversal(unsigned n_keys) : visited_(n_keys, false) {}
+
+	bool	empty() const { return stack_.empty(); }
+	void	push(const T& item) { stack_.push_back(item); }
+
+	// Removes the next item to process from the stack and writes it to [item].
+	// Returns false if there are no items left
+	bool next(T& item)
+	{
+		if (stack_.empty())
+			return false;
+
+		item = stack_.back();
+		stack_.pop_back();
+		return true;
+	}
+
+	// Returns true if [key] has been visited
+	bool visited(unsigned key) const { return key < visited_.size() && visited_[key]; }
+
+	// Marks [key] as visited. Returns false if it was already visited (or is
+	// out of range)
+	bool visit(unsigned key)
+	{
+		if (key >= visited_.size() || visited_[key])
+			return false;
+
+		visited_[key] = true;
+		return true;
+	}
+
+private:
+	vector<T>		stack_;
+	vector<bool>	visited_;
+};
@@ -546,6 +546,33 @@ public:
 		// Clear existing intersections
 		intersections.clear();
 
+		// Get line bounding boxes
+		const MapArrays& arr = map_->arrays();
+		vector<double> left(lines.size()), right(lines.size()), top(lines.size()), bottom(lines.size());
+		for (unsigned a = 0; a < lines.size(); a++)
+		{
+			// Use the line itself if it's no longer in the map
+			unsigned index = lines[a]->getIndex();
+			if (map_->getLine(index) != lines[a])
+			{
+				fseg2_t seg = lines[a]->seg();
+				left[a] = seg.left();
+				right[a] = seg.right();
+				top[a] = seg.top();
+				bottom[a] = seg.bottom();
+				continue;
+			}
+
+			double x1 = arr.vertex_x[arr.line_v1[index]];
+			double y1 = arr.vertex_y[arr.line_v1[index]];
+			double x2 = arr.vertex_x[arr.line_v2[index]];
+			double y2 = arr.vertex_y[arr.line_v2[index]];
+			left[a] = MIN(x1, x2);
+			right[a] = MAX(x1, x2);
+			top[a] = MIN(y1, y2);
+			bottom[a] = MAX(y1, y2);
+		}
+
 		// Go through lines
 		for (unsigned a = 0; a < lines.size(); a++)
 		{
@@ -554,6 +581,10 @@ public:
 			// Go through uncompared lines
 			for (unsigned b = a + 1; b < lines.size(); b++)
 			{
+				// Lines can't intersect if their bounding boxes don't overlap
+				if (right[b] < left[a] || left[b] > right[a] || bottom[b] < top[a] || top[b] > bottom[a])
+					continue;
+
 				line2 = lines[b];
 
 				// Check intersection
@@ -688,19 +719,19 @@ public:
 	void doCheck() override
 	{
 		// Go through lines
-		for (unsigned a = 0; a < map_->nLines(); a++)
+		const MapArrays& arr = map_->arrays();
+		for (unsigned a = 0; a < arr.line_v1.size(); a++)
 		{
-			MapLine* line1 = map_->getLine(a);
+			int l1v1 = arr.line_v1[a];
+			int l1v2 = arr.line_v2[a];
 
 			// Go through uncompared lines
-			for (unsigned b = a + 1; b < map_->nLines(); b++)
+			for (unsigned b = a + 1; b < arr.line_v1.size(); b++)
 			{
-				MapLine* line2 = map_->getLine(b);
-
 				// Check for overlap (both vertices shared)
-				if ((line1->v1() == line2->v1() && line1->v2() == line2->v2()) ||
-					(line1->v2() == line2->v1() && line1->v1() == line2->v2()))
-					overlaps.push_back(line_overlap_t(line1, line2));
+				if ((l1v1 == arr.line_v1[b] && l1v2 == arr.line_v2[b]) ||
+					(l1v2 == arr.line_v1[b] && l1v1 == arr.line_v2[b]))
+					overlaps.push_back(line_overlap_t(map_->getLine(a), map_->getLine(b)));
 			}
 		}
 	}
@@ -803,6 +834,25 @@ public:
 	{
 		double r1, r2;
 
+		int map_format = map_->currentFormat();
+		bool udmf_zdoom = (map_format == MAP_UDMF && S_CMPNOCASE(Game::configuration().udmfNamespace(), "zdoom"));
+		bool udmf_eternity = (map_format == MAP_UDMF && S_CMPNOCASE(Game::configuration().udmfNamespace(), "eternity"));
+		int min_skill = udmf_zdoom || udmf_eternity ? 1 : 2;
+		int max_skill = udmf_zdoom ? 17 : 5;
+		int max_class = udmf_zdoom ? 17 : 4;
+
+		// Resolve flags to check up front
+		using FlagHandle = Game::Configuration::FlagHandle;
+		vector<FlagHandle> flag_skill(max_skill);
+		vector<FlagHandle> flag_class(max_class);
+		for (int s = min_skill; s < max_skill; ++s)
+			flag_skill[s] = Game::configuration().thingFlagHandle(S_FMT("skill%d", s), map_format);
+		for (int c = 1; c < max_class; ++c)
+			flag_class[c] = Game::configuration().thingFlagHandle(S_FMT("class%d", c), map_format);
+		FlagHandle flag_single = Game::configuration().thingFlagHandle("single", map_format);
+		FlagHandle flag_coop = Game::configuration().thingFlagHandle("coop", map_format);
+		FlagHandle flag_dm = Game::configuration().thingFlagHandle("dm", map_format);
+
 		// Go through things
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
@@ -815,13 +865,6 @@ public:
 				continue;
 
 			// Go through uncompared things
-			int map_format = map_->currentFormat();
-			bool udmf_zdoom = (map_format == MAP_UDMF && S_CMPNOCASE(Game::configuration().udmfNamespace(), "zdoom"));
-			bool udmf_eternity = (map_format == MAP_UDMF && S_CMPNOCASE(Game::configuration().udmfNamespace(), "eternity"));
-			int min_skill = udmf_zdoom || udmf_eternity ? 1 : 2;
-			int max_skill = udmf_zdoom ? 17 : 5;
-			int max_class = udmf_zdoom ? 17 : 4;
-
 			for (unsigned b = a + 1; b < map_->nThings(); b++)
 			{
 				MapThing* thing2 = map_->getThing(b);
@@ -837,9 +880,7 @@ public:
 				bool shareflag = false;
 				for (int s = min_skill; s < max_skill; ++s)
 				{
-					string skill = S_FMT("skill%d", s);
-					if (Game::configuration().thingBasicFlagSet(skill, thing1, map_format) && 
-						Game::configuration().thingBasicFlagSet(skill, thing2, map_format))
+					if (flag_skill[s].isSet(thing1) && flag_skill[s].isSet(thing2))
 					{
 						shareflag = true;
 						s = max_skill;
@@ -850,12 +891,12 @@ public:
 
 				// Booleans for single, coop, deathmatch, and teamgame status for each thing
 				bool s1, s2, c1, c2, d1, d2, t1, t2;
-				s1 = Game::configuration().thingBasicFlagSet("single", thing1, map_format);
-				s2 = Game::configuration().thingBasicFlagSet("single", thing2, map_format);
-				c1 = Game::configuration().thingBasicFlagSet("coop", thing1, map_format);
-				c2 = Game::configuration().thingBasicFlagSet("coop", thing2, map_format);
-				d1 = Game::configuration().thingBasicFlagSet("dm", thing1, map_format);
-				d2 = Game::configuration().thingBasicFlagSet("dm", thing2, map_format);
+				s1 = flag_single.isSet(thing1);
+				s2 = flag_single.isSet(thing2);
+				c1 = flag_coop.isSet(thing1);
+				c2 = flag_coop.isSet(thing2);
+				d1 = flag_dm.isSet(thing1);
+				d2 = flag_dm.isSet(thing2);
 
 				// Player starts
 				// P1 are automatically S and C; P2+ are automatically C;
@@ -902,9 +943,7 @@ public:
 					// Case #3: things flagged for single player with different class filters
 					for (int c = 1; c < max_class; ++c)
 					{
-						string pclass = S_FMT("class%d", c);
-						if (Game::configuration().thingBasicFlagSet(pclass, thing1, map_format) && 
-							Game::configuration().thingBasicFlagSet(pclass, thing2, map_format))
+						if (flag_class[c].isSet(thing1) && flag_class[c].isSet(thing2))
 						{
 							shareflag = true;
 							c = max_class;
@@ -1432,12 +1471,13 @@ public:
 		// Get list of lines to check
 		vector<MapLine*> check_lines;
 		MapLine* line;
+		auto flag_blocking = Game::configuration().lineFlagHandle("blocking", map_->currentFormat());
 		for (unsigned a = 0; a < map_->nLines(); a++)
 		{
 			line = map_->getLine(a);
 
 			// Skip if line is 2-sided and not blocking
-			if (line->s2() && !Game::configuration().lineBasicFlagSet("blocking", line, map_->currentFormat()))
+			if (line->s2() && !flag_blocking.isSet(line))
 				continue;
 
 			check_lines.push_back(line);
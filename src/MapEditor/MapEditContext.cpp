@@ -33,10 +33,12 @@
 // ----------------------------------------------------------------------------
 #include "Main.h"
 #include "App.h"
+#include "Archive/Formats/WadArchive.h"
 #include "Game/Configuration.h"
 #include "General/Clipboard.h"
 #include "General/Console/Console.h"
 #include "General/UndoRedo.h"
+#include "Graphics/SImage/SImageKernels.h"
 #include "MapChecks.h"
 #include "MapEditContext.h"
 #include "MapEditor/Renderer/Overlays/LineTextureOverlay.h"
@@ -45,10 +47,13 @@
 #include "MapEditor/UI/Dialogs/ActionSpecialDialog.h"
 #include "MapEditor/UI/Dialogs/SectorSpecialDialog.h"
 #include "MapEditor/UI/Dialogs/ShowItemDialog.h"
+#include "MapEditor/UI/MapChecksPanel.h"
+#include "MapEditor/UI/PropsPanel/MapObjectPropsPanel.h"
 #include "MapTextureManager.h"
 #include "UI/MapCanvas.h"
 #include "UI/MapEditorWindow.h"
 #include "UndoSteps.h"
+#include "Utility/MathStuff.h"
 
 using MapEditor::Mode;
 using MapEditor::SectorMode;
@@ -97,6 +102,8 @@ CVAR(Bool, hilight_smooth, true, CVAR_SAVE)
 //
 // ----------------------------------------------------------------------------
 EXTERN_CVAR(Int, flat_drawtype)
+EXTERN_CVAR(Int, map_polygon_threads)
+EXTERN_CVAR(Bool, map_polygon_triangulate)
 
 
 // ----------------------------------------------------------------------------
@@ -1363,7 +1370,17 @@ void MapEditContext::endUndoRecord(bool success)
 		}
 
 		// End recording
+		bool       had_redo    = manager->getCurrentIndex() < (int)manager->nUndoLevels() - 1;
+		UndoLevel* first_level = manager->nUndoLevels() > 0 ? manager->undoLevel(0) : nullptr;
 		manager->endRecord(success && (modified || created_deleted));
+
+		// Free any removed map objects that were only restorable from undo
+		// levels that are now gone, either the discarded redo levels or the
+		// oldest levels trimmed from the start of the history
+		bool redo_discarded = had_redo && manager->getCurrentIndex() == (int)manager->nUndoLevels() - 1;
+		bool trimmed        = first_level && (manager->nUndoLevels() == 0 || manager->undoLevel(0) != first_level);
+		if (redo_discarded || trimmed)
+			freeRemovedObjects();
 	}
 	updateThingLists();
 	us_create_delete_ = nullptr;
@@ -1445,6 +1462,38 @@ void MapEditContext::doRedo()
 	map_.recomputeSpecials();
 }
 
+// ----------------------------------------------------------------------------
+// MapEditContext::freeRemovedObjects
+//
+// Deletes any objects removed from the map that can no longer be restored by
+// undo/redo (in either the 2d or 3d mode undo history), and aren't open in
+// the properties or map checks panels
+// ----------------------------------------------------------------------------
+void MapEditContext::freeRemovedObjects()
+{
+	vector<unsigned> ids;
+	undo_manager_->getObjectIds(ids);
+	edit_3d_.undoManager()->getObjectIds(ids);
+	if (MapEditor::window())
+	{
+		for (auto object : MapEditor::window()->propsPanel()->getObjects())
+			ids.push_back(object->getId());
+		MapEditor::window()->checksPanel()->getObjectIds(ids);
+	}
+
+	unsigned n_freed = map_.freeRemovedObjects(ids);
+	if (n_freed == 0)
+		return;
+
+	LOG_MESSAGE(3, "Freed %u removed map objects", n_freed);
+
+	// Clear anything else that may point to deleted objects
+	renderer_.forceUpdate();
+	renderer_.clearAnimations();
+	info_3d_.reset();
+	updateTagged();
+}
+
 // ----------------------------------------------------------------------------
 // MapEditContext::overlayActive
 //
@@ -2108,6 +2157,194 @@ CONSOLE_COMMAND(m_test_sector, 0, false)
 	LOG_MESSAGE(1, "Took %ldms", ms);
 }
 
+// Builds a doom format test map in [wad] with a [grid]x[grid] arrangement of
+// concave (star-shaped) sectors with [points] points each.
+// Use eg. 'm_test_polygons 48 24' for many small sectors, or
+// 'm_test_polygons 4 2000' for a few very large ones
+static void createTestMap(WadArchive& wad, int grid, int points)
+{
+	vector<doomvertex_t> vertices;
+	vector<doomline_t>   lines;
+	vector<doomside_t>   sides;
+	vector<doomsector_t> sectors;
+
+	// Scale sectors up with the number of points, so that vertices don't
+	// end up on top of each other
+	int n_verts = points * 2;
+	int radius  = MIN(MAX(240, points * 4), (32000 / grid - 32) / 2);
+	int spacing = radius * 2 + 32;
+	for (int sy = 0; sy < grid; sy++)
+	{
+		for (int sx = 0; sx < grid; sx++)
+		{
+			// Star outline (clockwise, so the front sides face inwards)
+			unsigned first = vertices.size();
+			for (int p = 0; p < n_verts; p++)
+			{
+				double angle = -PI * p / points;
+				double r     = (p % 2 == 0) ? radius : radius / 2;
+				doomvertex_t vertex;
+				vertex.x = (short)(sx * spacing + r * cos(angle));
+				vertex.y = (short)(sy * spacing + r * sin(angle));
+				vertices.push_back(vertex);
+
+				doomline_t line;
+				memset(&line, 0, sizeof(doomline_t));
+				line.vertex1 = first + p;
+				line.vertex2 = first + (p + 1) % n_verts;
+				line.flags   = 1;
+				line.side1   = sides.size();
+				line.side2   = 0xFFFF;
+				lines.push_back(line);
+
+				doomside_t side;
+				memset(&side, 0, sizeof(doomside_t));
+				side.tex_upper[0]  = '-';
+				side.tex_lower[0]  = '-';
+				side.tex_middle[0] = '-';
+				side.sector        = sectors.size();
+				sides.push_back(side);
+			}
+
+			doomsector_t sector;
+			memset(&sector, 0, sizeof(doomsector_t));
+			sector.c_height = 128;
+			sector.light    = 160;
+			memcpy(sector.f_tex, "FLAT1", 5);
+			memcpy(sector.c_tex, "FLAT1", 5);
+			sectors.push_back(sector);
+		}
+	}
+
+	wad.addNewEntry("MAP01");
+	wad.addNewEntry("THINGS");
+	wad.addNewEntry("LINEDEFS")->importMem(lines.data(), lines.size() * sizeof(doomline_t));
+	wad.addNewEntry("SIDEDEFS")->importMem(sides.data(), sides.size() * sizeof(doomside_t));
+	wad.addNewEntry("VERTEXES")->importMem(vertices.data(), vertices.size() * sizeof(doomvertex_t));
+	wad.addNewEntry("SECTORS")->importMem(sectors.data(), sectors.size() * sizeof(doomsector_t));
+}
+
+CONSOLE_COMMAND(m_test_polygons, 0, false)
+{
+	// Get test map size
+	long grid   = 48;
+	long points = 24;
+	if (args.size() > 0)
+		args[0].ToLong(&grid);
+	if (args.size() > 1)
+		args[1].ToLong(&points);
+	grid   = MAX(1, MIN(grid, 60));
+	points = MAX(3, MIN(points, 65535 / (grid * grid * 2)));
+
+	WadArchive wad;
+	createTestMap(wad, grid, points);
+	auto maps = wad.detectMaps();
+	if (maps.empty())
+		return;
+
+	// Open the test map with each polygon building method, single-threaded
+	// then with the configured number of threads, and compare
+	int  threads     = map_polygon_threads;
+	bool triangulate = map_polygon_triangulate;
+	Log::console(S_FMT("Test map: %ld sectors, %ld lines", grid * grid, grid * grid * points * 2));
+	for (int run = 0; run < 4; run++)
+	{
+		map_polygon_triangulate = run >= 2;
+		map_polygon_threads     = run % 2 == 0 ? 1 : threads;
+
+		SLADEMap  map;
+		sf::Clock clock;
+		map.readMap(maps[0]);
+		long ms_open = clock.getElapsedTime().asMilliseconds();
+
+		for (unsigned a = 0; a < map.nSectors(); a++)
+			map.getSector(a)->resetPolygon();
+		clock.restart();
+		map.initSectorPolygons();
+		long ms_poly = clock.getElapsedTime().asMilliseconds();
+
+		unsigned n_polys = 0;
+		for (unsigned a = 0; a < map.nSectors(); a++)
+			n_polys += map.getSector(a)->getPolygon()->nSubPolys();
+
+		Log::console(S_FMT(
+			"%s, %s: map open took %ldms, building polygons took %ldms (%u sub-polygons)",
+			map_polygon_triangulate ? "Triangulator" : "Splitter",
+			run % 2 == 0 ? "1 thread" : "threaded",
+			ms_open,
+			ms_poly,
+			n_polys));
+	}
+	map_polygon_threads     = threads;
+	map_polygon_triangulate = triangulate;
+}
+
+// Runs the packed array nearest vertex/thing and line bounding box scans at
+// [level] for each of [points], returning the time taken. The results are
+// added to [results] for comparison
+static long runArrayScans(SLADEMap& map, const vector<fpoint2_t>& points, SImageKernels::Level level, vector<int>& results)
+{
+	SImageKernels::setMaxLevel(level);
+
+	const MapArrays& arr = map.arrays();
+	vector<unsigned> lines;
+	sf::Clock clock;
+	for (auto& point : points)
+	{
+		results.push_back(MapArrays::nearestPoint(arr.vertex_x, arr.vertex_y, point.x, point.y));
+		results.push_back(MapArrays::nearestPoint(arr.thing_x, arr.thing_y, point.x, point.y));
+
+		lines.clear();
+		arr.linesNear(point.x, point.y, 64, lines);
+		results.push_back(lines.size());
+		for (auto line : lines)
+			results.push_back(line);
+	}
+	long ms = clock.getElapsedTime().asMilliseconds();
+
+	SImageKernels::setMaxLevel(SImageKernels::detectedLevel());
+
+	return ms;
+}
+
+CONSOLE_COMMAND(m_test_array_scans, 0, false)
+{
+	SLADEMap& map = MapEditor::editContext().map();
+	if (map.nVertices() == 0)
+		return;
+
+	long num = 1000;
+	if (!args.empty())
+		args[0].ToLong(&num);
+
+	// Get pseudo-random test points within the map
+	bbox_t bbox;
+	for (unsigned a = 0; a < map.nVertices(); a++)
+		bbox.extend(map.getVertex(a)->xPos(), map.getVertex(a)->yPos());
+	vector<fpoint2_t> points;
+	uint32_t seed = 12345;
+	for (long a = 0; a < num; a++)
+	{
+		seed = seed * 1103515245 + 12345;
+		double x = bbox.min.x + (seed >> 8) % 10000 / 10000.0 * bbox.width();
+		seed = seed * 1103515245 + 12345;
+		double y = bbox.min.y + (seed >> 8) % 10000 / 10000.0 * bbox.height();
+		points.push_back(fpoint2_t(x, y));
+	}
+
+	SImageKernels::Level best = SImageKernels::detectedLevel();
+	vector<int> res_scalar, res_best;
+	long t_scalar = runArrayScans(map, points, SImageKernels::SCALAR, res_scalar);
+	long t_best = runArrayScans(map, points, best, res_best);
+	Log::console(S_FMT(
+		"%ld points: %ldms scalar, %ldms %s%s",
+		num,
+		t_scalar,
+		t_best,
+		SImageKernels::levelName(best),
+		res_scalar == res_best ? "" : " - RESULTS DIFFER"));
+}
+
 CONSOLE_COMMAND(m_test_mobj_backup, 0, false)
 {
 	sf::Clock clock;
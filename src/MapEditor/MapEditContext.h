@@ -168,6 +168,8 @@ private:
 	bool	undo_deleted_		= false;
 	string	last_undo_level_;
 
+	void	freeRemovedObjects();
+
 	// Tagged items
 	vector<MapSector*>	tagged_sectors_;
 	vector<MapLine*>	tagged_lines_;
@@ -30,6 +30,7 @@
  * INCLUDES
  *******************************************************************/
 #include "Main.h"
+#include "App.h"
 #include "SLADEMap/SLADEMap.h"
 #include "MapSpecials.h"
 #include "Game/Configuration.h"
@@ -42,10 +43,55 @@
 const double TAU = PI * 2;
 
 
+/*******************************************************************
+ * FUNCTIONS
+ *******************************************************************/
+
+/* isSlopeThing
+ * Returns true if things of [type] are processed as slope things
+ *******************************************************************/
+static bool isSlopeThing(int type)
+{
+	return (type >= 9500 && type <= 9503) ||
+		type == 9510 || type == 9511 ||
+		type == 1500 || type == 1501 ||
+		type == 1504 || type == 1505;
+}
+
+/* isSpecialLine
+ * Returns true if lines with [special] are processed as map specials
+ *******************************************************************/
+static bool isSpecialLine(int special)
+{
+	return special == 118 || special == 160 || special == 181 || special == 208;
+}
+
+/* resetPlanes
+ * Resets [sector]'s floor and ceiling to flat planes
+ *******************************************************************/
+static void resetPlanes(MapSector* sector)
+{
+	sector->setPlane<FLOOR_PLANE>(plane_t::flat(sector->getPlaneHeight<FLOOR_PLANE>()));
+	sector->setPlane<CEILING_PLANE>(plane_t::flat(sector->getPlaneHeight<CEILING_PLANE>()));
+}
+
+
 /*******************************************************************
  * MAPSPECIALS NAMESPACE FUNCTIONS
  *******************************************************************/
 
+/* MapSpecials::MapSpecials
+ * MapSpecials class constructor
+ *******************************************************************/
+MapSpecials::MapSpecials()
+{
+	index_valid = false;
+	indexing = false;
+	index_time = 0;
+	index_last_id = 0;
+	touched = nullptr;
+}
+
 /* MapSpecials::reset
  * Clear out all internal state
  *******************************************************************/
@@ -53,19 +99,341 @@ void MapSpecials::reset()
 {
 	sector_colours.clear();
 	sector_fadecolours.clear();
+
+	// Clear specials index
+	index_valid = false;
+	slope_ops.clear();
+	floor_ops.clear();
+	sector_groups.clear();
+	sector_tags.clear();
+	side_sectors.clear();
+	line_relevant.clear();
+	thing_relevant.clear();
+	line_ids.clear();
+	vertex_floor_heights.clear();
+	vertex_ceiling_heights.clear();
 }
 
 /* MapSpecials::processMapSpecials
- * Process map specials, depending on the current game/port
+ * Process map specials, depending on the current game/port. If only
+ * sectors have been modified since the last time this was called,
+ * only the specials affecting those sectors are reprocessed
  *******************************************************************/
 void MapSpecials::processMapSpecials(SLADEMap* map)
 {
+	string port = Game::configuration().currentPort();
+	long time = App::runTimer();
+
+	// Check if we can just process modified sectors
+	if (index_valid && port == index_port && map->geometryUpdated() < index_time)
+	{
+		vector<MapObject*> modified = map->getModifiedObjects(index_time);
+		if (!needsFullUpdate(map, modified))
+		{
+			processModified(map, modified);
+			index_time = time;
+			return;
+		}
+	}
+
+	// Process everything, building the specials index as we go
+	beginIndex(map);
+
 	// ZDoom
-	if (Game::configuration().currentPort() == "zdoom")
+	if (port == "zdoom")
 		processZDoomMapSpecials(map);
 	// Eternity, currently no need for processEternityMapSpecials
-	else if (Game::configuration().currentPort() == "eternity")
+	else if (port == "eternity")
 		processEternitySlopes(map);
+
+	endIndex(map);
+	index_port = port;
+	index_time = time;
+}
+
+/* MapSpecials::beginIndex
+ * Clears the specials index, ready to be rebuilt while processing
+ * all specials in [map]
+ *******************************************************************/
+void MapSpecials::beginIndex(SLADEMap* map)
+{
+	slope_ops.clear();
+	floor_ops.clear();
+	line_ids.clear();
+	line_relevant.assign(map->nLines(), false);
+	sector_groups.resize(map->nSectors());
+	for (unsigned a = 0; a < sector_groups.size(); a++)
+		sector_groups[a] = a;
+
+	indexing = true;
+}
+
+/* MapSpecials::endIndex
+ * Records the current state of anything in [map] that would require
+ * a full update of the specials index if changed
+ *******************************************************************/
+void MapSpecials::endIndex(SLADEMap* map)
+{
+	index_counts[0] = map->nVertices();
+	index_counts[1] = map->nLines();
+	index_counts[2] = map->nSides();
+	index_counts[3] = map->nSectors();
+	index_counts[4] = map->nThings();
+
+	sector_tags.resize(map->nSectors());
+	for (unsigned a = 0; a < map->nSectors(); a++)
+		sector_tags[a] = map->getSector(a)->getTag();
+
+	side_sectors.resize(map->nSides());
+	for (unsigned a = 0; a < map->nSides(); a++)
+		side_sectors[a] = map->getSide(a)->getSector();
+
+	for (unsigned a = 0; a < map->nLines(); a++)
+		if (isSpecialLine(map->getLine(a)->getSpecial()))
+			line_relevant[a] = true;
+
+	thing_relevant.resize(map->nThings());
+	for (unsigned a = 0; a < map->nThings(); a++)
+		thing_relevant[a] = isSlopeThing(map->getThing(a)->getType());
+
+	// Get the newest object id, to check for objects created later
+	index_last_id = 0;
+	for (unsigned a = 0; a < map->nVertices(); a++)
+		index_last_id = MAX(index_last_id, map->getVertex(a)->getId());
+	for (unsigned a = 0; a < map->nLines(); a++)
+		index_last_id = MAX(index_last_id, map->getLine(a)->getId());
+	for (unsigned a = 0; a < map->nSides(); a++)
+		index_last_id = MAX(index_last_id, map->getSide(a)->getId());
+	for (unsigned a = 0; a < map->nSectors(); a++)
+		index_last_id = MAX(index_last_id, map->getSector(a)->getId());
+	for (unsigned a = 0; a < map->nThings(); a++)
+		index_last_id = MAX(index_last_id, map->getThing(a)->getId());
+
+	indexing = false;
+	index_valid = true;
+}
+
+/* MapSpecials::needsFullUpdate
+ * Returns true if any of the [modified] objects in [map] could change
+ * which sectors are affected by which specials (ie. anything other
+ * than a change to sector properties), meaning the specials index
+ * needs to be rebuilt
+ *******************************************************************/
+bool MapSpecials::needsFullUpdate(SLADEMap* map, vector<MapObject*>& modified)
+{
+	// Check for created/deleted objects
+	if (index_counts[0] != map->nVertices() ||
+		index_counts[1] != map->nLines() ||
+		index_counts[2] != map->nSides() ||
+		index_counts[3] != map->nSectors() ||
+		index_counts[4] != map->nThings())
+		return true;
+
+	for (auto object : modified)
+	{
+		// Check for objects created (replacing deleted ones)
+		if (object->getId() > index_last_id)
+			return true;
+
+		unsigned index = object->getIndex();
+		switch (object->getObjType())
+		{
+		// Vertex heights
+		case MOBJ_VERTEX:
+			return true;
+
+		// Line specials, ids and args
+		case MOBJ_LINE:
+		{
+			auto line = (MapLine*)object;
+			if (line_relevant[index] ||
+				isSpecialLine(line->getSpecial()) ||
+				line_ids.count(line->intProperty("id")))
+				return true;
+			break;
+		}
+
+		// Side sector references
+		case MOBJ_SIDE:
+			if (((MapSide*)object)->getSector() != side_sectors[index])
+				return true;
+			break;
+
+		// Sector tags
+		case MOBJ_SECTOR:
+			if (((MapSector*)object)->getTag() != sector_tags[index])
+				return true;
+			break;
+
+		// Slope things (including things that were slope things when indexed)
+		case MOBJ_THING:
+			if (thing_relevant[index] ||
+				isSlopeThing(((MapThing*)object)->getType()))
+				return true;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	return false;
+}
+
+/* MapSpecials::processModified
+ * Reprocesses slope and 3d floor specials for any [modified] sectors
+ * in [map] (and any sectors affected by the same specials). The
+ * result is the same as reprocessing all specials
+ *******************************************************************/
+void MapSpecials::processModified(SLADEMap* map, vector<MapObject*>& modified)
+{
+	// Get sector groups to update
+	vector<bool> group_modified(map->nSectors(), false);
+	bool any = false;
+	for (auto object : modified)
+	{
+		if (object->getObjType() == MOBJ_SECTOR)
+		{
+			group_modified[sectorGroup(object->getIndex())] = true;
+			any = true;
+		}
+	}
+	if (!any)
+		return;
+
+	// Reset all sectors in modified groups to flat planes
+	vector<bool> updated(map->nSectors(), false);
+	for (unsigned a = 0; a < map->nSectors(); a++)
+	{
+		if (group_modified[sectorGroup(a)])
+		{
+			updated[a] = true;
+			resetPlanes(map->getSector(a));
+		}
+	}
+
+	// Reapply slope specials for modified groups, in the original order
+	for (auto& op : slope_ops)
+		if (group_modified[sectorGroup(op.sector)])
+			applySlopeOp(map, op);
+
+	// Get sectors with 3d floors controlled by updated sectors
+	vector<bool> refresh(map->nSectors(), false);
+	any = false;
+	for (auto& op : floor_ops)
+	{
+		if (!updated[op.control])
+			continue;
+
+		for (int target : op.targets)
+			refresh[target] = true;
+		any = true;
+	}
+	if (!any)
+		return;
+
+	// Rebuild their 3d floors, in the original order
+	for (unsigned a = 0; a < map->nSectors(); a++)
+		if (refresh[a])
+			map->getSector(a)->extra_floors.clear();
+	for (auto& op : floor_ops)
+	{
+		extra_floor_t extra_floor;
+		bool built = false;
+		for (int target : op.targets)
+		{
+			if (!refresh[target])
+				continue;
+
+			if (!built)
+			{
+				build3dFloor(op.line, extra_floor);
+				built = true;
+			}
+			add3dFloor(extra_floor, map->getSector(op.control), map->getSector(target));
+		}
+	}
+}
+
+/* MapSpecials::sectorGroup
+ * Returns the group (index of the first sector in the group) that
+ * [sector] is part of
+ *******************************************************************/
+int MapSpecials::sectorGroup(int sector)
+{
+	while (sector_groups[sector] != sector)
+	{
+		sector_groups[sector] = sector_groups[sector_groups[sector]];
+		sector = sector_groups[sector];
+	}
+
+	return sector;
+}
+
+/* MapSpecials::touch
+ * Records that [sector] is affected by the special currently being
+ * processed (when building the index)
+ *******************************************************************/
+void MapSpecials::touch(MapSector* sector)
+{
+	if (touched && sector)
+		touched->push_back(sector);
+}
+
+/* MapSpecials::touchLine
+ * Records that [line] is used by the special currently being
+ * processed (when building the index)
+ *******************************************************************/
+void MapSpecials::touchLine(MapLine* line)
+{
+	if (indexing && line->getIndex() < line_relevant.size())
+		line_relevant[line->getIndex()] = true;
+}
+
+/* MapSpecials::runSlopeOp
+ * Applies the slope special of [type] from [object], and records it
+ * in the index along with the sectors it affects
+ *******************************************************************/
+void MapSpecials::runSlopeOp(SLADEMap* map, uint8_t type, MapObject* object)
+{
+	vector<MapSector*> op_touched;
+	slope_op_t op = { type, object, -1 };
+
+	touched = &op_touched;
+	applySlopeOp(map, op);
+	touched = nullptr;
+
+	// Ignore if it didn't affect any sectors
+	if (op_touched.empty())
+		return;
+
+	// Join affected sectors into one group
+	op.sector = op_touched[0]->getIndex();
+	for (auto sector : op_touched)
+	{
+		int group1 = sectorGroup(op.sector);
+		int group2 = sectorGroup(sector->getIndex());
+		if (group1 != group2)
+			sector_groups[MAX(group1, group2)] = MIN(group1, group2);
+	}
+
+	slope_ops.push_back(op);
+}
+
+/* MapSpecials::applySlopeOp
+ * Applies the slope special [op]
+ *******************************************************************/
+void MapSpecials::applySlopeOp(SLADEMap* map, const slope_op_t& op)
+{
+	switch (op.type)
+	{
+	case SLOPE_PLANE_ALIGN:		applyPlaneAlignLine((MapLine*)op.object); break;
+	case SLOPE_THING:			applySlopeThing(map, (MapThing*)op.object); break;
+	case SLOPE_COPY_THING:		applySlopeCopyThing(map, (MapThing*)op.object); break;
+	case SLOPE_VERTEX_HEIGHTS:	applyVertexHeights((MapSector*)op.object); break;
+	case SLOPE_PLANE_COPY:		applyPlaneCopyLine(map, (MapLine*)op.object); break;
+	default: break;
+	}
 }
 
 /* MapSpecials::getTagColour
@@ -166,9 +534,8 @@ void MapSpecials::processZDoomMapSpecials(SLADEMap* map)
 	processZDoomSlopes(map);
 
 	// Clear out all 3D floors, or every call to this function will create
-	// duplicates!
-	// TODO this isn't a very good solution, but we don't have incremental
-	// updates yet
+	// duplicates! (when only sectors have been modified, processModified
+	// updates just the affected 3D floors instead)
 	for (unsigned a = 0; a < map->nSectors(); a++)
 		map->getSector(a)->extra_floors.clear();
 
@@ -204,57 +571,26 @@ void MapSpecials::processZDoomLineSpecial(MapLine* line)
 	// --- Sector_Set3dFloor
 	if (special == 160)
 	{
-		MapSector* control_sector = line->frontSector();
-		if (!control_sector) return;
-
-		int sector_tag = args[0];
-		int type_flags = args[1];
-		int flags = args[2];
-		int alpha = args[3];
-
-		float falpha = float(alpha) / 255.0;
-
 		extra_floor_t extra_floor;
+		if (!build3dFloor(line, extra_floor))
+			return;
+		MapSector* control_sector = line->frontSector();
 
-		// Liquids (swimmable, type 2) and floors with flag 4 have their inner
-		// surfaces drawn as well
-		// TODO this does something different with vavoom
-		extra_floor.draw_inside = (type_flags & 4 || (type_flags & 3) == 2);
-		extra_floor.flags = flags;
-
-		// TODO only gzdoom supports slopes here.
-		// TODO this should probably happen live instead of being copied, if
-		// we're moving towards purely live updates here
-		// Guessing a bit here, but I suspect ZDoom sorts floors in order of
-		// the control sector's plain ceiling height
-		extra_floor.effective_height = control_sector->getCeilingHeight();
-		extra_floor.ceiling_plane = control_sector->getCeilingPlane();
-		if (extra_floor.ceilingOnly())
-			extra_floor.floor_plane = extra_floor.ceiling_plane;
-		else
-			extra_floor.floor_plane = control_sector->getFloorPlane();
-
-		extra_floor.control_sector_index = control_sector->getIndex();
-		extra_floor.control_line_index = line->getIndex();
-		extra_floor.floor_type = type_flags & 0x3;
-
-		extra_floor.alpha = falpha;
+		floor_op_t op;
+		op.line = line;
+		op.control = control_sector->getIndex();
 
 		vector<MapSector*> sectors;
-		map->getSectorsByTag(sector_tag, sectors);
+		map->getSectorsByTag(args[0], sectors);
 		for (unsigned a = 0; a < sectors.size(); a++)
 		{
-			sectors[a]->extra_floors.push_back(extra_floor);
-			std::sort(sectors[a]->extra_floors.begin(), sectors[a]->extra_floors.end(), _sort_extra_floors);
-
-			// Mark the target sector as updated if the control sector has
-			// been; this is a sort of very rudimentary dependency graph
-			if (control_sector->geometryUpdatedTime() > sectors[a]->geometryUpdatedTime())
-				sectors[a]->setGeometryUpdated();
-			if (control_sector->modifiedTime() > sectors[a]->modifiedTime())
-				sectors[a]->setModified();
+			add3dFloor(extra_floor, control_sector, sectors[a]);
+			op.targets.push_back(sectors[a]->getIndex());
 		}
 		LOG_MESSAGE(4, "adding a 3d floor controlled by sector %d to %lu sectors", extra_floor.control_sector_index, sectors.size());
+
+		if (indexing)
+			floor_ops.push_back(op);
 	}
 
 	// --- TranslucentLine ---
@@ -263,7 +599,11 @@ void MapSpecials::processZDoomLineSpecial(MapLine* line)
 		// Get tagged lines
 		vector<MapLine*> tagged;
 		if (args[0] > 0)
+		{
 			map->getLinesById(args[0], tagged);
+			if (indexing)
+				line_ids.insert(args[0]);
+		}
 		else
 			tagged.push_back(line);
 
@@ -274,6 +614,12 @@ void MapSpecials::processZDoomLineSpecial(MapLine* line)
 		// Set transparency
 		for (unsigned l = 0; l < tagged.size(); l++)
 		{
+			touchLine(tagged[l]);
+
+			// Don't modify the line if it's already set
+			if (tagged[l]->floatProperty("alpha") == alpha && tagged[l]->stringProperty("renderstyle") == type)
+				continue;
+
 			tagged[l]->setFloatProperty("alpha", alpha);
 			tagged[l]->setStringProperty("renderstyle", type);
 
@@ -282,6 +628,65 @@ void MapSpecials::processZDoomLineSpecial(MapLine* line)
 	}
 }
 
+/* MapSpecials::build3dFloor
+ * Sets up [extra_floor] from Sector_Set3dFloor special on [line].
+ * Returns false if the line has no control sector
+ *******************************************************************/
+bool MapSpecials::build3dFloor(MapLine* line, extra_floor_t& extra_floor)
+{
+	MapSector* control_sector = line->frontSector();
+	if (!control_sector)
+		return false;
+
+	int type_flags = line->intProperty("arg1");
+	int flags = line->intProperty("arg2");
+	int alpha = line->intProperty("arg3");
+
+	float falpha = float(alpha) / 255.0;
+
+	// Liquids (swimmable, type 2) and floors with flag 4 have their inner
+	// surfaces drawn as well
+	// TODO this does something different with vavoom
+	extra_floor.draw_inside = (type_flags & 4 || (type_flags & 3) == 2);
+	extra_floor.flags = flags;
+
+	// TODO only gzdoom supports slopes here.
+	// TODO this should probably happen live instead of being copied, if
+	// we're moving towards purely live updates here
+	// Guessing a bit here, but I suspect ZDoom sorts floors in order of
+	// the control sector's plain ceiling height
+	extra_floor.effective_height = control_sector->getCeilingHeight();
+	extra_floor.ceiling_plane = control_sector->getCeilingPlane();
+	if (extra_floor.ceilingOnly())
+		extra_floor.floor_plane = extra_floor.ceiling_plane;
+	else
+		extra_floor.floor_plane = control_sector->getFloorPlane();
+
+	extra_floor.control_sector_index = control_sector->getIndex();
+	extra_floor.control_line_index = line->getIndex();
+	extra_floor.floor_type = type_flags & 0x3;
+
+	extra_floor.alpha = falpha;
+
+	return true;
+}
+
+/* MapSpecials::add3dFloor
+ * Adds [extra_floor] (controlled by [control_sector]) to [target]
+ *******************************************************************/
+void MapSpecials::add3dFloor(extra_floor_t& extra_floor, MapSector* control_sector, MapSector* target)
+{
+	target->extra_floors.push_back(extra_floor);
+	std::sort(target->extra_floors.begin(), target->extra_floors.end(), _sort_extra_floors);
+
+	// Mark the target sector as updated if the control sector has
+	// been; this is a sort of very rudimentary dependency graph
+	if (control_sector->geometryUpdatedTime() > target->geometryUpdatedTime())
+		target->setGeometryUpdated();
+	if (control_sector->modifiedTime() > target->modifiedTime())
+		target->setModified();
+}
+
 /* MapSpecials::processACSScripts
  * Process 'OPEN' ACS scripts for various specials - sector colours,
  * slopes, etc.
@@ -426,43 +831,14 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 
 	// First things first: reset every sector to flat planes
 	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		MapSector* target = map->getSector(a);
-		target->setPlane<FLOOR_PLANE>(plane_t::flat(target->getPlaneHeight<FLOOR_PLANE>()));
-		target->setPlane<CEILING_PLANE>(plane_t::flat(target->getPlaneHeight<CEILING_PLANE>()));
-	}
+		resetPlanes(map->getSector(a));
 
 	// Plane_Align (line special 181)
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		MapLine* line = map->getLine(a);
-		if (line->getSpecial() != 181)
-			continue;
-
-		MapSector* sector1 = line->frontSector();
-		MapSector* sector2 = line->backSector();
-		if (!sector1 || !sector2)
-		{
-			LOG_MESSAGE(1, "Ignoring Plane_Align on one-sided line %d", line->getIndex());
-			continue;
-		}
-		if (sector1 == sector2)
-		{
-			LOG_MESSAGE(1, "Ignoring Plane_Align on line %d, which has the same sector on both sides", line->getIndex());
-			continue;
-		}
-
-		int floor_arg = line->intProperty("arg0");
-		if (floor_arg == 1)
-			applyPlaneAlign<FLOOR_PLANE>(line, sector1, sector2);
-		else if (floor_arg == 2)
-			applyPlaneAlign<FLOOR_PLANE>(line, sector2, sector1);
-
-		int ceiling_arg = line->intProperty("arg1");
-		if (ceiling_arg == 1)
-			applyPlaneAlign<CEILING_PLANE>(line, sector1, sector2);
-		else if (ceiling_arg == 2)
-			applyPlaneAlign<CEILING_PLANE>(line, sector2, sector1);
+		if (line->getSpecial() == 181)
+			runSlopeOp(map, SLOPE_PLANE_ALIGN, line);
 	}
 
 	// Line slope things (9500/9501), sector tilt things (9502/9503), and
@@ -470,65 +846,25 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 	for (unsigned a = 0; a < map->nThings(); a++)
 	{
 		MapThing* thing = map->getThing(a);
-
-		// Line slope things
-		if (thing->getType() == 9500)
-			applyLineSlopeThing<FLOOR_PLANE>(map, thing);
-		else if (thing->getType() == 9501)
-			applyLineSlopeThing<CEILING_PLANE>(map, thing);
-		// Sector tilt things
-		else if (thing->getType() == 9502)
-			applySectorTiltThing<FLOOR_PLANE>(map, thing);
-		else if (thing->getType() == 9503)
-			applySectorTiltThing<CEILING_PLANE>(map, thing);
-		// Vavoom things
-		else if (thing->getType() == 1500)
-			applyVavoomSlopeThing<FLOOR_PLANE>(map, thing);
-		else if (thing->getType() == 1501)
-			applyVavoomSlopeThing<CEILING_PLANE>(map, thing);
+		if ((thing->getType() >= 9500 && thing->getType() <= 9503) ||
+			thing->getType() == 1500 || thing->getType() == 1501)
+			runSlopeOp(map, SLOPE_THING, thing);
 	}
 
 	// Slope copy things (9510/9511)
 	for (unsigned a = 0; a < map->nThings(); a++)
 	{
 		MapThing* thing = map->getThing(a);
-
 		if (thing->getType() == 9510 || thing->getType() == 9511)
-		{
-			int target_idx = map->sectorAt(thing->point());
-			if (target_idx < 0)
-				continue;
-			MapSector* target = map->getSector(target_idx);
-
-			// First argument is the tag of a sector whose slope should be copied
-			int tag = thing->intProperty("arg0");
-			if (!tag)
-			{
-				LOG_MESSAGE(1, "Ignoring slope copy thing in sector %d with no argument", target_idx);
-				continue;
-			}
-
-			vector<MapSector*> tagged_sectors;
-			map->getSectorsByTag(tag, tagged_sectors);
-			if (tagged_sectors.empty())
-			{
-				LOG_MESSAGE(1, "Ignoring slope copy thing in sector %d; no sectors have target tag %d", target_idx, tag);
-				continue;
-			}
-
-			if (thing->getType() == 9510)
-				target->setFloorPlane(tagged_sectors[0]->getFloorPlane());
-			else
-				target->setCeilingPlane(tagged_sectors[0]->getCeilingPlane());
-		}
+			runSlopeOp(map, SLOPE_COPY_THING, thing);
 	}
 
 	// Vertex height things
 	// These only affect the calculation of slopes and shouldn't be stored in
 	// the map data proper, so instead of actually changing vertex properties,
 	// we store them in a hashmap.
-	VertexHeightMap vertex_floor_heights;
-	VertexHeightMap vertex_ceiling_heights;
+	vertex_floor_heights.clear();
+	vertex_ceiling_heights.clear();
 	for (unsigned a = 0; a < map->nThings(); a++)
 	{
 		MapThing* thing = map->getThing(a);
@@ -549,75 +885,15 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 	// Vertex heights -- only applies for sectors with exactly three vertices.
 	// Heights may be set by UDMF properties, or by a vertex height thing
 	// placed exactly on the vertex (which takes priority over the prop).
-	vector<MapVertex*> vertices;
 	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		MapSector* target = map->getSector(a);
-		vertices.clear();
-		target->getVertices(vertices);
-		if (vertices.size() != 3)
-			continue;
-
-		applyVertexHeightSlope<FLOOR_PLANE>(target, vertices, vertex_floor_heights);
-		applyVertexHeightSlope<CEILING_PLANE>(target, vertices, vertex_ceiling_heights);
-	}
+		runSlopeOp(map, SLOPE_VERTEX_HEIGHTS, map->getSector(a));
 
 	// Plane_Copy
-	vector<MapSector*> sectors;
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		MapLine* line = map->getLine(a);
-		if (line->getSpecial() != 118)
-			continue;
-
-		int tag;
-		MapSector* front = line->frontSector();
-		MapSector* back = line->backSector();
-		if ((tag = line->intProperty("arg0")) && front)
-		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				front->setFloorPlane(sectors[0]->getFloorPlane());
-		}
-		if ((tag = line->intProperty("arg1")) && front)
-		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				front->setCeilingPlane(sectors[0]->getCeilingPlane());
-		}
-		if ((tag = line->intProperty("arg2")) && back)
-		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				back->setFloorPlane(sectors[0]->getFloorPlane());
-		}
-		if ((tag = line->intProperty("arg3")) && back)
-		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				back->setCeilingPlane(sectors[0]->getCeilingPlane());
-		}
-
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
-		{
-			int share = line->intProperty("arg4");
-
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->getFloorPlane());
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->getFloorPlane());
-
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->getCeilingPlane());
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->getCeilingPlane());
-		}
+		if (line->getSpecial() == 118)
+			runSlopeOp(map, SLOPE_PLANE_COPY, line);
 	}
 }
 
@@ -634,105 +910,206 @@ void MapSpecials::processEternitySlopes(SLADEMap* map)
 
 	// First things first: reset every sector to flat planes
 	for(unsigned a = 0; a < map->nSectors(); a++)
+		resetPlanes(map->getSector(a));
+
+	// Plane_Align (line special 181)
+	for(unsigned a = 0; a < map->nLines(); a++)
 	{
-		MapSector* target = map->getSector(a);
-		target->setPlane<FLOOR_PLANE>(plane_t::flat(target->getPlaneHeight<FLOOR_PLANE>()));
-		target->setPlane<CEILING_PLANE>(plane_t::flat(target->getPlaneHeight<CEILING_PLANE>()));
+		MapLine* line = map->getLine(a);
+		if(line->getSpecial() == 181)
+			runSlopeOp(map, SLOPE_PLANE_ALIGN, line);
 	}
 
-	// Plane_Align (line special 181)
+	// Plane_Copy
 	for(unsigned a = 0; a < map->nLines(); a++)
 	{
 		MapLine* line = map->getLine(a);
-		if(line->getSpecial() != 181)
-			continue;
+		if(line->getSpecial() == 118)
+			runSlopeOp(map, SLOPE_PLANE_COPY, line);
+	}
+}
 
-		MapSector* sector1 = line->frontSector();
-		MapSector* sector2 = line->backSector();
-		if(!sector1 || !sector2)
-		{
-			LOG_MESSAGE(1, "Ignoring Plane_Align on one-sided line %d", line->getIndex());
-			continue;
-		}
-		if(sector1 == sector2)
-		{
-			LOG_MESSAGE(1, "Ignoring Plane_Align on line %d, which has the same sector on both sides", line->getIndex());
-			continue;
-		}
+/* MapSpecials::applyPlaneAlignLine
+ * Applies a Plane_Align special on [line]
+ *******************************************************************/
+void MapSpecials::applyPlaneAlignLine(MapLine* line)
+{
+	MapSector* sector1 = line->frontSector();
+	MapSector* sector2 = line->backSector();
+	if (!sector1 || !sector2)
+	{
+		LOG_MESSAGE(1, "Ignoring Plane_Align on one-sided line %d", line->getIndex());
+		return;
+	}
+	if (sector1 == sector2)
+	{
+		LOG_MESSAGE(1, "Ignoring Plane_Align on line %d, which has the same sector on both sides", line->getIndex());
+		return;
+	}
 
-		int floor_arg = line->intProperty("arg0");
-		if(floor_arg == 1)
-			applyPlaneAlign<FLOOR_PLANE>(line, sector1, sector2);
-		else if(floor_arg == 2)
-			applyPlaneAlign<FLOOR_PLANE>(line, sector2, sector1);
+	int floor_arg = line->intProperty("arg0");
+	if (floor_arg == 1)
+		applyPlaneAlign<FLOOR_PLANE>(line, sector1, sector2);
+	else if (floor_arg == 2)
+		applyPlaneAlign<FLOOR_PLANE>(line, sector2, sector1);
+
+	int ceiling_arg = line->intProperty("arg1");
+	if (ceiling_arg == 1)
+		applyPlaneAlign<CEILING_PLANE>(line, sector1, sector2);
+	else if (ceiling_arg == 2)
+		applyPlaneAlign<CEILING_PLANE>(line, sector2, sector1);
+}
+
+/* MapSpecials::applySlopeThing
+ * Applies a line slope, sector tilt or vavoom slope special on
+ * [thing]
+ *******************************************************************/
+void MapSpecials::applySlopeThing(SLADEMap* map, MapThing* thing)
+{
+	// Line slope things
+	if (thing->getType() == 9500)
+		applyLineSlopeThing<FLOOR_PLANE>(map, thing);
+	else if (thing->getType() == 9501)
+		applyLineSlopeThing<CEILING_PLANE>(map, thing);
+	// Sector tilt things
+	else if (thing->getType() == 9502)
+		applySectorTiltThing<FLOOR_PLANE>(map, thing);
+	else if (thing->getType() == 9503)
+		applySectorTiltThing<CEILING_PLANE>(map, thing);
+	// Vavoom things
+	else if (thing->getType() == 1500)
+		applyVavoomSlopeThing<FLOOR_PLANE>(map, thing);
+	else if (thing->getType() == 1501)
+		applyVavoomSlopeThing<CEILING_PLANE>(map, thing);
+}
+
+/* MapSpecials::applySlopeCopyThing
+ * Applies a slope copy special on [thing], to its containing sector
+ *******************************************************************/
+void MapSpecials::applySlopeCopyThing(SLADEMap* map, MapThing* thing)
+{
+	int target_idx = map->sectorAt(thing->point());
+	if (target_idx < 0)
+		return;
+	MapSector* target = map->getSector(target_idx);
 
-		int ceiling_arg = line->intProperty("arg1");
-		if(ceiling_arg == 1)
-			applyPlaneAlign<CEILING_PLANE>(line, sector1, sector2);
-		else if(ceiling_arg == 2)
-			applyPlaneAlign<CEILING_PLANE>(line, sector2, sector1);
+	// First argument is the tag of a sector whose slope should be copied
+	int tag = thing->intProperty("arg0");
+	if (!tag)
+	{
+		LOG_MESSAGE(1, "Ignoring slope copy thing in sector %d with no argument", target_idx);
+		return;
 	}
 
-	// Plane_Copy
-	vector<MapSector*> sectors;
-	for(unsigned a = 0; a < map->nLines(); a++)
+	vector<MapSector*> tagged_sectors;
+	map->getSectorsByTag(tag, tagged_sectors);
+	if (tagged_sectors.empty())
 	{
-		MapLine* line = map->getLine(a);
-		if(line->getSpecial() != 118)
-			continue;
+		LOG_MESSAGE(1, "Ignoring slope copy thing in sector %d; no sectors have target tag %d", target_idx, tag);
+		return;
+	}
 
-		int tag;
-		MapSector* front = line->frontSector();
-		MapSector* back = line->backSector();
-		if((tag = line->intProperty("arg0")))
+	touch(target);
+	touch(tagged_sectors[0]);
+	if (thing->getType() == 9510)
+		target->setFloorPlane(tagged_sectors[0]->getFloorPlane());
+	else
+		target->setCeilingPlane(tagged_sectors[0]->getCeilingPlane());
+}
+
+/* MapSpecials::applyVertexHeights
+ * Applies a slope to [sector] based on the heights of its vertices,
+ * if it is triangular
+ *******************************************************************/
+void MapSpecials::applyVertexHeights(MapSector* sector)
+{
+	vector<MapVertex*> vertices;
+	sector->getVertices(vertices);
+	if (vertices.size() != 3)
+		return;
+
+	touch(sector);
+	applyVertexHeightSlope<FLOOR_PLANE>(sector, vertices, vertex_floor_heights);
+	applyVertexHeightSlope<CEILING_PLANE>(sector, vertices, vertex_ceiling_heights);
+}
+
+/* MapSpecials::applyPlaneCopyLine
+ * Applies a Plane_Copy special on [line]
+ *******************************************************************/
+void MapSpecials::applyPlaneCopyLine(SLADEMap* map, MapLine* line)
+{
+	int tag;
+	vector<MapSector*> sectors;
+	MapSector* front = line->frontSector();
+	MapSector* back = line->backSector();
+	if ((tag = line->intProperty("arg0")) && front)
+	{
+		sectors.clear();
+		map->getSectorsByTag(tag, sectors);
+		if (sectors.size())
 		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if(sectors.size())
-				front->setFloorPlane(sectors[0]->getFloorPlane());
+			touch(front);
+			touch(sectors[0]);
+			front->setFloorPlane(sectors[0]->getFloorPlane());
 		}
-		if((tag = line->intProperty("arg1")))
+	}
+	if ((tag = line->intProperty("arg1")) && front)
+	{
+		sectors.clear();
+		map->getSectorsByTag(tag, sectors);
+		if (sectors.size())
 		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if(sectors.size())
-				front->setCeilingPlane(sectors[0]->getCeilingPlane());
+			touch(front);
+			touch(sectors[0]);
+			front->setCeilingPlane(sectors[0]->getCeilingPlane());
 		}
-		if((tag = line->intProperty("arg2")))
+	}
+	if ((tag = line->intProperty("arg2")) && back)
+	{
+		sectors.clear();
+		map->getSectorsByTag(tag, sectors);
+		if (sectors.size())
 		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if(sectors.size())
-				back->setFloorPlane(sectors[0]->getFloorPlane());
+			touch(back);
+			touch(sectors[0]);
+			back->setFloorPlane(sectors[0]->getFloorPlane());
 		}
-		if((tag = line->intProperty("arg3")))
+	}
+	if ((tag = line->intProperty("arg3")) && back)
+	{
+		sectors.clear();
+		map->getSectorsByTag(tag, sectors);
+		if (sectors.size())
 		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if(sectors.size())
-				back->setCeilingPlane(sectors[0]->getCeilingPlane());
+			touch(back);
+			touch(sectors[0]);
+			back->setCeilingPlane(sectors[0]->getCeilingPlane());
 		}
+	}
 
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if(front && back)
+	// The fifth "share" argument copies from one side of the line to the
+	// other
+	if (front && back)
+	{
+		int share = line->intProperty("arg4");
+		if (share & 15)
 		{
-			int share = line->intProperty("arg4");
+			touch(front);
+			touch(back);
+		}
 
-			if((share & 3) == 1)
-				back->setFloorPlane(front->getFloorPlane());
-			else if((share & 3) == 2)
-				front->setFloorPlane(back->getFloorPlane());
+		if ((share & 3) == 1)
+			back->setFloorPlane(front->getFloorPlane());
+		else if ((share & 3) == 2)
+			front->setFloorPlane(back->getFloorPlane());
 
-			if((share & 12) == 4)
-				back->setCeilingPlane(front->getCeilingPlane());
-			else if((share & 12) == 8)
-				front->setCeilingPlane(back->getCeilingPlane());
-		}
+		if ((share & 12) == 4)
+			back->setCeilingPlane(front->getCeilingPlane());
+		else if ((share & 12) == 8)
+			front->setCeilingPlane(back->getCeilingPlane());
 	}
 }
 
-
 /* MapSpecials::applyPlaneAlign
  * Applies a Plane_Align special on [line], to [target] from [model]
  *******************************************************************/
@@ -772,6 +1149,8 @@ void MapSpecials::applyPlaneAlign(MapLine* line, MapSector* target, MapSector* m
 	fpoint3_t p1(line->x1(), line->y1(), modelz);
 	fpoint3_t p2(line->x2(), line->y2(), modelz);
 	fpoint3_t p3(furthest_vertex->point(), targetz);
+	touch(target);
+	touch(model);
 	target->setPlane<p>(MathStuff::planeFromTriangle(p1, p2, p3));
 }
 
@@ -795,9 +1174,12 @@ void MapSpecials::applyLineSlopeThing(SLADEMap* map, MapThing* thing)
 
 	vector<MapLine*> lines;
 	map->getLinesById(lineid, lines);
+	if (indexing)
+		line_ids.insert(lineid);
 	for (unsigned b = 0; b < lines.size(); b++)
 	{
 		MapLine* line = lines[b];
+		touchLine(line);
 
 		// Line slope things only affect the sector on the side of the line
 		// that faces the thing
@@ -824,6 +1206,8 @@ void MapSpecials::applyLineSlopeThing(SLADEMap* map, MapThing* thing)
 		}
 
 		// Three points: endpoints of the line, and the thing itself
+		touch(containing_sector);
+		touch(target);
 		plane_t target_plane = target->getPlane<p>();
 		fpoint3_t p1(lines[b]->x1(), lines[b]->y1(), target_plane.height_at(lines[b]->point1()));
 		fpoint3_t p2(lines[b]->x2(), lines[b]->y2(), target_plane.height_at(lines[b]->point2()));
@@ -877,6 +1261,7 @@ void MapSpecials::applySectorTiltThing(SLADEMap* map, MapThing* thing)
 	// and y by multiplying by cos and sin of the thing's facing angle.
 	fpoint3_t vec2(cos_tilt * cos_angle, cos_tilt * sin_angle, sin_tilt);
 
+	touch(target);
 	target->setPlane<p>(MathStuff::planeFromTriangle(point, point + vec1, point + vec2));
 }
 
@@ -895,6 +1280,8 @@ void MapSpecials::applyVavoomSlopeThing(SLADEMap* map, MapThing* thing)
 	int tid = thing->intProperty("id");
 	vector<MapLine*> lines;
 	target->getLines(lines);
+	for (auto line : lines)
+		touchLine(line);
 
 	// TODO unclear if this is the same order that ZDoom would go through the
 	// lines, which matters if two lines have the same first arg
@@ -917,6 +1304,7 @@ void MapSpecials::applyVavoomSlopeThing(SLADEMap* map, MapThing* thing)
 		fpoint3_t p2(lines[a]->x1(), lines[a]->y1(), height);
 		fpoint3_t p3(lines[a]->x2(), lines[a]->y2(), height);
 
+		touch(target);
 		target->setPlane<p>(MathStuff::planeFromTriangle(p1, p2, p3));
 		return;
 	}
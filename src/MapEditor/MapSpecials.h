@@ -22,8 +22,70 @@ class MapSpecials
 	vector<sector_colour_t> sector_colours;
 	vector<sector_colour_t> sector_fadecolours;
 
+	// Slope specials/things, recorded in the order they were applied. Sectors
+	// affected (read or written) by the same special are joined into a group,
+	// so that when a sector is modified only the specials in its group need to
+	// be reapplied
+	enum
+	{
+		SLOPE_PLANE_ALIGN,
+		SLOPE_THING,
+		SLOPE_COPY_THING,
+		SLOPE_VERTEX_HEIGHTS,
+		SLOPE_PLANE_COPY
+	};
+	struct slope_op_t
+	{
+		uint8_t		type;
+		MapObject*	object;
+		int			sector;	// Any sector affected by the special
+	};
+
+	// Sector_Set3dFloor specials
+	struct floor_op_t
+	{
+		MapLine*	line;
+		int			control;
+		vector<int>	targets;
+	};
+
+	bool				index_valid;
+	bool				indexing;
+	string				index_port;
+	long				index_time;
+	unsigned			index_counts[5];
+	unsigned			index_last_id;
+	vector<slope_op_t>	slope_ops;
+	vector<floor_op_t>	floor_ops;
+	vector<int>			sector_groups;
+	vector<int>			sector_tags;
+	vector<MapSector*>	side_sectors;
+	vector<bool>		line_relevant;
+	vector<bool>		thing_relevant;
+	std::set<int>		line_ids;
+	vector<MapSector*>*	touched;
+	VertexHeightMap		vertex_floor_heights;
+	VertexHeightMap		vertex_ceiling_heights;
+
+	void	beginIndex(SLADEMap* map);
+	void	endIndex(SLADEMap* map);
+	bool	needsFullUpdate(SLADEMap* map, vector<MapObject*>& modified);
+	void	processModified(SLADEMap* map, vector<MapObject*>& modified);
+	int		sectorGroup(int sector);
+	void	touch(MapSector* sector);
+	void	touchLine(MapLine* line);
+	void	runSlopeOp(SLADEMap* map, uint8_t type, MapObject* object);
+	void	applySlopeOp(SLADEMap* map, const slope_op_t& op);
+	void	add3dFloor(extra_floor_t& extra_floor, MapSector* control_sector, MapSector* target);
+	bool	build3dFloor(MapLine* line, extra_floor_t& extra_floor);
+
 	void	processZDoomSlopes(SLADEMap* map);
-	void  processEternitySlopes(SLADEMap* map);
+	void	processEternitySlopes(SLADEMap* map);
+	void	applyPlaneAlignLine(MapLine* line);
+	void	applySlopeThing(SLADEMap* map, MapThing* thing);
+	void	applySlopeCopyThing(SLADEMap* map, MapThing* thing);
+	void	applyVertexHeights(MapSector* sector);
+	void	applyPlaneCopyLine(SLADEMap* map, MapLine* line);
 	template<PlaneType>
 	void	applyPlaneAlign(MapLine* line, MapSector* sector, MapSector* model_sector);
 	template<PlaneType>
@@ -38,7 +100,10 @@ class MapSpecials
 	void	applyVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights);
 
 public:
+	MapSpecials();
+
 	void	reset();
+	void	invalidateIndex() { index_valid = false; }
 
 	void	processMapSpecials(SLADEMap* map);
 
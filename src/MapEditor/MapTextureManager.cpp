@@ -104,6 +104,35 @@ Palette* MapTextureManager::getResourcePalette()
 		return theMainWindow->getPaletteChooser()->getSelectedPalette();
 }
 
+/* MapTextureManager::getImageEntry
+ * Returns the single image entry that the texture (or flat if [flat]
+ * is true) matching [name] would be loaded from, or nullptr if there
+ * is none (eg. it is a composite texture). See getTexture/getFlat
+ *******************************************************************/
+ArchiveEntry* MapTextureManager::getImageEntry(string name, bool flat)
+{
+	ArchiveEntry* entry = nullptr;
+	if (flat)
+	{
+		entry = theResourceManager->getTextureEntry(name, "hires", archive);
+		if (entry == nullptr)
+			entry = theResourceManager->getTextureEntry(name, "flats", archive);
+		if (entry == nullptr)
+			entry = theResourceManager->getFlatEntry(name, archive);
+	}
+	else
+	{
+		// Look for stand-alone textures first (hires, then textures), same as
+		// getTexture. If there are none it will be a composite texture (or
+		// missing), which has no single image entry
+		entry = theResourceManager->getTextureEntry(name, "hires", archive);
+		if (entry == nullptr)
+			entry = theResourceManager->getTextureEntry(name, "textures", archive);
+	}
+
+	return entry;
+}
+
 /* MapTextureManager::getTexture
  * Returns the texture matching [name]. Loads it from resources if
  * necessary. If [mixed] is true, flats are also searched if no
@@ -14,6 +14,7 @@ struct map_tex_t
 };
 
 class Archive;
+class ArchiveEntry;
 struct map_texinfo_t
 {
 	string			shortName;
@@ -65,6 +66,8 @@ public:
 	void	buildTexInfoList();
 
 	Palette*	getResourcePalette();
+	Palette*	getPalette() { return palette; }
+	ArchiveEntry*	getImageEntry(string name, bool flat);
 	GLTexture*		getTexture(string name, bool mixed);
 	GLTexture*		getFlat(string name, bool mixed);
 	GLTexture*		getSprite(string name, string translation = "", string palette = "");
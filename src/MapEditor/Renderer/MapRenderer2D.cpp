@@ -227,9 +227,10 @@ void MapRenderer2D::renderVerticesImmediate()
 		glNewList(list_vertices, GL_COMPILE_AND_EXECUTE);
 
 		// Draw all vertices
+		const MapArrays& arr = map->arrays();
 		glBegin(GL_POINTS);
-		for (unsigned a = 0; a < map->nVertices(); a++)
-			glVertex2d(map->getVertex(a)->xPos(), map->getVertex(a)->yPos());
+		for (unsigned a = 0; a < arr.vertex_x.size(); a++)
+			glVertex2d(arr.vertex_x[a], arr.vertex_y[a]);
 		glEnd();
 
 		glEndList();
@@ -425,6 +426,7 @@ void MapRenderer2D::renderLinesImmediate(bool show_direction, float alpha)
 	glNewList(list_lines, GL_COMPILE_AND_EXECUTE);
 
 	// Draw all lines
+	const MapArrays& arr = map->arrays();
 	rgba_t col;
 	MapLine* line = nullptr;
 	double x1, y1, x2, y2;
@@ -433,10 +435,10 @@ void MapRenderer2D::renderLinesImmediate(bool show_direction, float alpha)
 	{
 		// Get line info
 		line = map->getLine(a);
-		x1 = line->v1()->xPos();
-		y1 = line->v1()->yPos();
-		x2 = line->v2()->xPos();
-		y2 = line->v2()->yPos();
+		x1 = arr.vertex_x[arr.line_v1[a]];
+		y1 = arr.vertex_y[arr.line_v1[a]];
+		x2 = arr.vertex_x[arr.line_v2[a]];
+		y2 = arr.vertex_y[arr.line_v2[a]];
 
 		// Get line colour
 		col = lineColour(line);
@@ -2812,13 +2814,14 @@ void MapRenderer2D::updateVerticesVBO()
 		glGenBuffers(1, &vbo_vertices);
 
 	// Fill vertices VBO
+	const MapArrays& arr = map->arrays();
 	int nfloats = map->nVertices()*2;
 	GLfloat* verts = new GLfloat[nfloats];
 	unsigned i = 0;
 	for (unsigned a = 0; a < map->nVertices(); a++)
 	{
-		verts[i++] = map->getVertex(a)->xPos();
-		verts[i++] = map->getVertex(a)->yPos();
+		verts[i++] = arr.vertex_x[a];
+		verts[i++] = arr.vertex_y[a];
 	}
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*nfloats, verts, GL_STATIC_DRAW);
@@ -2847,6 +2850,7 @@ void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 	if (show_direction) vpl = 4;
 
 	// Fill lines VBO
+	const MapArrays& arr = map->arrays();
 	int nverts = map->nLines()*vpl;
 	glvert_t* lines = new glvert_t[nverts];
 	unsigned v = 0;
@@ -2861,10 +2865,10 @@ void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 		alpha = base_alpha*col.fa();
 
 		// Set line vertices
-		lines[v].x = line->v1()->xPos();
-		lines[v].y = line->v1()->yPos();
-		lines[v+1].x = line->v2()->xPos();
-		lines[v+1].y = line->v2()->yPos();
+		lines[v].x = arr.vertex_x[arr.line_v1[a]];
+		lines[v].y = arr.vertex_y[arr.line_v1[a]];
+		lines[v+1].x = arr.vertex_x[arr.line_v2[a]];
+		lines[v+1].y = arr.vertex_y[arr.line_v2[a]];
 
 		// Set line colour(s)
 		lines[v].r = lines[v+1].r = col.fr();
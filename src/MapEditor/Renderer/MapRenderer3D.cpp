@@ -2169,24 +2169,26 @@ void MapRenderer3D::renderThings()
 	float x1, y1, x2, y2;
 	unsigned update = 0;
 	fseg2_t strafe(cam_position.get2d(), (cam_position + cam_strafe).get2d());
+	const MapArrays& arr = map->arrays();
 	for (unsigned a = 0; a < map->nThings(); a++)
 	{
-		MapThing* thing = map->getThing(a);
 		things[a].flags = things[a].flags & ~DRAWN;
 
 		// Check side of camera
+		fpoint2_t pos(arr.thing_x[a], arr.thing_y[a]);
 		if (cam_pitch > -0.9 && cam_pitch < 0.9)
 		{
-			if (MathStuff::lineSide(thing->point(), strafe) > 0)
+			if (MathStuff::lineSide(pos, strafe) > 0)
 				continue;
 		}
 
 		// Check thing distance if needed
-		dist = MathStuff::distance(cam_position.get2d(), thing->point());
+		dist = MathStuff::distance(cam_position.get2d(), pos);
 		if (mdist > 0 && dist > mdist)
 			continue;
 
 		// Update thing if needed
+		MapThing* thing = map->getThing(a);
 		if (things[a].updated_time < thing->modifiedTime() ||
 		        (things[a].sector && (
 				things[a].updated_time < things[a].sector->modifiedTime() ||
@@ -47,6 +47,7 @@ namespace MapEditor
 		void	animateSelectionChange(const ItemSelection &selection);
 		void	animateHilightChange(const MapEditor::Item& old_item, MapObject* old_object = nullptr);
 		void	addAnimation(std::unique_ptr<MCAnimation> animation);
+		void	clearAnimations() { animations_.clear(); }
 
 	private:
 		MapEditContext&	context_;
@@ -0,0 +1,407 @@
+/*******************************************************************
+ * SLADE - It's a Doom Editor
+ * Copyright (C) 2008-2014 Simon Judd
+ *
+ * Email:       sirjuddington@gmail.com
+ * Web:         http://slade.mancubus.net
+ * Filename:    MapArrays.cpp
+ * Description: MapArrays class, packed arrays of commonly used map
+ *              object properties (vertex positions, line vertices,
+ *              sector heights etc.)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *******************************************************************/
+
+
+/*******************************************************************
+ * INCLUDES
+ *******************************************************************/
+#include "Main.h"
+#include "MapArrays.h"
+#include "Graphics/SImage/SImageKernels.h"
+#include "SLADEMap.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MA_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define MA_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define MA_TARGET_AVX2
+#else
+#define MA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+
+/*******************************************************************
+ * FUNCTIONS
+ *******************************************************************/
+
+/* setVertex, setLine, setSector, setThing
+ * Sets the array entries for the given object (at its index)
+ *******************************************************************/
+static void setVertex(MapArrays& arrays, unsigned index, MapVertex* vertex)
+{
+	arrays.vertex_x[index] = vertex->xPos();
+	arrays.vertex_y[index] = vertex->yPos();
+}
+
+static void setLine(MapArrays& arrays, unsigned index, MapLine* line)
+{
+	arrays.line_v1[index] = line->v1Index();
+	arrays.line_v2[index] = line->v2Index();
+	arrays.line_flags[index] = line->intProperty("flags");
+	arrays.line_special[index] = line->intProperty("special");
+}
+
+static void setSector(MapArrays& arrays, unsigned index, MapSector* sector)
+{
+	arrays.sector_floor[index] = sector->getFloorHeight();
+	arrays.sector_ceiling[index] = sector->getCeilingHeight();
+	arrays.sector_light[index] = sector->getLightLevel();
+}
+
+static void setThing(MapArrays& arrays, unsigned index, MapThing* thing)
+{
+	arrays.thing_x[index] = thing->xPos();
+	arrays.thing_y[index] = thing->yPos();
+	arrays.thing_type[index] = thing->getType();
+}
+
+
+
+/*******************************************************************
+ * SCALAR SCANS
+ *******************************************************************/
+namespace
+{
+	// Points further away than this are never 'nearest'
+	const double NEAREST_INIT = 999999999;
+
+	// Nearest point scan of points [start] to [count], continuing on from
+	// [best_dist] and [best_index]
+	void nearestPointScalar(const double* x, const double* y, unsigned start, unsigned count, double px, double py, double& best_dist, int& best_index)
+	{
+		for (unsigned a = start; a < count; a++)
+		{
+			double dist = fabs(x[a] - px) + fabs(y[a] - py);
+			if (dist < best_dist)
+			{
+				best_index = a;
+				best_dist = dist;
+			}
+		}
+	}
+
+	// Combines the per-lane nearest points from a SIMD scan into [best_dist]
+	// and [best_index], taking the lowest index if distances are equal (so
+	// the result is the same as a scalar scan)
+	void reduceLanes(const double* dist, const double* index, unsigned lanes, double& best_dist, int& best_index)
+	{
+		for (unsigned l = 0; l < lanes; l++)
+		{
+			if (index[l] < 0)
+				continue;
+
+			if (dist[l] < best_dist || (dist[l] == best_dist && (best_index < 0 || (int)index[l] < best_index)))
+			{
+				best_dist = dist[l];
+				best_index = (int)index[l];
+			}
+		}
+	}
+
+	// Line bounding box scan of lines from [start]
+	void linesNearScalar(const MapArrays& arr, unsigned start, double px, double py, double dist, vector<unsigned>& list)
+	{
+		for (unsigned a = start; a < arr.line_v1.size(); a++)
+		{
+			int v1 = arr.line_v1[a];
+			int v2 = arr.line_v2[a];
+			if (v1 < 0 || v2 < 0)
+				continue;
+
+			double x1 = arr.vertex_x[v1];
+			double y1 = arr.vertex_y[v1];
+			double x2 = arr.vertex_x[v2];
+			double y2 = arr.vertex_y[v2];
+			if (px < MIN(x1, x2) - dist || px > MAX(x1, x2) + dist ||
+				py < MIN(y1, y2) - dist || py > MAX(y1, y2) + dist)
+				continue;
+
+			list.push_back(a);
+		}
+	}
+}
+
+
+/*******************************************************************
+ * SSE2 SCANS
+ *******************************************************************/
+#ifdef MA_SSE2
+namespace
+{
+	void nearestPointSSE2(const double* x, const double* y, unsigned count, double px, double py, double& best_dist, int& best_index)
+	{
+		__m128d sign = _mm_set1_pd(-0.0);
+		__m128d vpx = _mm_set1_pd(px);
+		__m128d vpy = _mm_set1_pd(py);
+		__m128d best = _mm_set1_pd(best_dist);
+		__m128d best_i = _mm_set1_pd(-1);
+		__m128d index = _mm_set_pd(1, 0);
+		__m128d step = _mm_set1_pd(2);
+		unsigned a = 0;
+		for (; a + 2 <= count; a += 2)
+		{
+			// fabs(x - px) + fabs(y - py), same as the scalar version
+			__m128d dx = _mm_andnot_pd(sign, _mm_sub_pd(_mm_loadu_pd(x + a), vpx));
+			__m128d dy = _mm_andnot_pd(sign, _mm_sub_pd(_mm_loadu_pd(y + a), vpy));
+			__m128d dist = _mm_add_pd(dx, dy);
+
+			__m128d lt = _mm_cmplt_pd(dist, best);
+			best = _mm_or_pd(_mm_and_pd(lt, dist), _mm_andnot_pd(lt, best));
+			best_i = _mm_or_pd(_mm_and_pd(lt, index), _mm_andnot_pd(lt, best_i));
+			index = _mm_add_pd(index, step);
+		}
+
+		double lane_dist[2], lane_index[2];
+		_mm_storeu_pd(lane_dist, best);
+		_mm_storeu_pd(lane_index, best_i);
+		reduceLanes(lane_dist, lane_index, 2, best_dist, best_index);
+		nearestPointScalar(x, y, a, count, px, py, best_dist, best_index);
+	}
+}
+#endif
+
+
+/*******************************************************************
+ * AVX2 SCANS
+ *******************************************************************/
+#ifdef MA_AVX2
+namespace
+{
+	MA_TARGET_AVX2 void nearestPointAVX2(const double* x, const double* y, unsigned count, double px, double py, double& best_dist, int& best_index)
+	{
+		__m256d sign = _mm256_set1_pd(-0.0);
+		__m256d vpx = _mm256_set1_pd(px);
+		__m256d vpy = _mm256_set1_pd(py);
+		__m256d best = _mm256_set1_pd(best_dist);
+		__m256d best_i = _mm256_set1_pd(-1);
+		__m256d index = _mm256_set_pd(3, 2, 1, 0);
+		__m256d step = _mm256_set1_pd(4);
+		unsigned a = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			__m256d dx = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(x + a), vpx));
+			__m256d dy = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(y + a), vpy));
+			__m256d dist = _mm256_add_pd(dx, dy);
+
+			__m256d lt = _mm256_cmp_pd(dist, best, _CMP_LT_OQ);
+			best = _mm256_blendv_pd(best, dist, lt);
+			best_i = _mm256_blendv_pd(best_i, index, lt);
+			index = _mm256_add_pd(index, step);
+		}
+
+		double lane_dist[4], lane_index[4];
+		_mm256_storeu_pd(lane_dist, best);
+		_mm256_storeu_pd(lane_index, best_i);
+		reduceLanes(lane_dist, lane_index, 4, best_dist, best_index);
+		nearestPointScalar(x, y, a, count, px, py, best_dist, best_index);
+	}
+
+	MA_TARGET_AVX2 void linesNearAVX2(const MapArrays& arr, double px, double py, double dist, vector<unsigned>& list)
+	{
+		const int* line_v1 = arr.line_v1.data();
+		const int* line_v2 = arr.line_v2.data();
+		const double* vertex_x = arr.vertex_x.data();
+		const double* vertex_y = arr.vertex_y.data();
+		__m128i none = _mm_set1_epi32(-1);
+		__m256d vpx = _mm256_set1_pd(px);
+		__m256d vpy = _mm256_set1_pd(py);
+		__m256d vdist = _mm256_set1_pd(dist);
+		unsigned count = arr.line_v1.size();
+		unsigned a = 0;
+		for (; a + 4 <= count; a += 4)
+		{
+			// Get vertex indices, lines without both vertices are ignored
+			// (and use vertex 0 so the gathers below stay in bounds)
+			__m128i i1 = _mm_loadu_si128((const __m128i*)(line_v1 + a));
+			__m128i i2 = _mm_loadu_si128((const __m128i*)(line_v2 + a));
+			__m128i valid = _mm_and_si128(_mm_cmpgt_epi32(i1, none), _mm_cmpgt_epi32(i2, none));
+			int valid_mask = _mm_movemask_ps(_mm_castsi128_ps(valid));
+			if (valid_mask == 0)
+				continue;
+			i1 = _mm_and_si128(i1, valid);
+			i2 = _mm_and_si128(i2, valid);
+
+			__m256d x1 = _mm256_i32gather_pd(vertex_x, i1, 8);
+			__m256d y1 = _mm256_i32gather_pd(vertex_y, i1, 8);
+			__m256d x2 = _mm256_i32gather_pd(vertex_x, i2, 8);
+			__m256d y2 = _mm256_i32gather_pd(vertex_y, i2, 8);
+
+			// Same comparisons as the scalar version (not less than min - dist
+			// and not greater than max + dist)
+			__m256d in_x = _mm256_and_pd(
+				_mm256_cmp_pd(vpx, _mm256_sub_pd(_mm256_min_pd(x1, x2), vdist), _CMP_NLT_UQ),
+				_mm256_cmp_pd(vpx, _mm256_add_pd(_mm256_max_pd(x1, x2), vdist), _CMP_NGT_UQ));
+			__m256d in_y = _mm256_and_pd(
+				_mm256_cmp_pd(vpy, _mm256_sub_pd(_mm256_min_pd(y1, y2), vdist), _CMP_NLT_UQ),
+				_mm256_cmp_pd(vpy, _mm256_add_pd(_mm256_max_pd(y1, y2), vdist), _CMP_NGT_UQ));
+			int mask = _mm256_movemask_pd(_mm256_and_pd(in_x, in_y)) & valid_mask;
+			for (unsigned l = 0; l < 4; l++)
+			{
+				if (mask & (1 << l))
+					list.push_back(a + l);
+			}
+		}
+
+		linesNearScalar(arr, a, px, py, dist, list);
+	}
+}
+#endif
+
+
+/*******************************************************************
+ * MAPARRAYS CLASS FUNCTIONS
+ *******************************************************************/
+
+/* MapArrays::clear
+ * Clears all arrays
+ *******************************************************************/
+void MapArrays::clear()
+{
+	vertex_x.clear();
+	vertex_y.clear();
+	line_v1.clear();
+	line_v2.clear();
+	line_flags.clear();
+	line_special.clear();
+	sector_floor.clear();
+	sector_ceiling.clear();
+	sector_light.clear();
+	thing_x.clear();
+	thing_y.clear();
+	thing_type.clear();
+}
+
+/* MapArrays::rebuild
+ * Rebuilds all arrays from the objects in [map]
+ *******************************************************************/
+void MapArrays::rebuild(SLADEMap& map)
+{
+	// Vertices
+	vertex_x.resize(map.nVertices());
+	vertex_y.resize(map.nVertices());
+	for (unsigned a = 0; a < map.nVertices(); a++)
+		setVertex(*this, a, map.getVertex(a));
+
+	// Lines
+	line_v1.resize(map.nLines());
+	line_v2.resize(map.nLines());
+	line_flags.resize(map.nLines());
+	line_special.resize(map.nLines());
+	for (unsigned a = 0; a < map.nLines(); a++)
+		setLine(*this, a, map.getLine(a));
+
+	// Sectors
+	sector_floor.resize(map.nSectors());
+	sector_ceiling.resize(map.nSectors());
+	sector_light.resize(map.nSectors());
+	for (unsigned a = 0; a < map.nSectors(); a++)
+		setSector(*this, a, map.getSector(a));
+
+	// Things
+	thing_x.resize(map.nThings());
+	thing_y.resize(map.nThings());
+	thing_type.resize(map.nThings());
+	for (unsigned a = 0; a < map.nThings(); a++)
+		setThing(*this, a, map.getThing(a));
+}
+
+/* MapArrays::update
+ * Updates the array entries for [object] (which must be in the map,
+ * at the same index as when the arrays were last rebuilt)
+ *******************************************************************/
+void MapArrays::update(MapObject* object)
+{
+	unsigned index = object->getIndex();
+	switch (object->getObjType())
+	{
+	case MOBJ_VERTEX:
+		if (index < vertex_x.size())
+			setVertex(*this, index, (MapVertex*)object);
+		break;
+	case MOBJ_LINE:
+		if (index < line_v1.size())
+			setLine(*this, index, (MapLine*)object);
+		break;
+	case MOBJ_SECTOR:
+		if (index < sector_floor.size())
+			setSector(*this, index, (MapSector*)object);
+		break;
+	case MOBJ_THING:
+		if (index < thing_x.size())
+			setThing(*this, index, (MapThing*)object);
+		break;
+	default:
+		break;
+	}
+}
+
+/* MapArrays::nearestPoint
+ * Returns the index of the first point in [x],[y] with the smallest
+ * 'quick' (taxicab) distance to [px],[py], or -1 if there are no
+ * points
+ *******************************************************************/
+int MapArrays::nearestPoint(const vector<double>& x, const vector<double>& y, double px, double py)
+{
+	double best_dist = NEAREST_INIT;
+	int best_index = -1;
+	unsigned count = MIN(x.size(), y.size());
+
+#ifdef MA_AVX2
+	if (SImageKernels::level() >= SImageKernels::AVX2)
+	{
+		nearestPointAVX2(x.data(), y.data(), count, px, py, best_dist, best_index);
+		return best_index;
+	}
+#endif
+#ifdef MA_SSE2
+	if (SImageKernels::level() >= SImageKernels::SSE2)
+	{
+		nearestPointSSE2(x.data(), y.data(), count, px, py, best_dist, best_index);
+		return best_index;
+	}
+#endif
+	nearestPointScalar(x.data(), y.data(), 0, count, px, py, best_dist, best_index);
+	return best_index;
+}
+
+/* MapArrays::linesNear
+ * Adds the index of each line whose bounding box (expanded by [dist])
+ * contains [px],[py] to [list], in index order
+ *******************************************************************/
+void MapArrays::linesNear(double px, double py, double dist, vector<unsigned>& list) const
+{
+#ifdef MA_AVX2
+	// (No vertices means no line can have valid vertex indices)
+	if (SImageKernels::level() >= SImageKernels::AVX2 && !vertex_x.empty())
+		return linesNearAVX2(*this, px, py, dist, list);
+#endif
+	linesNearScalar(*this, 0, px, py, dist, list);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+class SLADEMap;
+class MapObject;
+
+// -----------------------------------------------------------------------------
+// Packed (structure-of-arrays) copy of the map object properties most often
+// read when going through every object in a map (eg. in renderers, nearest
+// object queries and map checks), indexed by object index. This avoids
+// following pointers from each line to its vertices, and property lookups.
+//
+// Kept up to date by SLADEMap (see SLADEMap::arrays), which only updates the
+// entries of modified objects unless objects have been added or removed
+// -----------------------------------------------------------------------------
+class MapArrays
+{
+public:
+	// Vertices
+	vector<double>	vertex_x;
+	vector<double>	vertex_y;
+
+	// Lines
+	vector<int>		line_v1;		// Vertex index
+	vector<int>		line_v2;		// Vertex index
+	vector<int>		line_flags;
+	vector<int>		line_special;
+
+	// Sectors
+	vector<short>	sector_floor;
+	vector<short>	sector_ceiling;
+	vector<short>	sector_light;
+
+	// Things
+	vector<double>	thing_x;
+	vector<double>	thing_y;
+	vector<short>	thing_type;
+
+	void	clear();
+	void	rebuild(SLADEMap& map);
+	void	update(MapObject* object);
+
+	// Scans (using SSE2/AVX2 where supported, see SImageKernels::level)
+
+	// Returns the index of the first point in [x],[y] with the smallest 'quick'
+	// (taxicab) distance to [px],[py], or -1 if there are no points
+	static int	nearestPoint(const vector<double>& x, const vector<double>& y, double px, double py);
+
+	// Adds the index of each line whose bounding box (expanded by [dist])
+	// contains [px],[py] to [list], in index order
+	void	linesNear(double px, double py, double dist, vector<unsigned>& list) const;
+};
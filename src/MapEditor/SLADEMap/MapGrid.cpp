@@ -0,0 +1,333 @@
+/*******************************************************************
+ * SLADE - It's a Doom Editor
+ * Copyright (C) 2008-2014 Simon Judd
+ *
+ * Email:       sirjuddington@gmail.com
+ * Web:         http://slade.mancubus.net
+ * Filename:    MapGrid.cpp
+ * Description: MapGrid class, a spatial grid of map vertices and
+ *              lines for fast lookups of objects near a point/area
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *******************************************************************/
+
+
+/*******************************************************************
+ * INCLUDES
+ *******************************************************************/
+#include "Main.h"
+#include "MapGrid.h"
+#include "MapLine.h"
+#include "MapVertex.h"
+
+
+/*******************************************************************
+ * VARIABLES
+ *******************************************************************/
+namespace
+{
+	// Size of each grid cell in map units
+	const double CELL_SIZE = 256;
+
+	// Lines covering more cells than this go in the 'large' list
+	const int MAX_LINE_CELLS = 64;
+}
+
+
+/*******************************************************************
+ * FUNCTIONS
+ *******************************************************************/
+
+/* sortByIndex
+ * Sorts [list] by object index and removes duplicates
+ *******************************************************************/
+template<typename T> static void sortByIndex(vector<T*>& list, size_t start)
+{
+	std::sort(list.begin() + start, list.end(), [](T* left, T* right)
+	{
+		return left->getIndex() < right->getIndex();
+	});
+	list.erase(std::unique(list.begin() + start, list.end()), list.end());
+}
+
+
+/*******************************************************************
+ * MAPGRID CLASS FUNCTIONS
+ *******************************************************************/
+
+/* MapGrid::CellRange::large
+ * Returns true if the range covers too many cells to add a line to
+ * each of them
+ *******************************************************************/
+bool MapGrid::CellRange::large() const
+{
+	return (int64_t)(x2 - x1 + 1) * (y2 - y1 + 1) > MAX_LINE_CELLS;
+}
+
+/* MapGrid::clear
+ * Removes everything from the grid
+ *******************************************************************/
+void MapGrid::clear()
+{
+	cells_.clear();
+	vertex_cells_.clear();
+	line_cells_.clear();
+	large_lines_.clear();
+}
+
+/* MapGrid::updateVertex
+ * Adds [vertex] to the grid, or moves it to the correct cell if its
+ * position has changed
+ *******************************************************************/
+void MapGrid::updateVertex(MapVertex* vertex)
+{
+	auto key = cellKey(cellCoord(vertex->xPos()), cellCoord(vertex->yPos()));
+	auto it  = vertex_cells_.find(vertex);
+	if (it != vertex_cells_.end())
+	{
+		if (it->second == key)
+			return;
+
+		removeVertex(vertex);
+	}
+
+	cells_[key].vertices.push_back(vertex);
+	vertex_cells_[vertex] = key;
+}
+
+/* MapGrid::removeVertex
+ * Removes [vertex] from the grid
+ *******************************************************************/
+void MapGrid::removeVertex(MapVertex* vertex)
+{
+	auto it = vertex_cells_.find(vertex);
+	if (it == vertex_cells_.end())
+		return;
+
+	auto cell = cells_.find(it->second);
+	if (cell != cells_.end())
+	{
+		auto& list = cell->second.vertices;
+		list.erase(std::remove(list.begin(), list.end(), vertex), list.end());
+		if (list.empty() && cell->second.lines.empty())
+			cells_.erase(cell);
+	}
+
+	vertex_cells_.erase(it);
+}
+
+/* MapGrid::updateLine
+ * Adds [line] to the grid, or moves it to the correct cells if it
+ * has changed
+ *******************************************************************/
+void MapGrid::updateLine(MapLine* line)
+{
+	if (!line->v1() || !line->v2())
+		return;
+
+	auto range = lineCells(line);
+	auto it    = line_cells_.find(line);
+	if (it != line_cells_.end())
+	{
+		auto& old = it->second;
+		if (old.x1 == range.x1 && old.y1 == range.y1 && old.x2 == range.x2 && old.y2 == range.y2)
+			return;
+
+		removeLineCells(line, old);
+	}
+
+	if (range.large())
+		large_lines_.push_back(line);
+	else
+	{
+		for (int x = range.x1; x <= range.x2; x++)
+			for (int y = range.y1; y <= range.y2; y++)
+				cells_[cellKey(x, y)].lines.push_back(line);
+	}
+
+	line_cells_[line] = range;
+}
+
+/* MapGrid::removeLine
+ * Removes [line] from the grid
+ *******************************************************************/
+void MapGrid::removeLine(MapLine* line)
+{
+	auto it = line_cells_.find(line);
+	if (it == line_cells_.end())
+		return;
+
+	removeLineCells(line, it->second);
+	line_cells_.erase(it);
+}
+
+/* MapGrid::forEachCell
+ * Calls [func] for each (non-empty) cell overlapping the box
+ * [x1,y1]-[x2,y2]
+ *******************************************************************/
+template<typename F> void MapGrid::forEachCell(double x1, double y1, double x2, double y2, F func) const
+{
+	int cx1 = cellCoord(x1);
+	int cy1 = cellCoord(y1);
+	int cx2 = cellCoord(x2);
+	int cy2 = cellCoord(y2);
+
+	// If the box covers more cells than exist, just go through existing cells
+	if ((double)(cx2 - cx1 + 1) * (cy2 - cy1 + 1) > cells_.size())
+	{
+		for (auto& cell : cells_)
+		{
+			int x = (int)(cell.first >> 32);
+			int y = (int)(int32_t)(cell.first & 0xFFFFFFFF);
+			if (x >= cx1 && x <= cx2 && y >= cy1 && y <= cy2)
+				func(cell.second);
+		}
+		return;
+	}
+
+	for (int x = cx1; x <= cx2; x++)
+	{
+		for (int y = cy1; y <= cy2; y++)
+		{
+			auto cell = cells_.find(cellKey(x, y));
+			if (cell != cells_.end())
+				func(cell->second);
+		}
+	}
+}
+
+/* MapGrid::vertexAt
+ * Returns the vertex (with the lowest index) exactly at [x,y], or
+ * NULL if none
+ *******************************************************************/
+MapVertex* MapGrid::vertexAt(double x, double y) const
+{
+	auto cell = cells_.find(cellKey(cellCoord(x), cellCoord(y)));
+	if (cell == cells_.end())
+		return nullptr;
+
+	MapVertex* found = nullptr;
+	for (auto vertex : cell->second.vertices)
+		if (vertex->xPos() == x && vertex->yPos() == y && (!found || vertex->getIndex() < found->getIndex()))
+			found = vertex;
+
+	return found;
+}
+
+/* MapGrid::verticesIn
+ * Adds all vertices within the box [x1,y1]-[x2,y2] (inclusive) to
+ * [list], in index order
+ *******************************************************************/
+void MapGrid::verticesIn(double x1, double y1, double x2, double y2, vector<MapVertex*>& list) const
+{
+	auto start = list.size();
+	forEachCell(x1, y1, x2, y2, [&](const Cell& cell)
+	{
+		for (auto vertex : cell.vertices)
+		{
+			if (vertex->xPos() >= x1 && vertex->xPos() <= x2 && vertex->yPos() >= y1 && vertex->yPos() <= y2)
+				list.push_back(vertex);
+		}
+	});
+
+	sortByIndex(list, start);
+}
+
+/* MapGrid::linesIn
+ * Adds all lines with bounding boxes overlapping the box [x1,y1]-
+ * [x2,y2] (inclusive) to [list], in index order
+ *******************************************************************/
+void MapGrid::linesIn(double x1, double y1, double x2, double y2, vector<MapLine*>& list) const
+{
+	auto start   = list.size();
+	auto overlap = [&](MapLine* line)
+	{
+		auto v1 = line->v1();
+		auto v2 = line->v2();
+		return MAX(v1->xPos(), v2->xPos()) >= x1 && MIN(v1->xPos(), v2->xPos()) <= x2 &&
+			MAX(v1->yPos(), v2->yPos()) >= y1 && MIN(v1->yPos(), v2->yPos()) <= y2;
+	};
+
+	forEachCell(x1, y1, x2, y2, [&](const Cell& cell)
+	{
+		for (auto line : cell.lines)
+			if (overlap(line))
+				list.push_back(line);
+	});
+	for (auto line : large_lines_)
+		if (overlap(line))
+			list.push_back(line);
+
+	sortByIndex(list, start);
+}
+
+/* MapGrid::cellCoord
+ * Returns the cell coordinate for map coordinate [value]
+ *******************************************************************/
+int MapGrid::cellCoord(double value)
+{
+	return (int)floor(value / CELL_SIZE);
+}
+
+/* MapGrid::cellKey
+ * Returns the key for the cell at [x,y]
+ *******************************************************************/
+int64_t MapGrid::cellKey(int x, int y)
+{
+	return ((int64_t)x << 32) | (uint32_t)y;
+}
+
+/* MapGrid::lineCells
+ * Returns the range of cells covered by [line]'s bounding box
+ *******************************************************************/
+MapGrid::CellRange MapGrid::lineCells(MapLine* line)
+{
+	auto v1 = line->v1();
+	auto v2 = line->v2();
+
+	CellRange range;
+	range.x1 = cellCoord(MIN(v1->xPos(), v2->xPos()));
+	range.y1 = cellCoord(MIN(v1->yPos(), v2->yPos()));
+	range.x2 = cellCoord(MAX(v1->xPos(), v2->xPos()));
+	range.y2 = cellCoord(MAX(v1->yPos(), v2->yPos()));
+	return range;
+}
+
+/* MapGrid::removeLineCells
+ * Removes [line] from all cells in [range]
+ *******************************************************************/
+void MapGrid::removeLineCells(MapLine* line, const CellRange& range)
+{
+	if (range.large())
+	{
+		large_lines_.erase(std::remove(large_lines_.begin(), large_lines_.end(), line), large_lines_.end());
+		return;
+	}
+
+	for (int x = range.x1; x <= range.x2; x++)
+	{
+		for (int y = range.y1; y <= range.y2; y++)
+		{
+			auto cell = cells_.find(cellKey(x, y));
+			if (cell == cells_.end())
+				continue;
+
+			auto& list = cell->second.lines;
+			list.erase(std::remove(list.begin(), list.end(), line), list.end());
+			if (list.empty() && cell->second.vertices.empty())
+				cells_.erase(cell);
+		}
+	}
+}
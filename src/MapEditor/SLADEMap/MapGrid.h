@@ -0,0 +1,56 @@
+#pragma once
+
+#include <unordered_map>
+
+class MapVertex;
+class MapLine;
+
+// -----------------------------------------------------------------------------
+// Spatial grid of map vertices and lines, to avoid checking every vertex/line
+// in the map when looking for those at or near a point/area (eg. when
+// creating vertices, splitting lines or merging architecture).
+//
+// Objects must be updated (or removed) when they move. Lines covering a large
+// number of cells are kept in a separate list that is always checked instead
+// of adding them to every cell
+// -----------------------------------------------------------------------------
+class MapGrid
+{
+public:
+	void clear();
+
+	void updateVertex(MapVertex* vertex);
+	void removeVertex(MapVertex* vertex);
+	void updateLine(MapLine* line);
+	void removeLine(MapLine* line);
+
+	MapVertex* vertexAt(double x, double y) const;
+	void       verticesIn(double x1, double y1, double x2, double y2, vector<MapVertex*>& list) const;
+	void       linesIn(double x1, double y1, double x2, double y2, vector<MapLine*>& list) const;
+
+private:
+	struct Cell
+	{
+		vector<MapVertex*> vertices;
+		vector<MapLine*>   lines;
+	};
+
+	struct CellRange
+	{
+		int x1, y1, x2, y2;
+		bool large() const;
+	};
+
+	std::unordered_map<int64_t, Cell>          cells_;
+	std::unordered_map<MapVertex*, int64_t>    vertex_cells_;
+	std::unordered_map<MapLine*, CellRange>    line_cells_;
+	vector<MapLine*>                           large_lines_;
+
+	static int       cellCoord(double value);
+	static int64_t   cellKey(int x, int y);
+	static CellRange lineCells(MapLine* line);
+
+	void removeLineCells(MapLine* line, const CellRange& range);
+
+	template<typename F> void forEachCell(double x1, double y1, double x2, double y2, F func) const;
+};
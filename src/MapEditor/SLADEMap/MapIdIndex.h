@@ -0,0 +1,146 @@
+#pragma once
+
+#include <unordered_map>
+
+// -----------------------------------------------------------------------------
+// Index of map objects by integer keys (sector tags, line/thing ids, special
+// args etc.), to avoid scanning every object in the map when looking up
+// objects by tag or id. Each object can be indexed under multiple keys, and
+// a key of 0 is never indexed.
+//
+// Also keeps track of the lowest unused positive key, so finding a free
+// tag/id doesn't require a search
+// -----------------------------------------------------------------------------
+template<typename T> class MapIdIndex
+{
+public:
+	void clear()
+	{
+		objects_.clear();
+		keys_.clear();
+		first_unused_ = 1;
+	}
+
+	// -------------------------------------------------------------------------
+	// Sets the key [object] is indexed under to [key], replacing any previous
+	// key(s)
+	// -------------------------------------------------------------------------
+	void set(T* object, int key)
+	{
+		auto it = keys_.find(object);
+		if (it != keys_.end())
+		{
+			if (it->second.size() == 1 && it->second[0] == key)
+				return;
+
+			removeKeys(object, it->second);
+			keys_.erase(it);
+		}
+
+		if (key == 0)
+			return;
+
+		objects_[key].push_back(object);
+		keys_[object].assign(1, key);
+	}
+
+	// -------------------------------------------------------------------------
+	// Sets the keys [object] is indexed under to [keys], replacing any
+	// previous key(s)
+	// -------------------------------------------------------------------------
+	void set(T* object, vector<int> keys)
+	{
+		keys.erase(std::remove(keys.begin(), keys.end(), 0), keys.end());
+		std::sort(keys.begin(), keys.end());
+		keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+		auto it = keys_.find(object);
+		if (it != keys_.end())
+		{
+			if (it->second == keys)
+				return;
+
+			removeKeys(object, it->second);
+			keys_.erase(it);
+		}
+
+		if (keys.empty())
+			return;
+
+		for (auto key : keys)
+			objects_[key].push_back(object);
+		keys_[object] = std::move(keys);
+	}
+
+	// -------------------------------------------------------------------------
+	// Removes [object] from the index
+	// -------------------------------------------------------------------------
+	void remove(T* object)
+	{
+		auto it = keys_.find(object);
+		if (it == keys_.end())
+			return;
+
+		removeKeys(object, it->second);
+		keys_.erase(it);
+	}
+
+	// -------------------------------------------------------------------------
+	// Adds all objects indexed under [key] with an index of at least [start]
+	// to [list], in index order
+	// -------------------------------------------------------------------------
+	void get(int key, vector<T*>& list, unsigned start = 0) const
+	{
+		auto it = objects_.find(key);
+		if (it == objects_.end())
+			return;
+
+		auto first = list.size();
+		for (auto object : it->second)
+			if (object->getIndex() >= start)
+				list.push_back(object);
+
+		std::sort(list.begin() + first, list.end(), [](T* left, T* right) {
+			return left->getIndex() < right->getIndex();
+		});
+	}
+
+	bool contains(int key) const { return objects_.find(key) != objects_.end(); }
+
+	// -------------------------------------------------------------------------
+	// Returns the lowest positive key with no objects indexed under it
+	// -------------------------------------------------------------------------
+	int firstUnused()
+	{
+		while (contains(first_unused_))
+			++first_unused_;
+
+		return first_unused_;
+	}
+
+private:
+	std::unordered_map<int, vector<T*>> objects_;
+	std::unordered_map<T*, vector<int>> keys_;
+	int                                 first_unused_ = 1;
+
+	void removeKeys(T* object, const vector<int>& keys)
+	{
+		for (auto key : keys)
+		{
+			auto it = objects_.find(key);
+			if (it == objects_.end())
+				continue;
+
+			auto& list = it->second;
+			list.erase(std::remove(list.begin(), list.end(), object), list.end());
+			if (list.empty())
+			{
+				objects_.erase(it);
+
+				// All positive keys below first_unused_ must be in use
+				if (key > 0 && key < first_unused_)
+					first_unused_ = key;
+			}
+		}
+	}
+};
@@ -350,7 +350,11 @@ void MapLine::setIntProperty(const string& key, int value)
 
 	// Id
 	else if (key == "id")
+	{
 		line_id = value;
+		if (parent_map)
+			parent_map->updateIdIndexes(this);
+	}
 
 	// Line property
 	else
@@ -687,6 +691,10 @@ void MapLine::resetInternals()
 		s2->resetPolygon();
 		s2->resetBBox();
 	}
+
+	// Update position in map spatial grid
+	if (parent_map)
+		parent_map->objectGeometryChanged(this);
 }
 
 /* MapLine::flip
@@ -763,8 +771,18 @@ void MapLine::readBackup(mobj_backup_t* backup)
 	}
 
 	// Sides
-	MapObject* s1 = parent_map->getObjectById(backup->props_internal["s1"]);
-	MapObject* s2 = parent_map->getObjectById(backup->props_internal["s2"]);
+	unsigned s1_id = backup->props_internal["s1"];
+	unsigned s2_id = backup->props_internal["s2"];
+	MapObject* s1 = parent_map->getObjectById(s1_id);
+	MapObject* s2 = parent_map->getObjectById(s2_id);
+
+	// A side that no longer exists would have been freed while still
+	// restorable by undo/redo, which shouldn't happen
+	if (s1_id > 0 && !s1)
+		LOG_MESSAGE(1, "Warning: Line %u side1 (object %u) was freed, restoring without it", index, s1_id);
+	if (s2_id > 0 && !s2)
+		LOG_MESSAGE(1, "Warning: Line %u side2 (object %u) was freed, restoring without it", index, s2_id);
+
 	side1 = (MapSide*)s1;
 	side2 = (MapSide*)s2;
 	if (side1) side1->parent = this;
@@ -796,4 +814,8 @@ void MapLine::copy(MapObject* c)
 	//setIntProperty("special", l->intProperty("special"));
 	special = l->special;
 	line_id = l->line_id;
+
+	// Update tag/id indexes
+	if (parent_map)
+		parent_map->updateIdIndexes(this);
 }
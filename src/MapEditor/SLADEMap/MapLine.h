@@ -76,6 +76,10 @@ public:
 	MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, SLADEMap* parent = nullptr);
 	~MapLine();
 
+	// Allocated from a pool (see MapObjectPool.h)
+	static void*	operator new(size_t size) { return MapObjectPool<MapLine>::allocate(size); }
+	static void		operator delete(void* ptr, size_t size) { MapObjectPool<MapLine>::release(ptr, size); }
+
 	bool	isOk() const { return vertex1 && vertex2; }
 
 	MapVertex*		v1() const { return vertex1; }
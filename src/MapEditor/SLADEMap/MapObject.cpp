@@ -118,7 +118,15 @@ void MapObject::setModified()
 		backup(obj_backup);
 	}
 
-	modified_time = App::runTimer();
+	// Record the modification in the parent map's change journal (if the
+	// modified time hasn't changed it will already be recorded)
+	long time = App::runTimer();
+	if (time != modified_time)
+	{
+		modified_time = time;
+		if (parent_map)
+			parent_map->objectModified(this);
+	}
 }
 
 /* MapObject::copy
@@ -247,6 +255,10 @@ void MapObject::setIntProperty(const string& key, int value)
 
 	// Set property
 	properties[key] = value;
+
+	// Update tag/id indexes if needed
+	if (parent_map && (key == "id" || key.StartsWith("arg")))
+		parent_map->updateIdIndexes(this);
 }
 
 /* MapObject::setFloatProperty
@@ -316,6 +328,10 @@ void MapObject::loadFromBackup(mobj_backup_t* backup)
 
 	// Object-specific properties
 	readBackup(backup);
+
+	// Update tag/id indexes
+	if (parent_map)
+		parent_map->updateIdIndexes(this);
 }
 
 /* MapObject::getBackup
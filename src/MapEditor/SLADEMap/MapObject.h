@@ -7,6 +7,7 @@
 #endif
 
 #include "MobjPropertyList.h"
+#include "MapObjectPool.h"
 
 class SLADEMap;
 
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+
+// -----------------------------------------------------------------------------
+// Pool allocator for map objects of type [T], used via class-specific
+// operator new/delete in each map object class.
+//
+// Objects are allocated from large fixed-size blocks, so addresses are stable
+// and objects created together (eg. when reading a map) are contiguous in
+// memory. Freed slots are kept in a free list for reuse. Once every object in
+// the pool has been freed (eg. when a map is closed), the pool is reset so
+// that the next map is allocated sequentially from the start again, and any
+// blocks other than the first are released.
+//
+// Allocations of any size other than sizeof(T) (ie. from a derived class) go
+// through the global operator new/delete instead.
+//
+// Not thread safe, map objects should only be created/deleted from the main
+// thread
+// -----------------------------------------------------------------------------
+template<typename T> class MapObjectPool
+{
+public:
+	static void* allocate(size_t size)
+	{
+		if (size != sizeof(T))
+			return ::operator new(size);
+
+		return instance().allocateSlot();
+	}
+
+	static void release(void* ptr, size_t size)
+	{
+		if (!ptr)
+			return;
+
+		if (size != sizeof(T))
+			::operator delete(ptr);
+		else
+			instance().releaseSlot(ptr);
+	}
+
+	// Returns the number of objects currently allocated from the pool
+	static size_t nAllocated() { return instance().n_allocated_; }
+
+	// Returns the amount of memory (in bytes) currently reserved by the pool
+	static size_t reservedSize() { return instance().blocks_.size() * BLOCK_SIZE * sizeof(Slot); }
+
+private:
+	static const size_t BLOCK_SIZE = 4096;
+
+	union Slot
+	{
+		Slot*	next;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	};
+
+	vector<std::unique_ptr<Slot[]>>	blocks_;
+	Slot*							free_list_		= nullptr;
+	size_t							n_used_			= 0;	// Number of slots handed out from blocks (including freed ones)
+	size_t							n_allocated_	= 0;
+
+	// Never destroyed, since map objects may be deleted during static
+	// destruction (eg. clipboard items)
+	static MapObjectPool& instance()
+	{
+		static MapObjectPool* pool = new MapObjectPool();
+		return *pool;
+	}
+
+	void* allocateSlot()
+	{
+		n_allocated_++;
+
+		// Reuse a freed slot if possible
+		if (free_list_)
+		{
+			Slot* slot = free_list_;
+			free_list_ = slot->next;
+			return slot;
+		}
+
+		// Otherwise take the next unused slot, adding a new block if needed
+		if (n_used_ == blocks_.size() * BLOCK_SIZE)
+			blocks_.emplace_back(new Slot[BLOCK_SIZE]);
+
+		Slot* slot = &blocks_[n_used_ / BLOCK_SIZE][n_used_ % BLOCK_SIZE];
+		n_used_++;
+		return slot;
+	}
+
+	void releaseSlot(void* ptr)
+	{
+		Slot* slot = static_cast<Slot*>(ptr);
+		slot->next = free_list_;
+		free_list_ = slot;
+
+		// Reset the pool once everything has been freed
+		if (--n_allocated_ == 0)
+		{
+			free_list_ = nullptr;
+			n_used_ = 0;
+			if (blocks_.size() > 1)
+				blocks_.resize(1);
+		}
+	}
+};
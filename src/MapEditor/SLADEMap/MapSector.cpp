@@ -121,6 +121,10 @@ void MapSector::copy(MapObject* s)
 
 	// Other properties
 	MapObject::copy(s);
+
+	// Update tag/id indexes
+	if (parent_map)
+		parent_map->updateIdIndexes(this);
 }
 
 /* MapSector::setGeometryUpdated
@@ -227,7 +231,11 @@ void MapSector::setIntProperty(const string& key, int value)
 	else if (key == "special")
 		special = value;
 	else if (key == "id")
+	{
 		tag = value;
+		if (parent_map)
+			parent_map->updateIdIndexes(this);
+	}
 	else
 		MapObject::setIntProperty(key, value);
 }
@@ -300,13 +308,17 @@ bbox_t MapSector::boundingBox()
 }
 
 /* MapSector::getPolygon
- * Returns the sector polygon, updating it if necessary
+ * Returns the sector polygon, updating it if necessary (using
+ * [splitter] if given)
  *******************************************************************/
-Polygon2D* MapSector::getPolygon()
+Polygon2D* MapSector::getPolygon(PolygonSplitter* splitter)
 {
 	if (poly_needsupdate)
 	{
-		polygon.openSector(this);
+		if (splitter)
+			polygon.openSector(this, *splitter);
+		else
+			polygon.openSector(this);
 		poly_needsupdate = false;
 	}
 
@@ -111,6 +111,10 @@ public:
 	MapSector(string f_tex, string c_tex, SLADEMap* parent = NULL);
 	~MapSector();
 
+	// Allocated from a pool (see MapObjectPool.h)
+	static void*	operator new(size_t size) { return MapObjectPool<MapSector>::allocate(size); }
+	static void		operator delete(void* ptr, size_t size) { MapObjectPool<MapSector>::release(ptr, size); }
+
 	void	copy(MapObject* copy) override;
 
 	string		getFloorTex() const { return f_tex; }
@@ -153,7 +157,7 @@ public:
 	bbox_t				boundingBox();
 	vector<MapSide*>&	connectedSides() { return connected_sides; }
 	void				resetPolygon() { poly_needsupdate = true; }
-	Polygon2D*			getPolygon();
+	Polygon2D*			getPolygon(PolygonSplitter* splitter = nullptr);
 	bool				isWithin(fpoint2_t point);
 	double				distanceTo(fpoint2_t point, double maxdist = -1);
 	bool				getLines(vector<MapLine*>& list);
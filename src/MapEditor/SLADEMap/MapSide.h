@@ -36,6 +36,10 @@ public:
 	MapSide(SLADEMap* parent);
 	~MapSide();
 
+	// Allocated from a pool (see MapObjectPool.h)
+	static void*	operator new(size_t size) { return MapObjectPool<MapSide>::allocate(size); }
+	static void		operator delete(void* ptr, size_t size) { MapObjectPool<MapSide>::release(ptr, size); }
+
 	void	copy(MapObject* c) override;
 
 	bool	isOk() const { return !!sector; }
@@ -30,6 +30,7 @@
 #include "Main.h"
 #include "MapThing.h"
 #include "App.h"
+#include "SLADEMap.h"
 
 
 /*******************************************************************
@@ -169,6 +170,10 @@ void MapThing::copy(MapObject* c)
 
 	// Other properties
 	MapObject::copy(c);
+
+	// Update tag/id indexes
+	if (parent_map)
+		parent_map->updateIdIndexes(this);
 }
 
 /* MapThing::setAnglePoint
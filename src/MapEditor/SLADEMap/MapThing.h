@@ -52,6 +52,10 @@ public:
 	MapThing(double x, double y, short type, SLADEMap* parent = nullptr);
 	~MapThing();
 
+	// Allocated from a pool (see MapObjectPool.h)
+	static void*	operator new(size_t size) { return MapObjectPool<MapThing>::allocate(size); }
+	static void		operator delete(void* ptr, size_t size) { MapObjectPool<MapThing>::release(ptr, size); }
+
 	double		xPos() { return x; }
 	double		yPos() { return y; }
 	void		setPos(double x, double y) { this->x = x; this->y = y; }
@@ -30,6 +30,7 @@
 #include "Main.h"
 #include "MapVertex.h"
 #include "MapLine.h"
+#include "SLADEMap.h"
 #include "App.h"
 
 
@@ -121,12 +122,16 @@ void MapVertex::setIntProperty(const string& key, int value)
 		x = value;
 		for (unsigned a = 0; a < connected_lines.size(); a++)
 			connected_lines[a]->resetInternals();
+		if (parent_map)
+			parent_map->objectGeometryChanged(this);
 	}
 	else if (key == "y")
 	{
 		y = value;
 		for (unsigned a = 0; a < connected_lines.size(); a++)
 			connected_lines[a]->resetInternals();
+		if (parent_map)
+			parent_map->objectGeometryChanged(this);
 	}
 	else
 		return MapObject::setIntProperty(key, value);
@@ -146,6 +151,9 @@ void MapVertex::setFloatProperty(const string& key, double value)
 		y = value;
 	else
 		return MapObject::setFloatProperty(key, value);
+
+	if (parent_map)
+		parent_map->objectGeometryChanged(this);
 }
 
 /* MapVertex::scriptCanModifyProp
@@ -211,4 +219,7 @@ void MapVertex::readBackup(mobj_backup_t* backup)
 	// Position
 	x = backup->props_internal["x"].getFloatValue();
 	y = backup->props_internal["y"].getFloatValue();
+
+	if (parent_map)
+		parent_map->objectGeometryChanged(this);
 }
@@ -27,6 +27,10 @@ public:
 	MapVertex(double x, double y, SLADEMap* parent = nullptr);
 	~MapVertex();
 
+	// Allocated from a pool (see MapObjectPool.h)
+	static void*	operator new(size_t size) { return MapObjectPool<MapVertex>::allocate(size); }
+	static void		operator delete(void* ptr, size_t size) { MapObjectPool<MapVertex>::release(ptr, size); }
+
 	double		xPos() const { return x; }
 	double		yPos() const { return y; }
 
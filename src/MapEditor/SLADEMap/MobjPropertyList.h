@@ -24,7 +24,7 @@ public:
 	~MobjPropertyList();
 
 	// Operator for direct access to hash map
-	Property& operator[](string key)
+	Property& operator[](const string& key)
 	{
 		for (unsigned a = 0; a < properties.size(); ++a)
 		{
@@ -38,6 +38,9 @@
 #include "SLADEMap.h"
 #include "Utility/MathStuff.h"
 #include "Utility/Parser.h"
+#include <atomic>
+#include <thread>
+#include <unordered_map>
 
 #define IDEQ(x) (((x) != 0) && ((x) == id))
 
@@ -46,6 +49,64 @@
  * VARIABLES
  *******************************************************************/
 CVAR(Bool, map_split_auto_offset, true, CVAR_SAVE)
+CVAR(Int, map_polygon_threads, 0, CVAR_SAVE) // 0 = number of cores
+
+
+/*******************************************************************
+ * FUNCTIONS
+ *******************************************************************/
+
+/* argKeys
+ * Returns the values (and absolute values) of all args of [object],
+ * to index it under for tagging lookups
+ *******************************************************************/
+static vector<int> argKeys(MapObject* object)
+{
+	static const string arg_names[] = { "arg0", "arg1", "arg2", "arg3", "arg4" };
+
+	vector<int> keys;
+	for (auto& arg : arg_names)
+	{
+		int value = object->intProperty(arg);
+		if (value != 0)
+		{
+			keys.push_back(value);
+			if (value < 0)
+				keys.push_back(-value);
+		}
+	}
+
+	return keys;
+}
+
+/* countLumpTexture
+ * Increments the count for 8-character texture [name] (from a binary
+ * map lump) in [counts], keyed by its raw bytes
+ *******************************************************************/
+static void countLumpTexture(std::unordered_map<uint64_t, int>& counts, const char* name)
+{
+	uint64_t key;
+	memcpy(&key, name, 8);
+	counts[key]++;
+}
+
+/* addLumpTextureUsage
+ * Adds the texture [counts] from countLumpTexture to [usage]
+ *******************************************************************/
+static void addLumpTextureUsage(const std::unordered_map<uint64_t, int>& counts, std::map<string, int>& usage)
+{
+	for (auto& count : counts)
+		usage[wxString::FromAscii((const char*)&count.first, 8).Upper()] += count.second;
+}
+
+/* addLumpTextureUsage
+ * Adds the (doom64) texture hash [counts] to [usage]
+ *******************************************************************/
+static void addLumpTextureUsage(const std::unordered_map<uint16_t, int>& counts, std::map<string, int>& usage)
+{
+	for (auto& count : counts)
+		usage[theResourceManager->getTextureName(count.first).Upper()] += count.second;
+}
 
 
 /*******************************************************************
@@ -60,6 +121,9 @@ SLADEMap::SLADEMap()
 	// Init variables
 	this->geometry_updated_ = 0;
 	this->position_frac_ = false;
+	this->grid_valid_ = false;
+	this->arrays_valid_ = false;
+	this->arrays_updated_ = 0;
 
 	// Object id 0 is always null
 	all_objects_.push_back(mobj_holder_t(nullptr, false));
@@ -193,6 +257,8 @@ void SLADEMap::refreshIndices()
 	// Thing indices
 	for (unsigned a = 0; a < things_.size(); a++)
 		things_[a]->index = a;
+
+	arrays_valid_ = false;
 }
 
 /* SLADEMap::addMapObject
@@ -203,6 +269,9 @@ void SLADEMap::addMapObject(MapObject* object)
 	all_objects_.push_back(mobj_holder_t(object, true));
 	object->id = all_objects_.size() - 1;
 	created_deleted_objects_.push_back(mobj_cd_t(object->id, true));
+	objectModified(object);
+	objectGeometryChanged(object);
+	arrays_valid_ = false;
 }
 
 /* SLADEMap::removeMapObject
@@ -213,6 +282,19 @@ void SLADEMap::removeMapObject(MapObject* object)
 {
 	all_objects_[object->id].in_map = false;
 	created_deleted_objects_.push_back(mobj_cd_t(object->id, false));
+	arrays_valid_ = false;
+
+	// Remove from tag/id indexes
+	updateIdIndexes(object);
+
+	// Remove from spatial grid
+	if (grid_valid_)
+	{
+		if (object->getObjType() == MOBJ_VERTEX)
+			grid_.removeVertex((MapVertex*)object);
+		else if (object->getObjType() == MOBJ_LINE)
+			grid_.removeLine((MapLine*)object);
+	}
 }
 
 /* SLADEMap::getObjectIdList
@@ -328,6 +410,51 @@ void SLADEMap::restoreObjectIdList(uint8_t type, vector<unsigned>& list)
 			things_.back()->index = things_.size() - 1;
 		}
 	}
+
+	// Update tag/id indexes
+	if (type == MOBJ_LINE || type == MOBJ_SECTOR || type == MOBJ_THING)
+		rebuildIdIndexes();
+
+	// Spatial grid needs rebuilding
+	if (type == MOBJ_VERTEX || type == MOBJ_LINE)
+		grid_valid_ = false;
+
+	arrays_valid_ = false;
+}
+
+/* SLADEMap::freeRemovedObjects
+ * Deletes all objects that have been removed from the map, other
+ * than those with ids in [keep_ids] (ie. objects that can still be
+ * restored by undo/redo). Object ids are never reused, the ids of
+ * deleted objects will just have no object. Returns the number of
+ * objects deleted
+ *******************************************************************/
+unsigned SLADEMap::freeRemovedObjects(const vector<unsigned>& keep_ids)
+{
+	vector<bool> keep(all_objects_.size(), false);
+	for (unsigned id : keep_ids)
+	{
+		if (id < keep.size())
+			keep[id] = true;
+	}
+
+	unsigned n_freed = 0;
+	for (unsigned a = 1; a < all_objects_.size(); a++)
+	{
+		mobj_holder_t& holder = all_objects_[a];
+		if (holder.mobj && !holder.in_map && !keep[a])
+		{
+			delete holder.mobj;
+			holder.mobj = nullptr;
+			n_freed++;
+		}
+	}
+
+	// The specials index may refer to deleted objects
+	if (n_freed > 0)
+		map_specials_.invalidateIndex();
+
+	return n_freed;
 }
 
 /* SLADEMap::readMap
@@ -383,6 +510,7 @@ bool SLADEMap::readMap(Archive::MapDesc map)
 			udmf_namespace_ = Game::configuration().udmfNamespace();
 	}
 
+	rebuildIdIndexes();
 	initSectorPolygons();
 	recomputeSpecials();
 
@@ -426,11 +554,6 @@ bool SLADEMap::addSide(doomside_t& s)
 	ns->offset_x = s.x_offset;
 	ns->offset_y = s.y_offset;
 
-	// Update texture counts
-	usage_tex_[ns->tex_upper.Upper()] += 1;
-	usage_tex_[ns->tex_middle.Upper()] += 1;
-	usage_tex_[ns->tex_lower.Upper()] += 1;
-
 	// Add side
 	sides_.push_back(ns);
 	return true;
@@ -451,11 +574,6 @@ bool SLADEMap::addSide(doom64side_t& s)
 	ns->offset_x = s.x_offset;
 	ns->offset_y = s.y_offset;
 
-	// Update texture counts
-	usage_tex_[ns->tex_upper.Upper()] += 1;
-	usage_tex_[ns->tex_middle.Upper()] += 1;
-	usage_tex_[ns->tex_lower.Upper()] += 1;
-
 	// Add side
 	sides_.push_back(ns);
 	return true;
@@ -603,10 +721,6 @@ bool SLADEMap::addSector(doomsector_t& s)
 	ns->special = s.special;
 	ns->tag = s.tag;
 
-	// Update texture counts
-	usage_flat_[ns->f_tex.Upper()] += 1;
-	usage_flat_[ns->c_tex.Upper()] += 1;
-
 	// Add sector
 	sectors_.push_back(ns);
 	return true;
@@ -635,10 +749,6 @@ bool SLADEMap::addSector(doom64sector_t& s)
 	ns->properties["color_upper"] = s.color[3];
 	ns->properties["color_lower"] = s.color[4];
 
-	// Update texture counts
-	usage_flat_[ns->f_tex.Upper()] += 1;
-	usage_flat_[ns->c_tex.Upper()] += 1;
-
 	// Add sector
 	sectors_.push_back(ns);
 	return true;
@@ -701,10 +811,12 @@ bool SLADEMap::readDoomVertexes(ArchiveEntry* entry)
 
 	doomvertex_t* vert_data = (doomvertex_t*)entry->getData(true);
 	unsigned nv = entry->getSize() / sizeof(doomvertex_t);
+	reserveObjects(vertices_, nv);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < nv; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / nv) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / nv) * 0.2f);
 		addVertex(vert_data[a]);
 	}
 
@@ -734,13 +846,26 @@ bool SLADEMap::readDoomSidedefs(ArchiveEntry* entry)
 
 	doomside_t* side_data = (doomside_t*)entry->getData(true);
 	unsigned ns = entry->getSize() / sizeof(doomside_t);
+	reserveObjects(sides_, ns);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < ns; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / ns) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / ns) * 0.2f);
 		addSide(side_data[a]);
 	}
 
+	// Update texture counts (names are counted by their raw lump bytes
+	// first, so each distinct name is only converted once)
+	std::unordered_map<uint64_t, int> tex_counts;
+	for (size_t a = 0; a < ns; a++)
+	{
+		countLumpTexture(tex_counts, side_data[a].tex_upper);
+		countLumpTexture(tex_counts, side_data[a].tex_middle);
+		countLumpTexture(tex_counts, side_data[a].tex_lower);
+	}
+	addLumpTextureUsage(tex_counts, usage_tex_);
+
 	LOG_MESSAGE(3, "Read %lu sides", sides_.size());
 
 	return true;
@@ -767,10 +892,12 @@ bool SLADEMap::readDoomLinedefs(ArchiveEntry* entry)
 
 	doomline_t* line_data = (doomline_t*)entry->getData(true);
 	unsigned nl = entry->getSize() / sizeof(doomline_t);
+	reserveObjects(lines_, nl);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < nl; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / nl) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		if (!addLine(line_data[a]))
 			LOG_MESSAGE(2, "Line %lu invalid, not added", a);
 	}
@@ -801,13 +928,24 @@ bool SLADEMap::readDoomSectors(ArchiveEntry* entry)
 
 	doomsector_t* sect_data = (doomsector_t*)entry->getData(true);
 	unsigned ns = entry->getSize() / sizeof(doomsector_t);
+	reserveObjects(sectors_, ns);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < ns; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / ns) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / ns) * 0.2f);
 		addSector(sect_data[a]);
 	}
 
+	// Update texture counts
+	std::unordered_map<uint64_t, int> tex_counts;
+	for (size_t a = 0; a < ns; a++)
+	{
+		countLumpTexture(tex_counts, sect_data[a].f_tex);
+		countLumpTexture(tex_counts, sect_data[a].c_tex);
+	}
+	addLumpTextureUsage(tex_counts, usage_flat_);
+
 	LOG_MESSAGE(3, "Read %lu sectors", sectors_.size());
 
 	return true;
@@ -834,10 +972,12 @@ bool SLADEMap::readDoomThings(ArchiveEntry* entry)
 
 	doomthing_t* thng_data = (doomthing_t*)entry->getData(true);
 	unsigned nt = entry->getSize() / sizeof(doomthing_t);
+	reserveObjects(things_, nt);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < nt; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / nt) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / nt) * 0.2f);
 		addThing(thng_data[a]);
 	}
 
@@ -1051,10 +1191,12 @@ bool SLADEMap::readHexenLinedefs(ArchiveEntry* entry)
 
 	hexenline_t* line_data = (hexenline_t*)entry->getData(true);
 	unsigned nl = entry->getSize() / sizeof(hexenline_t);
+	reserveObjects(lines_, nl);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < nl; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / nl) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		addLine(line_data[a]);
 	}
 
@@ -1083,10 +1225,12 @@ bool SLADEMap::readHexenThings(ArchiveEntry* entry)
 
 	hexenthing_t* thng_data = (hexenthing_t*)entry->getData(true);
 	unsigned nt = entry->getSize() / sizeof(hexenthing_t);
+	reserveObjects(things_, nt);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < nt; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / nt) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / nt) * 0.2f);
 		addThing(thng_data[a]);
 	}
 
@@ -1192,10 +1336,12 @@ bool SLADEMap::readDoom64Vertexes(ArchiveEntry* entry)
 
 	doom64vertex_t* vert_data = (doom64vertex_t*)entry->getData(true);
 	unsigned n = entry->getSize() / sizeof(doom64vertex_t);
+	reserveObjects(vertices_, n);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < n; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / n) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / n) * 0.2f);
 		addVertex(vert_data[a]);
 	}
 
@@ -1224,13 +1370,25 @@ bool SLADEMap::readDoom64Sidedefs(ArchiveEntry* entry)
 
 	doom64side_t* side_data = (doom64side_t*)entry->getData(true);
 	unsigned n = entry->getSize() / sizeof(doom64side_t);
+	reserveObjects(sides_, n);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < n; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / n) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / n) * 0.2f);
 		addSide(side_data[a]);
 	}
 
+	// Update texture counts
+	std::unordered_map<uint16_t, int> tex_counts;
+	for (size_t a = 0; a < n; a++)
+	{
+		tex_counts[side_data[a].tex_upper]++;
+		tex_counts[side_data[a].tex_middle]++;
+		tex_counts[side_data[a].tex_lower]++;
+	}
+	addLumpTextureUsage(tex_counts, usage_tex_);
+
 	LOG_MESSAGE(3, "Read %lu sides", sides_.size());
 
 	return true;
@@ -1256,10 +1414,12 @@ bool SLADEMap::readDoom64Linedefs(ArchiveEntry* entry)
 
 	doom64line_t* line_data = (doom64line_t*)entry->getData(true);
 	unsigned n = entry->getSize() / sizeof(doom64line_t);
+	reserveObjects(lines_, n);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < n; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / n) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / n) * 0.2f);
 		addLine(line_data[a]);
 	}
 
@@ -1288,13 +1448,24 @@ bool SLADEMap::readDoom64Sectors(ArchiveEntry* entry)
 
 	doom64sector_t* sect_data = (doom64sector_t*)entry->getData(true);
 	unsigned n = entry->getSize() / sizeof(doom64sector_t);
+	reserveObjects(sectors_, n);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < n; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / n) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / n) * 0.2f);
 		addSector(sect_data[a]);
 	}
 
+	// Update texture counts
+	std::unordered_map<uint16_t, int> tex_counts;
+	for (size_t a = 0; a < n; a++)
+	{
+		tex_counts[sect_data[a].f_tex]++;
+		tex_counts[sect_data[a].c_tex]++;
+	}
+	addLumpTextureUsage(tex_counts, usage_flat_);
+
 	LOG_MESSAGE(3, "Read %lu sectors", sectors_.size());
 
 	return true;
@@ -1320,10 +1491,12 @@ bool SLADEMap::readDoom64Things(ArchiveEntry* entry)
 
 	doom64thing_t* thng_data = (doom64thing_t*)entry->getData(true);
 	unsigned n = entry->getSize() / sizeof(doom64thing_t);
+	reserveObjects(things_, n);
 	float p = UI::getSplashProgress();
 	for (size_t a = 0; a < n; a++)
 	{
-		UI::setSplashProgress(p + ((float)a / n) * 0.2f);
+		if (a % 256 == 0)
+			UI::setSplashProgress(p + ((float)a / n) * 0.2f);
 		addThing(thng_data[a]);
 	}
 
@@ -1798,18 +1971,15 @@ bool SLADEMap::writeDoomVertexes(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(vertices_.size() * 4, false);
-	entry->seek(0, 0);
 
 	// Write vertex data
-	short x, y;
+	vector<doomvertex_t> data(vertices_.size());
 	for (unsigned a = 0; a < vertices_.size(); a++)
 	{
-		x = vertices_[a]->xPos();
-		y = vertices_[a]->yPos();
-		entry->write(&x, 2);
-		entry->write(&y, 2);
+		data[a].x = vertices_[a]->xPos();
+		data[a].y = vertices_[a]->yPos();
 	}
+	entry->write(data.data(), data.size() * sizeof(doomvertex_t));
 
 	return true;
 }
@@ -1825,15 +1995,13 @@ bool SLADEMap::writeDoomSidedefs(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(sides_.size() * 30, false);
-	entry->seek(0, 0);
 
 	// Write side data
-	doomside_t side;
+	vector<doomside_t> data(sides_.size());
 	string t_m, t_u, t_l;
 	for (unsigned a = 0; a < sides_.size(); a++)
 	{
-		memset(&side, 0, 30);
+		doomside_t& side = data[a];
 
 		// Offsets
 		side.x_offset = sides_[a]->offset_x;
@@ -1850,9 +2018,8 @@ bool SLADEMap::writeDoomSidedefs(ArchiveEntry* entry)
 		memcpy(side.tex_middle, CHR(t_m), t_m.Length());
 		memcpy(side.tex_upper, CHR(t_u), t_u.Length());
 		memcpy(side.tex_lower, CHR(t_l), t_l.Length());
-
-		entry->write(&side, 30);
 	}
+	entry->write(data.data(), data.size() * sizeof(doomside_t));
 
 	return true;
 }
@@ -1868,13 +2035,13 @@ bool SLADEMap::writeDoomLinedefs(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(lines_.size() * 14, false);
-	entry->seek(0, 0);
 
 	// Write line data
-	doomline_t line;
+	vector<doomline_t> data(lines_.size());
 	for (unsigned a = 0; a < lines_.size(); a++)
 	{
+		doomline_t& line = data[a];
+
 		// Vertices
 		line.vertex1 = lines_[a]->v1Index();
 		line.vertex2 = lines_[a]->v2Index();
@@ -1889,9 +2056,8 @@ bool SLADEMap::writeDoomLinedefs(ArchiveEntry* entry)
 		line.side2 = -1;
 		if (lines_[a]->side1) line.side1 = lines_[a]->side1->getIndex();
 		if (lines_[a]->side2) line.side2 = lines_[a]->side2->getIndex();
-
-		entry->write(&line, 14);
 	}
+	entry->write(data.data(), data.size() * sizeof(doomline_t));
 
 	return true;
 }
@@ -1907,14 +2073,12 @@ bool SLADEMap::writeDoomSectors(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(sectors_.size() * 26, false);
-	entry->seek(0, 0);
 
 	// Write sector data
-	doomsector_t sector;
+	vector<doomsector_t> data(sectors_.size());
 	for (unsigned a = 0; a < sectors_.size(); a++)
 	{
-		memset(&sector, 0, 26);
+		doomsector_t& sector = data[a];
 
 		// Height
 		sector.f_height = sectors_[a]->f_height;
@@ -1928,9 +2092,8 @@ bool SLADEMap::writeDoomSectors(ArchiveEntry* entry)
 		sector.light = sectors_[a]->light;
 		sector.special = sectors_[a]->special;
 		sector.tag = sectors_[a]->tag;
-
-		entry->write(&sector, 26);
 	}
+	entry->write(data.data(), data.size() * sizeof(doomsector_t));
 
 	return true;
 }
@@ -1946,13 +2109,13 @@ bool SLADEMap::writeDoomThings(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(things_.size() * 10, false);
-	entry->seek(0, 0);
 
 	// Write thing data
-	doomthing_t thing;
+	vector<doomthing_t> data(things_.size());
 	for (unsigned a = 0; a < things_.size(); a++)
 	{
+		doomthing_t& thing = data[a];
+
 		// Position
 		thing.x = things_[a]->xPos();
 		thing.y = things_[a]->yPos();
@@ -1961,9 +2124,8 @@ bool SLADEMap::writeDoomThings(ArchiveEntry* entry)
 		thing.angle = things_[a]->getAngle();
 		thing.type = things_[a]->type;
 		thing.flags = things_[a]->intProperty("flags");
-
-		entry->write(&thing, 10);
 	}
+	entry->write(data.data(), data.size() * sizeof(doomthing_t));
 
 	return true;
 }
@@ -2015,13 +2177,14 @@ bool SLADEMap::writeHexenLinedefs(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(lines_.size() * 16, false);
-	entry->seek(0, 0);
 
 	// Write line data
-	hexenline_t line;
+	static const string arg_names[] = { "arg0", "arg1", "arg2", "arg3", "arg4" };
+	vector<hexenline_t> data(lines_.size());
 	for (unsigned a = 0; a < lines_.size(); a++)
 	{
+		hexenline_t& line = data[a];
+
 		// Vertices
 		line.vertex1 = lines_[a]->v1Index();
 		line.vertex2 = lines_[a]->v2Index();
@@ -2032,16 +2195,15 @@ bool SLADEMap::writeHexenLinedefs(ArchiveEntry* entry)
 
 		// Args
 		for (unsigned arg = 0; arg < 5; arg++)
-			line.args[arg] = lines_[a]->intProperty(S_FMT("arg%u", arg));
+			line.args[arg] = lines_[a]->intProperty(arg_names[arg]);
 
 		// Sides
 		line.side1 = -1;
 		line.side2 = -1;
 		if (lines_[a]->side1) line.side1 = lines_[a]->side1->getIndex();
 		if (lines_[a]->side2) line.side2 = lines_[a]->side2->getIndex();
-
-		entry->write(&line, 16);
 	}
+	entry->write(data.data(), data.size() * sizeof(hexenline_t));
 
 	return true;
 }
@@ -2057,13 +2219,14 @@ bool SLADEMap::writeHexenThings(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(things_.size() * 20, false);
-	entry->seek(0, 0);
 
 	// Write thing data
-	hexenthing_t thing;
+	static const string arg_names[] = { "arg0", "arg1", "arg2", "arg3", "arg4" };
+	vector<hexenthing_t> data(things_.size());
 	for (unsigned a = 0; a < things_.size(); a++)
 	{
+		hexenthing_t& thing = data[a];
+
 		// Position
 		thing.x = things_[a]->xPos();
 		thing.y = things_[a]->yPos();
@@ -2078,10 +2241,9 @@ bool SLADEMap::writeHexenThings(ArchiveEntry* entry)
 
 		// Args
 		for (unsigned arg = 0; arg < 5; arg++)
-			thing.args[arg] = things_[a]->intProperty(S_FMT("arg%u", arg));
-
-		entry->write(&thing, 20);
+			thing.args[arg] = things_[a]->intProperty(arg_names[arg]);
 	}
+	entry->write(data.data(), data.size() * sizeof(hexenthing_t));
 
 	return true;
 }
@@ -2133,18 +2295,15 @@ bool SLADEMap::writeDoom64Vertexes(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(vertices_.size() * 8, false);
-	entry->seek(0, 0);
 
-	// Write vertex data
-	int32_t x, y;	// Those are actually fixed_t, so shift by FRACBIT (16)
+	// Write vertex data (positions are fixed_t, so shift by FRACBIT (16))
+	vector<doom64vertex_t> data(vertices_.size());
 	for (unsigned a = 0; a < vertices_.size(); a++)
 	{
-		x = vertices_[a]->xPos()*65536;
-		y = vertices_[a]->yPos()*65536;
-		entry->write(&x, 4);
-		entry->write(&y, 4);
+		data[a].x = vertices_[a]->xPos()*65536;
+		data[a].y = vertices_[a]->yPos()*65536;
 	}
+	entry->write(data.data(), data.size() * sizeof(doom64vertex_t));
 
 	return true;
 }
@@ -2160,14 +2319,12 @@ bool SLADEMap::writeDoom64Sidedefs(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(sides_.size() * sizeof(doom64side_t), false);
-	entry->seek(0, 0);
 
 	// Write side data
-	doom64side_t side;
+	vector<doom64side_t> data(sides_.size());
 	for (unsigned a = 0; a < sides_.size(); a++)
 	{
-		memset(&side, 0, sizeof(doom64side_t));
+		doom64side_t& side = data[a];
 
 		// Offsets
 		side.x_offset = sides_[a]->offset_x;
@@ -2181,9 +2338,8 @@ bool SLADEMap::writeDoom64Sidedefs(ArchiveEntry* entry)
 		side.tex_middle	= theResourceManager->getTextureHash(sides_[a]->tex_middle);
 		side.tex_upper	= theResourceManager->getTextureHash(sides_[a]->tex_upper);
 		side.tex_lower	= theResourceManager->getTextureHash(sides_[a]->tex_lower);
-
-		entry->write(&side, sizeof(doom64side_t));
 	}
+	entry->write(data.data(), data.size() * sizeof(doom64side_t));
 
 	return true;
 }
@@ -2199,13 +2355,13 @@ bool SLADEMap::writeDoom64Linedefs(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(lines_.size() * sizeof(doom64line_t), false);
-	entry->seek(0, 0);
 
 	// Write line data
-	doom64line_t line;
+	vector<doom64line_t> data(lines_.size());
 	for (unsigned a = 0; a < lines_.size(); a++)
 	{
+		doom64line_t& line = data[a];
+
 		// Vertices
 		line.vertex1 = lines_[a]->v1Index();
 		line.vertex2 = lines_[a]->v2Index();
@@ -2220,9 +2376,8 @@ bool SLADEMap::writeDoom64Linedefs(ArchiveEntry* entry)
 		line.side2 = -1;
 		if (lines_[a]->side1) line.side1 = lines_[a]->side1->getIndex();
 		if (lines_[a]->side2) line.side2 = lines_[a]->side2->getIndex();
-
-		entry->write(&line, sizeof(doom64line_t));
 	}
+	entry->write(data.data(), data.size() * sizeof(doom64line_t));
 
 	return true;
 }
@@ -2238,14 +2393,12 @@ bool SLADEMap::writeDoom64Sectors(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(sectors_.size() * sizeof(doom64sector_t), false);
-	entry->seek(0, 0);
 
 	// Write sector data
-	doom64sector_t sector;
+	vector<doom64sector_t> data(sectors_.size());
 	for (unsigned a = 0; a < sectors_.size(); a++)
 	{
-		memset(&sector, 0, sizeof(doom64sector_t));
+		doom64sector_t& sector = data[a];
 
 		// Height
 		sector.f_height = sectors_[a]->f_height;
@@ -2266,9 +2419,8 @@ bool SLADEMap::writeDoom64Sectors(ArchiveEntry* entry)
 		sector.special = sectors_[a]->special;
 		sector.flags = sectors_[a]->intProperty("flags");
 		sector.tag = sectors_[a]->tag;
-
-		entry->write(&sector, sizeof(doom64sector_t));
 	}
+	entry->write(data.data(), data.size() * sizeof(doom64sector_t));
 
 	return true;
 }
@@ -2284,13 +2436,13 @@ bool SLADEMap::writeDoom64Things(ArchiveEntry* entry)
 
 	// Init entry data
 	entry->clearData();
-	entry->resize(things_.size() * sizeof(doom64thing_t), false);
-	entry->seek(0, 0);
 
 	// Write thing data
-	doom64thing_t thing;
+	vector<doom64thing_t> data(things_.size());
 	for (unsigned a = 0; a < things_.size(); a++)
 	{
+		doom64thing_t& thing = data[a];
+
 		// Position
 		thing.x = things_[a]->xPos();
 		thing.y = things_[a]->yPos();
@@ -2301,9 +2453,8 @@ bool SLADEMap::writeDoom64Things(ArchiveEntry* entry)
 		thing.type = things_[a]->type;
 		thing.flags = things_[a]->intProperty("flags");
 		thing.tid = things_[a]->intProperty("id");
-
-		entry->write(&thing, sizeof(doom64thing_t));
 	}
+	entry->write(data.data(), data.size() * sizeof(doom64thing_t));
 
 	return true;
 }
@@ -2520,6 +2671,13 @@ void SLADEMap::clearMap()
 {
 	map_specials_.reset();
 
+	// Clear tag/id indexes
+	sector_tags_.clear();
+	line_ids_.clear();
+	thing_ids_.clear();
+	line_args_.clear();
+	thing_args_.clear();
+
 	// Clear vectors
 	sides_.clear();
 	lines_.clear();
@@ -2527,13 +2685,24 @@ void SLADEMap::clearMap()
 	sectors_.clear();
 	things_.clear();
 
-	// Clear map objects
+	// Clear map objects (once all objects are deleted, the object pools
+	// are reset, see MapObjectPool.h)
 	for (unsigned a = 0; a < all_objects_.size(); a++)
 	{
 		if (all_objects_[a].mobj)
 			delete all_objects_[a].mobj;
 	}
 	all_objects_.clear();
+	change_journal_.clear();
+
+	// Clear spatial grid
+	grid_.clear();
+	grid_valid_ = false;
+	grid_pending_.clear();
+
+	// Clear packed arrays
+	arrays_.clear();
+	arrays_valid_ = false;
 
 	// Object id 0 is always null
 	all_objects_.push_back(mobj_holder_t(nullptr, false));
@@ -2832,32 +3001,15 @@ bool SLADEMap::removeThing(unsigned index)
  *******************************************************************/
 int SLADEMap::nearestVertex(fpoint2_t point, double min)
 {
-	// Go through vertices
-	double min_dist = 999999999;
-	MapVertex* v = nullptr;
-	double dist = 0;
-	int index = -1;
-	for (unsigned a = 0; a < vertices_.size(); a++)
-	{
-		v = vertices_[a];
-
-		// Get 'quick' distance (no need to get real distance)
-		dist = point.taxicab_distance_to(v->point());
-
-		// Check if it's nearer than the previous nearest
-		if (dist < min_dist)
-		{
-			index = a;
-			min_dist = dist;
-		}
-	}
+	// Get nearest vertex by 'quick' distance (no need to get real distance)
+	const MapArrays& arr = arrays();
+	int index = MapArrays::nearestPoint(arr.vertex_x, arr.vertex_y, point.x, point.y);
 
 	// Now determine the real distance to the closest vertex,
 	// to check for minimum hilight distance
 	if (index >= 0)
 	{
-		v = vertices_[index];
-		double rdist = MathStuff::distance(v->point(), point);
+		double rdist = MathStuff::distance(vertices_[index]->point(), point);
 		if (rdist > min)
 			return -1;
 	}
@@ -2871,23 +3023,18 @@ int SLADEMap::nearestVertex(fpoint2_t point, double min)
  *******************************************************************/
 int SLADEMap::nearestLine(fpoint2_t point, double mindist)
 {
+	// Check with line bounding boxes first (since we have a minimum distance)
+	vector<unsigned> near_lines;
+	arrays().linesNear(point.x, point.y, mindist, near_lines);
+
 	// Go through lines
 	double min_dist = mindist;
 	double dist = 0;
 	int index = -1;
-	MapLine* l;
-	for (unsigned a = 0; a < lines_.size(); a++)
+	for (unsigned a : near_lines)
 	{
-		l = lines_[a];
-
-		// Check with line bounding box first (since we have a minimum distance)
-		fseg2_t bbox = l->seg();
-		bbox.expand(mindist, mindist);
-		if (! bbox.contains(point))
-			continue;
-
 		// Calculate distance to line
-		dist = l->distanceTo(point);
+		dist = lines_[a]->distanceTo(point);
 
 		// Check if it's nearer than the previous nearest
 		if (dist < min_dist && dist < mindist)
@@ -2906,32 +3053,15 @@ int SLADEMap::nearestLine(fpoint2_t point, double mindist)
  *******************************************************************/
 int SLADEMap::nearestThing(fpoint2_t point, double min)
 {
-	// Go through things
-	double min_dist = 999999999;
-	MapThing* t = nullptr;
-	double dist = 0;
-	int index = -1;
-	for (unsigned a = 0; a < things_.size(); a++)
-	{
-		t = things_[a];
-
-		// Get 'quick' distance (no need to get real distance)
-		dist = point.taxicab_distance_to(t->point());
-
-		// Check if it's nearer than the previous nearest
-		if (dist < min_dist)
-		{
-			index = a;
-			min_dist = dist;
-		}
-	}
+	// Get nearest thing by 'quick' distance (no need to get real distance)
+	const MapArrays& arr = arrays();
+	int index = MapArrays::nearestPoint(arr.thing_x, arr.thing_y, point.x, point.y);
 
 	// Now determine the real distance to the closest thing,
 	// to check for minimum hilight distance
 	if (index >= 0)
 	{
-		t = things_[index];
-		double rdist = MathStuff::distance(t->point(), point);
+		double rdist = MathStuff::distance(things_[index]->point(), point);
 		if (rdist > min)
 			return -1;
 	}
@@ -2946,16 +3076,14 @@ int SLADEMap::nearestThing(fpoint2_t point, double min)
 vector<int> SLADEMap::nearestThingMulti(fpoint2_t point)
 {
 	// Go through things
+	const MapArrays& arr = arrays();
 	vector<int> ret;
 	double min_dist = 999999999;
-	MapThing* t = nullptr;
 	double dist = 0;
-	for (unsigned a = 0; a < things_.size(); a++)
+	for (unsigned a = 0; a < arr.thing_x.size(); a++)
 	{
-		t = things_[a];
-
 		// Get 'quick' distance (no need to get real distance)
-		dist = point.taxicab_distance_to(t->point());
+		dist = fabs(arr.thing_x[a] - point.x) + fabs(arr.thing_y[a] - point.y);
 
 		// Check if it's nearer than the previous nearest
 		if (dist < min_dist)
@@ -3025,15 +3153,8 @@ bbox_t SLADEMap::getMapBBox()
  *******************************************************************/
 MapVertex* SLADEMap::vertexAt(double x, double y)
 {
-	// Go through all vertices
-	for (unsigned a = 0; a < vertices_.size(); a++)
-	{
-		if (vertices_[a]->x == x && vertices_[a]->y == y)
-			return vertices_[a];
-	}
-
-	// No vertex at [x,y]
-	return nullptr;
+	updateGrid();
+	return grid_.vertexAt(x, y);
 }
 
 // Sorting functions for SLADEMap::cutLines
@@ -3066,16 +3187,21 @@ vector<fpoint2_t> SLADEMap::cutLines(double x1, double y1, double x2, double y2)
 	vector<fpoint2_t> intersect_points;
 	fpoint2_t intersection;
 
+	// Get map lines that could intersect
+	vector<MapLine*> lines;
+	updateGrid();
+	grid_.linesIn(MIN(x1, x2), MIN(y1, y2), MAX(x1, x2), MAX(y1, y2), lines);
+
 	// Go through map lines
-	for (unsigned a = 0; a < lines_.size(); a++)
+	for (auto line : lines)
 	{
 		// Check for intersection
 		intersection = cutter.p1();
-		if (MathStuff::linesIntersect(cutter, lines_[a]->seg(), intersection))
+		if (MathStuff::linesIntersect(cutter, line->seg(), intersection))
 		{
 			// Add intersection point to vector
 			intersect_points.push_back(intersection);
-			LOG_DEBUG("Intersection point", intersection, "valid with", lines_[a]);
+			LOG_DEBUG("Intersection point", intersection, "valid with", line);
 		}
 		else if (intersection != cutter.p1())
 		{
@@ -3118,12 +3244,16 @@ MapVertex* SLADEMap::lineCrossVertex(double x1, double y1, double x2, double y2)
 {
 	fseg2_t seg(x1, y1, x2, y2);
 
+	// Get vertices within the line bbox
+	vector<MapVertex*> vertices;
+	updateGrid();
+	grid_.verticesIn(MIN(x1, x2), MIN(y1, y2), MAX(x1, x2), MAX(y1, y2), vertices);
+
 	// Go through vertices
 	MapVertex* cv = nullptr;
 	double min_dist = 999999;
-	for (unsigned a = 0; a < vertices_.size(); a++)
+	for (auto vertex : vertices)
 	{
-		MapVertex* vertex = vertices_[a];
 		fpoint2_t point = vertex->point();
 
 		// Skip if outside line bbox
@@ -3157,30 +3287,38 @@ MapVertex* SLADEMap::lineCrossVertex(double x1, double y1, double x2, double y2)
  *******************************************************************/
 void SLADEMap::updateGeometryInfo(long modified_time)
 {
-	for (unsigned a = 0; a < vertices_.size(); a++)
+	// Get vertices modified since [modified_time]
+	vector<MapVertex*> modified_vertices;
+	for (auto change = changesSince(modified_time + 1); change != change_journal_.end(); ++change)
+	{
+		mobj_holder_t& holder = all_objects_[change->id];
+		if (holder.in_map && holder.mobj->getObjType() == MOBJ_VERTEX)
+			modified_vertices.push_back((MapVertex*)holder.mobj);
+	}
+	std::sort(modified_vertices.begin(), modified_vertices.end());
+	modified_vertices.erase(std::unique(modified_vertices.begin(), modified_vertices.end()), modified_vertices.end());
+
+	for (auto vertex : modified_vertices)
 	{
-		if (vertices_[a]->modifiedTime() > modified_time)
+		for (unsigned l = 0; l < vertex->connected_lines.size(); l++)
 		{
-			for (unsigned l = 0; l < vertices_[a]->connected_lines.size(); l++)
-			{
-				MapLine* line = vertices_[a]->connected_lines[l];
+			MapLine* line = vertex->connected_lines[l];
 
-				// Update line geometry
-				line->resetInternals();
+			// Update line geometry
+			line->resetInternals();
 
-				// Update front sector
-				if (line->frontSector())
-				{
-					line->frontSector()->resetPolygon();
-					line->frontSector()->updateBBox();
-				}
+			// Update front sector
+			if (line->frontSector())
+			{
+				line->frontSector()->resetPolygon();
+				line->frontSector()->updateBBox();
+			}
 
-				// Update back sector
-				if (line->backSector())
-				{
-					line->backSector()->resetPolygon();
-					line->backSector()->updateBBox();
-				}
+			// Update back sector
+			if (line->backSector())
+			{
+				line->backSector()->resetPolygon();
+				line->backSector()->updateBBox();
 			}
 		}
 	}
@@ -3258,17 +3396,41 @@ void SLADEMap::findSectorTextPoint(MapSector* sector)
 }
 
 /* SLADEMap::initSectorPolygons
- * Forces building of polygons for all sectors
+ * Forces building of polygons for all sectors. Each sector's polygon
+ * only depends on its own lines, so they are built in parallel, each
+ * thread reusing its own PolygonSplitter
  *******************************************************************/
 void SLADEMap::initSectorPolygons()
 {
 	UI::setSplashProgressMessage("Building sector polygons");
 	UI::setSplashProgress(0.0f);
-	for (unsigned a = 0; a < sectors_.size(); a++)
+
+	// Determine number of threads to use (not worth it for small maps)
+	unsigned n_threads = map_polygon_threads > 0 ? (unsigned)map_polygon_threads : std::thread::hardware_concurrency();
+	n_threads = MAX(1u, MIN(n_threads, (unsigned)sectors_.size() / 64));
+
+	// Threads take the next sector to build until there are none left.
+	// Progress is only updated from the main thread (setSplashProgress
+	// does nothing on other threads)
+	std::atomic<size_t> next(0);
+	auto build = [this, &next]()
 	{
-		UI::setSplashProgress((float)a / (float)sectors_.size());
-		sectors_[a]->getPolygon();
-	}
+		PolygonSplitter splitter;
+		size_t index;
+		while ((index = next++) < sectors_.size())
+		{
+			UI::setSplashProgress((float)index / (float)sectors_.size());
+			sectors_[index]->getPolygon(&splitter);
+		}
+	};
+
+	vector<std::thread> threads;
+	for (unsigned a = 1; a < n_threads; a++)
+		threads.emplace_back(build);
+	build();
+	for (auto& thread : threads)
+		thread.join();
+
 	UI::setSplashProgress(1.0f);
 }
 
@@ -3326,11 +3488,7 @@ void SLADEMap::getSectorsByTag(int tag, vector<MapSector*>& list)
 		return;
 
 	// Find sectors with matching tag
-	for (unsigned a = 0; a < sectors_.size(); a++)
-	{
-		if (sectors_[a]->tag == tag)
-			list.push_back(sectors_[a]);
-	}
+	sector_tags_.get(tag, list);
 }
 
 /* SLADEMap::getThingsById
@@ -3343,11 +3501,16 @@ void SLADEMap::getThingsById(int id, vector<MapThing*>& list, unsigned start, in
 		return;
 
 	// Find things with matching id
-	for (unsigned a = start; a < things_.size(); a++)
+	if (type == 0)
 	{
-		if (things_[a]->intProperty("id") == id && (type == 0 || things_[a]->type == type))
-			list.push_back(things_[a]);
+		thing_ids_.get(id, list, start);
+		return;
 	}
+	vector<MapThing*> things;
+	thing_ids_.get(id, things, start);
+	for (auto thing : things)
+		if (thing->type == type)
+			list.push_back(thing);
 }
 
 /* SLADEMap::getFirstThingWithId
@@ -3359,11 +3522,13 @@ MapThing* SLADEMap::getFirstThingWithId(int id)
 		return nullptr;
 
 	// Find things with matching id, but ignore dragons, we don't want them!
-	for (unsigned a = 0; a < things_.size(); a++)
+	vector<MapThing*> things;
+	thing_ids_.get(id, things);
+	for (auto thing : things)
 	{
-		auto& tt = Game::configuration().thingType(things_[a]->getType());
-		if (things_[a]->intProperty("id") == id && !(tt.flags() & Game::ThingType::FLAG_DRAGON))
-			return things_[a];
+		auto& tt = Game::configuration().thingType(thing->getType());
+		if (!(tt.flags() & Game::ThingType::FLAG_DRAGON))
+			return thing;
 	}
 	return nullptr;
 }
@@ -3377,17 +3542,23 @@ void SLADEMap::getThingsByIdInSectorTag(int id, int tag, vector<MapThing*>& list
 	if (id==0 && tag==0)
 		return;
 
-	// Find things with matching id contained in sector with matching tag
-	for (unsigned a = 0; a < things_.size(); a++)
+	// Get things with matching id
+	vector<MapThing*> things;
+	if (id != 0)
+		thing_ids_.get(id, things);
+	else
 	{
-		if (things_[a]->intProperty("id") == id)
-		{
-			int si = sectorAt(things_[a]->point());
-			if (si > -1 && (unsigned)si < sectors_.size() && sectors_[si]->tag == tag)
-			{
-				list.push_back(things_[a]);
-			}
-		}
+		for (unsigned a = 0; a < things_.size(); a++)
+			if (things_[a]->intProperty("id") == 0)
+				things.push_back(things_[a]);
+	}
+
+	// Check which are contained in sector with matching tag
+	for (auto thing : things)
+	{
+		int si = sectorAt(thing->point());
+		if (si > -1 && (unsigned)si < sectors_.size() && sectors_[si]->tag == tag)
+			list.push_back(thing);
 	}
 }
 
@@ -3440,11 +3611,7 @@ void SLADEMap::getLinesById(int id, vector<MapLine*>& list)
 		return;
 
 	// Find lines with matching id
-	for (unsigned a = 0; a < lines_.size(); a++)
-	{
-		if (lines_[a]->line_id == id)
-			list.push_back(lines_[a]);
-	}
+	line_ids_.get(id, list);
 }
 
 /* SLADEMap::getTaggingThingsById
@@ -3454,18 +3621,31 @@ void SLADEMap::getTaggingThingsById(int id, int type, vector<MapThing*>& list, i
 {
 	using Game::TagType;
 
+	if (id == 0)
+		return;
+
+	// Get things that could possibly be affecting the id (any arg or tid
+	// matches it)
+	vector<MapThing*> things;
+	thing_args_.get(id, things);
+	thing_ids_.get(id, things);
+	std::sort(things.begin(), things.end(), [](MapThing* left, MapThing* right) {
+		return left->index < right->index;
+	});
+	things.erase(std::unique(things.begin(), things.end()), things.end());
+
 	// Find things with special affecting matching id
 	int tag, arg2, arg3, arg4, arg5, tid;
-	for (unsigned a = 0; a < things_.size(); a++)
+	for (unsigned a = 0; a < things.size(); a++)
 	{
-		auto& tt = Game::configuration().thingType(things_[a]->getType());
+		auto& tt = Game::configuration().thingType(things[a]->getType());
 		auto needs_tag = tt.needsTag();
 		if (needs_tag != TagType::None ||
-			(things_[a]->intProperty("special") && !(tt.flags() & Game::ThingType::FLAG_SCRIPT)))
+			(things[a]->intProperty("special") && !(tt.flags() & Game::ThingType::FLAG_SCRIPT)))
 		{
 			if (needs_tag == TagType::None)
-				needs_tag = Game::configuration().actionSpecial(things_[a]->intProperty("special")).needsTag();
-			tag = things_[a]->intProperty("arg0");
+				needs_tag = Game::configuration().actionSpecial(things[a]->intProperty("special")).needsTag();
+			tag = things[a]->intProperty("arg0");
 			bool fits = false;
 			int path_type;
 			switch (needs_tag)
@@ -3484,65 +3664,65 @@ void SLADEMap::getTaggingThingsById(int id, int type, vector<MapThing*>& list, i
 				fits = (IDEQ(tag) && type == THINGS);
 				break;
 			case TagType::Thing1Sector2:
-				arg2 = things_[a]->intProperty("arg1");
+				arg2 = things[a]->intProperty("arg1");
 				fits = (type == THINGS ? IDEQ(tag) : (IDEQ(arg2) && type == SECTORS));
 				break;
 			case TagType::Thing1Sector3:
-				arg3 = things_[a]->intProperty("arg2");
+				arg3 = things[a]->intProperty("arg2");
 				fits = (type == THINGS ? IDEQ(tag) : (IDEQ(arg3) && type == SECTORS));
 				break;
 			case TagType::Thing1Thing2:
-				arg2 = things_[a]->intProperty("arg1");
+				arg2 = things[a]->intProperty("arg1");
 				fits = (type == THINGS && (IDEQ(tag) || IDEQ(arg2)));
 				break;
 			case TagType::Thing1Thing4:
-				arg4 = things_[a]->intProperty("arg3");
+				arg4 = things[a]->intProperty("arg3");
 				fits = (type == THINGS && (IDEQ(tag) || IDEQ(arg4)));
 				break;
 			case TagType::Thing1Thing2Thing3:
-				arg2 = things_[a]->intProperty("arg1");
-				arg3 = things_[a]->intProperty("arg2");
+				arg2 = things[a]->intProperty("arg1");
+				arg3 = things[a]->intProperty("arg2");
 				fits = (type == THINGS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3)));
 				break;
 			case TagType::Sector1Thing2Thing3Thing5:
-				arg2 = things_[a]->intProperty("arg1");
-				arg3 = things_[a]->intProperty("arg2");
-				arg5 = things_[a]->intProperty("arg4");
+				arg2 = things[a]->intProperty("arg1");
+				arg3 = things[a]->intProperty("arg2");
+				arg5 = things[a]->intProperty("arg4");
 				fits = (type == SECTORS ? (IDEQ(tag)) : (type == THINGS &&
 						(IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg5))));
 				break;
 			case TagType::LineId1Line2:
-				arg2 = things_[a]->intProperty("arg1");
+				arg2 = things[a]->intProperty("arg1");
 				fits = (type == LINEDEFS && IDEQ(arg2));
 				break;
 			case TagType::Thing4:
-				arg4 = things_[a]->intProperty("arg3");
+				arg4 = things[a]->intProperty("arg3");
 				fits = (type == THINGS && IDEQ(arg4));
 				break;
 			case TagType::Thing5:
-				arg5 = things_[a]->intProperty("arg4");
+				arg5 = things[a]->intProperty("arg4");
 				fits = (type == THINGS && IDEQ(arg5));
 				break;
 			case TagType::Line1Sector2:
-				arg2 = things_[a]->intProperty("arg1");
+				arg2 = things[a]->intProperty("arg1");
 				fits = (type == LINEDEFS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SECTORS));
 				break;
 			case TagType::Sector1Sector2:
-				arg2 = things_[a]->intProperty("arg1");
+				arg2 = things[a]->intProperty("arg1");
 				fits = (type == SECTORS && (IDEQ(tag) || IDEQ(arg2)));
 				break;
 			case TagType::Sector1Sector2Sector3Sector4:
-				arg2 = things_[a]->intProperty("arg1");
-				arg3 = things_[a]->intProperty("arg2");
-				arg4 = things_[a]->intProperty("arg3");
+				arg2 = things[a]->intProperty("arg1");
+				arg3 = things[a]->intProperty("arg2");
+				arg4 = things[a]->intProperty("arg3");
 				fits = (type == SECTORS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg4)));
 				break;
 			case TagType::Sector2Is3Line:
-				arg2 = things_[a]->intProperty("arg1");
+				arg2 = things[a]->intProperty("arg1");
 				fits = (IDEQ(tag) && (arg2 == 3 ? type == LINEDEFS : type == SECTORS));
 				break;
 			case TagType::Sector1Thing2:
-				arg2 = things_[a]->intProperty("arg1");
+				arg2 = things[a]->intProperty("arg1");
 				fits = (type == SECTORS ? (IDEQ(tag)) : (IDEQ(arg2) && type == THINGS));
 				break;
 			case TagType::Patrol:
@@ -3551,15 +3731,15 @@ void SLADEMap::getTaggingThingsById(int id, int type, vector<MapThing*>& list, i
 			{
 				path_type = 9075;
 
-				tid = things_[a]->intProperty("id");
-				auto& tt = Game::configuration().thingType(things_[a]->getType());
+				tid = things[a]->intProperty("id");
+				auto& tt = Game::configuration().thingType(things[a]->getType());
 				fits = ((path_type == ttype) && (IDEQ(tid)) && (tt.needsTag() == needs_tag));
 			}
 				break;
 			default:
 				break;
 			}
-			if (fits) list.push_back(things_[a]);
+			if (fits) list.push_back(things[a]);
 		}
 	}
 }
@@ -3571,16 +3751,23 @@ void SLADEMap::getTaggingLinesById(int id, int type, vector<MapLine*>& list)
 {
 	using Game::TagType;
 
+	if (id == 0)
+		return;
+
+	// Get lines that could possibly be affecting the id (any arg matches it)
+	vector<MapLine*> lines;
+	line_args_.get(id, lines);
+
 	// Find lines with special affecting matching id
 	int tag, arg2, arg3, arg4, arg5;
-	for (unsigned a = 0; a < lines_.size(); a++)
+	for (unsigned a = 0; a < lines.size(); a++)
 	{
-		int special = lines_[a]->special;
+		int special = lines[a]->special;
 		if (special)
 		{
-			tag = lines_[a]->intProperty("arg0");
+			tag = lines[a]->intProperty("arg0");
 			bool fits = false;
-			switch (Game::configuration().actionSpecial(lines_[a]->special).needsTag())
+			switch (Game::configuration().actionSpecial(lines[a]->special).needsTag())
 			{
 			case TagType::Sector:
 			case TagType::SectorOrBack:
@@ -3596,71 +3783,71 @@ void SLADEMap::getTaggingLinesById(int id, int type, vector<MapLine*>& list)
 				fits = (IDEQ(tag) && type == THINGS);
 				break;
 			case TagType::Thing1Sector2:
-				arg2 = lines_[a]->intProperty("arg1");
+				arg2 = lines[a]->intProperty("arg1");
 				fits = (type == THINGS ? IDEQ(tag) : (IDEQ(arg2) && type == SECTORS));
 				break;
 			case TagType::Thing1Sector3:
-				arg3 = lines_[a]->intProperty("arg2");
+				arg3 = lines[a]->intProperty("arg2");
 				fits = (type == THINGS ? IDEQ(tag) : (IDEQ(arg3) && type == SECTORS));
 				break;
 			case TagType::Thing1Thing2:
-				arg2 = lines_[a]->intProperty("arg1");
+				arg2 = lines[a]->intProperty("arg1");
 				fits = (type == THINGS && (IDEQ(tag) || IDEQ(arg2)));
 				break;
 			case TagType::Thing1Thing4:
-				arg4 = lines_[a]->intProperty("arg3");
+				arg4 = lines[a]->intProperty("arg3");
 				fits = (type == THINGS && (IDEQ(tag) || IDEQ(arg4)));
 				break;
 			case TagType::Thing1Thing2Thing3:
-				arg2 = lines_[a]->intProperty("arg1");
-				arg3 = lines_[a]->intProperty("arg2");
+				arg2 = lines[a]->intProperty("arg1");
+				arg3 = lines[a]->intProperty("arg2");
 				fits = (type == THINGS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3)));
 				break;
 			case TagType::Sector1Thing2Thing3Thing5:
-				arg2 = lines_[a]->intProperty("arg1");
-				arg3 = lines_[a]->intProperty("arg2");
-				arg5 = lines_[a]->intProperty("arg4");
+				arg2 = lines[a]->intProperty("arg1");
+				arg3 = lines[a]->intProperty("arg2");
+				arg5 = lines[a]->intProperty("arg4");
 				fits = (type == SECTORS ? (IDEQ(tag)) : (type == THINGS &&
 						(IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg5))));
 				break;
 			case TagType::LineId1Line2:
-				arg2 = lines_[a]->intProperty("arg1");
+				arg2 = lines[a]->intProperty("arg1");
 				fits = (type == LINEDEFS && IDEQ(arg2));
 				break;
 			case TagType::Thing4:
-				arg4 = lines_[a]->intProperty("arg3");
+				arg4 = lines[a]->intProperty("arg3");
 				fits = (type == THINGS && IDEQ(arg4));
 				break;
 			case TagType::Thing5:
-				arg5 = lines_[a]->intProperty("arg4");
+				arg5 = lines[a]->intProperty("arg4");
 				fits = (type == THINGS && IDEQ(arg5));
 				break;
 			case TagType::Line1Sector2:
-				arg2 = lines_[a]->intProperty("arg1");
+				arg2 = lines[a]->intProperty("arg1");
 				fits = (type == LINEDEFS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SECTORS));
 				break;
 			case TagType::Sector1Sector2:
-				arg2 = lines_[a]->intProperty("arg1");
+				arg2 = lines[a]->intProperty("arg1");
 				fits = (type == SECTORS && (IDEQ(tag) || IDEQ(arg2)));
 				break;
 			case TagType::Sector1Sector2Sector3Sector4:
-				arg2 = lines_[a]->intProperty("arg1");
-				arg3 = lines_[a]->intProperty("arg2");
-				arg4 = lines_[a]->intProperty("arg3");
+				arg2 = lines[a]->intProperty("arg1");
+				arg3 = lines[a]->intProperty("arg2");
+				arg4 = lines[a]->intProperty("arg3");
 				fits = (type == SECTORS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg4)));
 				break;
 			case TagType::Sector2Is3Line:
-				arg2 = lines_[a]->intProperty("arg1");
+				arg2 = lines[a]->intProperty("arg1");
 				fits = (IDEQ(tag) && (arg2 == 3 ? type == LINEDEFS : type == SECTORS));
 				break;
 			case TagType::Sector1Thing2:
-				arg2 = lines_[a]->intProperty("arg1");
+				arg2 = lines[a]->intProperty("arg1");
 				fits = (type == SECTORS ? (IDEQ(tag)) : (IDEQ(arg2) && type == THINGS));
 				break;
 			default:
 				break;
 			}
-			if (fits) list.push_back(lines_[a]);
+			if (fits) list.push_back(lines[a]);
 		}
 	}
 }
@@ -3670,17 +3857,7 @@ void SLADEMap::getTaggingLinesById(int id, int type, vector<MapLine*>& list)
  *******************************************************************/
 int SLADEMap::findUnusedSectorTag()
 {
-	int tag = 1;
-	for (unsigned a = 0; a < sectors_.size(); a++)
-	{
-		if (sectors_[a]->tag == tag)
-		{
-			tag++;
-			a = 0;
-		}
-	}
-
-	return tag;
+	return sector_tags_.firstUnused();
 }
 
 /* SLADEMap::findUnusedThingId
@@ -3688,17 +3865,7 @@ int SLADEMap::findUnusedSectorTag()
  *******************************************************************/
 int SLADEMap::findUnusedThingId()
 {
-	int tag = 1;
-	for (unsigned a = 0; a < things_.size(); a++)
-	{
-		if (things_[a]->intProperty("id") == tag)
-		{
-			tag++;
-			a = 0;
-		}
-	}
-
-	return tag;
+	return thing_ids_.firstUnused();
 }
 
 /* SLADEMap::findUnusedLineId
@@ -3706,48 +3873,116 @@ int SLADEMap::findUnusedThingId()
  *******************************************************************/
 int SLADEMap::findUnusedLineId()
 {
-	int tag = 1;
-
 	// UDMF (id property)
 	if (current_format_ == MAP_UDMF)
+		return line_ids_.firstUnused();
+
+	// Hexen (special 121 arg0) or Boom (sector tag (arg0))
+	bool hexen = (current_format_ == MAP_HEXEN);
+	if (!hexen && !(current_format_ == MAP_DOOM && Game::configuration().featureSupported(Game::Feature::Boom)))
+		return 1;
+
+	// Mark used ids (only need to check up to the number of lines, there
+	// must be an unused id within that range)
+	vector<bool> used(lines_.size() + 2, false);
+	for (unsigned a = 0; a < lines_.size(); a++)
 	{
-		for (unsigned a = 0; a < lines_.size(); a++)
-		{
-			if (lines_[a]->line_id == tag)
-			{
-				tag++;
-				a = 0;
-			}
-		}
+		if (hexen && lines_[a]->special != 121)
+			continue;
+
+		int id = lines_[a]->intProperty("arg0");
+		if (id > 0 && (unsigned)id < used.size())
+			used[id] = true;
 	}
 
-	// Hexen (special 121 arg0)
-	else if (current_format_ == MAP_HEXEN)
+	// Find first unused
+	int id = 1;
+	while (used[id])
+		id++;
+
+	return id;
+}
+
+/* SLADEMap::updateIdIndexes
+ * Updates the tag/id indexes for [object], should be called whenever
+ * any of its tag, id or arg properties are changed
+ *******************************************************************/
+void SLADEMap::updateIdIndexes(MapObject* object)
+{
+	// Check the object is part of this map
+	if (!object || object->id >= all_objects_.size() || all_objects_[object->id].mobj != object)
+		return;
+
+	bool in_map = all_objects_[object->id].in_map;
+	switch (object->getObjType())
 	{
-		for (unsigned a = 0; a < lines_.size(); a++)
+	case MOBJ_SECTOR:
+	{
+		MapSector* sector = (MapSector*)object;
+		if (in_map)
+			sector_tags_.set(sector, sector->tag);
+		else
+			sector_tags_.remove(sector);
+		break;
+	}
+	case MOBJ_LINE:
+	{
+		MapLine* line = (MapLine*)object;
+		if (in_map)
 		{
-			if (lines_[a]->special == 121 && lines_[a]->intProperty("arg0") == tag)
-			{
-				tag++;
-				a = 0;
-			}
+			line_ids_.set(line, line->line_id);
+			line_args_.set(line, argKeys(line));
+		}
+		else
+		{
+			line_ids_.remove(line);
+			line_args_.remove(line);
 		}
+		break;
 	}
-
-	// Boom (sector tag (arg0))
-	else if (current_format_ == MAP_DOOM && Game::configuration().featureSupported(Game::Feature::Boom))
+	case MOBJ_THING:
 	{
-		for (unsigned a = 0; a < lines_.size(); a++)
+		MapThing* thing = (MapThing*)object;
+		if (in_map)
 		{
-			if (lines_[a]->intProperty("arg0") == tag)
-			{
-				tag++;
-				a = 0;
-			}
+			thing_ids_.set(thing, thing->intProperty("id"));
+			thing_args_.set(thing, argKeys(thing));
+		}
+		else
+		{
+			thing_ids_.remove(thing);
+			thing_args_.remove(thing);
 		}
+		break;
+	}
+	default:
+		break;
 	}
+}
+
+/* SLADEMap::rebuildIdIndexes
+ * Rebuilds all tag/id indexes from scratch
+ *******************************************************************/
+void SLADEMap::rebuildIdIndexes()
+{
+	sector_tags_.clear();
+	line_ids_.clear();
+	thing_ids_.clear();
+	line_args_.clear();
+	thing_args_.clear();
 
-	return tag;
+	for (unsigned a = 0; a < sectors_.size(); a++)
+		sector_tags_.set(sectors_[a], sectors_[a]->tag);
+	for (unsigned a = 0; a < lines_.size(); a++)
+	{
+		line_ids_.set(lines_[a], lines_[a]->line_id);
+		line_args_.set(lines_[a], argKeys(lines_[a]));
+	}
+	for (unsigned a = 0; a < things_.size(); a++)
+	{
+		thing_ids_.set(things_[a], things_[a]->intProperty("id"));
+		thing_args_.set(things_[a], argKeys(things_[a]));
+	}
 }
 
 /* SLADEMap::getAdjecentLineTexture
@@ -3891,64 +4126,166 @@ MapSector* SLADEMap::getLineSideSector(MapLine* line, bool front)
 	return nullptr;
 }
 
-/* SLADEMap::getModifiedObjects
- * Returns a list of objects of [type] that have a modified time
- * later than [since]
+/* SLADEMap::objectModified
+ * Records a modification of [object] in the change journal. Called
+ * whenever an object's modified time is updated
  *******************************************************************/
-vector<MapObject*> SLADEMap::getModifiedObjects(long since, int type)
+void SLADEMap::objectModified(MapObject* object)
 {
-	vector<MapObject*> modified_objects;
+	// Check the object is part of this map
+	if (object->id >= all_objects_.size() || all_objects_[object->id].mobj != object)
+		return;
+
+	change_journal_.push_back(mobj_change_t(object->id, object->modified_time));
+
+	// Keep the journal from growing indefinitely
+	if (change_journal_.size() > all_objects_.size() * 2 + 1024)
+		compactChangeJournal();
+}
+
+/* SLADEMap::objectGeometryChanged
+ * Called when [object] (a vertex or line) is added or its position
+ * changes, queues it to be updated in the spatial grid
+ *******************************************************************/
+void SLADEMap::objectGeometryChanged(MapObject* object)
+{
+	// Nothing to do if the grid hasn't been built yet
+	if (!grid_valid_ || object->id == 0)
+		return;
 
-	// Vertices
-	if (type < 0 || type == MOBJ_VERTEX)
+	if (object->getObjType() == MOBJ_VERTEX || object->getObjType() == MOBJ_LINE)
+		grid_pending_.push_back(object->id);
+}
+
+/* SLADEMap::updateGrid
+ * Builds the spatial grid if needed, otherwise applies any pending
+ * vertex/line changes to it
+ *******************************************************************/
+void SLADEMap::updateGrid()
+{
+	// Build grid if needed
+	if (!grid_valid_)
 	{
+		grid_.clear();
 		for (unsigned a = 0; a < vertices_.size(); a++)
-		{
-			if (vertices_[a]->modifiedTime() >= since)
-				modified_objects.push_back(vertices_[a]);
-		}
+			grid_.updateVertex(vertices_[a]);
+		for (unsigned a = 0; a < lines_.size(); a++)
+			grid_.updateLine(lines_[a]);
+
+		grid_pending_.clear();
+		grid_valid_ = true;
+		return;
 	}
 
-	// Sides
-	if (type < 0 || type == MOBJ_SIDE)
+	// Update changed objects
+	for (unsigned id : grid_pending_)
 	{
-		for (unsigned a = 0; a < sides_.size(); a++)
+		if (id >= all_objects_.size() || !all_objects_[id].in_map)
+			continue;
+
+		MapObject* object = all_objects_[id].mobj;
+		if (object->getObjType() == MOBJ_VERTEX)
 		{
-			if (sides_[a]->modifiedTime() >= since)
-				modified_objects.push_back(sides_[a]);
+			MapVertex* vertex = (MapVertex*)object;
+			grid_.updateVertex(vertex);
+			for (unsigned a = 0; a < vertex->connected_lines.size(); a++)
+				grid_.updateLine(vertex->connected_lines[a]);
 		}
+		else if (object->getObjType() == MOBJ_LINE)
+			grid_.updateLine((MapLine*)object);
 	}
+	grid_pending_.clear();
+}
 
-	// Lines
-	if (type < 0 || type == MOBJ_LINE)
+/* SLADEMap::arrays
+ * Returns packed arrays of commonly used properties of all objects
+ * in the map (see MapArrays.h). The arrays are rebuilt if any
+ * objects have been added or removed since they were last requested,
+ * otherwise only the entries for modified objects are updated
+ *******************************************************************/
+const MapArrays& SLADEMap::arrays()
+{
+	if (!arrays_valid_)
 	{
-		for (unsigned a = 0; a < lines_.size(); a++)
+		arrays_.rebuild(*this);
+		arrays_valid_ = true;
+	}
+	else
+	{
+		for (auto change = changesSince(arrays_updated_); change != change_journal_.end(); ++change)
 		{
-			if (lines_[a]->modifiedTime() >= since)
-				modified_objects.push_back(lines_[a]);
+			mobj_holder_t& holder = all_objects_[change->id];
+			if (holder.in_map)
+				arrays_.update(holder.mobj);
 		}
 	}
 
-	// Sectors
-	if (type < 0 || type == MOBJ_SECTOR)
+	// Changes are found from this time (inclusive) next time, so that any
+	// further changes made within the same timer tick aren't missed
+	arrays_updated_ = App::runTimer();
+
+	return arrays_;
+}
+
+/* SLADEMap::changesSince
+ * Returns an iterator to the first change in the journal made at or
+ * after [since]
+ *******************************************************************/
+vector<mobj_change_t>::const_iterator SLADEMap::changesSince(long since) const
+{
+	return std::lower_bound(
+		change_journal_.begin(),
+		change_journal_.end(),
+		since,
+		[](const mobj_change_t& change, long time) { return change.time < time; });
+}
+
+/* SLADEMap::compactChangeJournal
+ * Rebuilds the change journal with only the latest modification of
+ * each object (older entries for an object add nothing, since any
+ * query that would find them would also find the latest one)
+ *******************************************************************/
+void SLADEMap::compactChangeJournal()
+{
+	change_journal_.clear();
+	for (unsigned a = 0; a < all_objects_.size(); a++)
 	{
-		for (unsigned a = 0; a < sectors_.size(); a++)
-		{
-			if (sectors_[a]->modifiedTime() >= since)
-				modified_objects.push_back(sectors_[a]);
-		}
+		if (all_objects_[a].mobj)
+			change_journal_.push_back(mobj_change_t(a, all_objects_[a].mobj->modified_time));
 	}
 
-	// Things
-	if (type < 0 || type == MOBJ_THING)
+	std::stable_sort(
+		change_journal_.begin(),
+		change_journal_.end(),
+		[](const mobj_change_t& left, const mobj_change_t& right) { return left.time < right.time; });
+}
+
+/* SLADEMap::getModifiedObjects
+ * Returns a list of objects of [type] that have a modified time
+ * later than [since]
+ *******************************************************************/
+vector<MapObject*> SLADEMap::getModifiedObjects(long since, int type)
+{
+	vector<MapObject*> modified_objects;
+
+	for (auto change = changesSince(since); change != change_journal_.end(); ++change)
 	{
-		for (unsigned a = 0; a < things_.size(); a++)
-		{
-			if (things_[a]->modifiedTime() >= since)
-				modified_objects.push_back(things_[a]);
-		}
+		mobj_holder_t& holder = all_objects_[change->id];
+		if (holder.in_map && (type < 0 || holder.mobj->getObjType() == type))
+			modified_objects.push_back(holder.mobj);
 	}
 
+	// Remove duplicates and sort by type (vertices, sides, lines, sectors then
+	// things) then index
+	static const int type_order[] = { 0, 1, 3, 2, 4, 5 }; // Indexed by MOBJ_ type
+	std::sort(modified_objects.begin(), modified_objects.end());
+	modified_objects.erase(std::unique(modified_objects.begin(), modified_objects.end()), modified_objects.end());
+	std::sort(modified_objects.begin(), modified_objects.end(), [](MapObject* left, MapObject* right) {
+		if (left->getObjType() != right->getObjType())
+			return type_order[left->getObjType()] < type_order[right->getObjType()];
+		return left->index < right->index;
+	});
+
 	return modified_objects;
 }
 
@@ -3958,12 +4295,19 @@ vector<MapObject*> SLADEMap::getModifiedObjects(long since, int type)
  *******************************************************************/
 vector<MapObject*> SLADEMap::getAllModifiedObjects(long since)
 {
-	vector<MapObject*> modified_objects;
+	vector<unsigned> ids;
+	for (auto change = changesSince(since); change != change_journal_.end(); ++change)
+		ids.push_back(change->id);
 
-	for (unsigned a = 0; a < all_objects_.size(); a++)
+	// Remove duplicates
+	std::sort(ids.begin(), ids.end());
+	ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+	vector<MapObject*> modified_objects;
+	for (auto id : ids)
 	{
-		if (all_objects_[a].mobj && all_objects_[a].mobj->modifiedTime() >= since)
-			modified_objects.push_back(all_objects_[a].mobj);
+		if (all_objects_[id].mobj)
+			modified_objects.push_back(all_objects_[id].mobj);
 	}
 
 	return modified_objects;
@@ -3974,15 +4318,7 @@ vector<MapObject*> SLADEMap::getAllModifiedObjects(long since)
  *******************************************************************/
 long SLADEMap::getLastModifiedTime()
 {
-	long mod_time = 0;
-
-	for (unsigned a = 0; a < all_objects_.size(); a++)
-	{
-		if (all_objects_[a].mobj && all_objects_[a].mobj->modifiedTime() > mod_time)
-			mod_time = all_objects_[a].mobj->modifiedTime();
-	}
-
-	return mod_time;
+	return change_journal_.empty() ? 0 : change_journal_.back().time;
 }
 
 /* SLADEMap::isModified
@@ -4015,54 +4351,12 @@ bool SLADEMap::modifiedSince(long since, int type)
 	if (type < 0)
 		return getLastModifiedTime() > since;
 
-	// Vertices
-	else if (type == MOBJ_VERTEX)
+	// Check for any objects of [type] modified after [since]
+	for (auto change = changesSince(since + 1); change != change_journal_.end(); ++change)
 	{
-		for (unsigned a = 0; a < vertices_.size(); a++)
-		{
-			if (vertices_[a]->modified_time > since)
-				return true;
-		}
-	}
-
-	// Lines
-	else if (type == MOBJ_LINE)
-	{
-		for (unsigned a = 0; a < lines_.size(); a++)
-		{
-			if (lines_[a]->modified_time > since)
-				return true;
-		}
-	}
-
-	// Sides
-	else if (type == MOBJ_SIDE)
-	{
-		for (unsigned a = 0; a < sides_.size(); a++)
-		{
-			if (sides_[a]->modified_time > since)
-				return true;
-		}
-	}
-
-	// Sectors
-	else if (type == MOBJ_SECTOR)
-	{
-		for (unsigned a = 0; a < sectors_.size(); a++)
-		{
-			if (sectors_[a]->modified_time > since)
-				return true;
-		}
-	}
-
-	// Things
-	else if (type == MOBJ_THING)
-	{
-		for (unsigned a = 0; a < things_.size(); a++)
-		{
-			if (things_[a]->modified_time > since)
-				return true;
-		}
+		mobj_holder_t& holder = all_objects_[change->id];
+		if (holder.in_map && holder.mobj->getObjType() == type)
+			return true;
 	}
 
 	return false;
@@ -4095,11 +4389,9 @@ MapVertex* SLADEMap::createVertex(double x, double y, double split_dist)
 	fpoint2_t point(x, y);
 
 	// First check that it won't overlap any other vertex
-	for (unsigned a = 0; a < vertices_.size(); a++)
-	{
-		if (vertices_[a]->x == x && vertices_[a]->y == y)
-			return vertices_[a];
-	}
+	MapVertex* existing = vertexAt(x, y);
+	if (existing)
+		return existing;
 
 	// Create the vertex
 	MapVertex* nv = new MapVertex(x, y, this);
@@ -4109,17 +4401,18 @@ MapVertex* SLADEMap::createVertex(double x, double y, double split_dist)
 	// Check if this vertex splits any lines (if needed)
 	if (split_dist >= 0)
 	{
-		unsigned nlines = lines_.size();
-		for (unsigned a = 0; a < nlines; a++)
+		vector<MapLine*> lines;
+		grid_.linesIn(x - split_dist, y - split_dist, x + split_dist, y + split_dist, lines);
+		for (auto line : lines)
 		{
 			// Skip line if it shares the vertex
-			if (lines_[a]->v1() == nv || lines_[a]->v2() == nv)
+			if (line->v1() == nv || line->v2() == nv)
 				continue;
 
-			if (lines_[a]->distanceTo(point) < split_dist)
+			if (line->distanceTo(point) < split_dist)
 			{
 				//LOG_MESSAGE(1, "Vertex at (%1.2f,%1.2f) splits line %d", x, y, a);
-				splitLine(lines_[a], nv);
+				splitLine(line, nv);
 			}
 		}
 	}
@@ -4279,6 +4572,7 @@ void SLADEMap::moveVertex(unsigned vertex, double nx, double ny)
 	// Reset all attached lines' geometry info
 	for (unsigned a = 0; a < v->connected_lines.size(); a++)
 		v->connected_lines[a]->resetInternals();
+	objectGeometryChanged(v);
 
 	geometry_updated_ = App::runTimer();
 }
@@ -4319,6 +4613,8 @@ void SLADEMap::mergeVertices(unsigned vertex1, unsigned vertex2)
 			v1->connectLine(line);
 		}
 
+		objectGeometryChanged(line);
+
 		if (line->vertex1 == v1 && line->vertex2 == v1)
 			zlines.push_back(line);
 	}
@@ -4346,30 +4642,19 @@ void SLADEMap::mergeVertices(unsigned vertex1, unsigned vertex2)
  *******************************************************************/
 MapVertex* SLADEMap::mergeVerticesPoint(double x, double y)
 {
-	// Go through all vertices
-	int merge = -1;
-	for (unsigned a = 0; a < vertices_.size(); a++)
-	{
-		// Skip if vertex isn't on the point
-		if (vertices_[a]->x != x || vertices_[a]->y != y)
-			continue;
-
-		// Set as the merge target vertex if we don't have one already
-		if (merge < 0)
-		{
-			merge = a;
-			continue;
-		}
+	// Get all vertices on the point
+	vector<MapVertex*> vertices;
+	updateGrid();
+	grid_.verticesIn(x, y, x, y, vertices);
 
-		// Otherwise, merge this vertex with the merge target
-		mergeVertices(merge, a);
-		a--;
-	}
+	// Merge them all into the first (lowest index) vertex
+	for (unsigned a = 1; a < vertices.size(); a++)
+		mergeVertices(vertices[0]->index, vertices[a]->index);
 
 	geometry_updated_ = App::runTimer();
 
 	// Return the final merged vertex
-	return getVertex(merge);
+	return vertices.empty() ? nullptr : vertices[0];
 }
 
 /* SLADEMap::splitLine
@@ -4387,6 +4672,7 @@ MapLine* SLADEMap::splitLine(MapLine* l, MapVertex* v)
 	l->vertex2 = v;
 	v->connectLine(l);
 	l->length = -1;
+	objectGeometryChanged(l);
 
 	// Create and add new sides
 	MapSide* s1 = nullptr;
@@ -4476,18 +4762,22 @@ void SLADEMap::moveThing(unsigned thing, double nx, double ny)
  *******************************************************************/
 void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist)
 {
+	// Get lines near the vertex
+	vector<MapLine*> lines;
+	updateGrid();
+	grid_.linesIn(vertex->x - split_dist, vertex->y - split_dist, vertex->x + split_dist, vertex->y + split_dist, lines);
+
 	// Check if this vertex splits any lines (if needed)
-	unsigned nlines = lines_.size();
-	for (unsigned a = 0; a < nlines; a++)
+	for (auto line : lines)
 	{
 		// Skip line if it shares the vertex
-		if (lines_[a]->v1() == vertex || lines_[a]->v2() == vertex)
+		if (line->v1() == vertex || line->v2() == vertex)
 			continue;
 
-		if (lines_[a]->distanceTo(vertex->point()) < split_dist)
+		if (line->distanceTo(vertex->point()) < split_dist)
 		{
-			LOG_MESSAGE(2, "Vertex at (%1.2f,%1.2f) splits line %u", vertex->x, vertex->y, a);
-			splitLine(lines_[a], vertex);
+			LOG_MESSAGE(2, "Vertex at (%1.2f,%1.2f) splits line %u", vertex->x, vertex->y, line->index);
+			splitLine(line, vertex);
 		}
 	}
 }
@@ -4714,13 +5004,21 @@ bool SLADEMap::mergeArch(vector<MapVertex*> vertices)
 		splitLinesAt(merged_vertices[a], split_dist);
 
 	// Split lines that moved onto existing vertices
+	vector<MapVertex*> near_vertices;
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
-		unsigned nvertices = this->vertices_.size();
-		for (unsigned b = 0; b < nvertices; b++)
+		fseg2_t seg = connected_lines[a]->seg();
+		near_vertices.clear();
+		updateGrid();
+		grid_.verticesIn(
+			seg.left() - split_dist,
+			seg.top() - split_dist,
+			seg.right() + split_dist,
+			seg.bottom() + split_dist,
+			near_vertices);
+
+		for (auto vertex : near_vertices)
 		{
-			MapVertex* vertex = this->vertices_[b];
-
 			// Skip line if it shares the vertex
 			if (connected_lines[a]->v1() == vertex || connected_lines[a]->v2() == vertex)
 				continue;
@@ -4735,16 +5033,18 @@ bool SLADEMap::mergeArch(vector<MapVertex*> vertices)
 
 	// Split lines (by lines)
 	fseg2_t seg1;
+	vector<MapLine*> near_lines;
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
 		MapLine* line1 = connected_lines[a];
 		seg1 = line1->seg();
 
-		unsigned n_lines = lines_.size();
-		for (unsigned b = 0; b < n_lines; b++)
-		{
-			MapLine* line2 = lines_[b];
+		near_lines.clear();
+		updateGrid();
+		grid_.linesIn(seg1.left(), seg1.top(), seg1.right(), seg1.bottom(), near_lines);
 
+		for (auto line2 : near_lines)
+		{
 			// Can't intersect if they share a vertex
 			if (line1->vertex1 == line2->vertex1 ||
 				line1->vertex1 == line2->vertex2 ||
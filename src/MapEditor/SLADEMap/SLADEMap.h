@@ -7,6 +7,9 @@
 #include "MapSector.h"
 #include "MapVertex.h"
 #include "MapThing.h"
+#include "MapIdIndex.h"
+#include "MapGrid.h"
+#include "MapArrays.h"
 #include "Archive/Archive.h"
 #include "Utility/PropertyList/PropertyList.h"
 #include "MapEditor/MapSpecials.h"
@@ -38,6 +41,18 @@ struct mobj_cd_t
 	}
 };
 
+struct mobj_change_t
+{
+	unsigned	id;
+	long		time;
+
+	mobj_change_t(unsigned id, long time)
+	{
+		this->id = id;
+		this->time = time;
+	}
+};
+
 class ParseTreeNode;
 namespace Game { enum class TagType; }
 
@@ -84,6 +99,7 @@ public:
 	const vector<MapSide*>&		sides() const { return sides_; }
 	const vector<MapSector*>&	sectors() const { return sectors_; }
 	const vector<MapThing*>&	things() const { return things_; }
+	const MapArrays&			arrays();
 
 	vector<ArchiveEntry*>&	udmfExtraEntries() { return udmf_extra_entries_; }
 
@@ -93,6 +109,7 @@ public:
 	MapObject*	getObjectById(unsigned id) { return all_objects_[id].mobj; }
 	void		getObjectIdList(uint8_t type, vector<unsigned>& list);
 	void		restoreObjectIdList(uint8_t type, vector<unsigned>& list);
+	unsigned	freeRemovedObjects(const vector<unsigned>& keep_ids);
 
 	void	refreshIndices();
 	bool	readMap(Archive::MapDesc map);
@@ -154,6 +171,7 @@ public:
 	int		findUnusedSectorTag();
 	int		findUnusedThingId();
 	int		findUnusedLineId();
+	void	updateIdIndexes(MapObject* object);
 
 	// Info
 	string				getAdjacentLineTexture(MapVertex* vertex, int tex_part = 255);
@@ -164,6 +182,8 @@ public:
 	bool				isModified();
 	void				setOpenedTime();
 	bool				modifiedSince(long since, int type = -1);
+	void				objectModified(MapObject* object);
+	void				objectGeometryChanged(MapObject* object);
 
 	// Creation
 	MapVertex*	createVertex(double x, double y, double split_dist = -1);
@@ -242,9 +262,53 @@ private:
 	vector<unsigned>		created_objects_;
 	vector<mobj_cd_t>		created_deleted_objects_;
 
+	// Change journal, every object modification (or creation) is recorded
+	// here in time order, so that changes since a given time can be found
+	// without checking every object in the map
+	vector<mobj_change_t>	change_journal_;
+
+	vector<mobj_change_t>::const_iterator	changesSince(long since) const;
+	void									compactChangeJournal();
+
 	long	geometry_updated_;	// The last time the map geometry was updated
 	long	things_updated_;	// The last time the thing list was modified
 
+	// Tag/id indexes
+	MapIdIndex<MapSector>	sector_tags_;
+	MapIdIndex<MapLine>		line_ids_;
+	MapIdIndex<MapThing>	thing_ids_;
+	MapIdIndex<MapLine>		line_args_;		// By (absolute) arg values, for tagging lookups
+	MapIdIndex<MapThing>	thing_args_;	// By (absolute) arg values, for tagging lookups
+
+	void	rebuildIdIndexes();
+
+	// Spatial grid of vertices and lines, built when first needed and then
+	// kept up to date with any geometry changes (by object id)
+	MapGrid				grid_;
+	bool				grid_valid_;
+	vector<unsigned>	grid_pending_;
+
+	void	updateGrid();
+
+	// Packed arrays of commonly used object properties, rebuilt when
+	// objects are added/removed and otherwise updated from the change
+	// journal when requested
+	MapArrays	arrays_;
+	bool		arrays_valid_;
+	long		arrays_updated_;
+
+	// Reserves space for [count] more objects in [list] (and the object
+	// list) before reading a binary map lump. The objects themselves are
+	// still created one at a time by addVertex/addLine/etc., since each one
+	// must stay individually deletable for undo/redo. Lump data is read in
+	// place without any byte swapping, like all other binary map/lump data
+	// in SLADE
+	template<class T> void reserveObjects(vector<T*>& list, size_t count)
+	{
+		list.reserve(list.size() + count);
+		all_objects_.reserve(all_objects_.size() + count);
+	}
+
 	// Usage counts
 	std::map<string, int>	usage_tex_;
 	std::map<string, int>	usage_flat_;
@@ -94,6 +94,16 @@ bool MapTexBrowserItem::loadImage()
 		return false;
 }
 
+/* MapTexBrowserItem::requestThumbnail
+ * Requests a background-generated thumbnail of the item's image
+ * entry, if it isn't a composite texture
+ *******************************************************************/
+ThumbnailCache::RequestPtr MapTexBrowserItem::requestThumbnail(int max_size)
+{
+	MapTextureManager& manager = MapEditor::textureManager();
+	return ThumbnailCache::request(manager.getImageEntry(name_, type_ == "flat"), manager.getPalette(), max_size);
+}
+
 /* MapTexBrowserItem::itemInfo
  * Returns a string with extra information about the texture/flat
  *******************************************************************/
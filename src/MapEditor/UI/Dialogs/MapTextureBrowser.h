@@ -17,6 +17,7 @@ public:
 	~MapTexBrowserItem();
 
 	bool	loadImage();
+	ThumbnailCache::RequestPtr	requestThumbnail(int max_size);
 	string	itemInfo();
 	int		usageCount() { return usage_count; }
 	void	setUsage(int count) { usage_count = count; }
@@ -256,6 +256,22 @@ void MapChecksPanel::reset()
 	lb_errors_->Show(true);
 }
 
+// ----------------------------------------------------------------------------
+// MapChecksPanel::getObjectIds
+//
+// Adds the ids of all map objects with problems in the current check results
+// to [list]
+// ----------------------------------------------------------------------------
+void MapChecksPanel::getObjectIds(vector<unsigned>& list)
+{
+	for (auto& item : check_items_)
+	{
+		auto object = item.check->getObject(item.index);
+		if (object)
+			list.push_back(object->getId());
+	}
+}
+
 // ----------------------------------------------------------------------------
 // MapChecksPanel::layoutVertical
 //
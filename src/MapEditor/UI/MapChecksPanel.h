@@ -16,6 +16,7 @@ public:
 	void	showCheckItem(unsigned index);
 	void	refreshList();
 	void	reset();
+	void	getObjectIds(vector<unsigned>& list);
 
 	// DockPanel overrides
 	void	layoutNormal() override { layoutHorizontal(); }
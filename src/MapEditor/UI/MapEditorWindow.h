@@ -44,6 +44,7 @@ public:
 
 	MapObjectPropsPanel*	propsPanel() const { return panel_obj_props_; }
 	ObjectEditPanel*		objectEditPanel() const { return panel_obj_edit_; }
+	MapChecksPanel*			checksPanel() const { return panel_checks_; }
 	
 	void	showObjectEditPanel(bool show, ObjectEditGroup* group);
 	void	showShapeDrawPanel(bool show = true);
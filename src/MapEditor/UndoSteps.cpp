@@ -222,6 +222,15 @@ bool MapObjectCreateDeleteUS::isOk()
 	return true;
 }
 
+void MapObjectCreateDeleteUS::getObjectIds(vector<unsigned>& list)
+{
+	list.insert(list.end(), vertices.begin(), vertices.end());
+	list.insert(list.end(), lines.begin(), lines.end());
+	list.insert(list.end(), sides.begin(), sides.end());
+	list.insert(list.end(), sectors.begin(), sectors.end());
+	list.insert(list.end(), things.begin(), things.end());
+}
+
 
 
 MultiMapObjectPropertyChangeUS::MultiMapObjectPropertyChangeUS()
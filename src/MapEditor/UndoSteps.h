@@ -35,6 +35,7 @@ namespace MapEditor
 		bool doRedo();
 		void checkChanges();
 		bool isOk();
+		void getObjectIds(vector<unsigned>& list);
 
 	private:
 		vector<unsigned>	vertices;
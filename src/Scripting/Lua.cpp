@@ -258,8 +258,8 @@ void Lua::showErrorDialog(wxWindow* parent, const string& title, const string& m
 	// Get script log messages since the last script was started
 	auto log = Log::since(script_start_time, Log::MessageType::Script);
 	string output;
-	for (auto msg : log)
-		output += msg->formattedMessageLine() + "\n";
+	for (auto& msg : log)
+		output += msg.formattedMessageLine() + "\n";
 
 	ExtMessageDialog dlg(parent ? parent : current_window, title);
 	dlg.setMessage(message);
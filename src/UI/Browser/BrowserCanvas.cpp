@@ -76,6 +76,10 @@ BrowserCanvas::BrowserCanvas(wxWindow* parent) :
 	Bind(wxEVT_MOUSEWHEEL, &BrowserCanvas::onMouseEvent, this);
 	Bind(wxEVT_LEFT_DOWN, &BrowserCanvas::onMouseEvent, this);
 	Bind(wxEVT_KEY_DOWN, &BrowserCanvas::onKeyDown, this);
+
+	// Redraw periodically while any item thumbnails are still being generated
+	thumb_timer_.SetOwner(this);
+	Bind(wxEVT_TIMER, [&](wxTimerEvent&) { Refresh(); }, thumb_timer_.GetId());
 }
 
 // ----------------------------------------------------------------------------
@@ -310,6 +314,10 @@ void BrowserCanvas::draw()
 
 	// Swap Buffers
 	SwapBuffers();
+
+	// Check again shortly if any thumbnails are still being generated
+	if (ThumbnailCache::numPending() > 0 && !thumb_timer_.IsRunning())
+		thumb_timer_.StartOnce(50);
 }
 
 // ----------------------------------------------------------------------------
@@ -62,6 +62,7 @@ private:
 	wxScrollBar*			scrollbar_		= nullptr;
 	string					search_;
 	BrowserItem*			item_selected_	= nullptr;
+	wxTimer					thumb_timer_;	// Redraws while thumbnails are being generated
 
 	// Display
 	int	yoff_			= 0;
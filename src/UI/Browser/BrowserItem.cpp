@@ -67,6 +67,8 @@ BrowserItem::~BrowserItem()
 {
 	if (text_box_)
 		delete text_box_;
+	if (thumb_)
+		delete thumb_;
 }
 
 // ----------------------------------------------------------------------------
@@ -80,6 +82,53 @@ bool BrowserItem::loadImage()
 	return false;
 }
 
+// ----------------------------------------------------------------------------
+// BrowserItem::updateThumbnail
+//
+// Requests a background-generated thumbnail for the item if it hasn't been
+// already, and uploads it to the thumbnail texture once it is ready. Returns
+// true if the thumbnail texture is available. [pending] is set to true if the
+// thumbnail is still being generated
+// ----------------------------------------------------------------------------
+bool BrowserItem::updateThumbnail(int size, bool& pending)
+{
+	pending = false;
+
+	// Check if the thumbnail is already loaded
+	if (thumb_ && thumb_->isLoaded())
+		return true;
+
+	// Request thumbnail if needed (the requested size is never less than 128,
+	// so the thumbnail doesn't need to be regenerated if the item size changes)
+	if (!thumb_checked_)
+	{
+		thumb_checked_ = true;
+		thumb_request_ = requestThumbnail(MAX(size, 128));
+	}
+
+	// No thumbnail for this item
+	if (!thumb_request_)
+		return false;
+
+	// Still generating
+	if (!thumb_request_->done)
+	{
+		pending = true;
+		return false;
+	}
+
+	// Done, create thumbnail texture if generated successfully
+	auto request = thumb_request_;
+	thumb_request_.reset();
+	if (!request->success)
+		return false;
+	if (!thumb_)
+		thumb_ = new GLTexture(false);
+	thumb_width_ = request->full_width;
+	thumb_height_ = request->full_height;
+	return thumb_->loadRawData(request->rgba.data(), request->width, request->height);
+}
+
 // ----------------------------------------------------------------------------
 // BrowserItem::draw
 //
@@ -127,12 +176,45 @@ void BrowserItem::draw(int size, int x, int y, int font, int nametype, int viewt
 	if (blank_)
 		return;
 
-	// Try to load image if it isn't already
-	if (!image_ || (image_ && !image_->isLoaded()))
-		loadImage();
+	// Use the full image if it's already loaded, otherwise the thumbnail.
+	// Only load the full image here if the item has no thumbnail
+	GLTexture* texture = nullptr;
+	double width = 0;
+	double height = 0;
+	bool pending = false;
+	if (image_ && image_->isLoaded())
+		texture = image_;
+	else if (updateThumbnail(size, pending))
+	{
+		texture = thumb_;
+		width = thumb_width_;
+		height = thumb_height_;
+	}
+	else if (!pending && loadImage() && image_ && image_->isLoaded())
+		texture = image_;
 
-	// If it still isn't just draw a red box with an X
-	if (!image_ || (image_ && !image_->isLoaded()))
+	// If the thumbnail is still being generated, just draw a grey box
+	if (pending)
+	{
+		glPushAttrib(GL_ENABLE_BIT|GL_CURRENT_BIT);
+
+		glColor3f(0.5f, 0.5f, 0.5f);
+		glDisable(GL_TEXTURE_2D);
+
+		glBegin(GL_LINE_LOOP);
+		glVertex2i(x, y);
+		glVertex2i(x, y+size);
+		glVertex2i(x+size, y+size);
+		glVertex2i(x+size, y);
+		glEnd();
+
+		glPopAttrib();
+
+		return;
+	}
+
+	// If there is no image just draw a red box with an X
+	if (!texture)
 	{
 		glPushAttrib(GL_ENABLE_BIT|GL_CURRENT_BIT);
 
@@ -160,9 +242,12 @@ void BrowserItem::draw(int size, int x, int y, int font, int nametype, int viewt
 		return;
 	}
 
-	// Determine texture dimensions
-	double width = image_->getWidth();
-	double height = image_->getHeight();
+	// Determine texture dimensions (use the full image size for thumbnails)
+	if (texture == image_)
+	{
+		width = image_->getWidth();
+		height = image_->getHeight();
+	}
 
 	// Scale up if size > 128
 	if (size > 128)
@@ -198,7 +283,7 @@ void BrowserItem::draw(int size, int x, int y, int font, int nametype, int viewt
 	double left = x + ((double)size * 0.5) - (width * 0.5);
 
 	// Draw
-	image_->bind();
+	texture->bind();
 	OpenGL::setColour(COL_WHITE, false);
 
 	glBegin(GL_QUADS);
@@ -217,4 +302,9 @@ void BrowserItem::draw(int size, int x, int y, int font, int nametype, int viewt
 void BrowserItem::clearImage()
 {
 	if (image_) image_->clear();
+
+	// Regenerate thumbnail next time the item is drawn
+	if (thumb_) thumb_->clear();
+	thumb_request_.reset();
+	thumb_checked_ = false;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "OpenGL/GLTexture.h"
+#include "ThumbnailCache.h"
 
 class BrowserWindow;
 class TextBox;
@@ -15,6 +16,7 @@ public:
 	unsigned	index() const { return index_; }
 
 	virtual bool	loadImage();
+	virtual ThumbnailCache::RequestPtr	requestThumbnail(int max_size) { return nullptr; }
 	void			draw(
 						int size,
 						int x,
@@ -36,4 +38,13 @@ protected:
 	BrowserWindow*	parent_		= nullptr;
 	bool			blank_		= false;
 	TextBox*		text_box_	= nullptr;
+
+	// Thumbnail (generated in the background, see ThumbnailCache)
+	GLTexture*					thumb_			= nullptr;
+	int							thumb_width_	= 0;	// Size of the full image
+	int							thumb_height_	= 0;
+	ThumbnailCache::RequestPtr	thumb_request_;
+	bool						thumb_checked_	= false;
+
+	bool	updateThumbnail(int size, bool& pending);
 };
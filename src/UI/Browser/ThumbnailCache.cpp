@@ -0,0 +1,416 @@
+// ----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ThumbnailCache.cpp
+// Description: Generates browser item thumbnails on background threads, and
+//              caches them on disk
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// ----------------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------------
+//
+// Includes
+//
+// ----------------------------------------------------------------------------
+#include "Main.h"
+#include "ThumbnailCache.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Console/Console.h"
+#include "General/Misc.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using ThumbnailCache::Request;
+using ThumbnailCache::RequestPtr;
+
+
+// ----------------------------------------------------------------------------
+//
+// Variables
+//
+// ----------------------------------------------------------------------------
+CVAR(Bool, browser_thumbnail_cache, true, CVAR_SAVE)
+CVAR(Int, browser_thumbnail_threads, 0, CVAR_SAVE) // 0 = one less than the number of cores
+
+namespace
+{
+	const uint32_t THUMB_MAGIC		= 0x424d4854;	// THMB
+	const uint32_t THUMB_VERSION	= 1;
+
+	// Worker thread state, created when the first thumbnail is requested and
+	// freed by ThumbnailCache::shutdown
+	struct Workers
+	{
+		std::mutex				mutex;
+		std::condition_variable	requested;
+		vector<RequestPtr>		queue;
+		std::atomic<unsigned>	pending{ 0 };
+		bool					stop = false;
+		vector<std::thread>		threads;
+	};
+	Workers* workers = nullptr;
+}
+
+
+// ----------------------------------------------------------------------------
+//
+// Functions
+//
+// ----------------------------------------------------------------------------
+namespace
+{
+	// ------------------------------------------------------------------------
+	// Returns the thumbnail cache directory path
+	// ------------------------------------------------------------------------
+	string cacheDir()
+	{
+		return App::path("thumbcache", App::Dir::User);
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns the path to the cache file for the thumbnail of [request]
+	// ------------------------------------------------------------------------
+	string cacheFilename(Request& request)
+	{
+		return App::path(
+			S_FMT("thumbcache/%08x%08x_%08x_%d.dat",
+				request.data.getSize(),
+				request.data.crc(),
+				request.palette_crc,
+				request.max_size),
+			App::Dir::User);
+	}
+
+	// ------------------------------------------------------------------------
+	// Reads the thumbnail for [request] from the disk cache, returns false if
+	// it isn't cached
+	// ------------------------------------------------------------------------
+	bool readCached(Request& request, const string& filename)
+	{
+		if (!wxFileExists(filename))
+			return false;
+
+		wxFile file(filename);
+		if (!file.IsOpened())
+			return false;
+
+		uint32_t header[6];
+		if (file.Read(header, sizeof(header)) != sizeof(header) ||
+			header[0] != THUMB_MAGIC ||
+			header[1] != THUMB_VERSION)
+			return false;
+
+		// Check the size is valid (generated thumbnails are never larger than
+		// the max size) and the file contains all the pixel data, so a
+		// corrupt or truncated file is rejected before allocating anything
+		uint32_t width = header[2];
+		uint32_t height = header[3];
+		if (width == 0 || height == 0 ||
+			width > (uint32_t)request.max_size ||
+			height > (uint32_t)request.max_size ||
+			header[4] == 0 || header[4] > INT_MAX ||
+			header[5] == 0 || header[5] > INT_MAX ||
+			file.Length() != (wxFileOffset)(sizeof(header) + width * height * 4))
+			return false;
+
+		request.width = width;
+		request.height = height;
+		request.full_width = header[4];
+		request.full_height = header[5];
+		request.rgba.resize(request.width * request.height * 4);
+		return file.Read(request.rgba.data(), request.rgba.size()) == (ssize_t)request.rgba.size();
+	}
+
+	// ------------------------------------------------------------------------
+	// Writes the thumbnail for [request] to the disk cache
+	// ------------------------------------------------------------------------
+	void writeCached(Request& request, const string& filename)
+	{
+		// Write to a temp file first, in case another thread is writing the
+		// same thumbnail
+		string temp = S_FMT("%s.%p", filename, &request);
+		wxFile file(temp, wxFile::write);
+		if (!file.IsOpened())
+			return;
+
+		uint32_t header[6] = {
+			THUMB_MAGIC,
+			THUMB_VERSION,
+			(uint32_t)request.width,
+			(uint32_t)request.height,
+			(uint32_t)request.full_width,
+			(uint32_t)request.full_height
+		};
+		bool ok = file.Write(header, sizeof(header)) == sizeof(header) &&
+			file.Write(request.rgba.data(), request.rgba.size()) == request.rgba.size();
+		file.Close();
+
+		if (!ok || !wxRenameFile(temp, filename, true))
+			wxRemoveFile(temp);
+	}
+
+	// ------------------------------------------------------------------------
+	// Decodes the image data in [request] and writes a thumbnail (scaled down
+	// to fit within the max size) to its result
+	// ------------------------------------------------------------------------
+	bool generateThumbnail(Request& request)
+	{
+		// Load image
+		SImage image;
+		if (!image.open(request.data, 0, request.format_hint))
+		{
+			// Try detecting/loading via FreeImage
+			if (!SIFormat::generalFormat()->isThisFormat(request.data) ||
+				!SIFormat::generalFormat()->loadImage(image, request.data))
+				return false;
+		}
+		if (!image.isValid())
+			return false;
+
+		// Get RGBA data
+		MemChunk rgba;
+		if (!image.getRGBAData(rgba, &request.palette))
+			return false;
+
+		// Determine thumbnail size
+		int width = image.getWidth();
+		int height = image.getHeight();
+		request.full_width = width;
+		request.full_height = height;
+		double scale = 1.0;
+		if (width > request.max_size || height > request.max_size)
+			scale = (double)request.max_size / (double)MAX(width, height);
+		request.width = MAX(1, (int)(width * scale));
+		request.height = MAX(1, (int)(height * scale));
+
+		// Scale down, averaging each block of source pixels
+		request.rgba.resize(request.width * request.height * 4);
+		const uint8_t* src = rgba.getData();
+		for (int y = 0; y < request.height; y++)
+		{
+			int sy1 = y * height / request.height;
+			int sy2 = MAX(sy1 + 1, (y + 1) * height / request.height);
+			for (int x = 0; x < request.width; x++)
+			{
+				int sx1 = x * width / request.width;
+				int sx2 = MAX(sx1 + 1, (x + 1) * width / request.width);
+
+				unsigned total[4] = { 0, 0, 0, 0 };
+				for (int sy = sy1; sy < sy2; sy++)
+					for (int sx = sx1; sx < sx2; sx++)
+						for (int c = 0; c < 4; c++)
+							total[c] += src[(sy * width + sx) * 4 + c];
+
+				unsigned count = (sx2 - sx1) * (sy2 - sy1);
+				uint8_t* dest = &request.rgba[(y * request.width + x) * 4];
+				for (int c = 0; c < 4; c++)
+					dest[c] = total[c] / count;
+			}
+		}
+
+		return true;
+	}
+
+	// ------------------------------------------------------------------------
+	// Thumbnail worker thread, processes requests until stopped
+	// ------------------------------------------------------------------------
+	void workerThread()
+	{
+		while (true)
+		{
+			// Wait for the next request. The most recent request is processed
+			// first, since it's most likely to still be visible
+			RequestPtr request;
+			{
+				std::unique_lock<std::mutex> lock(workers->mutex);
+				workers->requested.wait(lock, [] { return workers->stop || !workers->queue.empty(); });
+				if (workers->stop)
+					return;
+				request = workers->queue.back();
+				workers->queue.pop_back();
+			}
+
+			// Skip if the requesting item no longer exists
+			if (request.use_count() > 1)
+			{
+				string filename = browser_thumbnail_cache ? cacheFilename(*request) : "";
+				if (browser_thumbnail_cache && readCached(*request, filename))
+					request->success = true;
+				else if (generateThumbnail(*request))
+				{
+					request->success = true;
+					if (browser_thumbnail_cache)
+						writeCached(*request, filename);
+				}
+			}
+
+			request->done = true;
+			workers->pending--;
+		}
+	}
+}
+
+
+// ----------------------------------------------------------------------------
+//
+// ThumbnailCache Namespace Functions
+//
+// ----------------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------------
+// ThumbnailCache::request
+//
+// Requests a thumbnail (no larger than [max_size]) for image [entry], using
+// [palette]. Returns nullptr if a thumbnail can't be generated in the
+// background for the entry, in which case it should be loaded directly
+// ----------------------------------------------------------------------------
+RequestPtr ThumbnailCache::request(ArchiveEntry* entry, Palette* palette, int max_size)
+{
+	if (!entry)
+		return nullptr;
+
+	// Detect entry type if it isn't already
+	if (entry->getType() == EntryType::unknownType())
+		EntryType::detectEntryType(entry);
+
+	// Check the entry is an image that can be loaded from its data alone
+	// (see Misc::loadImageFromEntry)
+	auto type = entry->getType();
+	string format = type->formatId();
+	if (!type->extraProps().propertyExists("image") ||
+		format.StartsWith("font_") ||
+		format.StartsWith("img_jaguar") ||
+		format == "img_raw")
+		return nullptr;
+
+	// Setup request
+	auto request = std::make_shared<Request>();
+	request->data.importMem(entry->getData(), entry->getSize());
+	if (type->extraProps().propertyExists("image_format"))
+		request->format_hint = type->extraProps()["image_format"].getStringValue();
+	if (palette)
+		request->palette.copyPalette(palette);
+	uint8_t pal_data[256 * 4];
+	for (unsigned a = 0; a < 256; a++)
+	{
+		rgba_t col = request->palette.colour(a);
+		pal_data[a * 4] = col.r;
+		pal_data[a * 4 + 1] = col.g;
+		pal_data[a * 4 + 2] = col.b;
+		pal_data[a * 4 + 3] = col.a;
+	}
+	request->palette_crc = Misc::crc(pal_data, 256 * 4);
+	request->max_size = max_size;
+
+	// Start worker threads if needed
+	if (!workers)
+	{
+		if (!wxDirExists(cacheDir()))
+			wxMkdir(cacheDir());
+
+		// (hardware_concurrency can return 0 if it isn't known)
+		unsigned n_threads = browser_thumbnail_threads > 0 ?
+			(unsigned)browser_thumbnail_threads :
+			MAX(std::thread::hardware_concurrency(), 2u) - 1;
+
+		workers = new Workers();
+		for (unsigned a = 0; a < n_threads; a++)
+			workers->threads.emplace_back(workerThread);
+	}
+
+	// Queue request
+	{
+		std::lock_guard<std::mutex> lock(workers->mutex);
+		workers->queue.push_back(request);
+		workers->pending++;
+	}
+	workers->requested.notify_one();
+
+	return request;
+}
+
+// ----------------------------------------------------------------------------
+// ThumbnailCache::numPending
+//
+// Returns the number of thumbnail requests that haven't been processed yet
+// ----------------------------------------------------------------------------
+unsigned ThumbnailCache::numPending()
+{
+	return workers ? workers->pending.load() : 0;
+}
+
+// ----------------------------------------------------------------------------
+// ThumbnailCache::shutdown
+//
+// Stops the worker threads (after they finish any thumbnails currently being
+// generated) and waits for them to exit. Any queued requests are discarded
+// ----------------------------------------------------------------------------
+void ThumbnailCache::shutdown()
+{
+	if (!workers)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(workers->mutex);
+		workers->stop = true;
+		workers->queue.clear();
+	}
+	workers->requested.notify_all();
+
+	for (auto& thread : workers->threads)
+		thread.join();
+
+	delete workers;
+	workers = nullptr;
+}
+
+// ----------------------------------------------------------------------------
+// ThumbnailCache::clearDisk
+//
+// Deletes all cached thumbnail files
+// ----------------------------------------------------------------------------
+void ThumbnailCache::clearDisk()
+{
+	if (!wxDirExists(cacheDir()))
+		return;
+
+	wxArrayString files;
+	wxDir::GetAllFiles(cacheDir(), &files, "*.dat", wxDIR_FILES);
+	for (auto& file : files)
+		wxRemoveFile(file);
+}
+
+
+// ----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// ----------------------------------------------------------------------------
+
+CONSOLE_COMMAND(thumbnail_cache_clear, 0, true)
+{
+	ThumbnailCache::clearDisk();
+	Log::console("Cleared thumbnail cache");
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Graphics/Palette/Palette.h"
+#include <atomic>
+
+class ArchiveEntry;
+
+// Generates downscaled thumbnail images of image entries on background
+// threads, for browser items. Generated thumbnails are also cached on disk
+// (keyed by the entry data and palette), so they only need to be decoded once
+namespace ThumbnailCache
+{
+	// A thumbnail being generated. The request data is copied from the entry
+	// when created, so the worker thread never accesses the entry/archive
+	struct Request
+	{
+		// Request
+		MemChunk	data;
+		string		format_hint;
+		Palette		palette;
+		uint32_t	palette_crc	= 0;
+		int			max_size	= 128;
+
+		// Result (only valid once done is set)
+		std::atomic<bool>	done{ false };
+		bool				success	= false;
+		vector<uint8_t>		rgba;
+		int					width	= 0;
+		int					height	= 0;
+		int					full_width	= 0;	// Size of the full image
+		int					full_height	= 0;
+	};
+	typedef std::shared_ptr<Request> RequestPtr;
+
+	RequestPtr	request(ArchiveEntry* entry, Palette* palette, int max_size = 128);
+	unsigned	numPending();
+	void		shutdown();
+	void		clearDisk();
+}
@@ -40,6 +40,9 @@
 #include "MapEditor/SLADEMap/MapVertex.h"
 #include "OpenGL/GLTexture.h"
 #include "Utility/Tokenizer.h"
+#include <atomic>
+#include <list>
+#include <thread>
 
 
 /*******************************************************************
@@ -47,6 +50,404 @@
  *******************************************************************/
 CVAR(Float, map_image_thickness, 1.5, CVAR_SAVE)
 CVAR(Bool, map_view_things, true, CVAR_SAVE)
+CVAR(Int, map_preview_cache_size, 32, CVAR_SAVE)
+DEFINE_EVENT_TYPE(wxEVT_MAPPREVIEW_LOADED)
+
+// A map preview being loaded. The map data is copied from the
+// archive when created, so the job never accesses any entries
+struct mep_job_t
+{
+	// Input
+	int			format;
+	string		name;
+	string		key;
+	MemChunk	textmap;
+	MemChunk	vertexes;
+	MemChunk	linedefs;
+	MemChunk	things;
+	unsigned	size_sides;
+	unsigned	size_sectors;
+
+	// Result (only valid once done is set)
+	std::shared_ptr<mep_map_t>	map;
+	bool						ok = false;
+	std::atomic<bool>			done{ false };
+	std::atomic<bool>			cancelled{ false };
+};
+
+namespace
+{
+	// Cache of previously loaded previews, keyed by map data
+	// (see previewKey). Most recently used previews are at the
+	// end of the list
+	typedef std::pair<string, std::shared_ptr<mep_map_t>> cached_preview_t;
+	std::list<cached_preview_t> preview_cache;
+}
+
+
+/*******************************************************************
+ * FUNCTIONS
+ *******************************************************************/
+namespace
+{
+	/* getCachedPreview
+	 * Returns the cached preview with [key], or nullptr if it isn't
+	 * cached
+	 *******************************************************************/
+	std::shared_ptr<mep_map_t> getCachedPreview(const string& key)
+	{
+		for (auto i = preview_cache.begin(); i != preview_cache.end(); ++i)
+		{
+			if (i->first == key)
+			{
+				// Move to end (most recently used)
+				preview_cache.splice(preview_cache.end(), preview_cache, i);
+				return preview_cache.back().second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/* addCachedPreview
+	 * Adds [map] to the preview cache with [key], removing the least
+	 * recently used previews if the cache is full
+	 *******************************************************************/
+	void addCachedPreview(const string& key, std::shared_ptr<mep_map_t> map)
+	{
+		if (map_preview_cache_size <= 0)
+			return;
+
+		preview_cache.emplace_back(key, map);
+		while (preview_cache.size() > (unsigned)map_preview_cache_size)
+			preview_cache.pop_front();
+	}
+
+	/* findMapEntry
+	 * Returns the first entry of [type] in the map from [head] to [end]
+	 *******************************************************************/
+	ArchiveEntry* findMapEntry(ArchiveEntry* head, ArchiveEntry* end, EntryType* type)
+	{
+		while (head)
+		{
+			// Check entry type
+			if (head->getType() == type)
+				return head;
+
+			// Exit loop if we've reached the end of the map entries
+			if (head == end)
+				break;
+			else
+				head = head->nextEntry();
+		}
+
+		return nullptr;
+	}
+
+	/* previewKey
+	 * Returns a key identifying the map preview data in [entries]
+	 * (for the preview cache)
+	 *******************************************************************/
+	string previewKey(int format, const vector<ArchiveEntry*>& entries)
+	{
+		string key = S_FMT("%d", format);
+		for (auto entry : entries)
+		{
+			if (entry)
+				key += S_FMT(":%x_%08x", entry->getSize(), entry->getMCData().crc());
+			else
+				key += ":-";
+		}
+
+		return key;
+	}
+
+	/* readUDMF
+	 * Scans the UDMF TEXTMAP data in [job] for preview geometry.
+	 * Only vertex/thing positions and line vertices/flags are read,
+	 * everything else is skipped
+	 *******************************************************************/
+	bool readUDMF(mep_job_t& job, mep_map_t& map)
+	{
+		enum { OTHER, VERTEX, LINEDEF, THING, SIDEDEF, SECTOR };
+
+		Tokenizer tz;
+		tz.setViewMode(true);
+		tz.openMemView(job.textmap, job.name);
+
+		while (tz.current().valid)
+		{
+			if (job.cancelled)
+				return false;
+
+			// Global property (eg. namespace), skip
+			if (tz.checkNext('='))
+			{
+				while (tz.current().valid && !tz.check(';'))
+					tz.adv();
+				tz.adv();
+				continue;
+			}
+
+			// Get block type
+			int type = OTHER;
+			if (tz.checkNC("vertex"))
+				type = VERTEX;
+			else if (tz.checkNC("linedef"))
+				type = LINEDEF;
+			else if (tz.checkNC("thing"))
+				type = THING;
+			else if (tz.checkNC("sidedef"))
+				type = SIDEDEF;
+			else if (tz.checkNC("sector"))
+				type = SECTOR;
+
+			tz.adv();
+			if (!tz.advIf('{'))
+			{
+				LOG_MESSAGE(1, "Bad syntax in UDMF map data at line %d", tz.current().line_no);
+				return false;
+			}
+
+			// Read block properties
+			double x = 0., y = 0.;
+			int v1 = 0, v2 = 0;
+			bool got1 = false, got2 = false;
+			bool special = false, twosided = false;
+			while (tz.current().valid && !tz.check('}'))
+			{
+				// Check property name
+				int prop = 0;
+				if (type == VERTEX || type == THING)
+				{
+					if (tz.checkNC("x")) prop = 1;
+					else if (tz.checkNC("y")) prop = 2;
+				}
+				else if (type == LINEDEF)
+				{
+					if (tz.checkNC("v1")) prop = 1;
+					else if (tz.checkNC("v2")) prop = 2;
+					else if (tz.checkNC("special")) prop = 3;
+					else if (tz.checkNC("sideback")) prop = 4;
+				}
+
+				// Read value
+				tz.adv();
+				if (!tz.advIf('='))
+				{
+					LOG_MESSAGE(1, "Bad syntax in UDMF map data at line %d", tz.current().line_no);
+					return false;
+				}
+				if (type == LINEDEF)
+				{
+					if (prop == 1) v1 = tz.current().asInt(), got1 = true;
+					else if (prop == 2) v2 = tz.current().asInt(), got2 = true;
+					else if (prop == 3) special = tz.current().asInt() != 0;
+					else if (prop == 4) twosided = tz.current().asInt() >= 0;
+				}
+				else
+				{
+					if (prop == 1) x = tz.current().asFloat(), got1 = true;
+					else if (prop == 2) y = tz.current().asFloat(), got2 = true;
+				}
+
+				// Skip to end of property
+				while (tz.current().valid && !tz.check(';') && !tz.check('}'))
+					tz.adv();
+				tz.advIf(';');
+			}
+			tz.adv();
+
+			// Add object
+			if (type == VERTEX)
+			{
+				if (!got1 || !got2)
+				{
+					LOG_MESSAGE(1, "Wrong vertex %d in UDMF map data", (int)map.verts.size());
+					return false;
+				}
+				map.verts.push_back(mep_vertex_t(x, y));
+			}
+			else if (type == LINEDEF)
+			{
+				if (!got1 || !got2)
+				{
+					LOG_MESSAGE(1, "Wrong line %d in UDMF map data", (int)map.lines.size());
+					return false;
+				}
+				mep_line_t line(v1, v2);
+				line.twosided = twosided;
+				line.special = special;
+				line.macro = false;
+				map.lines.push_back(line);
+			}
+			else if (type == THING)
+			{
+				if (!got1 || !got2)
+				{
+					LOG_MESSAGE(1, "Wrong thing %d in UDMF map data", (int)map.things.size());
+					return false;
+				}
+				map.things.push_back({ x, y });
+			}
+			else if (type == SIDEDEF)
+				map.n_sides++;
+			else if (type == SECTOR)
+				map.n_sectors++;
+		}
+
+		return true;
+	}
+
+	/* readBinary
+	 * Reads preview geometry from the binary map lumps in [job]
+	 *******************************************************************/
+	bool readBinary(mep_job_t& job, mep_map_t& map)
+	{
+		// Vertices
+		const uint8_t* data = job.vertexes.getData();
+		if (job.format == MAP_DOOM64)
+		{
+			unsigned count = job.vertexes.getSize() / sizeof(doom64vertex_t);
+			map.verts.reserve(count);
+			for (unsigned a = 0; a < count; a++)
+			{
+				doom64vertex_t v;
+				memcpy(&v, data + a * sizeof(doom64vertex_t), sizeof(doom64vertex_t));
+				map.verts.push_back(mep_vertex_t((double)v.x/65536, (double)v.y/65536));
+			}
+		}
+		else
+		{
+			unsigned count = job.vertexes.getSize() / sizeof(doomvertex_t);
+			map.verts.reserve(count);
+			for (unsigned a = 0; a < count; a++)
+			{
+				doomvertex_t v;
+				memcpy(&v, data + a * sizeof(doomvertex_t), sizeof(doomvertex_t));
+				map.verts.push_back(mep_vertex_t(v.x, v.y));
+			}
+		}
+
+		if (job.cancelled)
+			return false;
+
+		// Lines
+		data = job.linedefs.getData();
+		if (job.format == MAP_DOOM)
+		{
+			unsigned count = job.linedefs.getSize() / sizeof(doomline_t);
+			map.lines.reserve(count);
+			for (unsigned a = 0; a < count; a++)
+			{
+				doomline_t l;
+				memcpy(&l, data + a * sizeof(doomline_t), sizeof(doomline_t));
+				mep_line_t line(l.vertex1, l.vertex2);
+				line.twosided = l.side2 != 0xFFFF;
+				line.special = l.type > 0;
+				line.macro = false;
+				map.lines.push_back(line);
+			}
+		}
+		else if (job.format == MAP_DOOM64)
+		{
+			unsigned count = job.linedefs.getSize() / sizeof(doom64line_t);
+			map.lines.reserve(count);
+			for (unsigned a = 0; a < count; a++)
+			{
+				doom64line_t l;
+				memcpy(&l, data + a * sizeof(doom64line_t), sizeof(doom64line_t));
+				mep_line_t line(l.vertex1, l.vertex2);
+				line.twosided = l.side2 != 0xFFFF;
+				line.macro = l.type > 0 && (l.type & 0x100);
+				line.special = l.type > 0 && !line.macro;
+				map.lines.push_back(line);
+			}
+		}
+		else if (job.format == MAP_HEXEN)
+		{
+			unsigned count = job.linedefs.getSize() / sizeof(hexenline_t);
+			map.lines.reserve(count);
+			for (unsigned a = 0; a < count; a++)
+			{
+				hexenline_t l;
+				memcpy(&l, data + a * sizeof(hexenline_t), sizeof(hexenline_t));
+				mep_line_t line(l.vertex1, l.vertex2);
+				line.twosided = l.side2 != 0xFFFF;
+				line.special = l.type > 0;
+				line.macro = false;
+				map.lines.push_back(line);
+			}
+		}
+
+		if (job.cancelled)
+			return false;
+
+		// Things
+		data = job.things.getData();
+		if (job.format == MAP_DOOM)
+		{
+			unsigned count = job.things.getSize() / sizeof(doomthing_t);
+			map.things.reserve(count);
+			for (unsigned a = 0; a < count; a++)
+			{
+				doomthing_t t;
+				memcpy(&t, data + a * sizeof(doomthing_t), sizeof(doomthing_t));
+				map.things.push_back({ (double)t.x, (double)t.y });
+			}
+		}
+		else if (job.format == MAP_DOOM64)
+		{
+			unsigned count = job.things.getSize() / sizeof(doom64thing_t);
+			map.things.reserve(count);
+			for (unsigned a = 0; a < count; a++)
+			{
+				doom64thing_t t;
+				memcpy(&t, data + a * sizeof(doom64thing_t), sizeof(doom64thing_t));
+				map.things.push_back({ (double)t.x, (double)t.y });
+			}
+		}
+		else if (job.format == MAP_HEXEN)
+		{
+			unsigned count = job.things.getSize() / sizeof(hexenthing_t);
+			map.things.reserve(count);
+			for (unsigned a = 0; a < count; a++)
+			{
+				hexenthing_t t;
+				memcpy(&t, data + a * sizeof(hexenthing_t), sizeof(hexenthing_t));
+				map.things.push_back({ (double)t.x, (double)t.y });
+			}
+		}
+
+		// Sides & sectors (count only)
+		if (job.format == MAP_DOOM64)
+		{
+			map.n_sides = job.size_sides / 12;
+			map.n_sectors = job.size_sectors / 16;
+		}
+		else
+		{
+			map.n_sides = job.size_sides / 30;
+			map.n_sectors = job.size_sectors / 26;
+		}
+
+		return true;
+	}
+
+	/* runJob
+	 * Loads the map preview for [job]
+	 *******************************************************************/
+	void runJob(mep_job_t& job)
+	{
+		job.map = std::make_shared<mep_map_t>();
+		if (job.format == MAP_UDMF)
+			job.ok = readUDMF(job, *job.map);
+		else
+			job.ok = readBinary(job, *job.map);
+
+		job.done = true;
+	}
+}
 
 
 /*******************************************************************
@@ -66,6 +467,10 @@ MapPreviewCanvas::MapPreviewCanvas(wxWindow* parent) : OGLCanvas(parent, -1)
 	tex_loaded = false;
 	n_sides = 0;
 	n_sectors = 0;
+
+	// Check for background loading completion on a timer
+	load_timer.SetOwner(this);
+	Bind(wxEVT_TIMER, [&](wxTimerEvent&) { finishLoading(false); }, load_timer.GetId());
 }
 
 /* MapPreviewCanvas::~MapPreviewCanvas
@@ -73,6 +478,7 @@ MapPreviewCanvas::MapPreviewCanvas(wxWindow* parent) : OGLCanvas(parent, -1)
  *******************************************************************/
 MapPreviewCanvas::~MapPreviewCanvas()
 {
+	if (load_job) load_job->cancelled = true;
 	if (tex_thing) delete tex_thing;
 }
 
@@ -108,10 +514,21 @@ void MapPreviewCanvas::addThing(double x, double y)
 }
 
 /* MapPreviewCanvas::openMap
- * Opens a map from a mapdesc_t
+ * Opens a map from a mapdesc_t. If [background] is true and the
+ * map isn't already cached, it is loaded on a background thread and
+ * a wxEVT_MAPPREVIEW_LOADED event is sent once it has finished
+ * loading (see isLoading)
  *******************************************************************/
-bool MapPreviewCanvas::openMap(Archive::MapDesc map)
+bool MapPreviewCanvas::openMap(Archive::MapDesc map, bool background)
 {
+	// Cancel any current background load
+	if (load_job)
+	{
+		load_job->cancelled = true;
+		load_job = nullptr;
+		load_timer.Stop();
+	}
+
 	// All errors = invalid map
 	Global::error = "Invalid map";
 
@@ -126,6 +543,7 @@ bool MapPreviewCanvas::openMap(Archive::MapDesc map)
 		if (!temp_archive->open(map.head))
 		{
 			delete temp_archive;
+			temp_archive = nullptr;
 			return false;
 		}
 
@@ -136,223 +554,51 @@ bool MapPreviewCanvas::openMap(Archive::MapDesc map)
 		if (maps.size() > 0)
 			map = maps[0];
 		else
-			return false;
-	}
-
-	// Parse UDMF map
-	if (map.format == MAP_UDMF)
-	{
-		ArchiveEntry* udmfdata = nullptr;
-		for (ArchiveEntry* mapentry = map.head; mapentry != map.end; mapentry = mapentry->nextEntry())
 		{
-			// Check entry type
-			if (mapentry->getType() == EntryType::fromId("udmf_textmap"))
-			{
-				udmfdata = mapentry;
-				break;
-			}
-		}
-		if (udmfdata == nullptr)
+			delete temp_archive;
+			temp_archive = nullptr;
 			return false;
-
-		// Start parsing
-		Tokenizer tz;
-		tz.openMem(udmfdata->getMCData(), map.head->getName());
-
-		// Get first token
-		string token = tz.getToken();
-		size_t vertcounter = 0, linecounter = 0, thingcounter = 0;
-		while (!token.IsEmpty())
-		{
-			if (!token.CmpNoCase("namespace"))
-			{
-				//  skip till we reach the ';'
-				do { token = tz.getToken(); }
-				while (token.Cmp(";"));
-			}
-			else if (!token.CmpNoCase("vertex"))
-			{
-				// Get X and Y properties
-				bool gotx = false;
-				bool goty = false;
-				double x = 0.;
-				double y = 0.;
-				do
-				{
-					token = tz.getToken();
-					if (!token.CmpNoCase("x") || !token.CmpNoCase("y"))
-					{
-						bool isx = !token.CmpNoCase("x");
-						token = tz.getToken();
-						if (token.Cmp("="))
-						{
-							LOG_MESSAGE(1, "Bad syntax for vertex %i in UDMF map data", vertcounter);
-							return false;
-						}
-						if (isx) x = tz.getDouble(), gotx = true;
-						else y = tz.getDouble(), goty = true;
-						// skip to end of declaration after each key
-						do { token = tz.getToken(); }
-						while (token.Cmp(";"));
-					}
-				}
-				while (token.Cmp("}"));
-				if (gotx && goty)
-					addVertex(x, y);
-				else
-				{
-					LOG_MESSAGE(1, "Wrong vertex %i in UDMF map data", vertcounter);
-					return false;
-				}
-				vertcounter++;
-			}
-			else if (!token.CmpNoCase("linedef"))
-			{
-				bool special = false;
-				bool twosided = false;
-				bool gotv1 = false, gotv2 = false;
-				size_t v1 = 0, v2 = 0;
-				do
-				{
-					token = tz.getToken();
-					if (!token.CmpNoCase("v1") || !token.CmpNoCase("v2"))
-					{
-						bool isv1 = !token.CmpNoCase("v1");
-						token = tz.getToken();
-						if (token.Cmp("="))
-						{
-							LOG_MESSAGE(1, "Bad syntax for linedef %i in UDMF map data", linecounter);
-							return false;
-						}
-						if (isv1) v1 = tz.getInteger(), gotv1 = true;
-						else v2 = tz.getInteger(), gotv2 = true;
-						// skip to end of declaration after each key
-						do { token = tz.getToken(); }
-						while (token.Cmp(";"));
-					}
-					else if (!token.CmpNoCase("special"))
-					{
-						special = true;
-						// skip to end of declaration after each key
-						do { token = tz.getToken(); }
-						while (token.Cmp(";"));
-					}
-					else if (!token.CmpNoCase("sideback"))
-					{
-						twosided = true;
-						// skip to end of declaration after each key
-						do { token = tz.getToken(); }
-						while (token.Cmp(";"));
-					}
-				}
-				while (token.Cmp("}"));
-				if (gotv1 && gotv2)
-					addLine(v1, v2, twosided, special);
-				else
-				{
-					LOG_MESSAGE(1, "Wrong line %i in UDMF map data", linecounter);
-					return false;
-				}
-				linecounter++;
-			}
-			else if (S_CMPNOCASE(token, "thing"))
-			{
-				// Get X and Y properties
-				bool gotx = false;
-				bool goty = false;
-				double x = 0.;
-				double y = 0.;
-				do
-				{
-					token = tz.getToken();
-					if (!token.CmpNoCase("x") || !token.CmpNoCase("y"))
-					{
-						bool isx = !token.CmpNoCase("x");
-						token = tz.getToken();
-						if (token.Cmp("="))
-						{
-							LOG_MESSAGE(1, "Bad syntax for thing %i in UDMF map data", vertcounter);
-							return false;
-						}
-						if (isx) x = tz.getDouble(), gotx = true;
-						else y = tz.getDouble(), goty = true;
-						// skip to end of declaration after each key
-						do { token = tz.getToken(); } while (token.Cmp(";"));
-					}
-				} while (token.Cmp("}"));
-				if (gotx && goty)
-					addThing(x, y);
-				else
-				{
-					LOG_MESSAGE(1, "Wrong thing %i in UDMF map data", vertcounter);
-					return false;
-				}
-				vertcounter++;
-			}
-			else
-			{
-				// Check for side or sector definition (increase counts)
-				if (S_CMPNOCASE(token, "sidedef"))
-					n_sides++;
-				else if (S_CMPNOCASE(token, "sector"))
-					n_sectors++;
-
-				// map preview ignores sidedefs, sectors, comments,
-				// unknown fields, etc. so skip to end of block
-				do { token = tz.getToken(); }
-				while (token.Cmp("}") && !token.empty());
-			}
-			// Iterate to next token
-			token = tz.getToken();
 		}
 	}
 
-	// Non-UDMF map
-	if (map.format != MAP_UDMF)
+	// Find map data entries
+	vector<ArchiveEntry*> entries;
+	if (map.format == MAP_UDMF)
+		entries.push_back(findMapEntry(map.head, map.end, EntryType::fromId("udmf_textmap")));
+	else
 	{
-		// Read vertices (required)
-		if (!readVertices(map.head, map.end, map.format))
-			return false;
-
-		// Read linedefs (required)
-		if (!readLines(map.head, map.end, map.format))
-			return false;
+		entries.push_back(findMapEntry(map.head, map.end, EntryType::fromId("map_vertexes")));
+		entries.push_back(findMapEntry(map.head, map.end, EntryType::fromId("map_linedefs")));
+		entries.push_back(findMapEntry(map.head, map.end, EntryType::fromId("map_things")));
+		entries.push_back(findMapEntry(map.head, map.end, EntryType::fromId("map_sidedefs")));
+		entries.push_back(findMapEntry(map.head, map.end, EntryType::fromId("map_sectors")));
+	}
 
-		// Read things
-		if (map.format != MAP_UDMF)
-			readThings(map.head, map.end, map.format);
+	// Can't open a map without vertices and lines (or TEXTMAP)
+	bool valid = entries[0] && (map.format == MAP_UDMF || entries[1]);
 
-		// Read sides & sectors (count only)
-		ArchiveEntry* sidedefs = nullptr;
-		ArchiveEntry* sectors = nullptr;
-		while (map.head)
-		{
-			// Check entry type
-			if (map.head->getType() == EntryType::fromId("map_sidedefs"))
-				sidedefs = map.head;
-			if (map.head->getType() == EntryType::fromId("map_sectors"))
-				sectors = map.head;
-
-			// Exit loop if we've reached the end of the map entries
-			if (map.head == map.end)
-				break;
-			else
-				map.head = map.head->nextEntry();
-		}
-		if (sidedefs && sectors)
+	// Use cached preview if the map data is unchanged, otherwise
+	// copy the map data for loading
+	std::shared_ptr<mep_map_t> cached;
+	auto job = std::make_shared<mep_job_t>();
+	if (valid)
+	{
+		job->key = previewKey(map.format, entries);
+		cached = getCachedPreview(job->key);
+		if (!cached)
 		{
-			// Doom64 map
-			if (map.format != MAP_DOOM64)
-			{
-				n_sides = sidedefs->getSize() / 30;
-				n_sectors = sectors->getSize() / 26;
-			}
-
-			// Doom/Hexen map
+			job->format = map.format;
+			job->name = map.head->getName();
+			if (map.format == MAP_UDMF)
+				job->textmap.importMem(entries[0]->getData(), entries[0]->getSize());
 			else
 			{
-				n_sides = sidedefs->getSize() / 12;
-				n_sectors = sectors->getSize() / 16;
+				job->vertexes.importMem(entries[0]->getData(), entries[0]->getSize());
+				job->linedefs.importMem(entries[1]->getData(), entries[1]->getSize());
+				if (entries[2])
+					job->things.importMem(entries[2]->getData(), entries[2]->getSize());
+				job->size_sides = entries[3] ? entries[3]->getSize() : 0;
+				job->size_sectors = entries[4] ? entries[4]->getSize() : 0;
 			}
 		}
 	}
@@ -365,226 +611,88 @@ bool MapPreviewCanvas::openMap(Archive::MapDesc map)
 		temp_archive = nullptr;
 	}
 
-	// Refresh map
-	Refresh();
-
-	return true;
-}
+	if (!valid)
+		return false;
 
-/* MapPreviewCanvas::readVertices
- * Reads non-UDMF vertex data
- *******************************************************************/
-bool MapPreviewCanvas::readVertices(ArchiveEntry* map_head, ArchiveEntry* map_end, int map_format)
-{
-	// Find VERTEXES entry
-	ArchiveEntry* vertexes = nullptr;
-	while (map_head)
+	// Cached
+	if (cached)
 	{
-		// Check entry type
-		if (map_head->getType() == EntryType::fromId("map_vertexes"))
-		{
-			vertexes = map_head;
-			break;
-		}
-
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
+		applyMap(*cached);
+		Refresh();
+		return true;
 	}
 
-	// Can't open a map without vertices
-	if (!vertexes)
-		return false;
-
-	// Read vertex data
-	MemChunk& mc = vertexes->getMCData();
-	mc.seek(0, SEEK_SET);
-
-	if (map_format == MAP_DOOM64)
+	// Load in the background
+	if (background)
 	{
-		doom64vertex_t v;
-		while (1)
-		{
-			// Read vertex
-			if (!mc.read(&v, 8))
-				break;
-
-			// Add vertex
-			addVertex((double)v.x/65536, (double)v.y/65536);
-		}
+		load_job = job;
+		std::thread([job]() { runJob(*job); }).detach();
+		load_timer.Start(20);
+		Refresh();
+		return true;
 	}
-	else
-	{
-		doomvertex_t v;
-		while (1)
-		{
-			// Read vertex
-			if (!mc.read(&v, 4))
-				break;
 
-			// Add vertex
-			addVertex((double)v.x, (double)v.y);
-		}
-	}
+	// Load now
+	runJob(*job);
+	if (!job->ok)
+		return false;
+	addCachedPreview(job->key, job->map);
+	applyMap(*job->map);
+
+	// Refresh map
+	Refresh();
 
 	return true;
 }
 
-/* MapPreviewCanvas::readLines
- * Reads non-UDMF line data
+/* MapPreviewCanvas::applyMap
+ * Sets the preview map data to [map]
  *******************************************************************/
-bool MapPreviewCanvas::readLines(ArchiveEntry* map_head, ArchiveEntry* map_end, int map_format)
+void MapPreviewCanvas::applyMap(const mep_map_t& map)
 {
-	// Find LINEDEFS entry
-	ArchiveEntry* linedefs = nullptr;
-	while (map_head)
-	{
-		// Check entry type
-		if (map_head->getType() == EntryType::fromId("map_linedefs"))
-		{
-			linedefs = map_head;
-			break;
-		}
-
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
-	}
-
-	// Can't open a map without linedefs
-	if (!linedefs)
-		return false;
-
-	// Read line data
-	MemChunk& mc = linedefs->getMCData();
-	mc.seek(0, SEEK_SET);
-	if (map_format == MAP_DOOM)
-	{
-		while (1)
-		{
-			// Read line
-			doomline_t l;
-			if (!mc.read(&l, sizeof(doomline_t)))
-				break;
-
-			// Check properties
-			bool special = false;
-			bool twosided = false;
-			if (l.side2 != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
-				special = true;
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special);
-		}
-	}
-	else if (map_format == MAP_DOOM64)
-	{
-		while (1)
-		{
-			// Read line
-			doom64line_t l;
-			if (!mc.read(&l, sizeof(doom64line_t)))
-				break;
-
-			// Check properties
-			bool macro = false;
-			bool special = false;
-			bool twosided = false;
-			if (l.side2  != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
-			{
-				if (l.type & 0x100)
-					macro = true;
-				else special = true;
-			}
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special, macro);
-		}
-	}
-	else if (map_format == MAP_HEXEN)
-	{
-		while (1)
-		{
-			// Read line
-			hexenline_t l;
-			if (!mc.read(&l, sizeof(hexenline_t)))
-				break;
-
-			// Check properties
-			bool special = false;
-			bool twosided = false;
-			if (l.side2 != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
-				special = true;
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special);
-		}
-	}
-
-	return true;
+	verts = map.verts;
+	lines = map.lines;
+	things = map.things;
+	n_sides = map.n_sides;
+	n_sectors = map.n_sectors;
 }
 
-/* MapPreviewCanvas::readThings
- * Reads non-UDMF thing data
+/* MapPreviewCanvas::finishLoading
+ * Checks if the current background load has finished, and applies
+ * the loaded map if so. If [wait] is true, waits for the load to
+ * finish first
  *******************************************************************/
-bool MapPreviewCanvas::readThings(ArchiveEntry* map_head, ArchiveEntry* map_end, int map_format)
+void MapPreviewCanvas::finishLoading(bool wait)
 {
-	// Find THINGS entry
-	ArchiveEntry* things = nullptr;
-	while (map_head)
-	{
-		// Check entry type
-		if (map_head->getType() == EntryType::fromId("map_things"))
-		{
-			things = map_head;
-			break;
-		}
+	if (!load_job)
+		return;
 
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
+	// Check if finished
+	if (wait)
+	{
+		while (!load_job->done)
+			wxMilliSleep(1);
 	}
+	else if (!load_job->done)
+		return;
 
-	// No things
-	if (!things)
-		return false;
+	auto job = load_job;
+	load_job = nullptr;
+	load_timer.Stop();
 
-	// Read things data
-	if (map_format == MAP_DOOM)
+	// Apply loaded map
+	if (job->ok)
 	{
-		doomthing_t* thng_data = (doomthing_t*)things->getData(true);
-		unsigned nt = things->getSize() / sizeof(doomthing_t);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
-	}
-	else if (map_format == MAP_DOOM64)
-	{
-		doom64thing_t* thng_data = (doom64thing_t*)things->getData(true);
-		unsigned nt = things->getSize() / sizeof(doom64thing_t);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
-	}
-	else if (map_format == MAP_HEXEN)
-	{
-		hexenthing_t* thng_data = (hexenthing_t*)things->getData(true);
-		unsigned nt = things->getSize() / sizeof(hexenthing_t);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
+		addCachedPreview(job->key, job->map);
+		applyMap(*job->map);
+		Refresh();
 	}
 
-	return true;
+	// Send loaded event
+	wxCommandEvent e(wxEVT_MAPPREVIEW_LOADED, GetId());
+	e.SetEventObject(this);
+	e.SetInt(job->ok ? 1 : 0);
+	GetEventHandler()->ProcessEvent(e);
 }
 
 /* MapPreviewCanvas::clearMap
@@ -592,6 +700,14 @@ bool MapPreviewCanvas::readThings(ArchiveEntry* map_head, ArchiveEntry* map_end,
  *******************************************************************/
 void MapPreviewCanvas::clearMap()
 {
+	// Cancel any current background load
+	if (load_job)
+	{
+		load_job->cancelled = true;
+		load_job = nullptr;
+		load_timer.Stop();
+	}
+
 	verts.clear();
 	lines.clear();
 	things.clear();
@@ -781,6 +897,9 @@ void MapPreviewCanvas::draw()
  *******************************************************************/
 void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 {
+	// Make sure the map has finished loading
+	finishLoading(true);
+
 	// Find extents of map
 	mep_vertex_t m_min(999999.0, 999999.0);
 	mep_vertex_t m_max(-999999.0, -999999.0);
@@ -30,6 +30,17 @@ struct mep_thing_t
 	double	y;
 };
 
+// Preview geometry for a whole map
+struct mep_map_t
+{
+	vector<mep_vertex_t>	verts;
+	vector<mep_line_t>		lines;
+	vector<mep_thing_t>		things;
+	unsigned				n_sides = 0;
+	unsigned				n_sectors = 0;
+};
+
+struct mep_job_t;
 class GLTexture;
 class MapPreviewCanvas : public OGLCanvas
 {
@@ -46,6 +57,13 @@ private:
 	GLTexture*				tex_thing;
 	bool					tex_loaded;
 
+	// Background loading
+	std::shared_ptr<mep_job_t>	load_job;
+	wxTimer						load_timer;
+
+	void	applyMap(const mep_map_t& map);
+	void	finishLoading(bool wait);
+
 public:
 	MapPreviewCanvas(wxWindow* parent);
 	~MapPreviewCanvas();
@@ -53,10 +71,8 @@ public:
 	void addVertex(double x, double y);
 	void addLine(unsigned v1, unsigned v2, bool twosided, bool special, bool macro = false);
 	void addThing(double x, double y);
-	bool openMap(Archive::MapDesc map);
-	bool readVertices(ArchiveEntry* map_head, ArchiveEntry* map_end, int map_format);
-	bool readLines(ArchiveEntry* map_head, ArchiveEntry* map_end, int map_format);
-	bool readThings(ArchiveEntry* map_head, ArchiveEntry* map_end, int map_format);
+	bool openMap(Archive::MapDesc map, bool background = false);
+	bool isLoading() { return load_job != nullptr; }
 	void clearMap();
 	void showMap();
 	void draw();
@@ -71,4 +87,6 @@ public:
 	unsigned	getHeight();
 };
 
+DECLARE_EVENT_TYPE(wxEVT_MAPPREVIEW_LOADED, -1)
+
 #endif//__MAP_PREVIEW_CANVAS_H__
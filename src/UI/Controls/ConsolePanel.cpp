@@ -145,8 +145,8 @@ void ConsolePanel::update()
 	setupTextArea();
 
 	// Check if any new log messages were added since the last update
-	auto& log = Log::history();
-	if (log.size() <= next_message_index_)
+	auto log = Log::history(next_message_index_);
+	if (log.empty())
 	{
 		// None added, check again in 500ms
 		timer_update_.Start(500);
@@ -155,19 +155,21 @@ void ConsolePanel::update()
 
 	// Add new log messages to log text area
 	text_log_->SetEditable(true);
-	for (auto a = next_message_index_; a < log.size(); ++a)
+	for (unsigned index = 0; index < log.size(); ++index)
 	{
+		auto a = next_message_index_ + index;
+		auto& message = log[index];
 		if (a > 0)
 			text_log_->AppendText("\n");
 
 		// Add message line + timestamp margin
-		text_log_->AppendText(log[a].message);
-		text_log_->MarginSetText(a, wxDateTime(log[a].timestamp).FormatISOTime());
+		text_log_->AppendText(message.message);
+		text_log_->MarginSetText(a, wxDateTime(message.timestamp).FormatISOTime());
 		text_log_->MarginSetStyle(a, wxSTC_STYLE_LINENUMBER);
 
 		// Set line colour depending on message type
 		text_log_->StartStyling(text_log_->GetLineEndPosition(a) - text_log_->GetLineLength(a), 0);
-		switch (log[a].type)
+		switch (message.type)
 		{
 		case Log::MessageType::Error:
 			text_log_->SetStyling(text_log_->GetLineLength(a), 200); break;
@@ -182,7 +184,7 @@ void ConsolePanel::update()
 	}
 	text_log_->SetEditable(false);
 
-	next_message_index_ = Log::history().size();
+	next_message_index_ += log.size();
 	text_log_->ScrollToEnd();
 
 	// Check again in 100ms
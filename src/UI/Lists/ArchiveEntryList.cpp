@@ -32,10 +32,13 @@
 // ----------------------------------------------------------------------------
 #include "Main.h"
 #include "ArchiveEntryList.h"
+#include "App.h"
 #include "Graphics/Icons.h"
 #include "General/ColourConfiguration.h"
+#include "General/Console/Console.h"
 #include "General/UndoRedo.h"
 #include "UI/WxUtils.h"
+#include <unordered_set>
 
 
 // ----------------------------------------------------------------------------
@@ -68,6 +71,124 @@ wxDEFINE_EVENT(EVT_AEL_DIR_CHANGED, wxCommandEvent);
 EXTERN_CVAR(Bool, list_font_monospace)
 
 
+// ----------------------------------------------------------------------------
+//
+// Functions
+//
+// ----------------------------------------------------------------------------
+namespace
+{
+	// Sort key for a list item, precomputed so that sort comparisons don't
+	// need to query (and copy) entry names, sizes or column text
+	struct ItemSortKey
+	{
+		long	index;
+		bool	folder;
+		string	text;	// Name, or lowercase column text
+		int		size;
+	};
+
+	enum class SortMode
+	{
+		Name,
+		Size,
+		Index,
+		Text
+	};
+
+	// ------------------------------------------------------------------------
+	// Sorts [keys] by [mode], with folders always first
+	// ------------------------------------------------------------------------
+	void sortItemKeys(vector<ItemSortKey>& keys, SortMode mode, bool descend)
+	{
+		std::sort(keys.begin(), keys.end(), [mode, descend](const ItemSortKey& left, const ItemSortKey& right)
+		{
+			// Sort folder->entry first
+			if (left.folder != right.folder)
+				return left.folder;
+
+			switch (mode)
+			{
+			case SortMode::Name:
+				return descend ? left.text > right.text : left.text < right.text;
+			case SortMode::Size:
+				return descend ? left.size > right.size : left.size < right.size;
+			case SortMode::Index:
+				return descend ? left.index > right.index : left.index < right.index;
+			default:
+			{
+				// Sort by column text > index
+				int result = left.text.compare(right.text);
+				if (result == 0)
+					return left.index < right.index;
+				return descend ? result > 0 : result < 0;
+			}
+			}
+		});
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns the name filter terms (lowercase with * added to the end) from
+	// comma-separated [filter] text
+	// ------------------------------------------------------------------------
+	vector<string> filterTerms(const string& filter)
+	{
+		vector<string> terms;
+		for (auto term : wxSplit(filter, ','))
+		{
+			// Remove spaces
+			term.Replace(" ", "");
+
+			// Set to lowercase and add * to the end
+			if (!term.IsEmpty())
+				term = term.Lower() + "*";
+
+			terms.push_back(term);
+		}
+
+		return terms;
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns true if lowercase [name] matches any of the filter [terms]
+	// ------------------------------------------------------------------------
+	bool matchesFilterTerms(const string& name, const vector<string>& terms)
+	{
+		for (auto& term : terms)
+			if (name.Matches(term))
+				return true;
+
+		return false;
+	}
+
+	// ------------------------------------------------------------------------
+	// Returns true if every name matching [terms] would also match
+	// [prev_terms], ie. [terms] can be applied to the already filtered list
+	// (eg. when more text is typed into the filter)
+	// ------------------------------------------------------------------------
+	bool filterTermsRefine(const vector<string>& terms, const vector<string>& prev_terms)
+	{
+		if (terms.empty() || terms.size() != prev_terms.size())
+			return false;
+
+		for (unsigned a = 0; a < terms.size(); a++)
+		{
+			// Previous term must be a prefix of the new term (excluding the
+			// trailing *)
+			if (prev_terms[a].IsEmpty())
+			{
+				if (!terms[a].IsEmpty())
+					return false;
+			}
+			else if (!terms[a].StartsWith(prev_terms[a].Left(prev_terms[a].length() - 1)))
+				return false;
+		}
+
+		return true;
+	}
+}
+
+
 // ----------------------------------------------------------------------------
 //
 // ArchiveEntryList Class Functions
@@ -89,6 +210,7 @@ EXTERN_CVAR(Bool, list_font_monospace)
 	show_dir_back = false;
 	undo_manager = nullptr;
 	entries_update = true;
+	filter_refinable = false;
 
 	// Create dummy 'up folder' entry
 	entry_dir_back = new ArchiveEntry();
@@ -294,6 +416,7 @@ void ArchiveEntryList::setArchive(Archive* archive)
 
 		// Open root directory
 		current_dir = archive->rootDir();
+		filter_names.clear();
 		applyFilter();
 		updateList();
 	}
@@ -403,31 +526,33 @@ void ArchiveEntryList::updateList(bool clear)
 // ----------------------------------------------------------------------------
 void ArchiveEntryList::filterList(string filter, string category)
 {
+	// Check if the new filter can be applied to the currently filtered list
+	auto terms = filterTerms(filter);
+	bool refine = filter_refinable && category == filter_category && filterTermsRefine(terms, filter_terms);
+
 	// Update variables
 	filter_text = filter;
 	filter_category = category;
 
 	// Save current selection
 	vector<ArchiveEntry*> selection = getSelectedEntries();
+	std::unordered_set<ArchiveEntry*> selected(selection.begin(), selection.end());
 	ArchiveEntry* focus = getFocusedEntry();
 
 	// Apply the filter
 	clearSelection();
-	applyFilter();
+	if (refine)
+		refineFilter(terms);
+	else
+		applyFilter();
 
 	// Restore selection (if selected entries aren't filtered)
 	ArchiveEntry* entry = nullptr;
 	for (int a = 0; a < GetItemCount(); a++)
 	{
-		entry = getEntry(a, false);
-		for (unsigned b = 0; b < selection.size(); b++)
-		{
-			if (entry == selection[b])
-			{
-				selectItem(a);
-				break;
-			}
-		}
+		entry = getEntry(a);
+		if (selected.count(entry))
+			selectItem(a);
 
 		if (entry == focus)
 		{
@@ -446,6 +571,8 @@ void ArchiveEntryList::applyFilter()
 {
 	// Clear current filter list
 	items.clear();
+	filter_terms.clear();
+	filter_refinable = true;
 
 	// Check if any filters were given
 	if (filter_text.IsEmpty() && filter_category.IsEmpty())
@@ -479,49 +606,88 @@ void ArchiveEntryList::applyFilter()
 	// Now filter by name if needed
 	if (!filter_text.IsEmpty())
 	{
-		// Split filter by ,
-		wxArrayString terms = wxSplit(filter_text, ',');
+		filter_terms = filterTerms(filter_text);
+		updateFilterNames();
+
+		vector<long> filtered;
+		filtered.reserve(items.size());
+		for (auto item : items)
+			if (itemMatchesFilter(item, filter_terms))
+				filtered.push_back(item);
+		items.swap(filtered);
+	}
 
-		// Process filter strings
-		for (unsigned a = 0; a < terms.size(); a++)
-		{
-			// Remove spaces
-			terms[a].Replace(" ", "");
+	// Update the list
+	updateList();
+}
 
-			// Set to lowercase and add * to the end
-			if (!terms[a].IsEmpty()) terms[a] = terms[a].Lower() + "*";
-		}
+// ----------------------------------------------------------------------------
+// ArchiveEntryList::updateFilterNames
+//
+// Builds the list of lowercase item names used for name filtering, if it
+// isn't already up to date
+// ----------------------------------------------------------------------------
+void ArchiveEntryList::updateFilterNames()
+{
+	unsigned count = current_dir->numEntries() + current_dir->nChildren();
+	if (show_dir_back && current_dir->getParent())
+		count++;
+	if (filter_names.size() == count)
+		return;
 
-		// Go through filtered list
-		for (unsigned a = 0; a < items.size(); a++)
-		{
-			entry = getEntry(items[a], false);
+	filter_names.clear();
+	filter_names.reserve(count);
+	unsigned index = 0;
+	ArchiveEntry* entry = getEntry(index, false);
+	while (entry)
+	{
+		filter_names.push_back(entry->getName().Lower());
+		entry = getEntry(++index, false);
+	}
+}
 
-			// Don't filter folders if !elist_filter_dirs
-			if (!elist_filter_dirs && entry->getType() == EntryType::folderType())
-				continue;
+// ----------------------------------------------------------------------------
+// ArchiveEntryList::itemMatchesFilter
+//
+// Returns true if the item at (unfiltered) [index] matches the name filter
+// [terms]
+// ----------------------------------------------------------------------------
+bool ArchiveEntryList::itemMatchesFilter(long index, const vector<string>& terms)
+{
+	ArchiveEntry* entry = getEntry(index, false);
 
-			// Check for name match with filter
-			bool match = false;
-			for (unsigned b = 0; b < terms.size(); b++)
-			{
-				if (entry == entry_dir_back || entry->getName().Lower().Matches(terms[b]))
-				{
-					match = true;
-					continue;
-				}
-			}
-			if (match)
-				continue;
+	// Don't filter folders if !elist_filter_dirs
+	if (!elist_filter_dirs && entry->getType() == EntryType::folderType())
+		return true;
 
-			// No match, remove from filtered list
-			items.erase(items.begin() + a);
-			a--;
-		}
-	}
+	// Check for name match with filter
+	if (entry == entry_dir_back)
+		return true;
 
-	// Update the list
-	updateList();
+	return (unsigned)index < filter_names.size() && matchesFilterTerms(filter_names[index], terms);
+}
+
+// ----------------------------------------------------------------------------
+// ArchiveEntryList::refineFilter
+//
+// Filters the currently filtered list further by name filter [terms], which
+// must be a refinement of the current filter terms
+// ----------------------------------------------------------------------------
+void ArchiveEntryList::refineFilter(const vector<string>& terms)
+{
+	updateFilterNames();
+
+	vector<long> filtered;
+	filtered.reserve(items.size());
+	for (auto item : items)
+		if (itemMatchesFilter(item, terms))
+			filtered.push_back(item);
+	items.swap(filtered);
+	filter_terms = terms;
+
+	// Items remain sorted, so only the list size needs updating
+	SetItemCount(items.size());
+	Refresh();
 }
 
 // ----------------------------------------------------------------------------
@@ -537,6 +703,7 @@ bool ArchiveEntryList::setDir(ArchiveTreeNode* dir)
 
 	// Set current dir
 	current_dir = dir;
+	filter_names.clear();
 
 	// Clear current selection
 	clearSelection();
@@ -593,33 +760,37 @@ int ArchiveEntryList::entrySize(long index)
 // ----------------------------------------------------------------------------
 void ArchiveEntryList::sortItems()
 {
-	lv_current = this;
-	std::sort(items.begin(), items.end(), [&](long left, long right)
+	// Determine sort mode
+	SortMode mode = SortMode::Text;
+	if (col_name >= 0 && col_name == sortColumn())
+		mode = SortMode::Name;
+	else if (col_size >= 0 && col_size == sortColumn())
+		mode = SortMode::Size;
+	else if ((col_index >= 0 && col_index == sortColumn()) || sortColumn() < 0)
+		mode = SortMode::Index;
+
+	// Build sort keys
+	vector<ItemSortKey> keys(items.size());
+	for (unsigned a = 0; a < items.size(); a++)
 	{
-		auto le = getEntry(left, false);
-		auto re = getEntry(right, false);
-
-		// Sort folder->entry first
-		if (le->getType() == EntryType::folderType() && re->getType() != EntryType::folderType())
-			return true;
-		if (re->getType() == EntryType::folderType() && le->getType() != EntryType::folderType())
-			return false;
-
-		// Name sort
-		if (col_name >= 0 && col_name == sortColumn())
-			return sort_descend ? le->getName() > re->getName() : le->getName() < re->getName();
-
-		// Size sort
-		if (col_size >= 0 && col_size == sortColumn())
-			return sort_descend ? entrySize(left) > entrySize(right) : entrySize(left) < entrySize(right);
-
-		// Index sort
-		if (col_index >= 0 && col_index == sortColumn())
-			return sort_descend ? left > right : left < right;
+		auto& key = keys[a];
+		auto entry = getEntry(items[a], false);
+		key.index = items[a];
+		key.folder = entry->getType() == EntryType::folderType();
+		key.size = 0;
+
+		if (mode == SortMode::Name)
+			key.text = entry->getName();
+		else if (mode == SortMode::Size)
+			key.size = entrySize(items[a]);
+		else if (mode == SortMode::Text)
+			key.text = getItemText(items[a], sortColumn(), items[a]).Lower();
+	}
 
-		// Other (default) sort
-		return VirtualListView::defaultSort(left, right);
-	});
+	// Sort
+	sortItemKeys(keys, mode, sort_descend);
+	for (unsigned a = 0; a < items.size(); a++)
+		items[a] = keys[a].index;
 }
 
 // ----------------------------------------------------------------------------
@@ -854,6 +1025,13 @@ void ArchiveEntryList::labelEdited(int col, int index, string new_label)
 // ----------------------------------------------------------------------------
 void ArchiveEntryList::onAnnouncement(Announcer* announcer, string event_name, MemChunk& event_data)
 {
+	// Entries may have changed, so the filter must be fully reapplied
+	if (announcer == archive)
+	{
+		filter_names.clear();
+		filter_refinable = false;
+	}
+
 	if (entries_update && announcer == archive && event_name != "closed")
 	{
 		//updateList();
@@ -1026,3 +1204,105 @@ void ArchiveEntryList::onListItemActivated(wxListEvent& e)
 	else
 		e.Skip();
 }
+
+
+// ----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// Benchmarks entry list filtering, sorting and selection restoring with a
+// large number of (generated) entries. The first arg is the number of entries
+// to generate (default 100000)
+// ----------------------------------------------------------------------------
+CONSOLE_COMMAND(benchmark_entry_list, 0, false)
+{
+	long count = 100000;
+	if (!args.empty())
+		args[0].ToLong(&count);
+
+	// Generate entries
+	vector<std::unique_ptr<ArchiveEntry>> entries;
+	for (long a = 0; a < count; a++)
+	{
+		string name = S_FMT("%c%c%c%05d", 'A' + rand() % 26, 'A' + rand() % 26, 'A' + rand() % 26, rand() % 100000);
+		entries.push_back(std::make_unique<ArchiveEntry>(name, rand() % 65536));
+	}
+
+	// Lowercase names
+	auto start = App::runTimer();
+	vector<string> names;
+	names.reserve(entries.size());
+	for (auto& entry : entries)
+		names.push_back(entry->getName().Lower());
+	Log::console(S_FMT("Names: %ldms", App::runTimer() - start));
+
+	// Filter by name as if typed, from scratch each time
+	string filter_chars = "ab1";
+	string filter;
+	vector<long> items;
+	start = App::runTimer();
+	for (auto c : filter_chars)
+	{
+		filter += c;
+		auto terms = filterTerms(filter);
+		items.clear();
+		for (unsigned a = 0; a < names.size(); a++)
+			if (matchesFilterTerms(names[a], terms))
+				items.push_back(a);
+	}
+	Log::console(S_FMT("Filter (full): %ldms, %lu items", App::runTimer() - start, (unsigned long)items.size()));
+
+	// Filter by name as if typed, refining the previous filter
+	filter.clear();
+	vector<string> prev_terms;
+	items.clear();
+	start = App::runTimer();
+	for (auto c : filter_chars)
+	{
+		filter += c;
+		auto terms = filterTerms(filter);
+		vector<long> filtered;
+		if (filterTermsRefine(terms, prev_terms))
+		{
+			for (auto item : items)
+				if (matchesFilterTerms(names[item], terms))
+					filtered.push_back(item);
+		}
+		else
+		{
+			for (unsigned a = 0; a < names.size(); a++)
+				if (matchesFilterTerms(names[a], terms))
+					filtered.push_back(a);
+		}
+		items.swap(filtered);
+		prev_terms = terms;
+	}
+	Log::console(S_FMT("Filter (refined): %ldms, %lu items", App::runTimer() - start, (unsigned long)items.size()));
+
+	// Sort by name and size
+	vector<ItemSortKey> keys(entries.size());
+	start = App::runTimer();
+	for (unsigned a = 0; a < entries.size(); a++)
+		keys[a] = { (long)a, false, entries[a]->getName(), 0 };
+	sortItemKeys(keys, SortMode::Name, false);
+	Log::console(S_FMT("Sort by name: %ldms", App::runTimer() - start));
+	start = App::runTimer();
+	for (unsigned a = 0; a < entries.size(); a++)
+		keys[a] = { (long)a, false, wxEmptyString, (int)entries[a]->getSize() };
+	sortItemKeys(keys, SortMode::Size, true);
+	Log::console(S_FMT("Sort by size: %ldms", App::runTimer() - start));
+
+	// Restore a selection of every 10th entry
+	std::unordered_set<ArchiveEntry*> selected;
+	for (unsigned a = 0; a < entries.size(); a += 10)
+		selected.insert(entries[a].get());
+	unsigned n_selected = 0;
+	start = App::runTimer();
+	for (auto& key : keys)
+		if (selected.count(entries[key.index].get()))
+			n_selected++;
+	Log::console(S_FMT("Restore selection: %ldms, %u selected", App::runTimer() - start, n_selected));
+}
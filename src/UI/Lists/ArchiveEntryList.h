@@ -76,5 +76,13 @@ private:
 	int					col_type;
 	bool				entries_update;
 
-	int	entrySize(long index);
+	// Filtering
+	vector<string>		filter_names;		// Lowercase names of all items (unfiltered)
+	vector<string>		filter_terms;		// Name filter terms last applied
+	bool				filter_refinable;	// True if the current filter can be refined
+
+	int		entrySize(long index);
+	void	updateFilterNames();
+	bool	itemMatchesFilter(long index, const vector<string>& terms);
+	void	refineFilter(const vector<string>& terms);
 };
@@ -5,10 +5,14 @@
 #include "MapEditor/SLADEMap/SLADEMap.h"
 #include "MathStuff.h"
 #include "OpenGL/OpenGL.h"
+#include "PolygonTriangulator.h"
 
 // Number of bytes per vertex in a GL vertex array
 static const int VERTEX_SIZE = 20;
 
+// Use PolygonTriangulator rather than PolygonSplitter to build sector polygons
+CVAR(Bool, map_polygon_triangulate, false, CVAR_SAVE)
+
 Polygon2D::Polygon2D()
 {
 	vbo_update = 2;
@@ -96,15 +100,32 @@ unsigned Polygon2D::totalVertices()
 }
 
 bool Polygon2D::openSector(MapSector* sector)
+{
+	PolygonSplitter splitter;
+	return openSector(sector, splitter);
+}
+
+// Same as above, but uses [splitter] (eg. so that its buffers can be reused
+// when building polygons for many sectors)
+bool Polygon2D::openSector(MapSector* sector, PolygonSplitter& splitter)
 {
 	// Check sector was given
 	if (!sector)
 		return false;
 
 	// Init
-	PolygonSplitter splitter;
 	clear();
 
+	// Use triangulator if enabled (sector polygons can be built on multiple
+	// threads, so each needs its own)
+	if (map_polygon_triangulate)
+	{
+		static thread_local PolygonTriangulator triangulator;
+		return triangulator.openSector(sector) && triangulator.triangulate(this);
+	}
+
+	splitter.clear();
+
 	// Get list of sides connected to this sector
 	vector<MapSide*>& sides = sector->connectedSides();
 
@@ -27,6 +27,7 @@ struct gl_polygon_t
 
 class GLTexture;
 class MapSector;
+class PolygonSplitter;
 class Polygon2D
 {
 private:
@@ -62,6 +63,7 @@ public:
 	unsigned		totalVertices();
 
 	bool	openSector(MapSector* sector);
+	bool	openSector(MapSector* sector, PolygonSplitter& splitter);
 	void	updateTextureCoords(double scale_x = 1, double scale_y = 1, double offset_x = 0, double offset_y = 0, double rotation = 0);
 
 	unsigned	vboDataSize();
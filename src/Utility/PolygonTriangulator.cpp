@@ -0,0 +1,1096 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PolygonTriangulator.cpp
+// Description: Builds convex sub-polygons for a sector via ear clipping, an
+//              alternative to PolygonSplitter that scales better with large
+//              sectors. The ear clipping is based on the approach used by the
+//              'earcut' library (hole bridging, z-order hashed ear tests and
+//              fallbacks for self-intersecting/degenerate outlines)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PolygonTriangulator.h"
+#include "MapEditor/SLADEMap/SLADEMap.h"
+#include "MathStuff.h"
+#include "Polygon2D.h"
+#include <cfloat>
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Polygons with more vertices than this use z-order hashing for ear tests
+const unsigned HASH_THRESHOLD = 80;
+
+// Maximum number of vertices in a merged (convex) sub-polygon
+const unsigned MAX_MERGED = 256;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns twice the signed area of triangle [p],[q],[r] (negative if the
+// vertices turn left, ie. anticlockwise)
+// -----------------------------------------------------------------------------
+template<typename T> double area(const T* p, const T* q, const T* r)
+{
+	return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+template<typename T> bool equals(const T* p1, const T* p2)
+{
+	return p1->x == p2->x && p1->y == p2->y;
+}
+
+int sign(double value)
+{
+	return value > 0 ? 1 : value < 0 ? -1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if point [px,py] is within triangle [a],[b],[c]
+// -----------------------------------------------------------------------------
+bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+{
+	return (cx - px) * (ay - py) >= (ax - px) * (cy - py) && (ax - px) * (by - py) >= (bx - px) * (ay - py)
+		   && (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [q] lies on segment [p]-[r] (given they are collinear)
+// -----------------------------------------------------------------------------
+template<typename T> bool onSegment(const T* p, const T* q, const T* r)
+{
+	return q->x <= MAX(p->x, r->x) && q->x >= MIN(p->x, r->x) && q->y <= MAX(p->y, r->y)
+		   && q->y >= MIN(p->y, r->y);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if segments [p1]-[q1] and [p2]-[q2] intersect
+// -----------------------------------------------------------------------------
+template<typename T> bool intersects(const T* p1, const T* q1, const T* p2, const T* q2)
+{
+	int o1 = sign(area(p1, q1, p2));
+	int o2 = sign(area(p1, q1, q2));
+	int o3 = sign(area(p2, q2, p1));
+	int o4 = sign(area(p2, q2, q1));
+
+	if (o1 != o2 && o3 != o4)
+		return true;
+
+	return (o1 == 0 && onSegment(p1, p2, q1)) || (o2 == 0 && onSegment(p1, q2, q1))
+		   || (o3 == 0 && onSegment(p2, p1, q2)) || (o4 == 0 && onSegment(p2, q1, q2));
+}
+
+// -----------------------------------------------------------------------------
+// Returns twice the signed area of triangle [p],[q],[r] (positive if the
+// vertices turn left, ie. anticlockwise)
+// -----------------------------------------------------------------------------
+double cross(const fpoint2_t& p, const fpoint2_t& q, const fpoint2_t& r)
+{
+	return (q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x);
+}
+
+uint64_t edgeKey(int v1, int v2)
+{
+	return ((uint64_t)(uint32_t)v1 << 32) | (uint32_t)v2;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PolygonTriangulator Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Clears all input edges (buffers are kept for reuse)
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::clear()
+{
+	vertices_.clear();
+	vertex_map_.clear();
+	edges_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds an edge from [x1,y1] to [x2,y2]. The polygon interior is on the right
+// of edges, same as with PolygonSplitter
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::addEdge(double x1, double y1, double x2, double y2)
+{
+	int v1 = addVertex(x1, y1);
+	int v2 = addVertex(x2, y2);
+	if (v1 != v2)
+		edges_.push_back({ v1, v2, false });
+}
+
+// -----------------------------------------------------------------------------
+// Clears the triangulator and adds edges for all sides of [sector]
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::openSector(MapSector* sector)
+{
+	if (!sector)
+		return false;
+
+	clear();
+
+	for (auto side : sector->connectedSides())
+	{
+		auto line = side->getParentLine();
+
+		// Ignore this side if its parent line has the same sector on both sides
+		if (!line || line->doubleSector())
+			continue;
+
+		// Add the edge (direction depends on what side of the line this is)
+		if (line->s1() == side)
+			addEdge(line->v1()->xPos(), line->v1()->yPos(), line->v2()->xPos(), line->v2()->yPos());
+		else
+			addEdge(line->v2()->xPos(), line->v2()->yPos(), line->v1()->xPos(), line->v1()->yPos());
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Builds convex sub-polygons in [poly] from the added edges. Any edges that
+// aren't part of a closed outline, and any 'hole' outlines that aren't within
+// an outer outline, are ignored
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::triangulate(Polygon2D* poly)
+{
+	if (!poly)
+		return false;
+
+	traceLoops();
+
+	// Find the (smallest) outer loop containing each hole
+	for (auto& hole : loops_)
+	{
+		if (hole.area <= 0)
+			continue;
+
+		// Test a point on the hole's first edge, since its vertices may be
+		// shared with the outer loop
+		auto&  p1       = vertices_[loop_vertices_[hole.start]];
+		auto&  p2       = vertices_[loop_vertices_[hole.start + 1]];
+		double x        = (p1.x + p2.x) * 0.5;
+		double y        = (p1.y + p2.y) * 0.5;
+		double min_area = 0;
+		for (unsigned a = 0; a < loops_.size(); a++)
+		{
+			auto& outer = loops_[a];
+			if (outer.area >= 0 || outer.min_x > hole.min_x || outer.max_x < hole.max_x || outer.min_y > hole.min_y
+				|| outer.max_y < hole.max_y)
+				continue;
+
+			if ((hole.outer < 0 || -outer.area < min_area) && loopContains(outer, x, y))
+			{
+				hole.outer = a;
+				min_area   = -outer.area;
+			}
+		}
+	}
+
+	// Triangulate each outer loop (with its holes)
+	for (unsigned a = 0; a < loops_.size(); a++)
+	{
+		auto& loop = loops_[a];
+		if (loop.area >= 0)
+			continue;
+
+		nodes_.clear();
+		triangles_.clear();
+
+		auto outer = linkedList(loop, true);
+		if (!outer || outer->next == outer->prev)
+			continue;
+
+		// Bridge holes into the outer loop, leftmost first
+		holes_.clear();
+		unsigned n_vertices = loop.count;
+		for (auto& hole : loops_)
+		{
+			if (hole.outer != (int)a)
+				continue;
+
+			auto list = linkedList(hole, false);
+			if (!list)
+				continue;
+			if (list == list->next)
+				list->steiner = true;
+
+			// Find leftmost node
+			auto leftmost = list;
+			auto p        = list;
+			do
+			{
+				if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+					leftmost = p;
+				p = p->next;
+			} while (p != list);
+
+			holes_.push_back(leftmost);
+			n_vertices += hole.count;
+		}
+		std::sort(holes_.begin(), holes_.end(), [](Node* l, Node* r) { return l->x < r->x; });
+		for (auto hole : holes_)
+			outer = eliminateHole(hole, outer);
+
+		// Use z-order hashing for large polygons
+		inv_size_ = 0;
+		if (n_vertices > HASH_THRESHOLD)
+		{
+			min_x_ = loop.min_x;
+			min_y_ = loop.min_y;
+			double size = MAX(loop.max_x - loop.min_x, loop.max_y - loop.min_y);
+			inv_size_   = size != 0 ? 32767 / size : 0;
+		}
+
+		earcutLinked(outer, 0);
+
+		// Merge triangles into convex sub-polygons
+		n_polys_ = 0;
+		poly_edges_.clear();
+		for (unsigned t = 0; t + 2 < triangles_.size(); t += 3)
+			mergeTriangle(triangles_[t], triangles_[t + 1], triangles_[t + 2]);
+		for (unsigned p = 0; p < n_polys_; p++)
+			addSubPoly(poly, polys_[p]);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the vertex at [x,y], adding it if needed
+// -----------------------------------------------------------------------------
+int PolygonTriangulator::addVertex(double x, double y)
+{
+	auto result = vertex_map_.emplace(fpoint2_t(x, y), (int)vertices_.size());
+	if (result.second)
+		vertices_.emplace_back(x, y);
+
+	return result.first->second;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the next edge to follow from [edge] when tracing the outline
+// starting at [start] (the edge turning furthest right), or -1 if there is
+// none
+// -----------------------------------------------------------------------------
+int PolygonTriangulator::nextEdge(int edge, int start)
+{
+	auto& e     = edges_[edge];
+	auto  first = out_start_[e.v2];
+	auto  last  = out_start_[e.v2 + 1];
+
+	int    next      = -1;
+	double min_angle = 2 * PI;
+	for (auto a = first; a < last; a++)
+	{
+		int   index = out_edges_[a];
+		auto& out   = edges_[index];
+		if ((out.used && index != start) || out.v2 == e.v1)
+			continue;
+
+		// Most vertices only have one edge out, no need to check angles
+		if (last - first == 1)
+			return index;
+
+		double angle = MathStuff::angle2DRad(vertices_[e.v1], vertices_[e.v2], vertices_[out.v2]);
+		if (angle < min_angle)
+		{
+			min_angle = angle;
+			next      = index;
+		}
+	}
+
+	return next;
+}
+
+// -----------------------------------------------------------------------------
+// Traces all closed outlines ('loops') from the added edges
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::traceLoops()
+{
+	loops_.clear();
+	loop_vertices_.clear();
+
+	// Count edges in/out of each vertex
+	auto n_verts = vertices_.size();
+	out_start_.assign(n_verts + 1, 0);
+	in_count_.assign(n_verts, 0);
+	for (auto& edge : edges_)
+	{
+		out_start_[edge.v1 + 1]++;
+		in_count_[edge.v2]++;
+	}
+
+	// Flip any edges that are obviously the wrong way around (nothing goes
+	// into the start vertex and nothing comes out of the end vertex)
+	for (auto& edge : edges_)
+	{
+		if (in_count_[edge.v1] == 0 && out_start_[edge.v2 + 1] == 0)
+		{
+			out_start_[edge.v1 + 1]--;
+			in_count_[edge.v2]--;
+			std::swap(edge.v1, edge.v2);
+			out_start_[edge.v1 + 1]++;
+			in_count_[edge.v2]++;
+		}
+	}
+
+	// Build outgoing edge lists
+	for (unsigned a = 0; a < n_verts; a++)
+		out_start_[a + 1] += out_start_[a];
+	out_edges_.resize(edges_.size());
+	in_count_.assign(out_start_.begin(), out_start_.end() - 1); // Reuse as insert positions
+	for (unsigned a = 0; a < edges_.size(); a++)
+		out_edges_[in_count_[edges_[a].v1]++] = a;
+
+	// Trace loops
+	for (unsigned a = 0; a < edges_.size(); a++)
+	{
+		if (edges_[a].used)
+			continue;
+
+		unsigned start  = loop_vertices_.size();
+		int      edge   = a;
+		bool     closed = false;
+		loop_edges_.clear();
+		while (edge >= 0)
+		{
+			edges_[edge].used = true;
+			loop_edges_.push_back(edge);
+			loop_vertices_.push_back(edges_[edge].v1);
+
+			edge = nextEdge(edge, a);
+			if (edge == (int)a)
+			{
+				closed = true;
+				break;
+			}
+		}
+
+		// Ignore unclosed/degenerate loops, and free up their edges so they
+		// can still be part of a loop traced from a later edge
+		unsigned count = loop_vertices_.size() - start;
+		if (!closed || count < 3)
+		{
+			for (auto e : loop_edges_)
+				edges_[e].used = false;
+			loop_vertices_.resize(start);
+			continue;
+		}
+
+		// Get area and bounds
+		Loop loop{ start, count, 0, 0, 0, 0, 0, -1 };
+		auto& first = vertices_[loop_vertices_[start]];
+		loop.min_x = loop.max_x = first.x;
+		loop.min_y = loop.max_y = first.y;
+		for (unsigned v = 0; v < count; v++)
+		{
+			auto& p1 = vertices_[loop_vertices_[start + v]];
+			auto& p2 = vertices_[loop_vertices_[start + (v + 1) % count]];
+			loop.area += p1.x * p2.y - p2.x * p1.y;
+			loop.min_x = MIN(loop.min_x, p1.x);
+			loop.min_y = MIN(loop.min_y, p1.y);
+			loop.max_x = MAX(loop.max_x, p1.x);
+			loop.max_y = MAX(loop.max_y, p1.y);
+		}
+		loop.area *= 0.5;
+
+		if (loop.area != 0)
+			loops_.push_back(loop);
+	}
+
+	for (auto& edge : edges_)
+		edge.used = false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if point [x,y] is within [loop]
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::loopContains(const Loop& loop, double x, double y)
+{
+	bool inside = false;
+	for (unsigned a = 0, b = loop.count - 1; a < loop.count; b = a++)
+	{
+		auto& p1 = vertices_[loop_vertices_[loop.start + a]];
+		auto& p2 = vertices_[loop_vertices_[loop.start + b]];
+		if ((p1.y > y) != (p2.y > y) && x < (p2.x - p1.x) * (y - p1.y) / (p2.y - p1.y) + p1.x)
+			inside = !inside;
+	}
+
+	return inside;
+}
+
+// -----------------------------------------------------------------------------
+// Creates a new (unlinked) node for vertex [index]
+// -----------------------------------------------------------------------------
+PolygonTriangulator::Node* PolygonTriangulator::createNode(int index)
+{
+	nodes_.emplace_back();
+	auto node = &nodes_.back();
+	node->index   = index;
+	node->x       = vertices_[index].x;
+	node->y       = vertices_[index].y;
+	node->prev    = node;
+	node->next    = node;
+	node->z       = 0;
+	node->prev_z  = nullptr;
+	node->next_z  = nullptr;
+	node->steiner = false;
+	return node;
+}
+
+// -----------------------------------------------------------------------------
+// Creates a node for vertex [index] and links it after [last]
+// -----------------------------------------------------------------------------
+PolygonTriangulator::Node* PolygonTriangulator::insertNode(int index, Node* last)
+{
+	auto node = createNode(index);
+	if (last)
+	{
+		node->next       = last->next;
+		node->prev       = last;
+		last->next->prev = node;
+		last->next       = node;
+	}
+
+	return node;
+}
+
+// -----------------------------------------------------------------------------
+// Unlinks [node] from its ring and z-order list
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::removeNode(Node* node)
+{
+	node->next->prev = node->prev;
+	node->prev->next = node->next;
+
+	if (node->prev_z)
+		node->prev_z->next_z = node->next_z;
+	if (node->next_z)
+		node->next_z->prev_z = node->prev_z;
+}
+
+// -----------------------------------------------------------------------------
+// Creates a circular linked list of nodes from [loop], in [anticlockwise]
+// order (outer loops must be anticlockwise and holes clockwise)
+// -----------------------------------------------------------------------------
+PolygonTriangulator::Node* PolygonTriangulator::linkedList(const Loop& loop, bool anticlockwise)
+{
+	Node* last    = nullptr;
+	bool  forward = (loop.area > 0) == anticlockwise;
+	for (unsigned a = 0; a < loop.count; a++)
+		last = insertNode(loop_vertices_[loop.start + (forward ? a : loop.count - 1 - a)], last);
+
+	if (last && equals(last, last->next))
+	{
+		removeNode(last);
+		last = last->next;
+	}
+
+	return last;
+}
+
+// -----------------------------------------------------------------------------
+// Removes duplicate and collinear points between [start] and [end]
+// -----------------------------------------------------------------------------
+PolygonTriangulator::Node* PolygonTriangulator::filterPoints(Node* start, Node* end)
+{
+	if (!start)
+		return start;
+	if (!end)
+		end = start;
+
+	auto p = start;
+	bool again;
+	do
+	{
+		again = false;
+
+		if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0))
+		{
+			removeNode(p);
+			p = end = p->prev;
+			if (p == p->next)
+				break;
+			again = true;
+		}
+		else
+			p = p->next;
+	} while (again || p != end);
+
+	return end;
+}
+
+// -----------------------------------------------------------------------------
+// Main ear clipping loop. If no more ears can be found, [pass] 0 filters out
+// degenerate points and tries again, pass 1 cures small self-intersections
+// and pass 2 splits the remaining polygon in two
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::earcutLinked(Node* ear, int pass)
+{
+	if (!ear)
+		return;
+
+	if (!pass && inv_size_ != 0)
+		indexCurve(ear);
+
+	auto stop = ear;
+	while (ear->prev != ear->next)
+	{
+		auto prev = ear->prev;
+		auto next = ear->next;
+
+		if (inv_size_ != 0 ? isEarHashed(ear) : isEar(ear))
+		{
+			// Clip the ear
+			triangles_.push_back(prev->index);
+			triangles_.push_back(ear->index);
+			triangles_.push_back(next->index);
+			removeNode(ear);
+
+			ear  = next->next;
+			stop = next->next;
+			continue;
+		}
+
+		ear = next;
+
+		// If we looped through the whole remaining polygon and can't find any
+		// more ears
+		if (ear == stop)
+		{
+			if (pass == 0)
+				earcutLinked(filterPoints(ear), 1);
+			else if (pass == 1)
+				earcutLinked(cureLocalIntersections(filterPoints(ear)), 2);
+			else
+				splitEarcut(ear);
+
+			break;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [ear] is a valid ear (convex, with no other points inside)
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::isEar(Node* ear)
+{
+	auto a = ear->prev;
+	auto b = ear;
+	auto c = ear->next;
+
+	// Reflex, can't be an ear
+	if (area(a, b, c) >= 0)
+		return false;
+
+	double x0 = MIN(a->x, MIN(b->x, c->x));
+	double y0 = MIN(a->y, MIN(b->y, c->y));
+	double x1 = MAX(a->x, MAX(b->x, c->x));
+	double y1 = MAX(a->y, MAX(b->y, c->y));
+
+	for (auto p = c->next; p != a; p = p->next)
+	{
+		if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1
+			&& pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && area(p->prev, p, p->next) >= 0)
+			return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Same as isEar, but only checks points within the ear's z-order range
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::isEarHashed(Node* ear)
+{
+	auto a = ear->prev;
+	auto b = ear;
+	auto c = ear->next;
+
+	if (area(a, b, c) >= 0)
+		return false;
+
+	double x0 = MIN(a->x, MIN(b->x, c->x));
+	double y0 = MIN(a->y, MIN(b->y, c->y));
+	double x1 = MAX(a->x, MAX(b->x, c->x));
+	double y1 = MAX(a->y, MAX(b->y, c->y));
+
+	auto min_z = zOrder(x0, y0);
+	auto max_z = zOrder(x1, y1);
+
+	auto inside = [&](Node* p) {
+		return p != a && p != c && p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1
+			   && pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y)
+			   && area(p->prev, p, p->next) >= 0;
+	};
+
+	// Look for points inside the triangle in both directions
+	auto p = ear->prev_z;
+	auto n = ear->next_z;
+	while (p && p->z >= min_z && n && n->z <= max_z)
+	{
+		if (inside(p))
+			return false;
+		p = p->prev_z;
+
+		if (inside(n))
+			return false;
+		n = n->next_z;
+	}
+	for (; p && p->z >= min_z; p = p->prev_z)
+		if (inside(p))
+			return false;
+	for (; n && n->z <= max_z; n = n->next_z)
+		if (inside(n))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Clips ears over small self-intersections (eg. from overlapping lines)
+// -----------------------------------------------------------------------------
+PolygonTriangulator::Node* PolygonTriangulator::cureLocalIntersections(Node* start)
+{
+	auto p = start;
+	do
+	{
+		auto a = p->prev;
+		auto b = p->next->next;
+
+		if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a))
+		{
+			triangles_.push_back(a->index);
+			triangles_.push_back(p->index);
+			triangles_.push_back(b->index);
+
+			removeNode(p);
+			removeNode(p->next);
+
+			p = start = b;
+		}
+		p = p->next;
+	} while (p != start);
+
+	return filterPoints(p);
+}
+
+// -----------------------------------------------------------------------------
+// Splits the polygon at [start] in two along a valid diagonal and
+// triangulates both halves
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::splitEarcut(Node* start)
+{
+	auto a = start;
+	do
+	{
+		for (auto b = a->next->next; b != a->prev; b = b->next)
+		{
+			if (a->index != b->index && isValidDiagonal(a, b))
+			{
+				auto c = splitPolygon(a, b);
+
+				a = filterPoints(a, a->next);
+				c = filterPoints(c, c->next);
+
+				earcutLinked(a, 0);
+				earcutLinked(c, 0);
+				return;
+			}
+		}
+		a = a->next;
+	} while (a != start);
+}
+
+// -----------------------------------------------------------------------------
+// Bridges [hole] into the [outer] polygon, returns the new outer polygon
+// -----------------------------------------------------------------------------
+PolygonTriangulator::Node* PolygonTriangulator::eliminateHole(Node* hole, Node* outer)
+{
+	auto bridge = findHoleBridge(hole, outer);
+	if (!bridge)
+		return outer;
+
+	auto bridge_reverse = splitPolygon(bridge, hole);
+	filterPoints(bridge_reverse, bridge_reverse->next);
+	return filterPoints(bridge, bridge->next);
+}
+
+// -----------------------------------------------------------------------------
+// Finds a vertex in [outer] that [hole] (its leftmost vertex) can be
+// connected to without crossing any edges
+// -----------------------------------------------------------------------------
+PolygonTriangulator::Node* PolygonTriangulator::findHoleBridge(Node* hole, Node* outer)
+{
+	double hx = hole->x;
+	double hy = hole->y;
+	double qx = -DBL_MAX;
+	Node*  m  = nullptr;
+
+	// Find the segment intersected by a ray from the hole's leftmost point to
+	// the left. The segment's endpoint with lesser x will be the potential
+	// connection point
+	auto p = outer;
+	do
+	{
+		if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+		{
+			double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+			if (x <= hx && x > qx)
+			{
+				qx = x;
+				m  = p->x < p->next->x ? p : p->next;
+				if (x == hx)
+					return m; // Hole touches outer segment
+			}
+		}
+		p = p->next;
+	} while (p != outer);
+
+	if (!m)
+		return nullptr;
+
+	// Look for points inside the triangle of hole point, segment intersection
+	// and endpoint. If there are none, the endpoint is a valid connection.
+	// Otherwise use the point with the minimum angle with the ray
+	auto   stop    = m;
+	double mx      = m->x;
+	double my      = m->y;
+	double tan_min = DBL_MAX;
+	p              = m;
+	do
+	{
+		if (hx >= p->x && p->x >= mx && hx != p->x
+			&& pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+		{
+			double tan = fabs(hy - p->y) / (hx - p->x);
+			if (locallyInside(p, hole)
+				&& (tan < tan_min
+					|| (tan == tan_min
+						&& (p->x > m->x
+							|| (p->x == m->x && area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0)))))
+			{
+				m       = p;
+				tan_min = tan;
+			}
+		}
+		p = p->next;
+	} while (p != stop);
+
+	return m;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the z-order of all nodes in the polygon at [start], and sorts them
+// into a z-order linked list
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::indexCurve(Node* start)
+{
+	auto p = start;
+	do
+	{
+		if (p->z == 0)
+			p->z = zOrder(p->x, p->y);
+		p->prev_z = p->prev;
+		p->next_z = p->next;
+		p         = p->next;
+	} while (p != start);
+
+	p->prev_z->next_z = nullptr;
+	p->prev_z         = nullptr;
+
+	// Merge sort the z-order list
+	Node*    list    = p;
+	unsigned in_size = 1;
+	unsigned n_merges;
+	do
+	{
+		p          = list;
+		list       = nullptr;
+		Node* tail = nullptr;
+		n_merges   = 0;
+
+		while (p)
+		{
+			n_merges++;
+			auto     q      = p;
+			unsigned p_size = 0;
+			for (unsigned a = 0; a < in_size && q; a++)
+			{
+				p_size++;
+				q = q->next_z;
+			}
+			unsigned q_size = in_size;
+
+			while (p_size > 0 || (q_size > 0 && q))
+			{
+				Node* e;
+				if (p_size != 0 && (q_size == 0 || !q || p->z <= q->z))
+				{
+					e = p;
+					p = p->next_z;
+					p_size--;
+				}
+				else
+				{
+					e = q;
+					q = q->next_z;
+					q_size--;
+				}
+
+				if (tail)
+					tail->next_z = e;
+				else
+					list = e;
+
+				e->prev_z = tail;
+				tail      = e;
+			}
+
+			p = q;
+		}
+
+		tail->next_z = nullptr;
+		in_size *= 2;
+	} while (n_merges > 1);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the z-order curve value of [x,y] (relative to the current polygon
+// bounds)
+// -----------------------------------------------------------------------------
+int32_t PolygonTriangulator::zOrder(double x, double y)
+{
+	auto ix = (uint32_t)((x - min_x_) * inv_size_);
+	auto iy = (uint32_t)((y - min_y_) * inv_size_);
+
+	ix = (ix | (ix << 8)) & 0x00FF00FF;
+	ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+	ix = (ix | (ix << 2)) & 0x33333333;
+	ix = (ix | (ix << 1)) & 0x55555555;
+
+	iy = (iy | (iy << 8)) & 0x00FF00FF;
+	iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+	iy = (iy | (iy << 2)) & 0x33333333;
+	iy = (iy | (iy << 1)) & 0x55555555;
+
+	return (int32_t)(ix | (iy << 1));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if a diagonal between [a] and [b] is within the polygon and
+// doesn't intersect any edges
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::isValidDiagonal(Node* a, Node* b)
+{
+	if (a->next->index == b->index || a->prev->index == b->index || intersectsPolygon(a, b))
+		return false;
+
+	// Locally visible and not opposite-facing sectors, or a zero-length case
+	return (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b)
+			&& (area(a->prev, a, b->prev) != 0 || area(a, b->prev, b) != 0))
+		   || (equals(a, b) && area(a->prev, a, a->next) > 0 && area(b->prev, b, b->next) > 0);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if segment [a]-[b] intersects any polygon edge
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::intersectsPolygon(Node* a, Node* b)
+{
+	auto p = a;
+	do
+	{
+		if (p->index != a->index && p->next->index != a->index && p->index != b->index
+			&& p->next->index != b->index && intersects(p, p->next, a, b))
+			return true;
+		p = p->next;
+	} while (p != a);
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if a diagonal from [a] to [b] is locally inside the polygon
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::locallyInside(Node* a, Node* b)
+{
+	return area(a->prev, a, a->next) < 0 ? area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0 :
+										   area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the middle point of a diagonal from [a] to [b] is inside
+// the polygon
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::middleInside(Node* a, Node* b)
+{
+	auto   p      = a;
+	bool   inside = false;
+	double px     = (a->x + b->x) / 2;
+	double py     = (a->y + b->y) / 2;
+	do
+	{
+		if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y
+			&& (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+			inside = !inside;
+		p = p->next;
+	} while (p != a);
+
+	return inside;
+}
+
+// -----------------------------------------------------------------------------
+// Links [a] and [b] with a bridge, splitting the polygon in two (or joining
+// a hole to the outer polygon). Returns the new node copy of [b]
+// -----------------------------------------------------------------------------
+PolygonTriangulator::Node* PolygonTriangulator::splitPolygon(Node* a, Node* b)
+{
+	auto a2 = createNode(a->index);
+	auto b2 = createNode(b->index);
+	auto an = a->next;
+	auto bp = b->prev;
+
+	a->next = b;
+	b->prev = a;
+
+	a2->next = an;
+	an->prev = a2;
+
+	b2->next = a2;
+	a2->prev = b2;
+
+	bp->next = b2;
+	b2->prev = bp;
+
+	return b2;
+}
+
+// -----------------------------------------------------------------------------
+// Merges triangle [a],[b],[c] (anticlockwise) into a polygon it shares an edge
+// with, if the result is still convex. Otherwise it is added as a new polygon
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::mergeTriangle(int a, int b, int c)
+{
+	// Ignore degenerate triangles
+	if (cross(vertices_[a], vertices_[b], vertices_[c]) <= 0)
+		return;
+
+	int tri[3] = { a, b, c };
+	for (unsigned e = 0; e < 3; e++)
+	{
+		// A shared edge goes the opposite way in the polygon
+		int  p1 = tri[(e + 1) % 3];
+		int  p2 = tri[e];
+		int  w  = tri[(e + 2) % 3];
+		auto it = poly_edges_.find(edgeKey(p1, p2));
+		if (it == poly_edges_.end())
+			continue;
+
+		auto index = it->second;
+		if (insertVertex(polys_[index], p1, p2, w))
+		{
+			poly_edges_.erase(it);
+			poly_edges_[edgeKey(p1, w)] = index;
+			poly_edges_[edgeKey(w, p2)] = index;
+			return;
+		}
+	}
+
+	// Add new polygon
+	if (n_polys_ == polys_.size())
+		polys_.emplace_back();
+	polys_[n_polys_].assign(tri, tri + 3);
+	for (unsigned e = 0; e < 3; e++)
+		poly_edges_[edgeKey(tri[e], tri[(e + 1) % 3])] = n_polys_;
+	n_polys_++;
+}
+
+// -----------------------------------------------------------------------------
+// Inserts [vertex] into [poly] between [p1] and [p2], if [poly] would still be
+// convex
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::insertVertex(vector<int>& poly, int p1, int p2, int vertex)
+{
+	unsigned n = poly.size();
+	if (n >= MAX_MERGED)
+		return false;
+
+	for (unsigned k = 0; k < n; k++)
+	{
+		if (poly[k] != p1 || poly[(k + 1) % n] != p2)
+			continue;
+
+		int before = poly[(k + n - 1) % n];
+		int after  = poly[(k + 2) % n];
+		if (cross(vertices_[before], vertices_[p1], vertices_[vertex]) < 0
+			|| cross(vertices_[vertex], vertices_[p2], vertices_[after]) < 0)
+			return false;
+
+		poly.insert(poly.begin() + k + 1, vertex);
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Adds a sub-polygon to [poly] from (anticlockwise) [vertices]
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::addSubPoly(Polygon2D* poly, const vector<int>& vertices)
+{
+	poly->addSubPoly();
+	auto sub        = poly->getSubPoly(poly->nSubPolys() - 1);
+	sub->n_vertices = vertices.size();
+	sub->vertices   = new gl_vertex_t[sub->n_vertices];
+
+	// Sub-polygons are clockwise, same as PolygonSplitter gives
+	for (unsigned a = 0; a < vertices.size(); a++)
+	{
+		auto& vertex       = vertices_[vertices[vertices.size() - 1 - a]];
+		sub->vertices[a].x = vertex.x;
+		sub->vertices[a].y = vertex.y;
+	}
+}
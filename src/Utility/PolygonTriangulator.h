@@ -0,0 +1,118 @@
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+
+class MapSector;
+class Polygon2D;
+
+// Alternative to PolygonSplitter for building sector polygons.
+// Traces the sector outlines, bridges holes into the outline containing them
+// and triangulates by ear clipping (using a z-order curve to speed up the ear
+// tests on large polygons). The resulting triangles are then merged back into
+// convex sub-polygons. Unlike PolygonSplitter there are no searches over all
+// edges/vertices per edge, so it scales much better for sectors with many
+// edges
+class PolygonTriangulator
+{
+public:
+	void clear();
+	void addEdge(double x1, double y1, double x2, double y2);
+	bool openSector(MapSector* sector);
+	bool triangulate(Polygon2D* poly);
+
+private:
+	struct Edge
+	{
+		int  v1, v2;
+		bool used;
+	};
+
+	struct Loop
+	{
+		unsigned start, count;
+		double   area; // Negative if clockwise ('outer')
+		double   min_x, min_y, max_x, max_y;
+		int      outer; // Containing outer loop (holes only)
+	};
+
+	struct Node
+	{
+		int     index;
+		double  x, y;
+		Node*   prev;
+		Node*   next;
+		int32_t z;
+		Node*   prev_z;
+		Node*   next_z;
+		bool    steiner;
+	};
+
+	struct PointHash
+	{
+		size_t operator()(const fpoint2_t& p) const
+		{
+			return std::hash<double>()(p.x) ^ (std::hash<double>()(p.y) * 31);
+		}
+	};
+
+	struct PointEqual
+	{
+		bool operator()(const fpoint2_t& l, const fpoint2_t& r) const { return l.x == r.x && l.y == r.y; }
+	};
+
+	// Input
+	vector<fpoint2_t>                                        vertices_;
+	std::unordered_map<fpoint2_t, int, PointHash, PointEqual> vertex_map_;
+	vector<Edge>                                             edges_;
+
+	// Outline tracing
+	vector<unsigned> out_start_;
+	vector<int>      out_edges_;
+	vector<int>      in_count_;
+	vector<int>      loop_vertices_;
+	vector<int>      loop_edges_; // Edges of the loop currently being traced
+	vector<Loop>     loops_;
+
+	// Ear clipping
+	std::deque<Node> nodes_;
+	vector<Node*>    holes_;
+	vector<int>      triangles_;
+	double           min_x_    = 0;
+	double           min_y_    = 0;
+	double           inv_size_ = 0;
+
+	// Triangle merging
+	vector<vector<int>>                    polys_;
+	unsigned                               n_polys_ = 0;
+	std::unordered_map<uint64_t, unsigned> poly_edges_;
+
+	int  addVertex(double x, double y);
+	int  nextEdge(int edge, int start);
+	void traceLoops();
+	bool loopContains(const Loop& loop, double x, double y);
+
+	Node*   createNode(int index);
+	Node*   insertNode(int index, Node* last);
+	void    removeNode(Node* node);
+	Node*   linkedList(const Loop& loop, bool anticlockwise);
+	Node*   filterPoints(Node* start, Node* end = nullptr);
+	void    earcutLinked(Node* ear, int pass);
+	bool    isEar(Node* ear);
+	bool    isEarHashed(Node* ear);
+	Node*   cureLocalIntersections(Node* start);
+	void    splitEarcut(Node* start);
+	Node*   eliminateHole(Node* hole, Node* outer);
+	Node*   findHoleBridge(Node* hole, Node* outer);
+	void    indexCurve(Node* start);
+	int32_t zOrder(double x, double y);
+	bool    isValidDiagonal(Node* a, Node* b);
+	bool    intersectsPolygon(Node* a, Node* b);
+	bool    locallyInside(Node* a, Node* b);
+	bool    middleInside(Node* a, Node* b);
+	Node*   splitPolygon(Node* a, Node* b);
+
+	void mergeTriangle(int a, int b, int c);
+	bool insertVertex(vector<int>& poly, int p1, int p2, int vertex);
+	void addSubPoly(Polygon2D* poly, const vector<int>& vertices);
+};
@@ -60,6 +60,107 @@ namespace
 		// Whitespace is either a newline, tab character or space
 		return p == '\n' || p == 13 || p == ' ' || p == '\t';
 	}
+
+	// ------------------------------------------------------------------------
+	// asciiLower
+	//
+	// Returns [c] in lowercase if it is an uppercase (ascii) letter
+	// ------------------------------------------------------------------------
+	char asciiLower(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+	}
+
+	// ------------------------------------------------------------------------
+	// isDigit / isHexDigit
+	//
+	// Returns true if [c] is a decimal/hex digit
+	// ------------------------------------------------------------------------
+	bool isDigit(char c) { return c >= '0' && c <= '9'; }
+	bool isHexDigit(char c) { return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+	// ------------------------------------------------------------------------
+	// matchHex
+	//
+	// Returns true if [str] is a valid hex string. Same as StringUtils::isHex
+	// but works on a plain char buffer
+	// ------------------------------------------------------------------------
+	bool matchHex(const char* str, unsigned len)
+	{
+		if (len < 3 || str[0] != '0' || str[1] != 'x')
+			return false;
+		for (unsigned a = 2; a < len; a++)
+			if (!isHexDigit(str[a]))
+				return false;
+
+		return true;
+	}
+
+	// ------------------------------------------------------------------------
+	// matchInteger
+	//
+	// Returns true if [str] is a valid integer, or a valid hex string if
+	// [allow_hex] is true. Same as StringUtils::isInteger but works on a plain
+	// char buffer
+	// ------------------------------------------------------------------------
+	bool matchInteger(const char* str, unsigned len, bool allow_hex)
+	{
+		unsigned start = (len > 0 && (str[0] == '+' || str[0] == '-')) ? 1 : 0;
+		bool valid = len > start;
+		for (unsigned a = start; a < len && valid; a++)
+			valid = isDigit(str[a]);
+
+		return valid || (allow_hex && matchHex(str, len));
+	}
+
+	// ------------------------------------------------------------------------
+	// matchFloat
+	//
+	// Returns true if [str] is a valid floating point number. Same as
+	// StringUtils::isFloat (including its regex quirk of allowing any
+	// character as the decimal point) but works on a plain char buffer
+	// ------------------------------------------------------------------------
+	bool matchFloat(const char* str, unsigned len)
+	{
+		unsigned start = (len > 0 && (str[0] == '+' || str[0] == '-')) ? 1 : 0;
+
+		// Find end of integer part
+		unsigned int_end = start;
+		while (int_end < len && isDigit(str[int_end]))
+			int_end++;
+
+		// Try each possible split of [integer part][any char][fraction digits]
+		for (unsigned split = start; split <= int_end; split++)
+		{
+			for (unsigned frac = split; frac <= split + 1 && frac < len; frac++)
+			{
+				// Fraction digits (at least one)
+				unsigned pos = frac;
+				while (pos < len && isDigit(str[pos]))
+					pos++;
+				if (pos == frac)
+					continue;
+
+				// Optional exponent
+				if (pos < len && (str[pos] == 'e' || str[pos] == 'E'))
+				{
+					unsigned exp = pos + 1;
+					if (exp < len && (str[exp] == '+' || str[exp] == '-'))
+						exp++;
+					pos = exp;
+					while (pos < len && isDigit(str[pos]))
+						pos++;
+					if (pos == exp)
+						continue;
+				}
+
+				if (pos == len)
+					return true;
+			}
+		}
+
+		return false;
+	}
 }
 
 
@@ -78,7 +179,12 @@ namespace
 // ----------------------------------------------------------------------------
 bool Tokenizer::Token::isInteger(bool allow_hex) const
 {
-	return StringUtils::isInteger(text, allow_hex);
+	if (!view)
+		return StringUtils::isInteger(text, allow_hex);
+
+	char buf[128];
+	unsigned len = viewCopy(buf, 128);
+	return matchInteger(buf, len, allow_hex);
 }
 
 // ----------------------------------------------------------------------------
@@ -88,7 +194,12 @@ bool Tokenizer::Token::isInteger(bool allow_hex) const
 // ----------------------------------------------------------------------------
 bool Tokenizer::Token::isHex() const
 {
-	return StringUtils::isHex(text);
+	if (!view)
+		return StringUtils::isHex(text);
+
+	char buf[128];
+	unsigned len = viewCopy(buf, 128);
+	return matchHex(buf, len);
 }
 
 // ----------------------------------------------------------------------------
@@ -98,7 +209,51 @@ bool Tokenizer::Token::isHex() const
 // ----------------------------------------------------------------------------
 bool Tokenizer::Token::isFloat() const
 {
-	return StringUtils::isFloat(text);
+	if (!view)
+		return StringUtils::isFloat(text);
+
+	char buf[128];
+	unsigned len = viewCopy(buf, 128);
+	return matchFloat(buf, len);
+}
+
+// ----------------------------------------------------------------------------
+// Token::asString
+//
+// Returns the token text. In view mode this is built from the source data
+// ----------------------------------------------------------------------------
+string Tokenizer::Token::asString() const
+{
+	if (!view)
+		return text;
+
+	string str;
+	str.reserve(length);
+	for (unsigned a = 0; a < length; ++a)
+	{
+		if (quoted_string && data[a] == '\\')
+			if (++a >= length)
+				break;
+
+		str += lower ? asciiLower(data[a]) : data[a];
+	}
+
+	return str;
+}
+
+// ----------------------------------------------------------------------------
+// Token::asInt
+//
+// Returns the token as an integer value
+// ----------------------------------------------------------------------------
+int Tokenizer::Token::asInt() const
+{
+	if (!view)
+		return wxAtoi(text);
+
+	char buf[128];
+	viewCopy(buf, 128);
+	return atoi(buf);
 }
 
 // ----------------------------------------------------------------------------
@@ -109,22 +264,113 @@ bool Tokenizer::Token::isFloat() const
 // ----------------------------------------------------------------------------
 bool Tokenizer::Token::asBool() const
 {
-	return !(S_CMPNOCASE(text, "false") ||
-			 S_CMPNOCASE(text, "no") ||
-			 S_CMPNOCASE(text, "0"));
+	return !(equalsNC("false") || equalsNC("no") || equalsNC("0"));
 }
 
 // ----------------------------------------------------------------------------
-// Token::toBool
+// Token::asFloat
 //
-// Sets [val] to the token as a bool value.
-// "false", "no" and "0" are false, anything else is true.
+// Returns the token as a floating point value
 // ----------------------------------------------------------------------------
-void Tokenizer::Token::toBool(bool& val) const
+double Tokenizer::Token::asFloat() const
 {
-	val = !(S_CMPNOCASE(text, "false") ||
-			S_CMPNOCASE(text, "no") ||
-			S_CMPNOCASE(text, "0"));
+	if (!view)
+		return wxAtof(text);
+
+	char buf[128];
+	viewCopy(buf, 128);
+	return atof(buf);
+}
+
+// ----------------------------------------------------------------------------
+// Token::viewEquals
+//
+// Returns true if the token (as read from the source data) matches [cmp].
+// Escaped characters and lowercase reading are handled without building the
+// token text. If [nocase] is true, the comparison is case-insensitive
+// ----------------------------------------------------------------------------
+bool Tokenizer::Token::viewEquals(const char* cmp, bool nocase) const
+{
+	unsigned c = 0;
+	for (unsigned a = 0; a < length; ++a, ++c)
+	{
+		if (quoted_string && data[a] == '\\')
+			if (++a >= length)
+				break;
+
+		if (cmp[c] == 0)
+			return false;
+
+		char ch = lower ? asciiLower(data[a]) : data[a];
+		if (nocase ? asciiLower(ch) != asciiLower(cmp[c]) : ch != cmp[c])
+			return false;
+	}
+
+	return cmp[c] == 0;
+}
+bool Tokenizer::Token::viewEquals(const string& cmp, bool nocase) const
+{
+	unsigned c = 0;
+	for (unsigned a = 0; a < length; ++a, ++c)
+	{
+		if (quoted_string && data[a] == '\\')
+			if (++a >= length)
+				break;
+
+		if (c >= cmp.length() || !cmp[c].IsAscii())
+			return false;
+
+		char ch = lower ? asciiLower(data[a]) : data[a];
+		char cc = (char)cmp[c];
+		if (nocase ? asciiLower(ch) != asciiLower(cc) : ch != cc)
+			return false;
+	}
+
+	return c == cmp.length();
+}
+
+// ----------------------------------------------------------------------------
+// Token::viewChar
+//
+// Returns the character at [index] in the token (as read from the source data)
+// ----------------------------------------------------------------------------
+char Tokenizer::Token::viewChar(unsigned index) const
+{
+	unsigned c = 0;
+	for (unsigned a = 0; a < length; ++a, ++c)
+	{
+		if (quoted_string && data[a] == '\\')
+			if (++a >= length)
+				break;
+
+		if (c == index)
+			return lower ? asciiLower(data[a]) : data[a];
+	}
+
+	return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Token::viewCopy
+//
+// Copies the token (as read from the source data) to [buf] as a null-
+// terminated string, up to [buf_size] - 1 characters. Returns the number of
+// characters copied
+// ----------------------------------------------------------------------------
+unsigned Tokenizer::Token::viewCopy(char* buf, unsigned buf_size) const
+{
+	unsigned c = 0;
+	for (unsigned a = 0; a < length && c + 1 < buf_size; ++a, ++c)
+	{
+		if (quoted_string && data[a] == '\\')
+			if (++a >= length)
+				break;
+
+		buf[c] = lower ? asciiLower(data[a]) : data[a];
+	}
+	buf[c] = 0;
+
+	return c;
 }
 
 
@@ -145,7 +391,10 @@ Tokenizer::Tokenizer(int comments, const string& special_characters) :
 	special_characters_{special_characters.begin(), special_characters.end()},
 	decorate_{ false },
 	read_lowercase_{ false },
-	debug_{ false }
+	debug_{ false },
+	view_mode_{ false },
+	data_{ nullptr },
+	data_size_{ 0 }
 {
 }
 
@@ -237,7 +486,7 @@ bool Tokenizer::advIf(char check, size_t inc)
 // ----------------------------------------------------------------------------
 bool Tokenizer::advIfNC(const char* check, size_t inc)
 {
-	if (S_CMPNOCASE(token_current_.text, check))
+	if (token_current_.equalsNC(check))
 	{
 		adv(inc);
 		return true;
@@ -247,7 +496,7 @@ bool Tokenizer::advIfNC(const char* check, size_t inc)
 }
 bool Tokenizer::advIfNC(const string& check, size_t inc)
 {
-	if (S_CMPNOCASE(token_current_.text, check))
+	if (token_current_.equalsNC(check))
 	{
 		adv(inc);
 		return true;
@@ -311,7 +560,7 @@ bool Tokenizer::advIfNextNC(const char* check, size_t inc)
 	if (!token_next_.valid)
 		return false;
 
-	if (S_CMPNOCASE(token_next_.text, check))
+	if (token_next_.equalsNC(check))
 	{
 		adv(inc);
 		return true;
@@ -477,7 +726,7 @@ string Tokenizer::getLine(bool from_start)
 	}
 
 	string line;
-	while (data_[state_.position] != '\n' && data_[state_.position] != '\r')
+	while (state_.position < state_.size && data_[state_.position] != '\n' && data_[state_.position] != '\r')
 		line += data_[state_.position++];
 
 	readNext(&token_current_);
@@ -517,7 +766,7 @@ bool Tokenizer::checkOrEndNC(const char* check) const
 	if (!token_next_.valid)
 		return true;
 
-	return S_CMPNOCASE(token_current_.text, check);
+	return token_current_.equalsNC(check);
 }
 
 // ----------------------------------------------------------------------------
@@ -552,7 +801,7 @@ bool Tokenizer::checkNextNC(const char* check) const
 	if (!token_next_.valid)
 		return false;
 
-	return S_CMPNOCASE(token_next_.text, check);
+	return token_next_.equalsNC(check);
 }
 
 // ----------------------------------------------------------------------------
@@ -582,9 +831,11 @@ bool Tokenizer::openFile(const string& filename, size_t offset, size_t length)
 		length = (size_t) file.Length() - offset;
 
 	// Read the file portion
-	data_.resize((size_t) length, 0);
+	data_buffer_.resize((size_t) length, 0);
 	file.Seek(offset, wxFromStart);
-	file.Read(data_.data(), (size_t) length);
+	file.Read(data_buffer_.data(), (size_t) length);
+	data_ = data_buffer_.data();
+	data_size_ = data_buffer_.size();
 
 	reset();
 
@@ -608,7 +859,9 @@ bool Tokenizer::openString(const string& text, size_t offset, size_t length, con
 		length = ascii.length() - offset;
 
 	// Copy the string portion
-	data_.assign(ascii.data() + offset, ascii.data() + offset + length);
+	data_buffer_.assign(ascii.data() + offset, ascii.data() + offset + length);
+	data_ = data_buffer_.data();
+	data_size_ = data_buffer_.size();
 
 	reset();
 
@@ -623,7 +876,9 @@ bool Tokenizer::openString(const string& text, size_t offset, size_t length, con
 bool Tokenizer::openMem(const char* mem, size_t length, const string& source)
 {
 	source_ = source;
-	data_.assign(mem, mem + length);
+	data_buffer_.assign(mem, mem + length);
+	data_ = data_buffer_.data();
+	data_size_ = data_buffer_.size();
 
 	reset();
 
@@ -638,7 +893,28 @@ bool Tokenizer::openMem(const char* mem, size_t length, const string& source)
 bool Tokenizer::openMem(const MemChunk& mc, const string& source)
 {
 	source_ = source;
-	data_.assign(mc.getData(), mc.getData() + mc.getSize());
+	data_buffer_.assign(mc.getData(), mc.getData() + mc.getSize());
+	data_ = data_buffer_.data();
+	data_size_ = data_buffer_.size();
+
+	reset();
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+// Tokenizer::openMemView
+//
+// Opens text from a MemChunk [mc] without copying its data, so [mc] must not
+// be modified or destroyed while the tokenizer (or any view mode tokens read
+// from it) are in use
+// ----------------------------------------------------------------------------
+bool Tokenizer::openMemView(const MemChunk& mc, const string& source)
+{
+	source_ = source;
+	data_buffer_.clear();
+	data_ = (const char*)mc.getData();
+	data_size_ = mc.getSize();
 
 	reset();
 
@@ -654,7 +930,7 @@ void Tokenizer::reset()
 {
 	// Init tokenizing state
 	state_ = TokenizeState{};
-	state_.size = data_.size();
+	state_.size = data_size_;
 
 	// Read first tokens
 	readNext(&token_current_);
@@ -877,7 +1153,7 @@ void Tokenizer::tokenizeWhitespace()
 // ----------------------------------------------------------------------------
 bool Tokenizer::readNext(Token* target)
 {
-	if (data_.empty() || state_.position >= state_.size)
+	if (data_size_ == 0 || state_.position >= state_.size)
 	{
 		if (target) target->valid = false;
 		return false;
@@ -903,7 +1179,21 @@ bool Tokenizer::readNext(Token* target)
 	}
 
 	// Write to target token (if specified)
-	if (target)
+	if (target && view_mode_)
+	{
+		// View mode, just point to the token in the source data
+		target->text.clear();
+		target->data = data_ + state_.current_token.pos_start;
+		target->view = true;
+		target->lower = read_lowercase_ && !state_.current_token.quoted_string;
+		target->line_no = state_.current_token.line_no;
+		target->quoted_string = state_.current_token.quoted_string;
+		target->pos_start = state_.current_token.pos_start;
+		target->pos_end = state_.position;
+		target->length = target->pos_end - target->pos_start;
+		target->valid = true;
+	}
+	else if (target)
 	{
 		// How is this slower than using += in a loop as below? Just wxString things >_>
 		//target->text.assign(
@@ -920,6 +1210,9 @@ bool Tokenizer::readNext(Token* target)
 			target->text += data_[a];
 		}
 
+		target->data = data_ + state_.current_token.pos_start;
+		target->view = false;
+		target->lower = false;
 		target->line_no = state_.current_token.line_no;
 		target->quoted_string = state_.current_token.quoted_string;
 		target->pos_start = state_.current_token.pos_start;
@@ -937,7 +1230,7 @@ bool Tokenizer::readNext(Token* target)
 		++state_.position;
 
 	if (debug_)
-		Log::debug(S_FMT("%d: \"%s\"", token_current_.line_no, CHR(token_current_.text)));
+		Log::debug(S_FMT("%d: \"%s\"", token_current_.line_no, CHR(token_current_.asString())));
 		
 	return true;
 }
@@ -1043,3 +1336,57 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 			Log::debug(S_FMT("%d: \"%s\"%s", token.line_no, CHR(token.text), token.quoted_string ? " (quoted)" : ""));
 	}
 }
+
+CONSOLE_COMMAND(benchmark_tokenizer, 0, false)
+{
+	auto entry = MainEditor::currentEntry();
+	if (!entry || entry->getSize() == 0)
+		return;
+
+	long num = 10;
+	if (!args.empty())
+		args[0].ToLong(&num);
+
+	// Tokenizes the entry [num] times, doing a typical amount of checking and
+	// conversion for each token
+	auto run = [&](bool view)
+	{
+		Tokenizer tz;
+		tz.setViewMode(view);
+
+		unsigned tokens = 0;
+		unsigned numbers = 0;
+		long time = App::runTimer();
+		for (long a = 0; a < num; a++)
+		{
+			tz.openMemView(entry->getMCData(), entry->getName());
+			while (!tz.atEnd())
+			{
+				if (tz.check('{') || tz.check('}') || tz.checkNC("actor") || tz.checkNC("class"))
+					tokens++;
+				else if (tz.current().isInteger() && tz.current().asInt() != 0)
+					numbers++;
+				else if (tz.current().isFloat() && tz.current().asFloat() != 0)
+					numbers++;
+
+				tokens++;
+				tz.adv();
+			}
+		}
+		time = App::runTimer() - time;
+
+		double mb = (double)entry->getSize() * num / (1024.0 * 1024.0);
+		Log::info(S_FMT(
+			"%s: %ld tokens (%ld numbers) x%ld in %ldms (%1.2f MB/s)",
+			view ? "View mode" : "Text mode",
+			tokens / num,
+			numbers / num,
+			num,
+			time,
+			time > 0 ? mb / (time / 1000.0) : 0.0
+		));
+	};
+
+	run(false);
+	run(true);
+}
@@ -16,37 +16,49 @@ public:
 
 	struct Token
 	{
-		string		text;
+		string		text;			// Not read in view mode, use asString() instead
 		unsigned	line_no;
 		bool		quoted_string;
 		unsigned	pos_start;
 		unsigned	pos_end;
 		unsigned	length;
 		bool		valid;
-
-		explicit	operator	string() const { return text; }
-		explicit	operator	const string() const { return text; }
-		explicit	operator	const char*() const { return CHR(text); }
-		bool		operator	==(const string& cmp) const { return text == cmp; }
-		bool		operator	==(const char* cmp) const { return text.Cmp(cmp) == 0; }
-		bool		operator	==(char cmp) const { return length == 1 && text[0] == cmp; }
-		bool		operator	!=(const string& cmp) const { return text != cmp; }
-		bool		operator	!=(const char* cmp) const { return text.Cmp(cmp) != 0; }
-		bool		operator	!=(char cmp) const { return length != 1 || text[0] != cmp; }
-		char		operator	[](unsigned index) const { return text[index]; }
+		const char*	data = nullptr;	// Start of the token in the source data (escapes not processed)
+		bool		view = false;	// True if read in view mode
+		bool		lower = false;	// True if the token should be read in lowercase (view mode only)
+
+		explicit	operator	string() const { return asString(); }
+		explicit	operator	const string() const { return asString(); }
+		bool		operator	==(const string& cmp) const { return view ? viewEquals(cmp) : text == cmp; }
+		bool		operator	==(const char* cmp) const { return view ? viewEquals(cmp) : text.Cmp(cmp) == 0; }
+		bool		operator	==(char cmp) const { return length == 1 && (*this)[0] == cmp; }
+		bool		operator	!=(const string& cmp) const { return !(*this == cmp); }
+		bool		operator	!=(const char* cmp) const { return !(*this == cmp); }
+		bool		operator	!=(char cmp) const { return !(*this == cmp); }
+		char		operator	[](unsigned index) const { return view ? viewChar(index) : (char)text[index]; }
+
+		bool	equalsNC(const char* cmp) const { return view ? viewEquals(cmp, true) : S_CMPNOCASE(text, cmp); }
+		bool	equalsNC(const string& cmp) const { return view ? viewEquals(cmp, true) : S_CMPNOCASE(text, cmp); }
 
 		bool	isInteger(bool allow_hex = false) const;
 		bool	isHex() const;
 		bool	isFloat() const;
 
-		int		asInt() const { return wxAtoi(text); }
+		string	asString() const;
+		int		asInt() const;
 		bool	asBool() const;
-		double 	asFloat() const { return wxAtof(text); }
-
-		void 	toInt(int& val) const { val = wxAtoi(text); }
-		void 	toBool(bool& val) const;
-		void 	toFloat(double& val) const { val = wxAtof(text); }
-		void	toFloat(float& val) const { val = (float) wxAtof(text); }
+		double 	asFloat() const;
+
+		void 	toInt(int& val) const { val = asInt(); }
+		void 	toBool(bool& val) const { val = asBool(); }
+		void 	toFloat(double& val) const { val = asFloat(); }
+		void	toFloat(float& val) const { val = (float)asFloat(); }
+
+		// View mode
+		bool		viewEquals(const char* cmp, bool nocase = false) const;
+		bool		viewEquals(const string& cmp, bool nocase = false) const;
+		char		viewChar(unsigned index) const;
+		unsigned	viewCopy(char* buf, unsigned buf_size) const;
 	};
 
 	struct TokenizeState
@@ -78,6 +90,7 @@ public:
 	const string&	source() const { return source_; }
 	bool			decorate() const { return decorate_; }
 	bool			readLowerCase() const { return read_lowercase_; }
+	bool			viewMode() const { return view_mode_; }
 	const Token&	current() const { return token_current_; }
 	const Token&	peek() const;
 
@@ -87,6 +100,7 @@ public:
 			{ special_characters_.assign(characters, characters + strlen(characters)); }
 	void	setSource(const string& source) { source_ = source; }
 	void	setReadLowerCase(bool lower) { read_lowercase_ = lower; }
+	void	setViewMode(bool view) { view_mode_ = view; }
 	void 	enableDecorate(bool enable) { decorate_ = enable; }
 	void	enableDebug(bool enable) { debug_ = enable; }
 
@@ -122,7 +136,7 @@ public:
 	bool	checkOrEnd(const char* check) const;
 	bool	checkOrEnd(const string& check) const;
 	bool	checkOrEnd(char check) const;
-	bool	checkNC(const char* check) const { return S_CMPNOCASE(token_current_.text, check); }
+	bool	checkNC(const char* check) const { return token_current_.equalsNC(check); }
 	bool	checkOrEndNC(const char* check) const;
 	bool	checkNext(const char* check) const;
 	bool	checkNext(const string& check) const;
@@ -139,6 +153,7 @@ public:
 			);
 	bool	openMem(const char* mem, size_t length, const string& source);
 	bool	openMem(const MemChunk& mc, const string& source);
+	bool	openMemView(const MemChunk& mc, const string& source);
 
 	// General
 	bool	isSpecialCharacter(char p) const { return VECTOR_EXISTS(special_characters_, p); }
@@ -147,10 +162,10 @@ public:
 
 	// Old tokenizer interface bridge (don't use)
 	string		getToken()
-				{ if (atEnd()) return ""; string t = token_current_.text; adv(); return t; }
+				{ if (atEnd()) return ""; string t = token_current_.asString(); adv(); return t; }
 	void		getToken(string* str)
-				{ if (atEnd()) *str = ""; else *str = token_current_.text; adv(); }
-	string		peekToken() const { if (atEnd()) return ""; return token_next_.text; }
+				{ if (atEnd()) *str = ""; else *str = token_current_.asString(); adv(); }
+	string		peekToken() const { if (atEnd()) return ""; return token_next_.asString(); }
 	int			getInteger()
 				{ if (atEnd()) return 0; int v = token_current_.asInt(); adv(); return v; }
 	double		getDouble()
@@ -167,7 +182,9 @@ public:
 	static const Token&	invalidToken() { return invalid_token_; }
 
 private:
-	vector<char>	data_;
+	vector<char>	data_buffer_;
+	const char*		data_;
+	size_t			data_size_;
 	Token			token_current_;
 	Token			token_next_;
 	TokenizeState	state_;
@@ -180,6 +197,8 @@ private:
 	bool			read_lowercase_;		// If true, tokens will all be read in lowercase
 											// (except for quoted strings, obviously)
 	bool			debug_;					// Log each token read
+	bool			view_mode_;				// If true, tokens are read as views into the source
+											// data only (Token::text is not read)
 
 	// Static
 	static Token	invalid_token_;